@@ -0,0 +1,68 @@
+#include "base_benchmark_fixture.hpp"
+
+#include <format>
+#include <string>
+#include <vector>
+
+#include "../src/memory_mutator.hpp"
+#include "../src/types/object_function.hpp"
+
+// Allocation heavy programms where most of the objects are short-lived strings, that are garbage soon after they were
+// created.
+
+static auto StringConcatenationInLoop(benchmark::State & state) -> void {
+    runProgramm(state, "fun build() { var built = \"\"; var i = 0; while (i < 500) { built = built + \"x\"; i = i + 1; "
+                       "} return built; } var i = 0; while (i < 100) { build(); i = i + 1; }");
+}
+BENCHMARK(StringConcatenationInLoop)->Unit(benchmark::kMillisecond);
+
+// Keeps thousands of strings alive in the locals of a deep recursion, so the old generation is large when it is
+// collected, while short-lived strings are created in a loop. The prefixes grow in every iteration, so the strings are
+// never found among the interned strings
+static char const * const LIVE_STRINGS =
+    "fun churn() { var prefix = \"\"; var i = 0; while (i < 300) { prefix = prefix + \"y\"; var built = prefix; var "
+    "j = 0; while (j < 100) { built = built + \"x\"; j = j + 1; } i = i + 1; } } fun hold(depth, prefix) { if (depth "
+    "== 0) { churn(); return; } var a = prefix + \"a\"; var b = prefix + \"b\"; var c = prefix + \"c\"; var d = "
+    "prefix + \"d\"; var e = prefix + \"e\"; var f = prefix + \"f\"; var g = prefix + \"g\"; var h = prefix + "
+    "\"h\"; hold(depth - 1, prefix + \"i\"); } hold(900, \"\");";
+
+static auto LiveStringsStopTheWorld(benchmark::State & state) -> void {
+    runProgrammCollecting(state, LIVE_STRINGS, cppLox::CollectionMode::STOP_THE_WORLD);
+}
+BENCHMARK(LiveStringsStopTheWorld)->Unit(benchmark::kMillisecond);
+
+static auto LiveStringsIncremental(benchmark::State & state) -> void {
+    runProgrammCollecting(state, LIVE_STRINGS, cppLox::CollectionMode::INCREMENTAL);
+}
+BENCHMARK(LiveStringsIncremental)->Unit(benchmark::kMillisecond);
+
+// Creates objects in the old generation and frees them again, to measure the rate at which objects are allocated.
+// The strings are formatted up front, so only the allocation and the interning are measured
+
+static auto CreateAndCollectStrings(benchmark::State & state) -> void {
+    std::vector<std::string> strings;
+    for (int string = 0; string < 100000; string++) {
+        strings.push_back(std::format("string{}", string));
+    }
+    cppLox::MemoryMutator memoryMutator;
+    for (auto _ : state) {
+        for (std::string const & string : strings) {
+            memoryMutator.create<cppLox::Types::ObjectString>(string);
+        }
+        memoryMutator.collectGarbage();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * strings.size()));
+}
+BENCHMARK(CreateAndCollectStrings)->Unit(benchmark::kMillisecond);
+
+static auto CreateAndCollectFunctions(benchmark::State & state) -> void {
+    cppLox::MemoryMutator memoryMutator;
+    for (auto _ : state) {
+        for (int function = 0; function < 100000; function++) {
+            memoryMutator.create<cppLox::Types::ObjectFunction>(0, nullptr);
+        }
+        memoryMutator.collectGarbage();
+    }
+    state.SetItemsProcessed(state.iterations() * 100000);
+}
+BENCHMARK(CreateAndCollectFunctions)->Unit(benchmark::kMillisecond);
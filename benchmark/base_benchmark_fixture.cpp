@@ -0,0 +1,65 @@
+#include "base_benchmark_fixture.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
+#include <memory>
+
+#include "../src/backend/vm.hpp"
+#include "../src/frontend/compiler.hpp"
+#include "../src/frontend/lexer.hpp"
+#include "../src/init.hpp"
+#include "../src/memory_mutator.hpp"
+
+auto runProgramm(benchmark::State & state, std::string const & source, cppLox::ByteCode::Tier tier,
+                 cppLox::Frontend::CompilerOptions options) -> void {
+#ifdef PROFILE_DISPATCH
+    uint64_t dispatches = 0;
+#endif
+    for (auto _ : state) {
+        state.PauseTiming();
+        // Every iteration uses a new interpreter, because the globals of the previous run would still be defined
+        auto lexer = std::make_unique<cppLox::Frontend::Lexer>();
+        auto memoryMutator = std::make_shared<cppLox::MemoryMutator>();
+        auto vm = std::make_unique<cppLox::Backend::VM>(memoryMutator);
+        auto compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator, tier, options);
+        std::string programm = source;
+        state.ResumeTiming();
+        cppLox::run(programm, *lexer, *compiler, *vm);
+#ifdef PROFILE_DISPATCH
+        dispatches += vm->dispatchProfile().dispatches();
+#endif
+    }
+#ifdef PROFILE_DISPATCH
+    state.counters["dispatches"] =
+        benchmark::Counter(static_cast<double>(dispatches), benchmark::Counter::kAvgIterations);
+#endif
+}
+
+auto runProgrammCollecting(benchmark::State & state, std::string const & source, cppLox::CollectionMode mode)
+    -> void {
+    uint64_t pauses = 0;
+    std::chrono::nanoseconds longestPause(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto lexer = std::make_unique<cppLox::Frontend::Lexer>();
+        auto memoryMutator = std::make_shared<cppLox::MemoryMutator>();
+        memoryMutator->setCollectionMode(mode);
+        auto vm = std::make_unique<cppLox::Backend::VM>(memoryMutator);
+        auto compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+        std::string programm = source;
+        state.ResumeTiming();
+        cppLox::run(programm, *lexer, *compiler, *vm);
+        state.PauseTiming();
+        for (cppLox::CollectionPause pause :
+             {cppLox::CollectionPause::FULL, cppLox::CollectionPause::ROOT_SCAN, cppLox::CollectionPause::MARKING_STEP,
+              cppLox::CollectionPause::SWEEPING_STEP}) {
+            pauses += memoryMutator->pauseHistogram(pause).count();
+            longestPause = std::max(longestPause, memoryMutator->pauseHistogram(pause).longest());
+        }
+        state.ResumeTiming();
+    }
+    state.counters["pauses"] = benchmark::Counter(static_cast<double>(pauses), benchmark::Counter::kAvgIterations);
+    state.counters["longestPause"] =
+        static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(longestPause).count());
+}
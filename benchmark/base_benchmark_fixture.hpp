@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "../src/bytecode/tier.hpp"
+#include "../src/frontend/compiler_options.hpp"
+#include "../src/memory_mutator.hpp"
+
+/// @brief Runs the given lox programm using a freshly initialized interpreter for every iteration of the benchmark
+/// @param state The state of the benchmark
+/// @param source The source code of the programm
+/// @details If the interpreter is built with CLX_PROFILE_DISPATCH, the amount of dispatched instructions per iteration
+/// is reported as the dispatches counter.
+/// @param tier The tier of the virtual machine the programm is executed on
+/// @param options The optimizations the compiler applies to the programm
+auto runProgramm(benchmark::State & state, std::string const & source,
+                 cppLox::ByteCode::Tier tier = cppLox::ByteCode::Tier::STACK,
+                 cppLox::Frontend::CompilerOptions options = {}) -> void;
+
+/// @brief Runs the given lox programm with the given collection mode and reports the pauses, that collect the old
+/// generation
+/// @details The amount of pauses per iteration and the longest pause in microseconds are reported as the pauses and the
+/// longestPause counters.
+/// @param state The state of the benchmark
+/// @param source The source code of the programm
+/// @param mode How the old generation is collected
+auto runProgrammCollecting(benchmark::State & state, std::string const & source, cppLox::CollectionMode mode) -> void;
@@ -0,0 +1,24 @@
+#include "base_benchmark_fixture.hpp"
+
+// Call heavy programms where most of the time is spent setting up and tearing down call frames.
+
+static auto RecursiveFibonacci(benchmark::State & state) -> void {
+    runProgramm(state, "fun fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } fib(25);");
+}
+BENCHMARK(RecursiveFibonacci)->Unit(benchmark::kMillisecond);
+
+static auto CallInLoop(benchmark::State & state) -> void {
+    runProgramm(state, "fun identity(n) { return n; } for (var i = 0; i < 200000; i = i + 1) { identity(i); }");
+}
+BENCHMARK(CallInLoop)->Unit(benchmark::kMillisecond);
+
+static auto TailRecursiveLoop(benchmark::State & state) -> void {
+    runProgramm(state, "fun count(n, total) { if (n == 0) return total; return count(n - 1, total + n); } "
+                       "for (var i = 0; i < 100; i = i + 1) { count(2000, 0); }");
+}
+BENCHMARK(TailRecursiveLoop)->Unit(benchmark::kMillisecond);
+
+static auto NativeCallInLoop(benchmark::State & state) -> void {
+    runProgramm(state, "for (var i = 0; i < 200000; i = i + 1) { clock(); }");
+}
+BENCHMARK(NativeCallInLoop)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,30 @@
+#include "base_benchmark_fixture.hpp"
+
+// Loops, whose bodies use expressions on literals, that are compiled with and without constant folding.
+
+static auto const SecondsLoop = "{ var seconds = 0; var day = 0;"
+                                "  while (day < 500000) { seconds = seconds + 60 * 60 * 24; day = day + 1; } }";
+
+static auto const GreetingLoop = "{ var length = 0; var i = 0;"
+                                 "  while (i < 200000) { var greeting = \"Hello\" + \", \" + \"World\";"
+                                 "  if (!(1 < 2) or greeting == null) length = length - 1; i = i + 1; } }";
+
+static auto SecondsLoopUnfolded(benchmark::State & state) -> void {
+    runProgramm(state, SecondsLoop, cppLox::ByteCode::Tier::STACK, {.constantFolding = false});
+}
+BENCHMARK(SecondsLoopUnfolded)->Unit(benchmark::kMillisecond);
+
+static auto SecondsLoopFolded(benchmark::State & state) -> void {
+    runProgramm(state, SecondsLoop, cppLox::ByteCode::Tier::STACK, {.constantFolding = true});
+}
+BENCHMARK(SecondsLoopFolded)->Unit(benchmark::kMillisecond);
+
+static auto GreetingLoopUnfolded(benchmark::State & state) -> void {
+    runProgramm(state, GreetingLoop, cppLox::ByteCode::Tier::STACK, {.constantFolding = false});
+}
+BENCHMARK(GreetingLoopUnfolded)->Unit(benchmark::kMillisecond);
+
+static auto GreetingLoopFolded(benchmark::State & state) -> void {
+    runProgramm(state, GreetingLoop, cppLox::ByteCode::Tier::STACK, {.constantFolding = true});
+}
+BENCHMARK(GreetingLoopFolded)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,26 @@
+#include "base_benchmark_fixture.hpp"
+
+// Loop heavy programms where most of the time is spent dispatching short instructions.
+// Compare the results of cpplox-benchmarks (computed goto) with cpplox-benchmarks-switch.
+
+static auto NumericForLoop(benchmark::State & state) -> void {
+    runProgramm(state, "var sum = 0; for (var i = 0; i < 1000000; i = i + 1) { sum = sum + i; }");
+}
+BENCHMARK(NumericForLoop)->Unit(benchmark::kMillisecond);
+
+static auto NestedWhileLoops(benchmark::State & state) -> void {
+    runProgramm(state, "{ var i = 0; var j = 0; var count = 0;"
+                       "  while (i < 1000) { j = 0; while (j < 1000) { count = count + 1; j = j + 1; } i = i + 1; } }");
+}
+BENCHMARK(NestedWhileLoops)->Unit(benchmark::kMillisecond);
+
+static auto ArithmeticWhileLoop(benchmark::State & state) -> void {
+    runProgramm(state, "{ var x = 0; var n = 0; while (n < 500000) { x = x * 2 - x + n / 2; n = n + 1; } }");
+}
+BENCHMARK(ArithmeticWhileLoop)->Unit(benchmark::kMillisecond);
+
+static auto BranchingLoop(benchmark::State & state) -> void {
+    runProgramm(state, "var hits = 0; for (var i = 0; i < 500000; i = i + 1) {"
+                       "  if (i > 100000 and i <= 400000) { hits = hits + 1; } else { hits = hits - 1; } }");
+}
+BENCHMARK(BranchingLoop)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,14 @@
+#include "base_benchmark_fixture.hpp"
+
+// Programms that keep their whole state in global variables, so most instructions read or write a global.
+
+static auto GlobalCountingLoop(benchmark::State & state) -> void {
+    runProgramm(state, "var i = 0; var sum = 0; while (i < 200000) { sum = sum + i; i = i + 1; }");
+}
+BENCHMARK(GlobalCountingLoop)->Unit(benchmark::kMillisecond);
+
+static auto GlobalFunctionCalls(benchmark::State & state) -> void {
+    runProgramm(state, "var total = 0; fun add(n) { total = total + n; } var i = 0; while (i < 100000) { add(i); "
+                       "i = i + 1; }");
+}
+BENCHMARK(GlobalFunctionCalls)->Unit(benchmark::kMillisecond);
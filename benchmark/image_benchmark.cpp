@@ -0,0 +1,58 @@
+#include "base_benchmark_fixture.hpp"
+
+#include <format>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../src/bytecode/image.hpp"
+#include "../src/bytecode/image_loader.hpp"
+#include "../src/bytecode/image_writer.hpp"
+#include "../src/frontend/compiler.hpp"
+#include "../src/frontend/lexer.hpp"
+#include "../src/types/object_function.hpp"
+
+// Compiles a script with many small functions from its source code, compared to loading the image of the same script.
+// The script is not executed, so only the time until it could run is measured.
+
+static auto manyFunctions() -> std::string {
+    std::string source;
+    for (int function = 0; function < 150; function++) {
+        source += std::format("fun f{0}(a, b) {{ var c = a * {0} + b; if (c > {0}) {{ c = c - 1; }} return c + "
+                              "{0}.5; }} ",
+                              function);
+    }
+    source += "var total = 0;";
+    for (int function = 0; function < 150; function++) {
+        source += std::format(" total = total + f{}(1, 2);", function);
+    }
+    return source + " print total;";
+}
+
+static auto CompileScript(benchmark::State & state) -> void {
+    std::string const source = manyFunctions();
+    std::shared_ptr<cppLox::MemoryMutator> memoryMutator = std::make_shared<cppLox::MemoryMutator>();
+    for (auto _ : state) {
+        cppLox::Frontend::Lexer lexer;
+        cppLox::Frontend::Compiler compiler(memoryMutator, cppLox::ByteCode::Tier::STACK,
+                                            {.optimize = true, .inlining = true});
+        benchmark::DoNotOptimize(compiler.compile(lexer.tokenize(source)));
+    }
+}
+BENCHMARK(CompileScript)->Unit(benchmark::kMicrosecond);
+
+static auto LoadImageOfScript(benchmark::State & state) -> void {
+    std::string const source = manyFunctions();
+    std::shared_ptr<cppLox::MemoryMutator> memoryMutator = std::make_shared<cppLox::MemoryMutator>();
+    cppLox::Frontend::Lexer lexer;
+    cppLox::Frontend::Compiler compiler(memoryMutator, cppLox::ByteCode::Tier::STACK,
+                                        {.optimize = true, .inlining = true});
+    std::optional<std::vector<uint8_t>> image = cppLox::ByteCode::ImageWriter().write(
+        *compiler.compile(lexer.tokenize(source)).value(), *memoryMutator, 0, cppLox::ByteCode::IMAGE_FLAG_OPTIMIZED);
+    cppLox::ByteCode::ImageLoader loader(memoryMutator);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(loader.load(*image));
+    }
+}
+BENCHMARK(LoadImageOfScript)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,28 @@
+#include "base_benchmark_fixture.hpp"
+
+// A loop, that calls small helper functions, compiled with and without inlining and compared to the same loop with the
+// helpers inlined by hand.
+
+static auto const HelperCalls = "fun square(x) { return x * x; } fun clamp(x, low, high) { if (x < low) return low;"
+                                "  if (x > high) return high; return x; } fun sum() { var total = 0; var i = 0;"
+                                "  while (i < 200000) { total = total + clamp(square(i) - 1000, 0, 50000); i = i + 1; }"
+                                "  return total; } sum();";
+
+static auto const HandInlinedCalls = "fun sum() { var total = 0; var i = 0; var x = 0; while (i < 200000) {"
+                                     "  x = i * i - 1000; if (x < 0) x = 0; if (x > 50000) x = 50000;"
+                                     "  total = total + x; i = i + 1; } return total; } sum();";
+
+static auto HelperCallsNotInlined(benchmark::State & state) -> void {
+    runProgramm(state, HelperCalls, cppLox::ByteCode::Tier::STACK, {.inlining = false});
+}
+BENCHMARK(HelperCallsNotInlined)->Unit(benchmark::kMillisecond);
+
+static auto HelperCallsInlined(benchmark::State & state) -> void {
+    runProgramm(state, HelperCalls, cppLox::ByteCode::Tier::STACK, {.inlining = true});
+}
+BENCHMARK(HelperCallsInlined)->Unit(benchmark::kMillisecond);
+
+static auto HelperCallsInlinedByHand(benchmark::State & state) -> void {
+    runProgramm(state, HandInlinedCalls, cppLox::ByteCode::Tier::STACK, {.inlining = false});
+}
+BENCHMARK(HelperCallsInlinedByHand)->Unit(benchmark::kMillisecond);
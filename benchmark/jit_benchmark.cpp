@@ -0,0 +1,15 @@
+#include "base_benchmark_fixture.hpp"
+
+// Programms that spend their time in hot functions, which are compiled to native code if the jit compiler is enabled.
+
+static auto HotNumericFunction(benchmark::State & state) -> void {
+    runProgramm(state, "fun sum(n) { var total = 0; var i = 0; while (i < n) { total = total + i * 2 - 1; i = i + 1; } "
+                       "return total; } var result = 0; for (var i = 0; i < 5000; i = i + 1) { result = result + "
+                       "sum(100); }");
+}
+BENCHMARK(HotNumericFunction)->Unit(benchmark::kMillisecond);
+
+static auto HotRecursiveFunction(benchmark::State & state) -> void {
+    runProgramm(state, "fun fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } fib(27);");
+}
+BENCHMARK(HotRecursiveFunction)->Unit(benchmark::kMillisecond);
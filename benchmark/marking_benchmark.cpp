@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>
+
+#include <format>
+#include <vector>
+
+#include "../src/memory_mutator.hpp"
+#include "../src/types/object_function.hpp"
+
+// Collects a large heap, whose strings are referenced by the constants of thousands of functions, with an increasing
+// amount of marking threads. Compare the real time of the variants to see how the marking scales with the cores.
+
+// Keeps the functions of the large heap alive
+class LargeHeapRoots : public cppLox::RootSource {
+  public:
+    auto markRoots(cppLox::MemoryMutator & memoryMutator) -> void override {
+        for (cppLox::Types::Object * function : functions) {
+            memoryMutator.markObject(function);
+        }
+    }
+
+    std::vector<cppLox::Types::Object *> functions;
+};
+
+static auto CollectLargeHeap(benchmark::State & state) -> void {
+    cppLox::MemoryMutator memoryMutator;
+    memoryMutator.setMarkingThreads(static_cast<size_t>(state.range(0)));
+    LargeHeapRoots roots;
+    memoryMutator.addRootSource(&roots);
+    for (int function = 0; function < 4000; function++) {
+        roots.functions.push_back(memoryMutator.create<cppLox::Types::ObjectFunction>(0, nullptr));
+        cppLox::ByteCode::Chunk * chunk = roots.functions.back()->as<cppLox::Types::ObjectFunction>()->chunk();
+        for (int constant = 0; constant < 250; constant++) {
+            cppLox::Types::Object * string =
+                memoryMutator.create<cppLox::Types::ObjectString>(std::format("{}_{}", function, constant));
+            static_cast<void>(chunk->addConstant(cppLox::Types::Value(string)));
+        }
+    }
+    for (auto _ : state) {
+        memoryMutator.collectGarbage();
+    }
+    memoryMutator.removeRootSource(&roots);
+    state.counters["objects"] = static_cast<double>(roots.functions.size() * 251);
+}
+BENCHMARK(CollectLargeHeap)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,33 @@
+#include "base_benchmark_fixture.hpp"
+
+// Programms with loop invariant and redundant computations, that are compiled with and without the ssa based middle
+// end.
+
+static auto const InvariantLoop = "fun scale() { var factor = 3; var offset = 4; var sum = 0; var i = 0;"
+                                  "  while (i < 200000) { sum = sum + i * (factor * offset + 1) - factor / offset;"
+                                  "  i = i + 1; } return sum; } scale();";
+
+static auto const RedundantLoop = "fun area(width, height) { var total = 0; var shifted = 0; var unused = 0;"
+                                  "  var i = 0; while (i < 200000) { shifted = width * height - width * height + i;"
+                                  "  unused = shifted * 2; total = total + shifted; i = i + 1; } return total; }"
+                                  "area(7, 9);";
+
+static auto InvariantLoopNoSsa(benchmark::State & state) -> void {
+    runProgramm(state, InvariantLoop, cppLox::ByteCode::Tier::STACK, {.optimize = false});
+}
+BENCHMARK(InvariantLoopNoSsa)->Unit(benchmark::kMillisecond);
+
+static auto InvariantLoopSsa(benchmark::State & state) -> void {
+    runProgramm(state, InvariantLoop, cppLox::ByteCode::Tier::STACK, {.optimize = true});
+}
+BENCHMARK(InvariantLoopSsa)->Unit(benchmark::kMillisecond);
+
+static auto RedundantLoopNoSsa(benchmark::State & state) -> void {
+    runProgramm(state, RedundantLoop, cppLox::ByteCode::Tier::STACK, {.optimize = false});
+}
+BENCHMARK(RedundantLoopNoSsa)->Unit(benchmark::kMillisecond);
+
+static auto RedundantLoopSsa(benchmark::State & state) -> void {
+    runProgramm(state, RedundantLoop, cppLox::ByteCode::Tier::STACK, {.optimize = true});
+}
+BENCHMARK(RedundantLoopSsa)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,32 @@
+#include "base_benchmark_fixture.hpp"
+
+// Programms with negated conditions and branches at the end of loop bodies, that are compiled with and without the
+// peephole optimizer.
+
+static auto const CountingLoop = "{ var small = 0; var large = 0; var i = 0;"
+                                 "  while (!(i == 500000)) { if (!(i < 250000)) large = large + 1; "
+                                 "else small = small + 1; i = i + 1; } }";
+
+static auto const BranchLoop = "fun sign(n) { if (n < 0) return -1; else if (n > 0) return 1; else return 0; }"
+                               "{ var sum = 0; var i = -100000; while (i < 100000) { if (!(sign(i) == 0)) "
+                               "sum = sum + sign(i); else sum = sum - 1; i = i + 1; } }";
+
+static auto CountingLoopUnoptimized(benchmark::State & state) -> void {
+    runProgramm(state, CountingLoop, cppLox::ByteCode::Tier::STACK, {.peepholeOptimization = false});
+}
+BENCHMARK(CountingLoopUnoptimized)->Unit(benchmark::kMillisecond);
+
+static auto CountingLoopOptimized(benchmark::State & state) -> void {
+    runProgramm(state, CountingLoop, cppLox::ByteCode::Tier::STACK, {.peepholeOptimization = true});
+}
+BENCHMARK(CountingLoopOptimized)->Unit(benchmark::kMillisecond);
+
+static auto BranchLoopUnoptimized(benchmark::State & state) -> void {
+    runProgramm(state, BranchLoop, cppLox::ByteCode::Tier::STACK, {.peepholeOptimization = false});
+}
+BENCHMARK(BranchLoopUnoptimized)->Unit(benchmark::kMillisecond);
+
+static auto BranchLoopOptimized(benchmark::State & state) -> void {
+    runProgramm(state, BranchLoop, cppLox::ByteCode::Tier::STACK, {.peepholeOptimization = true});
+}
+BENCHMARK(BranchLoopOptimized)->Unit(benchmark::kMillisecond);
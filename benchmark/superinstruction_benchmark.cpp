@@ -0,0 +1,44 @@
+#include "base_benchmark_fixture.hpp"
+
+// Loop heavy programms, that are compiled with and without superinstructions.
+// Build the benchmarks with CLX_PROFILE_DISPATCH to compare the amount of dispatched instructions as well.
+
+static auto const CountingLoops =
+    "{ var i = 0; var j = 0; var count = 0;"
+    "  while (i < 1000) { j = 0; while (j < 1000) { count = count + 1; j = j + 1; } i = i + 1; } }";
+
+static auto const PolynomialLoop = "{ var sum = 0; var a = 3; var b = 5; var c = 7; var i = 0;"
+                                   "  while (i < 500000) { sum = sum + a * i * i + b * i + c; i = i + 1; } }";
+
+static auto const ComparingLoop = "{ var hits = 0; var i = 0; while (i < 500000) {"
+                                  "  if (i > 100000) { if (i <= 400000) hits = hits + 1; } i = i + 1; } }";
+
+static auto CountingLoopsPlain(benchmark::State & state) -> void {
+    runProgramm(state, CountingLoops, cppLox::ByteCode::Tier::STACK, {.superinstructions = false});
+}
+BENCHMARK(CountingLoopsPlain)->Unit(benchmark::kMillisecond);
+
+static auto CountingLoopsSuperinstructions(benchmark::State & state) -> void {
+    runProgramm(state, CountingLoops, cppLox::ByteCode::Tier::STACK, {.superinstructions = true});
+}
+BENCHMARK(CountingLoopsSuperinstructions)->Unit(benchmark::kMillisecond);
+
+static auto PolynomialLoopPlain(benchmark::State & state) -> void {
+    runProgramm(state, PolynomialLoop, cppLox::ByteCode::Tier::STACK, {.superinstructions = false});
+}
+BENCHMARK(PolynomialLoopPlain)->Unit(benchmark::kMillisecond);
+
+static auto PolynomialLoopSuperinstructions(benchmark::State & state) -> void {
+    runProgramm(state, PolynomialLoop, cppLox::ByteCode::Tier::STACK, {.superinstructions = true});
+}
+BENCHMARK(PolynomialLoopSuperinstructions)->Unit(benchmark::kMillisecond);
+
+static auto ComparingLoopPlain(benchmark::State & state) -> void {
+    runProgramm(state, ComparingLoop, cppLox::ByteCode::Tier::STACK, {.superinstructions = false});
+}
+BENCHMARK(ComparingLoopPlain)->Unit(benchmark::kMillisecond);
+
+static auto ComparingLoopSuperinstructions(benchmark::State & state) -> void {
+    runProgramm(state, ComparingLoop, cppLox::ByteCode::Tier::STACK, {.superinstructions = true});
+}
+BENCHMARK(ComparingLoopSuperinstructions)->Unit(benchmark::kMillisecond);
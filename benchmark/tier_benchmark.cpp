@@ -0,0 +1,44 @@
+#include "base_benchmark_fixture.hpp"
+
+// Arithmetic heavy programms that are executed on both tiers of the virtual machine.
+// Compare the results of the Stack and the Register variant of each benchmark.
+
+static auto const LocalArithmeticLoop =
+    "{ var x = 0; var n = 0; while (n < 500000) { x = x * 2 - x + n / 2; n = n + 1; } }";
+
+static auto const PolynomialLoop =
+    "{ var sum = 0; var a = 3; var b = 5; var c = 7; var i = 0;"
+    "  while (i < 500000) { sum = sum + a * i * i + b * i + c; i = i + 1; } }";
+
+static auto const RecursiveFibonacci =
+    "fun fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } fib(24);";
+
+static auto LocalArithmeticLoopStack(benchmark::State & state) -> void {
+    runProgramm(state, LocalArithmeticLoop, cppLox::ByteCode::Tier::STACK);
+}
+BENCHMARK(LocalArithmeticLoopStack)->Unit(benchmark::kMillisecond);
+
+static auto LocalArithmeticLoopRegister(benchmark::State & state) -> void {
+    runProgramm(state, LocalArithmeticLoop, cppLox::ByteCode::Tier::REGISTER);
+}
+BENCHMARK(LocalArithmeticLoopRegister)->Unit(benchmark::kMillisecond);
+
+static auto PolynomialLoopStack(benchmark::State & state) -> void {
+    runProgramm(state, PolynomialLoop, cppLox::ByteCode::Tier::STACK);
+}
+BENCHMARK(PolynomialLoopStack)->Unit(benchmark::kMillisecond);
+
+static auto PolynomialLoopRegister(benchmark::State & state) -> void {
+    runProgramm(state, PolynomialLoop, cppLox::ByteCode::Tier::REGISTER);
+}
+BENCHMARK(PolynomialLoopRegister)->Unit(benchmark::kMillisecond);
+
+static auto RecursiveFibonacciStack(benchmark::State & state) -> void {
+    runProgramm(state, RecursiveFibonacci, cppLox::ByteCode::Tier::STACK);
+}
+BENCHMARK(RecursiveFibonacciStack)->Unit(benchmark::kMillisecond);
+
+static auto RecursiveFibonacciRegister(benchmark::State & state) -> void {
+    runProgramm(state, RecursiveFibonacci, cppLox::ByteCode::Tier::REGISTER);
+}
+BENCHMARK(RecursiveFibonacciRegister)->Unit(benchmark::kMillisecond);
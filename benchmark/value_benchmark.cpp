@@ -0,0 +1,49 @@
+#include "base_benchmark_fixture.hpp"
+
+#include "../src/types/value.hpp"
+
+#include <format>
+#include <vector>
+
+// Stack heavy workloads, where the size of a value determines the memory traffic.
+// Compare the results of cpplox-benchmarks with cpplox-benchmarks-nan-boxing (or cpplox-benchmarks-tagged-union).
+
+static auto ValueArrayTraffic(benchmark::State & state) -> void {
+    std::vector<cppLox::Types::Value> values(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        // Pushes values like the vm does and sums them up afterwards
+        for (size_t index = 0; index < values.size(); index++) {
+            values[index] = cppLox::Types::Value(static_cast<double>(index));
+        }
+        double sum = 0;
+        for (cppLox::Types::Value const & value : values) {
+            sum += value.as<double>();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 2 * sizeof(cppLox::Types::Value));
+    state.SetLabel(std::format("sizeof(Value) = {}", sizeof(cppLox::Types::Value)));
+}
+// From a stack that fits into the L1 cache up to one that only fits into main memory
+BENCHMARK(ValueArrayTraffic)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+
+static auto ManyArgumentsCall(benchmark::State & state) -> void {
+    runProgramm(state, "fun sum(a, b, c, d, e, f, g, h) { return a + b + c + d + e + f + g + h; }"
+                       "var total = 0; for (var i = 0; i < 100000; i = i + 1) {"
+                       "  total = total + sum(i, i, i, i, i, i, i, i); }");
+}
+BENCHMARK(ManyArgumentsCall)->Unit(benchmark::kMillisecond);
+
+static auto DeepRecursionWithLocals(benchmark::State & state) -> void {
+    runProgramm(state, "fun walk(n) { var a = n; var b = n * 2; var c = n * 3; var d = n * 4;"
+                       "  if (n < 1) { return 0; } return walk(n - 1) + a + b + c + d; }"
+                       "for (var i = 0; i < 200; i = i + 1) { walk(500); }");
+}
+BENCHMARK(DeepRecursionWithLocals)->Unit(benchmark::kMillisecond);
+
+static auto NestedExpressions(benchmark::State & state) -> void {
+    runProgramm(state, "var x = 1; for (var i = 0; i < 100000; i = i + 1) {"
+                       "  x = ((((x + 1) * (x - 1)) - ((x + 2) * (x - 2))) + (((x + 3) * (x - 3)) - ((x + 4) * (x - "
+                       "4)))) / 8 + x; }");
+}
+BENCHMARK(NestedExpressions)->Unit(benchmark::kMillisecond);
@@ -34,6 +34,10 @@ class CallFrame {
 
     // The VM class is a friend of the CallFrame class
     friend class VM;
+#ifdef JIT
+    // The helpers of the native code update the instruction pointer, before they execute an instruction that can fail
+    friend class JitRuntime;
+#endif
 
   public:
     /// @brief Constructs a new call frame.
@@ -0,0 +1,103 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file dispatch_profile.cpp
+ * @details This file contains the implementation of the dispatch profile
+ */
+
+#include "dispatch_profile.hpp"
+
+#include <algorithm>
+#include <format>
+#include <numeric>
+
+using namespace cppLox::Backend;
+
+DispatchProfile::DispatchProfile() : m_pairs((UINT8_MAX + 1) * (UINT8_MAX + 1), 0), m_history(0), m_historyLength(0) {
+    m_opcodes.fill(0);
+}
+
+auto DispatchProfile::breakSequence() noexcept -> void {
+    m_history = 0;
+    m_historyLength = 0;
+}
+
+[[nodiscard]] auto DispatchProfile::dispatches() const noexcept -> uint64_t {
+    return std::accumulate(m_opcodes.begin(), m_opcodes.end(), uint64_t{0});
+}
+
+[[nodiscard]] auto DispatchProfile::count(cppLox::ByteCode::Opcode opcode) const noexcept -> uint64_t {
+    return m_opcodes[opcode];
+}
+
+[[nodiscard]] auto DispatchProfile::count(cppLox::ByteCode::Opcode first,
+                                          cppLox::ByteCode::Opcode second) const noexcept -> uint64_t {
+    return m_pairs[first << 8 | second];
+}
+
+[[nodiscard]] auto DispatchProfile::count(cppLox::ByteCode::Opcode first, cppLox::ByteCode::Opcode second,
+                                          cppLox::ByteCode::Opcode third) const -> uint64_t {
+    auto const triple = m_triples.find(static_cast<uint32_t>(first) << 16 | second << 8 | third);
+    return triple == m_triples.end() ? 0 : triple->second;
+}
+
+[[nodiscard]] auto DispatchProfile::mostFrequentPairs(size_t amount) const -> std::vector<Sequence<2>> {
+    std::vector<Sequence<2>> pairs;
+    for (size_t index = 0; index < m_pairs.size(); index++) {
+        if (m_pairs[index] != 0) {
+            pairs.push_back({{static_cast<cppLox::ByteCode::Opcode>(index >> 8),
+                              static_cast<cppLox::ByteCode::Opcode>(index & 0xff)},
+                             m_pairs[index]});
+        }
+    }
+    std::ranges::sort(pairs, std::ranges::greater(), &Sequence<2>::count);
+    pairs.resize(std::min(amount, pairs.size()));
+    return pairs;
+}
+
+[[nodiscard]] auto DispatchProfile::mostFrequentTriples(size_t amount) const -> std::vector<Sequence<3>> {
+    std::vector<Sequence<3>> triples;
+    for (auto const & [key, count] : m_triples) {
+        triples.push_back({{static_cast<cppLox::ByteCode::Opcode>(key >> 16),
+                            static_cast<cppLox::ByteCode::Opcode>(key >> 8 & 0xff),
+                            static_cast<cppLox::ByteCode::Opcode>(key & 0xff)},
+                           count});
+    }
+    std::ranges::sort(triples, std::ranges::greater(), &Sequence<3>::count);
+    triples.resize(std::min(amount, triples.size()));
+    return triples;
+}
+
+auto DispatchProfile::report(std::ostream & os, size_t amount) const -> void {
+    uint64_t const total = dispatches();
+    os << std::format("{} dispatches", total) << std::endl;
+    auto const share = [total](uint64_t count) { return total == 0 ? 0.0 : 100.0 * count / total; };
+    os << "Most frequent pairs:" << std::endl;
+    for (auto const & pair : mostFrequentPairs(amount)) {
+        os << std::format("  {:>12} {:5.1f}%  {} {}", pair.count, share(pair.count),
+                          cppLox::ByteCode::opcode_as_string(pair.opcodes[0]),
+                          cppLox::ByteCode::opcode_as_string(pair.opcodes[1]))
+           << std::endl;
+    }
+    os << "Most frequent triples:" << std::endl;
+    for (auto const & triple : mostFrequentTriples(amount)) {
+        os << std::format("  {:>12} {:5.1f}%  {} {} {}", triple.count, share(triple.count),
+                          cppLox::ByteCode::opcode_as_string(triple.opcodes[0]),
+                          cppLox::ByteCode::opcode_as_string(triple.opcodes[1]),
+                          cppLox::ByteCode::opcode_as_string(triple.opcodes[2]))
+           << std::endl;
+    }
+}
@@ -0,0 +1,124 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file dispatch_profile.hpp
+ * @details This file contains the declaration of the dispatch profile, that counts the executed opcode sequences
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "../bytecode/opcode.hpp"
+
+namespace cppLox::Backend {
+
+/// @brief Counts how often every opcode, opcode pair and opcode triple is dispatched by the virtual machine.
+/// @details The profile is used to find the instruction sequences that are worth to be fused into a superinstruction.
+/// It is only collected by the virtual machine if the interpreter is built with CLX_PROFILE_DISPATCH.
+class DispatchProfile {
+  public:
+    /// @brief A sequence of opcodes and how often it was dispatched.
+    template <size_t LENGTH> struct Sequence {
+        /// @brief The opcodes of the sequence in the order they were dispatched.
+        std::array<cppLox::ByteCode::Opcode, LENGTH> opcodes;
+        /// @brief How often the sequence was dispatched.
+        uint64_t count;
+    };
+
+    /// @brief Constructs a new, empty dispatch profile
+    DispatchProfile();
+
+    /// @brief Records the dispatch of the given opcode
+    /// @param opcode The dispatched opcode
+    auto record(uint8_t opcode) -> void {
+        m_opcodes[opcode]++;
+        // The history holds the previous two opcodes, the older one in the upper byte
+        if (m_historyLength > 0) {
+            m_pairs[(m_history & 0xff) << 8 | opcode]++;
+        }
+        if (m_historyLength > 1) {
+            m_triples[static_cast<uint32_t>(m_history) << 8 | opcode]++;
+        } else {
+            m_historyLength++;
+        }
+        m_history = static_cast<uint16_t>(m_history << 8 | opcode);
+    }
+
+    /// @brief Forgets the previously dispatched opcodes, so no sequence is recorded across the boundary
+    auto breakSequence() noexcept -> void;
+
+    /// @brief Gets the total amount of dispatches
+    /// @return The total amount of dispatches
+    [[nodiscard]] auto dispatches() const noexcept -> uint64_t;
+
+    /// @brief Gets how often the given opcode was dispatched
+    /// @param opcode The opcode
+    /// @return How often the opcode was dispatched
+    [[nodiscard]] auto count(cppLox::ByteCode::Opcode opcode) const noexcept -> uint64_t;
+
+    /// @brief Gets how often the given opcodes were dispatched directly after each other
+    /// @param first The first opcode of the pair
+    /// @param second The second opcode of the pair
+    /// @return How often the pair was dispatched
+    [[nodiscard]] auto count(cppLox::ByteCode::Opcode first, cppLox::ByteCode::Opcode second) const noexcept
+        -> uint64_t;
+
+    /// @brief Gets how often the given opcodes were dispatched directly after each other
+    /// @param first The first opcode of the triple
+    /// @param second The second opcode of the triple
+    /// @param third The third opcode of the triple
+    /// @return How often the triple was dispatched
+    [[nodiscard]] auto count(cppLox::ByteCode::Opcode first, cppLox::ByteCode::Opcode second,
+                             cppLox::ByteCode::Opcode third) const -> uint64_t;
+
+    /// @brief Gets the most frequently dispatched opcode pairs
+    /// @param amount The maximum amount of pairs
+    /// @return The pairs, ordered by their count descending
+    [[nodiscard]] auto mostFrequentPairs(size_t amount) const -> std::vector<Sequence<2>>;
+
+    /// @brief Gets the most frequently dispatched opcode triples
+    /// @param amount The maximum amount of triples
+    /// @return The triples, ordered by their count descending
+    [[nodiscard]] auto mostFrequentTriples(size_t amount) const -> std::vector<Sequence<3>>;
+
+    /// @brief Prints the total amount of dispatches and the most frequent pairs and triples
+    /// @param os The output stream to print to
+    /// @param amount The amount of pairs and triples that are printed
+    auto report(std::ostream & os, size_t amount = 10) const -> void;
+
+  private:
+    /// @brief How often every opcode was dispatched
+    std::array<uint64_t, UINT8_MAX + 1> m_opcodes;
+
+    /// @brief How often every opcode pair was dispatched, indexed by the first opcode in the upper byte
+    std::vector<uint64_t> m_pairs;
+
+    /// @brief How often every opcode triple that occured was dispatched, keyed by the three opcodes
+    std::unordered_map<uint32_t, uint64_t> m_triples;
+
+    /// @brief The two previously dispatched opcodes
+    uint16_t m_history;
+
+    /// @brief The amount of valid opcodes in the history
+    uint8_t m_historyLength;
+};
+
+} // namespace cppLox::Backend
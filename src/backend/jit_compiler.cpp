@@ -0,0 +1,891 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file jit_compiler.cpp
+ * @details This file contains the implementation of the baseline jit compiler, that translates hot functions into
+ * native code
+ */
+
+#ifdef JIT
+
+#include "jit_compiler.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../bytecode/opcode.hpp"
+#include "vm.hpp"
+
+using namespace cppLox::Backend;
+
+namespace {
+
+/// @brief The status, that is returned by a helper to the native code
+enum class Status : uint64_t {
+    /// @brief The native code continues with the next instruction
+    CONTINUE = 0,
+    /// @brief The native code jumps to the target of the instruction, a tail call leaves the native code for the
+    /// callee
+    JUMP = 1,
+    /// @brief A runtime error occurred and the native code returns to the virtual machine
+    ERROR = 2
+};
+
+/// @brief The result of a helper, that is returned in rax and rdx
+struct Result {
+    /// @brief The new top of the stack
+    cppLox::Types::Value * top;
+    /// @brief The status of the instruction
+    Status status;
+};
+
+/// @brief The signature of the helpers, that implement the instructions
+/// @details The arguments are the virtual machine, the slots of the call frame, the top of the stack, the instruction
+/// pointer after the opcode and the operand of the instruction.
+using Helper = Result (*)(VM *, cppLox::Types::Value *, cppLox::Types::Value *, uint8_t *, uint64_t);
+
+/// @brief The value of nil, that is pushed by the native code
+cppLox::Types::Value const NIL_VALUE;
+
+/// @brief The value of true, that is pushed by the native code
+cppLox::Types::Value const TRUE_VALUE(true);
+
+/// @brief The value of false, that is pushed by the native code
+cppLox::Types::Value const FALSE_VALUE(false);
+
+} // namespace
+
+namespace cppLox::Backend {
+
+/// @brief The helpers of the native code and the layout of the values, that the native code relies on
+/// @details The helpers behave exactly like the handlers of the instructions in the interpreter. Every helper stores
+/// the top of the stack and the instruction pointer in the virtual machine before it executes the instruction, so that
+/// the stack trace of a runtime error points to the right line.
+class JitRuntime {
+  public:
+    /// @brief The size of a value in bytes
+    static constexpr int32_t VALUE_SIZE = sizeof(cppLox::Types::Value);
+#ifdef NAN_BOXING
+    /// @brief The offset of the number in a value
+    static constexpr int32_t NUMBER_OFFSET = 0;
+
+    /// @brief The bits that are set in every value, that is not a number
+    static constexpr uint64_t QUIET_NAN = cppLox::Types::Value::QUIET_NAN;
+
+    /// @brief The encoding of null, false is encoded by the next bit pattern
+    static constexpr uint64_t NULL_BITS = cppLox::Types::Value::NULL_BITS;
+    static_assert(cppLox::Types::Value::FALSE_BITS == NULL_BITS + 1, "the falsey values have to be adjacent");
+#else
+    /// @brief The offset of the type in a value
+    static constexpr int32_t TYPE_OFFSET = offsetof(cppLox::Types::Value, m_type);
+
+    /// @brief The offset of the number and the boolean in a value
+    static constexpr int32_t NUMBER_OFFSET = offsetof(cppLox::Types::Value, m_underlying_value);
+#endif
+
+    template <auto OPERATION>
+    static auto binary(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip, uint64_t)
+        -> Result {
+        return guarded(vm, top, ip, [&] {
+            cppLox::Types::Value const right = pop(vm);
+            cppLox::Types::Value const left = pop(vm);
+            std::optional<cppLox::Types::Value> const result = OPERATION(*vm, left, right);
+            if (!result) {
+                return false;
+            }
+            push(vm, *result);
+            return true;
+        });
+    }
+
+    template <auto COMPARISON>
+    static auto compareJumpIfFalse(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip,
+                                   uint64_t) -> Result {
+        return guarded(vm, top, ip, [&] {
+            cppLox::Types::Value const right = pop(vm);
+            cppLox::Types::Value const left = pop(vm);
+            std::optional<cppLox::Types::Value> const condition = COMPARISON(*vm, left, right);
+            if (!condition) {
+                return Status::ERROR;
+            }
+            return condition->isFalsey() ? Status::JUMP : Status::CONTINUE;
+        });
+    }
+
+    static auto negate(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip, uint64_t)
+        -> Result {
+        return guarded(vm, top, ip, [&] {
+            std::optional<cppLox::Types::Value> const result = vm->negate(pop(vm));
+            if (!result) {
+                return false;
+            }
+            push(vm, *result);
+            return true;
+        });
+    }
+
+    static auto logicalNot(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip, uint64_t)
+        -> Result {
+        return guarded(vm, top, ip, [&] { push(vm, !pop(vm)); });
+    }
+
+    static auto getGlobal(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip, uint64_t slot)
+        -> Result {
+        return guarded(vm, top, ip, [&] { push(vm, vm->m_memoryMutator->getGlobal(slot)); });
+    }
+
+    static auto defineGlobal(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip,
+                             uint64_t slot) -> Result {
+        return guarded(vm, top, ip, [&] { return vm->defineGlobal(static_cast<uint16_t>(slot), pop(vm)); });
+    }
+
+    static auto setGlobal(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip, uint64_t slot)
+        -> Result {
+        return guarded(vm, top, ip, [&] {
+            return vm->setGlobal(currentFrame(vm), static_cast<uint16_t>(slot), vm->m_stack[vm->m_stack_top - 1]);
+        });
+    }
+
+    static auto print(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip, uint64_t)
+        -> Result {
+        return guarded(vm, top, ip, [&] { std::cout << pop(vm) << std::endl; });
+    }
+
+    static auto call(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip, uint64_t argCount)
+        -> Result {
+        return guarded(vm, top, ip, [&] {
+            size_t const frameCount = vm->m_frame_count;
+            cppLox::Types::Value callee = vm->m_stack[vm->m_stack_top - 1 - argCount];
+            if (!vm->callFunction(callee, static_cast<uint8_t>(argCount), currentFrame(vm))) {
+                return false;
+            }
+            // Native functions return immediately, lox functions are executed until they returned to this frame
+            return vm->m_frame_count == frameCount || vm->runNested(frameCount) == InterpretResult::OK;
+        });
+    }
+
+    static auto callInlined(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip,
+                            uint64_t argCount) -> Result {
+        return guarded(vm, top, ip, [&] {
+            cppLox::Types::Value callee = vm->m_stack[vm->m_stack_top - 1 - argCount];
+            uint16_t const constant = static_cast<uint16_t>(ip[1] << 8 | ip[2]);
+            // The inlined body follows the instruction, any other callee is called and the body is jumped over
+            if (callee == currentFrame(vm).m_function->chunk()->getConstant(constant)) {
+                return Status::CONTINUE;
+            }
+            size_t const frameCount = vm->m_frame_count;
+            if (!vm->callFunction(callee, static_cast<uint8_t>(argCount), currentFrame(vm))) {
+                return Status::ERROR;
+            }
+            return vm->m_frame_count == frameCount || vm->runNested(frameCount) == InterpretResult::OK ? Status::JUMP
+                                                                                                       : Status::ERROR;
+        });
+    }
+
+    static auto tailCall(VM * vm, cppLox::Types::Value *, cppLox::Types::Value * top, uint8_t * ip, uint64_t argCount)
+        -> Result {
+        return guarded(vm, top, ip, [&] {
+            cppLox::Types::Value callee = vm->m_stack[vm->m_stack_top - 1 - argCount];
+            if (callee.is(cppLox::Types::Value::Type::OBJECT) &&
+                callee.as<cppLox::Types::Object *>()->is(cppLox::Types::Object::Type::FUNCTION)) {
+                cppLox::Types::ObjectFunction & function =
+                    *callee.as<cppLox::Types::Object *>()->as<cppLox::Types::ObjectFunction>();
+                return vm->tailCall(function, static_cast<uint8_t>(argCount), currentFrame(vm)) ? Status::JUMP
+                                                                                                   : Status::ERROR;
+            }
+            return vm->callFunction(callee, static_cast<uint8_t>(argCount), currentFrame(vm)) ? Status::CONTINUE
+                                                                                                : Status::ERROR;
+        });
+    }
+
+    static auto returnFromFunction(VM * vm, cppLox::Types::Value * slots, cppLox::Types::Value * top, uint8_t *,
+                                   uint64_t) -> Result {
+        // Discards the arguments, the locals and the callee of the returning function
+        slots[0] = top[-1];
+        vm->m_stack_top = slots - vm->m_stack.data() + 1;
+        vm->m_frame_count--;
+        return {slots + 1, Status::CONTINUE};
+    }
+
+    static auto add(VM & vm, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value> {
+        return vm.add(left, right);
+    }
+
+    static auto subtract(VM & vm, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value> {
+        return vm.subtract(left, right);
+    }
+
+    static auto multiply(VM & vm, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value> {
+        return vm.multiply(left, right);
+    }
+
+    static auto divide(VM & vm, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value> {
+        return vm.divide(left, right);
+    }
+
+    static auto equal(VM &, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value> {
+        return cppLox::Types::Value(left == right);
+    }
+
+    static auto notEqual(VM &, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value> {
+        return cppLox::Types::Value(left != right);
+    }
+
+    static auto greater(VM & vm, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value> {
+        return vm.greater(left, right);
+    }
+
+    static auto greaterEqual(VM & vm, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value> {
+        return vm.greaterEqual(left, right);
+    }
+
+    static auto less(VM & vm, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value> {
+        return vm.less(left, right);
+    }
+
+    static auto lessEqual(VM & vm, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value> {
+        return vm.lessEqual(left, right);
+    }
+
+  private:
+    static auto push(VM * vm, cppLox::Types::Value value) -> void {
+        vm->m_stack[vm->m_stack_top++] = value;
+    }
+
+    static auto pop(VM * vm) -> cppLox::Types::Value {
+        return vm->m_stack[--vm->m_stack_top];
+    }
+
+    static auto currentFrame(VM * vm) -> CallFrame & {
+        return vm->m_frames[vm->m_frame_count - 1];
+    }
+
+    /// @brief Executes an instruction on the stack of the virtual machine
+    /// @details An instruction, that can fail, returns false or Status::ERROR after the runtime error was recorded in
+    /// the virtual machine. Any other exception is stored in the virtual machine, that rethrows it after the native
+    /// code returned, because it must not unwind through the native code.
+    template <typename Instruction>
+    static auto guarded(VM * vm, cppLox::Types::Value * top, uint8_t * ip, Instruction instruction) -> Result {
+        vm->m_stack_top = top - vm->m_stack.data();
+        currentFrame(vm).m_instruction_pointer = ip;
+        try {
+            Status status = Status::CONTINUE;
+            if constexpr (std::is_void_v<std::invoke_result_t<Instruction>>) {
+                instruction();
+            } else if constexpr (std::is_same_v<std::invoke_result_t<Instruction>, bool>) {
+                status = instruction() ? Status::CONTINUE : Status::ERROR;
+            } else {
+                status = instruction();
+            }
+            if (status == Status::ERROR) [[unlikely]] {
+                return {nullptr, Status::ERROR};
+            }
+            return {vm->m_stack.data() + vm->m_stack_top, status};
+        } catch (...) {
+            vm->m_jitException = std::current_exception();
+            return {nullptr, Status::ERROR};
+        }
+    }
+};
+} // namespace cppLox::Backend
+
+namespace {
+
+/// @brief The general purpose registers of x86-64
+enum Register : uint8_t {
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3,
+    RSP = 4,
+    RBP = 5,
+    RSI = 6,
+    RDI = 7,
+    R8 = 8,
+    R12 = 12,
+    R13 = 13
+};
+
+/// @brief The condition codes of x86-64, that are used by the conditional jumps
+enum class Condition : uint8_t { BELOW = 0x2, EQUAL = 0x4, NOT_EQUAL = 0x5, BELOW_EQUAL = 0x6, PARITY = 0xA };
+
+/// @brief The sse instructions, that are used for the numbers
+enum class Sse : uint8_t {
+    LOAD = 0x10,
+    STORE = 0x11,
+    ADD = 0x58,
+    MULTIPLY = 0x59,
+    SUBTRACT = 0x5C,
+    DIVIDE = 0x5E,
+    COMPARE = 0x2E
+};
+
+/// @brief The mandatory prefix of the sse instructions on doubles
+#define SSE_DOUBLE_PREFIX 0xF2
+
+/// @brief The mandatory prefix of the comparison of doubles
+#define SSE_COMPARE_PREFIX 0x66
+
+/// @brief Emits the x86-64 machine code of a function
+/// @details The native code keeps the virtual machine in rbx, the slots of the call frame in r12 and the top of the
+/// stack in r13, as these registers are preserved by the calls of the helpers. Values are read and written in place on
+/// the stack of the virtual machine.
+class Assembler {
+  public:
+    /// @brief Saves the callee saved registers, three pushes keep the stack aligned to 16 bytes for the helpers
+    auto prologue() -> void {
+        emit({0x53});             // push rbx
+        emit({0x41, 0x54});       // push r12
+        emit({0x41, 0x55});       // push r13
+        moveRegister(RBX, RDI);   // the virtual machine
+        moveRegister(R12, RSI);   // the slots of the call frame
+        moveRegister(R13, RDX);   // the top of the stack
+    }
+
+    /// @brief Restores the callee saved registers and returns the given result
+    auto epilogue(bool result) -> void {
+        if (result) {
+            emit({0xB8, 0x01, 0x00, 0x00, 0x00}); // mov eax, 1
+        } else {
+            emit({0x31, 0xC0}); // xor eax, eax
+        }
+        emit({0x41, 0x5D}); // pop r13
+        emit({0x41, 0x5C}); // pop r12
+        emit({0x5B});       // pop rbx
+        emit({0xC3});       // ret
+    }
+
+    /// @brief Calls the given helper and takes over the top of the stack, that is returned by the helper
+    auto call(Helper helper, uint8_t * ip, uint64_t operand) -> void {
+        moveRegister(RDI, RBX);
+        moveRegister(RSI, R12);
+        moveRegister(RDX, R13);
+        moveImmediate(RCX, reinterpret_cast<uint64_t>(ip));
+        moveImmediate(R8, operand);
+        moveImmediate(RAX, reinterpret_cast<uint64_t>(helper));
+        emit({0xFF, 0xD0}); // call rax
+        moveRegister(R13, RAX);
+    }
+
+    /// @brief Emits a jump, that is taken if the last helper returned the given status
+    /// @return The position of the displacement, that is patched once the target is known
+    auto jumpIfStatus(Status status) -> size_t {
+        emit({0x80, 0xFA, static_cast<uint8_t>(status)}); // cmp dl, status
+        return jumpIf(Condition::EQUAL);
+    }
+
+    /// @brief Emits an unconditional jump
+    /// @return The position of the displacement, that is patched once the target is known
+    auto jump() -> size_t {
+        emit({0xE9}); // jmp rel32
+        return displacement();
+    }
+
+    /// @brief Emits a conditional jump
+    /// @return The position of the displacement, that is patched once the target is known
+    auto jumpIf(Condition condition) -> size_t {
+        emit({0x0F, static_cast<uint8_t>(0x80 | static_cast<uint8_t>(condition))}); // jcc rel32
+        return displacement();
+    }
+
+    /// @brief Copies a value in memory
+    auto copyValue(Register destination, int32_t destinationOffset, Register source, int32_t sourceOffset) -> void {
+#ifdef NAN_BOXING
+        memory(true, 0x8B, RCX, source, sourceOffset);           // mov rcx, [source]
+        memory(true, 0x89, RCX, destination, destinationOffset); // mov [destination], rcx
+#else
+        sse(0, Sse::LOAD, source, sourceOffset);            // movups xmm0, [source]
+        sse(0, Sse::STORE, destination, destinationOffset); // movups [destination], xmm0
+#endif
+    }
+
+    /// @brief Emits a jump, that is taken if the value in memory is not a number
+    /// @return The position of the displacement, that is patched once the target is known
+    auto jumpIfNotNumber(Register base, int32_t offset) -> size_t {
+#ifdef NAN_BOXING
+        memory(true, 0x8B, RAX, base, offset); // mov rax, [value]
+        moveImmediate(RCX, JitRuntime::QUIET_NAN);
+        emit({0x48, 0x21, 0xC8}); // and rax, rcx
+        emit({0x48, 0x39, 0xC8}); // cmp rax, rcx
+        return jumpIf(Condition::EQUAL);
+#else
+        memory(false, 0x83, 7, base, offset + JitRuntime::TYPE_OFFSET); // cmp dword [value.type], NUMBER
+        emit({static_cast<uint8_t>(cppLox::Types::Value::Type::NUMBER)});
+        return jumpIf(Condition::NOT_EQUAL);
+#endif
+    }
+
+    /// @brief Emits a jump, that is taken if the value in memory is falsey - null or false, like Value::isFalsey
+    /// @return The position of the displacement, that is patched once the target is known
+    auto jumpIfFalse(Register base, int32_t offset) -> size_t {
+#ifdef NAN_BOXING
+        memory(true, 0x8B, RAX, base, offset); // mov rax, [value]
+        moveImmediate(RCX, JitRuntime::NULL_BITS);
+        emit({0x48, 0x29, 0xC8});       // sub rax, rcx
+        emit({0x48, 0x83, 0xF8, 0x02}); // cmp rax, 2
+        return jumpIf(Condition::BELOW);
+#else
+        memory(false, 0x83, 7, base, offset + JitRuntime::TYPE_OFFSET); // cmp dword [value.type], BOOL
+        emit({static_cast<uint8_t>(cppLox::Types::Value::Type::BOOL)});
+        size_t const notBool = jumpIf(Condition::NOT_EQUAL);
+        memory(false, 0x80, 7, base, offset + JitRuntime::NUMBER_OFFSET); // cmp byte [value.bool], 0
+        emit({0x00});
+        size_t const tested = jump();
+        bind(notBool);
+        memory(false, 0x83, 7, base, offset + JitRuntime::TYPE_OFFSET); // cmp dword [value.type], NULL
+        emit({static_cast<uint8_t>(cppLox::Types::Value::Type::NULL_)});
+        bind(tested);
+        return jumpIf(Condition::EQUAL);
+#endif
+    }
+
+    /// @brief Emits an sse instruction on xmm0, that uses a value in memory as its operand
+    auto sse(uint8_t prefix, Sse instruction, Register base, int32_t offset) -> void {
+        if (prefix != 0) {
+            emit({prefix});
+        }
+        memory(false, 0x0F, 0, base, offset, static_cast<uint8_t>(instruction));
+    }
+
+    /// @brief Compares the number in xmm0 with itself, which sets the parity flag if it is NaN
+    auto compareNaN() -> void {
+        emit({0x66, 0x0F, 0x2E, 0xC0}); // ucomisd xmm0, xmm0
+    }
+
+    /// @brief Adds a signed immediate to the given register, without changing the flags
+    auto addImmediate(Register reg, int32_t value) -> void {
+        memory(true, 0x8D, reg, reg, value); // lea reg, [reg + value]
+    }
+
+    /// @brief Loads the given immediate into the given register
+    auto moveImmediate(Register reg, uint64_t value) -> void {
+        rex(true, 0, reg);
+        emit({static_cast<uint8_t>(0xB8 | (reg & 7))}); // mov reg, imm64
+        immediate(value);
+    }
+
+    /// @brief Patches the displacement at the given position, so the jump targets the given position
+    auto patch(size_t position, size_t target) -> void {
+        int32_t const relative = static_cast<int32_t>(target) - static_cast<int32_t>(position + sizeof(int32_t));
+        std::memcpy(m_code.data() + position, &relative, sizeof(relative));
+    }
+
+    /// @brief Patches the displacement at the given position, so the jump targets the current position
+    auto bind(size_t position) -> void {
+        patch(position, m_code.size());
+    }
+
+    [[nodiscard]] auto code() const noexcept -> std::vector<uint8_t> const & {
+        return m_code;
+    }
+
+    [[nodiscard]] auto size() const noexcept -> size_t {
+        return m_code.size();
+    }
+
+  private:
+    auto emit(std::initializer_list<uint8_t> bytes) -> void {
+        m_code.insert(m_code.end(), bytes);
+    }
+
+    auto immediate(uint64_t value) -> void {
+        uint8_t bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        m_code.insert(m_code.end(), std::begin(bytes), std::end(bytes));
+    }
+
+    auto displacement() -> size_t {
+        size_t const position = m_code.size();
+        m_code.insert(m_code.end(), sizeof(int32_t), 0);
+        return position;
+    }
+
+    /// @brief Emits the rex prefix, if the instruction uses 64-bit operands or one of the registers r8 to r15
+    auto rex(bool wide, uint8_t reg, uint8_t base) -> void {
+        uint8_t const prefix = 0x40 | (wide ? 0x08 : 0) | ((reg & 8) != 0 ? 0x04 : 0) | ((base & 8) != 0 ? 0x01 : 0);
+        if (prefix != 0x40) {
+            emit({prefix});
+        }
+    }
+
+    /// @brief Moves the source register into the destination register
+    auto moveRegister(Register destination, Register source) -> void {
+        rex(true, source, destination);
+        emit({0x89, static_cast<uint8_t>(0xC0 | (source & 7) << 3 | (destination & 7))}); // mov destination, source
+    }
+
+    /// @brief Emits an instruction with a memory operand, that is addressed by a base register and a 32-bit offset
+    /// @param wide Whether the instruction uses 64-bit operands
+    /// @param opcode The opcode of the instruction
+    /// @param reg The register operand or the extension of the opcode
+    /// @param base The base register of the memory operand
+    /// @param offset The offset of the memory operand
+    /// @param secondOpcode The second byte of a two byte opcode or 0
+    auto memory(bool wide, uint8_t opcode, uint8_t reg, Register base, int32_t offset, uint8_t secondOpcode = 0)
+        -> void {
+        rex(wide, reg, base);
+        emit({opcode});
+        if (secondOpcode != 0) {
+            emit({secondOpcode});
+        }
+        emit({static_cast<uint8_t>(0x80 | (reg & 7) << 3 | (base & 7))});
+        // rsp and r12 can only be used as a base register with a scale index byte
+        if ((base & 7) == RSP) {
+            emit({0x24});
+        }
+        immediate32(offset);
+    }
+
+    auto immediate32(int32_t value) -> void {
+        uint8_t bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        m_code.insert(m_code.end(), std::begin(bytes), std::end(bytes));
+    }
+
+    /// @brief The emitted machine code
+    std::vector<uint8_t> m_code;
+};
+
+/// @brief Gets the length of the instruction with the given opcode
+/// @param opcode The opcode of the instruction
+/// @return The length of the instruction in bytes or 0 if the opcode is unknown
+auto instructionLength(uint8_t opcode) -> size_t {
+    if (opcode >= cppLox::ByteCode::Opcode::AMOUNT) {
+        return 0;
+    }
+    return cppLox::ByteCode::instruction_length(static_cast<cppLox::ByteCode::Opcode>(opcode));
+}
+
+} // namespace
+
+auto JitCompiler::compile(cppLox::Types::ObjectFunction & function) -> std::unique_ptr<NativeCode> {
+    cppLox::ByteCode::Chunk & chunk = *function.chunk();
+    std::vector<uint8_t> & code = chunk.code();
+    int32_t const size = JitRuntime::VALUE_SIZE;
+    int32_t const number = JitRuntime::NUMBER_OFFSET;
+    Assembler assembler;
+    // The position of every instruction in the native code, that is used to resolve the targets of the jumps
+    std::vector<size_t> positions(code.size(), SIZE_MAX);
+    // The displacements of the jumps and the offsets of the instructions they target
+    std::vector<std::pair<size_t, size_t>> jumps;
+    // The displacements of the jumps, that are taken after a runtime error
+    std::vector<size_t> errorExits;
+
+    // Gets the offset of a local variable from the slots of the call frame
+    auto const local = [&](uint8_t slot) -> int32_t { return (slot + 1) * size; };
+
+    // Calls the helper of an instruction, the native code is left through the error exit if the instruction failed
+    auto const callHelper = [&](Helper helper, uint8_t * ip, uint64_t operand) -> void {
+        assembler.call(helper, ip, operand);
+        errorExits.push_back(assembler.jumpIfStatus(Status::ERROR));
+    };
+
+    // Pushes the value at the given address, the chunk of a function is not changed after it was compiled
+    auto const pushValue = [&](cppLox::Types::Value const & value) -> void {
+        assembler.moveImmediate(RAX, reinterpret_cast<uint64_t>(&value));
+        assembler.copyValue(R13, 0, RAX, 0);
+        assembler.addImmediate(R13, size);
+    };
+
+    // Executes an arithmetic instruction inline if both operands are numbers and calls the helper otherwise
+    auto const arithmetic = [&](Sse instruction, Helper helper, uint8_t * ip) -> void {
+        size_t const leftIsNoNumber = assembler.jumpIfNotNumber(R13, -2 * size);
+        size_t const rightIsNoNumber = assembler.jumpIfNotNumber(R13, -size);
+        assembler.sse(SSE_DOUBLE_PREFIX, Sse::LOAD, R13, -2 * size + number);
+        assembler.sse(SSE_DOUBLE_PREFIX, instruction, R13, -size + number);
+#ifdef NAN_BOXING
+        // A NaN is left to the helper, that stores it as the canonical quiet NaN
+        assembler.compareNaN();
+        size_t const isNaN = assembler.jumpIf(Condition::PARITY);
+#endif
+        assembler.sse(SSE_DOUBLE_PREFIX, Sse::STORE, R13, -2 * size + number);
+        assembler.addImmediate(R13, -size);
+        size_t const done = assembler.jump();
+        assembler.bind(leftIsNoNumber);
+        assembler.bind(rightIsNoNumber);
+#ifdef NAN_BOXING
+        assembler.bind(isNaN);
+#endif
+        callHelper(helper, ip, 0);
+        assembler.bind(done);
+    };
+
+    // Executes a comparison, that is fused with a conditional jump, inline if both operands are numbers and calls the
+    // helper otherwise. The comparisons of the numbers are unordered for NaN, so the jump is taken for every NaN.
+    auto const compareJumpIfFalse = [&](uint8_t opcode, Helper helper, uint8_t * ip, size_t target) -> void {
+        using cppLox::ByteCode::Opcode;
+        size_t const leftIsNoNumber = assembler.jumpIfNotNumber(R13, -2 * size);
+        size_t const rightIsNoNumber = assembler.jumpIfNotNumber(R13, -size);
+        // Less is evaluated as greater with swapped operands
+        bool const swapped = opcode == Opcode::LESS_JUMP_IF_FALSE || opcode == Opcode::LESS_JUMP_IF_FALSE_NUM_NUM ||
+                             opcode == Opcode::LESS_EQUAL_JUMP_IF_FALSE ||
+                             opcode == Opcode::LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM;
+        assembler.sse(SSE_DOUBLE_PREFIX, Sse::LOAD, R13, (swapped ? -size : -2 * size) + number);
+        assembler.sse(SSE_COMPARE_PREFIX, Sse::COMPARE, R13, (swapped ? -2 * size : -size) + number);
+        assembler.addImmediate(R13, -2 * size);
+        switch (opcode) {
+        case Opcode::EQUAL_JUMP_IF_FALSE:
+            jumps.emplace_back(assembler.jumpIf(Condition::NOT_EQUAL), target);
+            jumps.emplace_back(assembler.jumpIf(Condition::PARITY), target);
+            break;
+        case Opcode::NOT_EQUAL_JUMP_IF_FALSE: {
+            size_t const unordered = assembler.jumpIf(Condition::PARITY);
+            jumps.emplace_back(assembler.jumpIf(Condition::EQUAL), target);
+            assembler.bind(unordered);
+            break;
+        }
+        case Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+        case Opcode::GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+        case Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+        case Opcode::LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+            jumps.emplace_back(assembler.jumpIf(Condition::BELOW), target);
+            break;
+        default:
+            jumps.emplace_back(assembler.jumpIf(Condition::BELOW_EQUAL), target);
+            break;
+        }
+        size_t const done = assembler.jump();
+        assembler.bind(leftIsNoNumber);
+        assembler.bind(rightIsNoNumber);
+        callHelper(helper, ip, 0);
+        jumps.emplace_back(assembler.jumpIfStatus(Status::JUMP), target);
+        assembler.bind(done);
+    };
+
+    assembler.prologue();
+    for (size_t offset = 0; offset < code.size();) {
+        uint8_t const opcode = code[offset];
+        size_t const length = instructionLength(opcode);
+        if (length == 0 || offset + length > code.size()) {
+            return nullptr;
+        }
+        positions[offset] = assembler.size();
+        uint8_t * ip = code.data() + offset + 1;
+        uint8_t const first = length > 1 ? code[offset + 1] : 0;
+        uint8_t const second = length > 2 ? code[offset + 2] : 0;
+        uint16_t const operand = static_cast<uint16_t>(first << 8 | second);
+        size_t const next = offset + length;
+        // The quickened instructions are compiled like their generic form, that checks the types of the operands inline
+        switch (opcode) {
+        case cppLox::ByteCode::Opcode::ADD:
+        case cppLox::ByteCode::Opcode::ADD_NUM_NUM:
+            arithmetic(Sse::ADD, &JitRuntime::binary<&JitRuntime::add>, ip);
+            break;
+        case cppLox::ByteCode::Opcode::CALL:
+            callHelper(&JitRuntime::call, ip, first);
+            break;
+        case cppLox::ByteCode::Opcode::CALL_INLINED:
+            callHelper(&JitRuntime::callInlined, ip, first);
+            jumps.emplace_back(assembler.jumpIfStatus(Status::JUMP),
+                               next + static_cast<uint16_t>(code[offset + 4] << 8 | code[offset + 5]));
+            break;
+        case cppLox::ByteCode::Opcode::CONSTANT:
+            pushValue(chunk.getConstant(first));
+            break;
+        case cppLox::ByteCode::Opcode::CONSTANT_LONG:
+            pushValue(chunk.getConstant(operand));
+            break;
+        case cppLox::ByteCode::Opcode::DEFINE_GLOBAL:
+            callHelper(&JitRuntime::defineGlobal, ip, operand);
+            break;
+        case cppLox::ByteCode::Opcode::DIVIDE:
+        case cppLox::ByteCode::Opcode::DIVIDE_NUM_NUM:
+            arithmetic(Sse::DIVIDE, &JitRuntime::binary<&JitRuntime::divide>, ip);
+            break;
+        case cppLox::ByteCode::Opcode::EQUAL:
+            callHelper(&JitRuntime::binary<&JitRuntime::equal>, ip, 0);
+            break;
+        case cppLox::ByteCode::Opcode::EQUAL_JUMP_IF_FALSE:
+            compareJumpIfFalse(opcode, &JitRuntime::compareJumpIfFalse<&JitRuntime::equal>, ip, next + operand);
+            break;
+        case cppLox::ByteCode::Opcode::FALSE:
+            pushValue(FALSE_VALUE);
+            break;
+        case cppLox::ByteCode::Opcode::GET_GLOBAL:
+            callHelper(&JitRuntime::getGlobal, ip, operand);
+            break;
+        case cppLox::ByteCode::Opcode::GET_LOCAL:
+            assembler.copyValue(R13, 0, R12, local(first));
+            assembler.addImmediate(R13, size);
+            break;
+        case cppLox::ByteCode::Opcode::GET_LOCAL_CONSTANT:
+            assembler.copyValue(R13, 0, R12, local(first));
+            assembler.moveImmediate(RAX, reinterpret_cast<uint64_t>(&chunk.getConstant(second)));
+            assembler.copyValue(R13, size, RAX, 0);
+            assembler.addImmediate(R13, 2 * size);
+            break;
+        case cppLox::ByteCode::Opcode::GET_LOCAL_GET_LOCAL:
+            assembler.copyValue(R13, 0, R12, local(first));
+            assembler.copyValue(R13, size, R12, local(second));
+            assembler.addImmediate(R13, 2 * size);
+            break;
+        case cppLox::ByteCode::Opcode::GREATER:
+        case cppLox::ByteCode::Opcode::GREATER_NUM_NUM:
+            callHelper(&JitRuntime::binary<&JitRuntime::greater>, ip, 0);
+            break;
+        case cppLox::ByteCode::Opcode::GREATER_EQUAL:
+        case cppLox::ByteCode::Opcode::GREATER_EQUAL_NUM_NUM:
+            callHelper(&JitRuntime::binary<&JitRuntime::greaterEqual>, ip, 0);
+            break;
+        case cppLox::ByteCode::Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+        case cppLox::ByteCode::Opcode::GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+            compareJumpIfFalse(opcode, &JitRuntime::compareJumpIfFalse<&JitRuntime::greaterEqual>, ip,
+                               next + operand);
+            break;
+        case cppLox::ByteCode::Opcode::GREATER_JUMP_IF_FALSE:
+        case cppLox::ByteCode::Opcode::GREATER_JUMP_IF_FALSE_NUM_NUM:
+            compareJumpIfFalse(opcode, &JitRuntime::compareJumpIfFalse<&JitRuntime::greater>, ip, next + operand);
+            break;
+        case cppLox::ByteCode::Opcode::JUMP:
+            jumps.emplace_back(assembler.jump(), next + operand);
+            break;
+        case cppLox::ByteCode::Opcode::JUMP_IF_FALSE:
+            jumps.emplace_back(assembler.jumpIfFalse(R13, -size), next + operand);
+            break;
+        case cppLox::ByteCode::Opcode::LESS:
+        case cppLox::ByteCode::Opcode::LESS_NUM_NUM:
+            callHelper(&JitRuntime::binary<&JitRuntime::less>, ip, 0);
+            break;
+        case cppLox::ByteCode::Opcode::LESS_EQUAL:
+        case cppLox::ByteCode::Opcode::LESS_EQUAL_NUM_NUM:
+            callHelper(&JitRuntime::binary<&JitRuntime::lessEqual>, ip, 0);
+            break;
+        case cppLox::ByteCode::Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+        case cppLox::ByteCode::Opcode::LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+            compareJumpIfFalse(opcode, &JitRuntime::compareJumpIfFalse<&JitRuntime::lessEqual>, ip, next + operand);
+            break;
+        case cppLox::ByteCode::Opcode::LESS_JUMP_IF_FALSE:
+        case cppLox::ByteCode::Opcode::LESS_JUMP_IF_FALSE_NUM_NUM:
+            compareJumpIfFalse(opcode, &JitRuntime::compareJumpIfFalse<&JitRuntime::less>, ip, next + operand);
+            break;
+        case cppLox::ByteCode::Opcode::LOOP:
+            jumps.emplace_back(assembler.jump(), next - operand);
+            break;
+        case cppLox::ByteCode::Opcode::MULTIPLY:
+        case cppLox::ByteCode::Opcode::MULTIPLY_NUM_NUM:
+            arithmetic(Sse::MULTIPLY, &JitRuntime::binary<&JitRuntime::multiply>, ip);
+            break;
+        case cppLox::ByteCode::Opcode::NEGATE:
+            callHelper(&JitRuntime::negate, ip, 0);
+            break;
+        case cppLox::ByteCode::Opcode::NOT:
+            callHelper(&JitRuntime::logicalNot, ip, 0);
+            break;
+        case cppLox::ByteCode::Opcode::NOT_EQUAL:
+            callHelper(&JitRuntime::binary<&JitRuntime::notEqual>, ip, 0);
+            break;
+        case cppLox::ByteCode::Opcode::NOT_EQUAL_JUMP_IF_FALSE:
+            compareJumpIfFalse(opcode, &JitRuntime::compareJumpIfFalse<&JitRuntime::notEqual>, ip, next + operand);
+            break;
+        case cppLox::ByteCode::Opcode::NULL_:
+            pushValue(NIL_VALUE);
+            break;
+        case cppLox::ByteCode::Opcode::POP:
+            assembler.addImmediate(R13, -size);
+            break;
+        case cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE:
+            assembler.addImmediate(R13, -size);
+            jumps.emplace_back(assembler.jumpIfFalse(R13, 0), next + operand);
+            break;
+        case cppLox::ByteCode::Opcode::POP_JUMP_IF_TRUE:
+            callHelper(&JitRuntime::logicalNot, ip, 0);
+            assembler.addImmediate(R13, -size);
+            jumps.emplace_back(assembler.jumpIfFalse(R13, 0), next + operand);
+            break;
+        case cppLox::ByteCode::Opcode::PRINT:
+            callHelper(&JitRuntime::print, ip, 0);
+            break;
+        case cppLox::ByteCode::Opcode::RETURN:
+            assembler.call(&JitRuntime::returnFromFunction, ip, 0);
+            assembler.epilogue(true);
+            break;
+        case cppLox::ByteCode::Opcode::RETURN_INLINED:
+            // Discards the callee, the arguments and the locals of the inlined function below its result
+            assembler.copyValue(R13, -(first + 1) * size, R13, -size);
+            assembler.addImmediate(R13, -first * size);
+            break;
+        case cppLox::ByteCode::Opcode::SET_GLOBAL:
+            callHelper(&JitRuntime::setGlobal, ip, operand);
+            break;
+        case cppLox::ByteCode::Opcode::SET_LOCAL:
+            assembler.copyValue(R12, local(first), R13, -size);
+            break;
+        case cppLox::ByteCode::Opcode::SET_LOCAL_POP:
+            assembler.addImmediate(R13, -size);
+            assembler.copyValue(R12, local(first), R13, 0);
+            break;
+        case cppLox::ByteCode::Opcode::SUBTRACT:
+        case cppLox::ByteCode::Opcode::SUBTRACT_NUM_NUM:
+            arithmetic(Sse::SUBTRACT, &JitRuntime::binary<&JitRuntime::subtract>, ip);
+            break;
+        case cppLox::ByteCode::Opcode::TAIL_CALL: {
+            callHelper(&JitRuntime::tailCall, ip, first);
+            // A lox function reused the frame, so the native code is left and the callee is executed by the vm
+            size_t const calledNative = assembler.jumpIfStatus(Status::CONTINUE);
+            assembler.epilogue(true);
+            assembler.bind(calledNative);
+            break;
+        }
+        case cppLox::ByteCode::Opcode::TRUE:
+            pushValue(TRUE_VALUE);
+            break;
+        default:
+            return nullptr;
+        }
+        offset = next;
+    }
+    for (auto const & [displacement, target] : jumps) {
+        if (target >= code.size() || positions[target] == SIZE_MAX) {
+            return nullptr;
+        }
+        assembler.patch(displacement, positions[target]);
+    }
+    // A runtime error leaves the native code through a single exit
+    for (size_t const displacement : errorExits) {
+        assembler.bind(displacement);
+    }
+    assembler.epilogue(false);
+    std::unique_ptr<NativeCode> nativeCode = NativeCode::create(assembler.code());
+    if (nativeCode != nullptr) {
+        m_perfMap.add(reinterpret_cast<void const *>(nativeCode->entry()), nativeCode->size(),
+                      std::format("lox::{}", function.name() != nullptr && !function.name()->string().empty()
+                                                 ? function.name()->string()
+                                                 : "script"));
+    }
+    return nativeCode;
+}
+
+#endif
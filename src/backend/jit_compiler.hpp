@@ -0,0 +1,53 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file jit_compiler.hpp
+ * @details This file contains the declaration of the baseline jit compiler, that translates hot functions into native
+ * code
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "../types/object_function.hpp"
+#include "native_code.hpp"
+#include "perf_map.hpp"
+
+namespace cppLox::Backend {
+
+/// @brief The baseline jit compiler, that translates the stack bytecode of a function into x86-64 machine code.
+/// @details The compiler is a template compiler - every instruction is replaced by a fixed template of machine code,
+/// so the dispatch of the interpreter disappears. The templates work on the stack of the virtual machine in place.
+/// Moving values, the arithmetic on numbers and the comparisons of numbers, that are fused with conditional jumps, are
+/// executed inline, jumps and loops become native jumps. Everything else and the operands, that are no numbers, are
+/// handled by calls of helpers, that behave exactly like the interpreter. The helpers catch all runtime errors and
+/// report them through their status, so exceptions never unwind through native code.
+class JitCompiler {
+  public:
+    /// @brief Constructs a new jit compiler
+    JitCompiler() = default;
+
+    /// @brief Compiles the stack bytecode of the given function into native code
+    /// @param function The function to compile
+    /// @return The native code or nullptr if the function can not be compiled, then it stays interpreted
+    [[nodiscard]] auto compile(cppLox::Types::ObjectFunction & function) -> std::unique_ptr<NativeCode>;
+
+  private:
+    /// @brief The perf map, that names the compiled functions for linux perf
+    PerfMap m_perfMap;
+};
+} // namespace cppLox::Backend
@@ -0,0 +1,57 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file native_code.cpp
+ * @details This file contains the implementation of the native code, that a function is compiled to by the jit
+ * compiler
+ */
+
+#ifdef JIT
+
+#include "native_code.hpp"
+
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace cppLox::Backend;
+
+auto NativeCode::create(std::vector<uint8_t> const & code) -> std::unique_ptr<NativeCode> {
+    size_t const pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t const mappedSize = (code.size() + pageSize - 1) & ~(pageSize - 1);
+    void * memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    std::memcpy(memory, code.data(), code.size());
+    // The code is made executable after it was written, so the pages are never writable and executable at once
+    if (mprotect(memory, mappedSize, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, mappedSize);
+        return nullptr;
+    }
+    return std::unique_ptr<NativeCode>(new NativeCode(memory, mappedSize, code.size()));
+}
+
+NativeCode::NativeCode(void * memory, size_t mappedSize, size_t size)
+    : m_memory(memory), m_mappedSize(mappedSize), m_size(size) {
+}
+
+NativeCode::~NativeCode() {
+    munmap(m_memory, m_mappedSize);
+}
+
+#endif
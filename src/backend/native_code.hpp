@@ -0,0 +1,85 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file native_code.hpp
+ * @details This file contains the declaration of the native code, that a function is compiled to by the jit compiler
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../types/value.hpp"
+
+namespace cppLox::Backend {
+
+// forward declaration of the VM class
+class VM;
+
+/// @brief Executable machine code of a function, that was compiled by the jit compiler.
+/// @details The code is copied into its own pages, that are never writable and executable at the same time. The pages
+/// are released when the native code is destroyed.
+class NativeCode {
+  public:
+    /// @brief The signature of the compiled code
+    /// @details The code executes the function of the top call frame of the virtual machine, using the given slots of
+    /// the call frame and the given top of the stack. It returns true after the function returned and its result was
+    /// pushed onto the stack and false if a runtime error occurred.
+    using Entry = bool (*)(VM * vm, cppLox::Types::Value * slots, cppLox::Types::Value * top);
+
+    /// @brief Copies the given machine code into executable memory
+    /// @param code The machine code
+    /// @return The native code or nullptr if no executable memory could be mapped
+    [[nodiscard]] static auto create(std::vector<uint8_t> const & code) -> std::unique_ptr<NativeCode>;
+
+    /// @brief Destructor of the native code that releases the executable memory
+    ~NativeCode();
+
+    NativeCode(NativeCode const &) = delete;
+    auto operator=(NativeCode const &) -> NativeCode & = delete;
+
+    /// @brief Gets the entry point of the code
+    /// @return The entry point of the code
+    [[nodiscard]] auto entry() const noexcept -> Entry {
+        return reinterpret_cast<Entry>(m_memory);
+    }
+
+    /// @brief Gets the size of the machine code
+    /// @return The size of the machine code in bytes
+    [[nodiscard]] auto size() const noexcept -> size_t {
+        return m_size;
+    }
+
+  private:
+    /// @brief Constructs a new native code, that owns the given memory
+    /// @param memory The executable memory
+    /// @param mappedSize The size of the executable memory in bytes
+    /// @param size The size of the machine code in bytes
+    NativeCode(void * memory, size_t mappedSize, size_t size);
+
+    /// @brief The executable memory
+    void * m_memory;
+
+    /// @brief The size of the executable memory in bytes
+    size_t m_mappedSize;
+
+    /// @brief The size of the machine code in bytes
+    size_t m_size;
+};
+} // namespace cppLox::Backend
@@ -21,19 +21,15 @@
 #pragma once
 
 #include <chrono>
-#include <functional>
+#include <span>
 
+#include "../types/object_native_fuction.hpp"
 #include "../types/value.hpp"
-#include "callframe.hpp"
 
 namespace cppLox::Backend {
 
 /// @brief The clock function.
-/// @param argCount The number of arguments that were passed to the function
 /// @param args The arguments that were passed to the function
-/// @param frame The call frame from which the function was called
-/// @param onError The error function to call if an error occurs
 /// @return The amount of time in milliseconds since the Unix epoch.
-cppLox::Types::Value clock(uint8_t argCount, Types::Value * args, CallFrame & frame,
-                           std::function<void(CallFrame & frame, std::string_view fmt)> onError);
+auto clock(std::span<cppLox::Types::Value> args) -> cppLox::Types::NativeResult;
 } // namespace cppLox::Backend
\ No newline at end of file
@@ -0,0 +1,40 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file perf_map.cpp
+ * @details This file contains the implementation of the perf map, that names the native code of the jit compiler
+ */
+
+#ifdef JIT
+
+#include "perf_map.hpp"
+
+#include <cstdint>
+#include <format>
+
+#include <unistd.h>
+
+using namespace cppLox::Backend;
+
+auto PerfMap::add(void const * code, size_t size, std::string_view name) -> void {
+    if (!m_file.is_open()) {
+        // Other virtual machines of the same process append to the same file
+        m_file.open(std::format("/tmp/perf-{}.map", getpid()), std::ios::app);
+    }
+    m_file << std::format("{:x} {:x} {}", reinterpret_cast<uintptr_t>(code), size, name) << std::endl;
+}
+
+#endif
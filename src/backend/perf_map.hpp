@@ -0,0 +1,48 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file perf_map.hpp
+ * @details This file contains the declaration of the perf map, that names the native code of the jit compiler
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string_view>
+
+namespace cppLox::Backend {
+
+/// @brief Writes the symbols of the native code, that was generated by the jit compiler, to /tmp/perf-<pid>.map.
+/// @details The file uses the format of the perf map files, that are read by linux perf to attribute the samples in
+/// code without symbols - every line contains the start address and the size of the code as hexadecimal numbers,
+/// followed by the name of the symbol. The file is only created, when the first symbol is added.
+class PerfMap {
+  public:
+    /// @brief Constructs a new perf map
+    PerfMap() = default;
+
+    /// @brief Adds a symbol to the perf map
+    /// @param code The start of the code
+    /// @param size The size of the code in bytes
+    /// @param name The name of the symbol
+    auto add(void const * code, size_t size, std::string_view name) -> void;
+
+  private:
+    /// @brief The perf map file of the process
+    std::ofstream m_file;
+};
+} // namespace cppLox::Backend
@@ -0,0 +1,121 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file value_stack.cpp
+ * @details This file contains the implementation of the value stack used by the virtual machine
+ */
+
+#include "value_stack.hpp"
+
+#include <algorithm>
+#include <new>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace cppLox::Backend;
+
+/// @brief The minimum amount of bytes that are committed at once when the stack grows
+#define STACK_COMMIT_SIZE (64 * 1024)
+
+/// @brief Rounds the given size up to a multiple of the given alignment
+/// @param size The size to round up
+/// @param alignment The alignment (a power of two)
+/// @return The rounded up size
+static auto alignUp(size_t size, size_t alignment) -> size_t {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/// @brief Gets the page size of the operating system
+/// @return The page size in bytes
+static auto pageSize() -> size_t {
+#ifdef _WIN32
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    return systemInfo.dwPageSize;
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+/// @brief Releases the given reserved address range
+/// @param memory The start of the address range
+/// @param size The size of the address range in bytes
+static auto release(void * memory, size_t size) -> void {
+#ifdef _WIN32
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    munmap(memory, size);
+#endif
+}
+
+ValueStack::ValueStack(size_t maxSize) {
+    m_page_size = pageSize();
+    m_max_size = maxSize;
+    m_capacity = 0;
+    // One additional page that is never committed guards the end of the stack
+    m_reserved_bytes = alignUp(maxSize * sizeof(cppLox::Types::Value), m_page_size) + m_page_size;
+#ifdef _WIN32
+    void * memory = VirtualAlloc(nullptr, m_reserved_bytes, MEM_RESERVE, PAGE_NOACCESS);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+#else
+    void * memory = mmap(nullptr, m_reserved_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+#endif
+    m_values = static_cast<cppLox::Types::Value *>(memory);
+    if (!grow(1)) {
+        release(m_values, m_reserved_bytes);
+        throw std::bad_alloc();
+    }
+}
+
+ValueStack::~ValueStack() {
+    release(m_values, m_reserved_bytes);
+}
+
+auto ValueStack::grow(size_t size) -> bool {
+    if (size > m_max_size) {
+        return false;
+    }
+    size_t const committedBytes = m_capacity * sizeof(cppLox::Types::Value);
+    size_t const requiredBytes = alignUp(size * sizeof(cppLox::Types::Value), m_page_size);
+    // Commit at least a whole chunk, but never the guard page at the end of the reservation
+    size_t const newCommittedBytes =
+        std::min(std::max(requiredBytes, alignUp(committedBytes + STACK_COMMIT_SIZE, m_page_size)),
+                 m_reserved_bytes - m_page_size);
+    char * const begin = reinterpret_cast<char *>(m_values) + alignUp(committedBytes, m_page_size);
+    size_t const length = newCommittedBytes - alignUp(committedBytes, m_page_size);
+#ifdef _WIN32
+    if (VirtualAlloc(begin, length, MEM_COMMIT, PAGE_READWRITE) == nullptr) {
+        return false;
+    }
+#else
+    if (mprotect(begin, length, PROT_READ | PROT_WRITE) != 0) {
+        return false;
+    }
+#endif
+    m_capacity = std::min(newCommittedBytes / sizeof(cppLox::Types::Value), m_max_size);
+    return true;
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file value_stack.hpp
+ * @details This file contains the declaration of the value stack used by the virtual machine
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "../types/value.hpp"
+
+namespace cppLox::Backend {
+
+/// @brief The value stack used by the virtual machine.
+/// @details The whole address range of the stack is reserved up front and memory is only committed when the stack
+/// grows, so the values never move and pointers into the stack (like the slots of a call frame) stay valid.
+/// The reservation ends with a guard page that is never committed, so running past the stack faults instead of
+/// silently corrupting memory.
+class ValueStack {
+  public:
+    /// @brief Constructs a new value stack
+    /// @param maxSize The maximum amount of values that can be stored on the stack
+    explicit ValueStack(size_t maxSize);
+
+    /// @brief Destructor of the value stack that releases the reserved memory
+    ~ValueStack();
+
+    ValueStack(ValueStack const &) = delete;
+    auto operator=(ValueStack const &) -> ValueStack & = delete;
+
+    /// @brief Gets the value at the given index
+    /// @param index The index of the value
+    /// @return The value at the given index
+    [[nodiscard]] auto operator[](size_t index) noexcept -> cppLox::Types::Value & {
+        return m_values[index];
+    }
+
+    /// @brief Gets the bottom of the stack
+    /// @return The bottom of the stack
+    [[nodiscard]] auto data() const noexcept -> cppLox::Types::Value * {
+        return m_values;
+    }
+
+    /// @brief Gets the amount of values that can be stored without committing more memory
+    /// @return The amount of values that can be stored without committing more memory
+    [[nodiscard]] auto capacity() const noexcept -> size_t {
+        return m_capacity;
+    }
+
+    /// @brief Gets the maximum amount of values that can be stored on the stack
+    /// @return The maximum amount of values that can be stored on the stack
+    [[nodiscard]] auto maxSize() const noexcept -> size_t {
+        return m_max_size;
+    }
+
+    /// @brief Makes sure that the given amount of values can be stored on the stack
+    /// @param size The amount of values that need to fit on the stack
+    /// @return true if the values fit on the stack, false if the stack can not grow that large
+    [[nodiscard]] auto ensureCapacity(size_t size) -> bool {
+        return size <= m_capacity || grow(size);
+    }
+
+  private:
+    /// @brief Commits enough memory to store the given amount of values
+    /// @param size The amount of values that need to fit on the stack
+    /// @return true if the memory was committed, false if the stack can not grow that large
+    auto grow(size_t size) -> bool;
+
+    /// @brief The bottom of the stack
+    cppLox::Types::Value * m_values;
+
+    /// @brief The amount of values that fit into the committed memory
+    size_t m_capacity;
+
+    /// @brief The maximum amount of values that can be stored on the stack
+    size_t m_max_size;
+
+    /// @brief The size of the reserved address range in bytes, including the guard page
+    size_t m_reserved_bytes;
+
+    /// @brief The size of a page of the operating system in bytes
+    size_t m_page_size;
+};
+} // namespace cppLox::Backend
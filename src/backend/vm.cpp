@@ -20,11 +20,15 @@
 
 #include "vm.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <optional>
 #include <ranges>
+#include <utility>
 
 #include "../bytecode/opcode.hpp"
+#include "../bytecode/register_opcode.hpp"
 #include "../error/runtime_exception.hpp"
 #include "../types/object_formatter.hpp"
 #include "../types/object_native_fuction.hpp"
@@ -34,252 +38,1085 @@
 
 using namespace cppLox::Backend;
 
-VM::VM(std::shared_ptr<cppLox::MemoryMutator> memoryMutator) {
+VM::VM(std::shared_ptr<cppLox::MemoryMutator> memoryMutator, size_t frameLimit) : m_stack(STACK_MAX) {
     m_stack_top = 0;
+    m_rootTop = 0;
     m_frame_count = 0;
+    // The script itself always needs a call frame
+    m_frame_limit = std::max<size_t>(frameLimit, 1);
+    m_frames.resize(std::min<size_t>(FRAMES_INITIAL, m_frame_limit));
     m_memoryMutator = memoryMutator;
+#ifdef JIT
+    m_jitThreshold = JIT_THRESHOLD;
+    m_exitFrameCount = 0;
+#endif
+    m_memoryMutator->addRootSource(this);
     defineNative<0>("clock", &clock);
 }
 
+VM::~VM() {
+    m_memoryMutator->removeRootSource(this);
+}
+
+auto VM::markRoots(cppLox::MemoryMutator & memoryMutator) -> void {
+    for (size_t slot = 0; slot < std::max(m_stack_top, m_rootTop); slot++) {
+        memoryMutator.markValue(m_stack[slot]);
+    }
+    for (size_t frame = 0; frame < m_frame_count; frame++) {
+        memoryMutator.markObject(m_frames[frame].m_function);
+    }
+}
+
 auto VM::interpret(cppLox::Types::ObjectFunction & function) -> void {
+    if (tryInterpret(function) == InterpretResult::RUNTIME_ERROR) {
+        throwRecordedError();
+    }
+}
+
+auto VM::tryInterpret(cppLox::Types::ObjectFunction & function) -> InterpretResult {
     m_stack_top = 0;
+    m_rootTop = 0;
     m_frame_count = 0;
+#ifdef JIT
+    m_exitFrameCount = 0;
+#endif
+    m_errorMessage.clear();
     push(m_frames[m_frame_count], cppLox::Types::Value(&function));
-    call(function, 0);
-    return;
+    if (!call(function, 0)) {
+        return InterpretResult::RUNTIME_ERROR;
+    }
+#ifdef PROFILE_DISPATCH
+    m_dispatchProfile.breakSequence();
+#endif
+    return function.registerChunk() != nullptr ? runRegisters() : run();
+}
+
+auto VM::errorMessage() const noexcept -> std::string const & {
+    return m_errorMessage;
+}
+
+/// @brief Gets the bytecode of the given function, that is executed by the vm
+/// @param function The function
+/// @return The register bytecode if the function was compiled for the register tier, the stack bytecode otherwise
+static auto executedChunk(cppLox::Types::ObjectFunction & function) -> cppLox::ByteCode::Chunk * {
+    return function.registerChunk() != nullptr ? function.registerChunk() : function.chunk();
 }
 
-auto VM::run(cppLox::Types::ObjectFunction & function) -> void {
+#ifdef DEBUG_TRACE_EXECUTION
+#define VM_TRACE_EXECUTION()                                                                                           \
+    do {                                                                                                               \
+        for (size_t slot = 0; slot < m_stack_top; slot++) {                                                            \
+            std::cout << std::format("[ {} ]", m_stack[slot]);                                                         \
+        }                                                                                                              \
+        std::cout << std::endl;                                                                                        \
+        frame->m_function->chunk()->disassembleInstruction(frame->m_instruction_pointer -                              \
+                                                           frame->m_function->chunk()->code().data());                 \
+    } while (false)
+#else
+#define VM_TRACE_EXECUTION()                                                                                           \
+    do {                                                                                                               \
+    } while (false)
+#endif
+
+#ifdef PROFILE_DISPATCH
+#define VM_PROFILE_DISPATCH() m_dispatchProfile.record(*frame->m_instruction_pointer)
+#else
+#define VM_PROFILE_DISPATCH()                                                                                          \
+    do {                                                                                                               \
+    } while (false)
+#endif
+
+// Quickening - a generic arithmetic or comparison instruction, that finds two numbers as its operands, rewrites itself
+// in place into its quickened form, which skips the type checks of the operators of the value. The length is the
+// amount of bytes the instruction pointer advanced since the opcode was read.
+#define VM_QUICKEN(left, right, length, quickened)                                                                     \
+    do {                                                                                                               \
+        if ((left).isNumber() && (right).isNumber()) {                                                                 \
+            *(frame->m_instruction_pointer - (length)) = cppLox::ByteCode::Opcode::quickened;                          \
+        }                                                                                                              \
+    } while (false)
+
+// Guards a quickened instruction - if one of the two operands on top of the stack is not a number, the instruction is
+// rewritten back into its generic form and dispatched again.
+#define VM_GUARD_NUMBERS(generic)                                                                                      \
+    if (!m_stack[m_stack_top - 1].isNumber() || !m_stack[m_stack_top - 2].isNumber()) [[unlikely]] {                  \
+        *(--frame->m_instruction_pointer) = cppLox::ByteCode::Opcode::generic;                                         \
+        VM_NEXT();                                                                                                     \
+    }
+
+// Leaves the interpreter loop after a runtime error, that was already recorded in the virtual machine
+#define VM_ERROR() return InterpretResult::RUNTIME_ERROR
+
+// Unwraps the result of an operator, that can fail, into the given variable or leaves the interpreter loop
+#define VM_CHECKED(variable, operation)                                                                                \
+    std::optional<cppLox::Types::Value> const variable = (operation);                                                  \
+    if (!variable) [[unlikely]] {                                                                                      \
+        VM_ERROR();                                                                                                    \
+    }
+
+#ifdef COMPUTED_GOTO
+// Direct threaded dispatch - every handler jumps straight to the handler of the next instruction, so each opcode
+// gets its own indirect branch that the branch predictor can learn separately.
+#define VM_DISPATCH()                                                                                                  \
+    do {                                                                                                               \
+        VM_TRACE_EXECUTION();                                                                                          \
+        VM_PROFILE_DISPATCH();                                                                                         \
+        goto *dispatchTable[*frame->m_instruction_pointer++];                                                          \
+    } while (false)
+#define VM_CASE(opcode) label_##opcode
+#define VM_NEXT()       VM_DISPATCH()
+#else
+// Portable fallback - a single switch inside of an endless loop.
+#define VM_CASE(opcode) case cppLox::ByteCode::Opcode::opcode
+#define VM_NEXT()       break
+#endif
+
+auto VM::run() -> InterpretResult {
     CallFrame * frame = &m_frames[m_frame_count - 1];
+#ifdef COMPUTED_GOTO
+    // The labels have to be in the same order as the opcodes are declared in the Opcode enum. The table covers every
+    // possible byte, so that a corrupted instruction stream ends up in the error handler instead of a wild jump.
+    static void * dispatchTable[UINT8_MAX + 1] = {
+        &&label_ADD,                                  &&label_ADD_NUM_NUM,
+        &&label_CALL,                                 &&label_CALL_INLINED,
+        &&label_CONSTANT,                             &&label_CONSTANT_LONG,
+        &&label_DEFINE_GLOBAL,                        &&label_DIVIDE,
+        &&label_DIVIDE_NUM_NUM,                       &&label_EQUAL,
+        &&label_EQUAL_JUMP_IF_FALSE,                  &&label_FALSE,
+        &&label_GET_GLOBAL,                           &&label_GET_LOCAL,
+        &&label_GET_LOCAL_CONSTANT,                   &&label_GET_LOCAL_GET_LOCAL,
+        &&label_GREATER,                              &&label_GREATER_EQUAL,
+        &&label_GREATER_EQUAL_JUMP_IF_FALSE,          &&label_GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM,
+        &&label_GREATER_EQUAL_NUM_NUM,                &&label_GREATER_JUMP_IF_FALSE,
+        &&label_GREATER_JUMP_IF_FALSE_NUM_NUM,        &&label_GREATER_NUM_NUM,
+        &&label_JUMP,                                 &&label_JUMP_IF_FALSE,
+        &&label_LESS,                                 &&label_LESS_EQUAL,
+        &&label_LESS_EQUAL_JUMP_IF_FALSE,             &&label_LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM,
+        &&label_LESS_EQUAL_NUM_NUM,                   &&label_LESS_JUMP_IF_FALSE,
+        &&label_LESS_JUMP_IF_FALSE_NUM_NUM,           &&label_LESS_NUM_NUM,
+        &&label_LOOP,                                 &&label_MULTIPLY,
+        &&label_MULTIPLY_NUM_NUM,                     &&label_NEGATE,
+        &&label_NOT,                                  &&label_NOT_EQUAL,
+        &&label_NOT_EQUAL_JUMP_IF_FALSE,              &&label_NULL_,
+        &&label_POP,                                  &&label_POP_JUMP_IF_FALSE,
+        &&label_POP_JUMP_IF_TRUE,                     &&label_PRINT,
+        &&label_RETURN,                               &&label_RETURN_INLINED,
+        &&label_SET_GLOBAL,                           &&label_SET_LOCAL,
+        &&label_SET_LOCAL_POP,                        &&label_SUBTRACT,
+        &&label_SUBTRACT_NUM_NUM,                     &&label_TAIL_CALL,
+        &&label_TRUE};
+    // The remaining entries are filled once by a thread safe static initializer, so virtual machines, that run for the
+    // first time on different threads, do not race on the table
+    [[maybe_unused]] static bool const filled =
+        (std::fill(std::begin(dispatchTable) + cppLox::ByteCode::Opcode::AMOUNT, std::end(dispatchTable),
+                   &&label_UNKNOWN),
+         true);
+    VM_DISPATCH();
+    {
+#else
     for (;;) {
-#ifdef DEBUG_TRACE_EXECUTION
-        for (cppLox::Types::Value * slot = m_stack; (size_t)slot - m_stack < m_stack_top; slot++) {
-            std::cout << std::format("[ {} ]", *slot);
+        VM_TRACE_EXECUTION();
+        VM_PROFILE_DISPATCH();
+        switch (static_cast<cppLox::ByteCode::Opcode>(*frame->m_instruction_pointer++)) {
+#endif
+    VM_CASE(ADD) : {
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 1, ADD_NUM_NUM);
+        VM_CHECKED(result, add(b, a));
+        push(*frame, *result);
+        VM_NEXT();
+    }
+    VM_CASE(ADD_NUM_NUM) : {
+        VM_GUARD_NUMBERS(ADD);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        push(*frame, cppLox::Types::Value(b + a));
+        VM_NEXT();
+    }
+    VM_CASE(CALL) : {
+        uint8_t const arg_count = *frame->m_instruction_pointer++;
+        cppLox::Types::Value val = m_stack[m_stack_top - 1 - arg_count];
+#ifdef JIT
+        size_t const frameCount = m_frame_count;
+        if (!callFunction(val, arg_count, *frame)) {
+            VM_ERROR();
+        }
+        // A compiled function is executed as native code, that already returned to this frame
+        if (m_frame_count > frameCount && runCompiled() == NativeExecution::RUNTIME_ERROR) {
+            VM_ERROR();
+        }
+#else
+        if (!callFunction(val, arg_count, *frame)) {
+            VM_ERROR();
         }
-        std::cout << std::endl;
-        frame->m_function->chunk()->disassembleInstruction((size_t)frame->m_instruction_index -
-                                                           frame->m_function->chunk()->code().data());
 #endif
-        uint8_t const instruction = *frame->m_instruction_pointer++;
-        switch (static_cast<cppLox::ByteCode::Opcode>(instruction)) {
-        case cppLox::ByteCode::Opcode::ADD:
-            {
-                cppLox::Types::Value a = pop(*frame);
-                cppLox::Types::Value b = pop(*frame);
-                if (a.is(cppLox::Types::Value::Type::NUMBER) && b.is(cppLox::Types::Value::Type::NUMBER)) {
-                    push(*frame, a + b);
-                } else if (a.is(cppLox::Types::Value::Type::OBJECT) && b.is(cppLox::Types::Value::Type::OBJECT)) {
-                    cppLox::Types::Object * aObject = a.as<cppLox::Types::Object *>();
-                    cppLox::Types::Object * bObject = b.as<cppLox::Types::Object *>();
-                    if (aObject->is(cppLox::Types::Object::Type::STRING) &&
-                        bObject->is(cppLox::Types::Object::Type::STRING)) {
-                        push(*frame, cppLox::Types::Value(m_memoryMutator->create<cppLox::Types::ObjectString>(
-                                         bObject->as<cppLox::Types::ObjectString>()->string() +
-                                         aObject->as<cppLox::Types::ObjectString>()->string())));
-                    } else {
-                        throw cppLox::Error::RunTimeException("Operands must be two numbers or two strings");
-                    }
-                } else {
-                    throw cppLox::Error::RunTimeException("Operands must be two numbers or two strings");
-                }
-                break;
-            }
-        case cppLox::ByteCode::Opcode::CALL:
-            {
-                uint8_t const arg_count = *frame->m_instruction_pointer++;
-                cppLox::Types::Value val = m_stack[m_stack_top - 1 - arg_count];
-                callFunction(val, arg_count, *frame);
-                break;
-            }
-        case cppLox::ByteCode::Opcode::CONSTANT:
-            {
-                uint8_t const constant = *frame->m_instruction_pointer++;
-                push(*frame, function.chunk()->getConstant(constant));
-                break;
-            }
-        case cppLox::ByteCode::Opcode::DEFINE_GLOBAL:
-            {
-                uint8_t const constant = *frame->m_instruction_pointer++;
-                cppLox::Types::Value const value = pop(*frame);
-                if (m_memoryMutator->setGlobal(function.chunk()
-                                                   ->getConstant(constant)
-                                                   .as<cppLox::Types::Object *>()
-                                                   ->as<cppLox::Types::ObjectString>(),
-                                               value)) {
-                    throw cppLox::Error::RunTimeException("Variable already defined");
-                }
-                push(*frame, value);
-                break;
-            }
-        case cppLox::ByteCode::Opcode::DIVIDE:
-            {
-                cppLox::Types::Value const a = pop(*frame);
-                cppLox::Types::Value const b = pop(*frame);
-                push(*frame, b / a);
-                break;
-            }
-        case cppLox::ByteCode::Opcode::EQUAL:
-            push(*frame, pop(*frame) == pop(*frame));
-            break;
-        case cppLox::ByteCode::Opcode::FALSE:
-            push(*frame, cppLox::Types::Value(false));
-            break;
-        case cppLox::ByteCode::Opcode::GET_GLOBAL:
-            {
-                uint8_t const constant = *frame->m_instruction_pointer++;
-                cppLox::Types::Value const value = m_memoryMutator->getGlobal(frame->m_function->chunk()
-                                                                                  ->getConstant(constant)
-                                                                                  .as<cppLox::Types::Object *>()
-                                                                                  ->as<cppLox::Types::ObjectString>());
-                push(*frame, value);
-                break;
-            }
-        case cppLox::ByteCode::Opcode::GET_LOCAL:
-            {
-                uint8_t const slot = *frame->m_instruction_pointer++;
-                push(*frame, frame->m_slots[slot + 1]);
-                break;
-            }
-        case cppLox::ByteCode::Opcode::GREATER:
-            {
-                cppLox::Types::Value const a = pop(*frame);
-                cppLox::Types::Value const b = pop(*frame);
-                push(*frame, b > a);
-                break;
-            }
-        case cppLox::ByteCode::Opcode::GREATER_EQUAL:
-            {
-                cppLox::Types::Value const a = pop(*frame);
-                cppLox::Types::Value const b = pop(*frame);
-                push(*frame, b >= a);
-                break;
-            }
-        case cppLox::ByteCode::Opcode::JUMP:
-            {
-                uint16_t const offset = getShort(*frame);
-                frame->m_instruction_pointer += offset;
-                break;
-            }
-        case cppLox::ByteCode::Opcode::JUMP_IF_FALSE:
-            {
-                uint16_t const offset = getShort(*frame);
-                if (!peek(*frame).as<bool>()) {
-                    frame->m_instruction_pointer += offset;
-                }
-                break;
-            }
-        case cppLox::ByteCode::Opcode::LESS:
-            {
-                cppLox::Types::Value const a = pop(*frame);
-                cppLox::Types::Value const b = pop(*frame);
-                push(*frame, b < a);
-                break;
-            }
-        case cppLox::ByteCode::Opcode::LESS_EQUAL:
-            {
-                cppLox::Types::Value const a = pop(*frame);
-                cppLox::Types::Value const b = pop(*frame);
-                push(*frame, b <= a);
-                break;
-            }
-        case cppLox::ByteCode::Opcode::LOOP:
-            {
-                uint16_t const offset = getShort(*frame);
-                frame->m_instruction_pointer -= offset;
-                break;
-            }
-        case cppLox::ByteCode::Opcode::MULTIPLY:
-            push(*frame, pop(*frame) * pop(*frame));
-            break;
-        case cppLox::ByteCode::Opcode::NEGATE:
-            push(*frame, -pop(*frame));
-            break;
-        case cppLox::ByteCode::Opcode::NOT:
-            push(*frame, !pop(*frame));
-            break;
-        case cppLox::ByteCode::Opcode::NOT_EQUAL:
-            push(*frame, pop(*frame) != pop(*frame));
-            break;
-        case cppLox::ByteCode::Opcode::NULL_:
-            push(*frame, cppLox::Types::Value());
-            break;
-        case cppLox::ByteCode::Opcode::RETURN:
-            {
-                cppLox::Types::Value const result = pop(*frame);
-                m_frame_count--;
-                if (m_frame_count == 0) {
-                    return;
-                }
-                m_stack_top = frame->m_slots - m_stack + 1;
-                push(m_frames[m_frame_count - 1], result);
-                frame = &m_frames[m_frame_count - 1];
-                return;
+        // Calling a lox function pushes a new frame instead of recursing, so we continue with the callee
+        frame = &m_frames[m_frame_count - 1];
+        VM_NEXT();
+    }
+    VM_CASE(CALL_INLINED) : {
+        uint8_t const arg_count = *frame->m_instruction_pointer++;
+        uint16_t const constant = getShort(*frame);
+        uint16_t const offset = getShort(*frame);
+        cppLox::Types::Value val = m_stack[m_stack_top - 1 - arg_count];
+        // The inlined body follows, it uses the callee and the arguments on the stack as the first slots of its locals
+        if (val == frame->m_function->chunk()->getConstant(constant)) {
+            VM_NEXT();
+        }
+        size_t const caller = m_frame_count - 1;
+#ifdef JIT
+        size_t const frameCount = m_frame_count;
+        if (!callFunction(val, arg_count, *frame)) {
+            VM_ERROR();
+        }
+        // Any other callee returns behind the inlined body
+        m_frames[caller].m_instruction_pointer += offset;
+        if (m_frame_count > frameCount && runCompiled() == NativeExecution::RUNTIME_ERROR) {
+            VM_ERROR();
+        }
+#else
+        if (!callFunction(val, arg_count, *frame)) {
+            VM_ERROR();
+        }
+        // Any other callee returns behind the inlined body
+        m_frames[caller].m_instruction_pointer += offset;
+#endif
+        frame = &m_frames[m_frame_count - 1];
+        VM_NEXT();
+    }
+    VM_CASE(CONSTANT) : {
+        uint8_t const constant = *frame->m_instruction_pointer++;
+        push(*frame, frame->m_function->chunk()->getConstant(constant));
+        VM_NEXT();
+    }
+    VM_CASE(CONSTANT_LONG) : {
+        uint16_t const constant = getShort(*frame);
+        push(*frame, frame->m_function->chunk()->getConstant(constant));
+        VM_NEXT();
+    }
+    VM_CASE(DEFINE_GLOBAL) : {
+        uint16_t const slot = getShort(*frame);
+        if (!defineGlobal(slot, pop(*frame))) {
+            VM_ERROR();
+        }
+        VM_NEXT();
+    }
+    VM_CASE(DIVIDE) : {
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 1, DIVIDE_NUM_NUM);
+        VM_CHECKED(result, divide(b, a));
+        push(*frame, *result);
+        VM_NEXT();
+    }
+    VM_CASE(DIVIDE_NUM_NUM) : {
+        VM_GUARD_NUMBERS(DIVIDE);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        push(*frame, cppLox::Types::Value(b / a));
+        VM_NEXT();
+    }
+    VM_CASE(EQUAL) : {
+        push(*frame, pop(*frame) == pop(*frame));
+        VM_NEXT();
+    }
+    VM_CASE(EQUAL_JUMP_IF_FALSE) : {
+        uint16_t const offset = getShort(*frame);
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        if (!(b == a)) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(FALSE) : {
+        push(*frame, cppLox::Types::Value(false));
+        VM_NEXT();
+    }
+    VM_CASE(GET_GLOBAL) : {
+        uint16_t const slot = getShort(*frame);
+        push(*frame, m_memoryMutator->getGlobal(slot));
+        VM_NEXT();
+    }
+    VM_CASE(GET_LOCAL) : {
+        uint8_t const slot = *frame->m_instruction_pointer++;
+        push(*frame, frame->m_slots[slot + 1]);
+        VM_NEXT();
+    }
+    VM_CASE(GET_LOCAL_CONSTANT) : {
+        uint8_t const slot = *frame->m_instruction_pointer++;
+        uint8_t const constant = *frame->m_instruction_pointer++;
+        push(*frame, frame->m_slots[slot + 1]);
+        push(*frame, frame->m_function->chunk()->getConstant(constant));
+        VM_NEXT();
+    }
+    VM_CASE(GET_LOCAL_GET_LOCAL) : {
+        uint8_t const first = *frame->m_instruction_pointer++;
+        uint8_t const second = *frame->m_instruction_pointer++;
+        push(*frame, frame->m_slots[first + 1]);
+        push(*frame, frame->m_slots[second + 1]);
+        VM_NEXT();
+    }
+    VM_CASE(GREATER) : {
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 1, GREATER_NUM_NUM);
+        VM_CHECKED(result, greater(b, a));
+        push(*frame, *result);
+        VM_NEXT();
+    }
+    VM_CASE(GREATER_EQUAL) : {
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 1, GREATER_EQUAL_NUM_NUM);
+        VM_CHECKED(result, greaterEqual(b, a));
+        push(*frame, *result);
+        VM_NEXT();
+    }
+    VM_CASE(GREATER_EQUAL_JUMP_IF_FALSE) : {
+        uint16_t const offset = getShort(*frame);
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 3, GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM);
+        VM_CHECKED(condition, greaterEqual(b, a));
+        if (condition->isFalsey()) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM) : {
+        VM_GUARD_NUMBERS(GREATER_EQUAL_JUMP_IF_FALSE);
+        uint16_t const offset = getShort(*frame);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        if (!(b >= a)) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(GREATER_EQUAL_NUM_NUM) : {
+        VM_GUARD_NUMBERS(GREATER_EQUAL);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        push(*frame, cppLox::Types::Value(b >= a));
+        VM_NEXT();
+    }
+    VM_CASE(GREATER_JUMP_IF_FALSE) : {
+        uint16_t const offset = getShort(*frame);
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 3, GREATER_JUMP_IF_FALSE_NUM_NUM);
+        VM_CHECKED(condition, greater(b, a));
+        if (condition->isFalsey()) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(GREATER_JUMP_IF_FALSE_NUM_NUM) : {
+        VM_GUARD_NUMBERS(GREATER_JUMP_IF_FALSE);
+        uint16_t const offset = getShort(*frame);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        if (!(b > a)) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(GREATER_NUM_NUM) : {
+        VM_GUARD_NUMBERS(GREATER);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        push(*frame, cppLox::Types::Value(b > a));
+        VM_NEXT();
+    }
+    VM_CASE(JUMP) : {
+        uint16_t const offset = getShort(*frame);
+        frame->m_instruction_pointer += offset;
+        VM_NEXT();
+    }
+    VM_CASE(JUMP_IF_FALSE) : {
+        uint16_t const offset = getShort(*frame);
+        if (peek(*frame).isFalsey()) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(LESS) : {
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 1, LESS_NUM_NUM);
+        VM_CHECKED(result, less(b, a));
+        push(*frame, *result);
+        VM_NEXT();
+    }
+    VM_CASE(LESS_EQUAL) : {
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 1, LESS_EQUAL_NUM_NUM);
+        VM_CHECKED(result, lessEqual(b, a));
+        push(*frame, *result);
+        VM_NEXT();
+    }
+    VM_CASE(LESS_EQUAL_JUMP_IF_FALSE) : {
+        uint16_t const offset = getShort(*frame);
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 3, LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM);
+        VM_CHECKED(condition, lessEqual(b, a));
+        if (condition->isFalsey()) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM) : {
+        VM_GUARD_NUMBERS(LESS_EQUAL_JUMP_IF_FALSE);
+        uint16_t const offset = getShort(*frame);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        if (!(b <= a)) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(LESS_EQUAL_NUM_NUM) : {
+        VM_GUARD_NUMBERS(LESS_EQUAL);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        push(*frame, cppLox::Types::Value(b <= a));
+        VM_NEXT();
+    }
+    VM_CASE(LESS_JUMP_IF_FALSE) : {
+        uint16_t const offset = getShort(*frame);
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 3, LESS_JUMP_IF_FALSE_NUM_NUM);
+        VM_CHECKED(condition, less(b, a));
+        if (condition->isFalsey()) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(LESS_JUMP_IF_FALSE_NUM_NUM) : {
+        VM_GUARD_NUMBERS(LESS_JUMP_IF_FALSE);
+        uint16_t const offset = getShort(*frame);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        if (!(b < a)) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(LESS_NUM_NUM) : {
+        VM_GUARD_NUMBERS(LESS);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        push(*frame, cppLox::Types::Value(b < a));
+        VM_NEXT();
+    }
+    VM_CASE(LOOP) : {
+        uint16_t const offset = getShort(*frame);
+        frame->m_instruction_pointer -= offset;
+        VM_NEXT();
+    }
+    VM_CASE(MULTIPLY) : {
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 1, MULTIPLY_NUM_NUM);
+        VM_CHECKED(result, multiply(b, a));
+        push(*frame, *result);
+        VM_NEXT();
+    }
+    VM_CASE(MULTIPLY_NUM_NUM) : {
+        VM_GUARD_NUMBERS(MULTIPLY);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        push(*frame, cppLox::Types::Value(b * a));
+        VM_NEXT();
+    }
+    VM_CASE(NEGATE) : {
+        VM_CHECKED(result, negate(pop(*frame)));
+        push(*frame, *result);
+        VM_NEXT();
+    }
+    VM_CASE(NOT) : {
+        push(*frame, !pop(*frame));
+        VM_NEXT();
+    }
+    VM_CASE(NOT_EQUAL) : {
+        push(*frame, pop(*frame) != pop(*frame));
+        VM_NEXT();
+    }
+    VM_CASE(NOT_EQUAL_JUMP_IF_FALSE) : {
+        uint16_t const offset = getShort(*frame);
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        if (!(b != a)) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(NULL_) : {
+        push(*frame, cppLox::Types::Value());
+        VM_NEXT();
+    }
+    VM_CASE(POP) : {
+        static_cast<void>(pop(*frame));
+        VM_NEXT();
+    }
+    VM_CASE(POP_JUMP_IF_FALSE) : {
+        uint16_t const offset = getShort(*frame);
+        if (pop(*frame).isFalsey()) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(POP_JUMP_IF_TRUE) : {
+        uint16_t const offset = getShort(*frame);
+        // The jump is taken for the values, that NOT turns into false, so it replaces NOT and POP_JUMP_IF_FALSE
+        if (!pop(*frame).isFalsey()) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(PRINT) : {
+        std::cout << pop(*frame) << std::endl;
+        VM_NEXT();
+    }
+    VM_CASE(RETURN) : {
+        cppLox::Types::Value const result = pop(*frame);
+        m_frame_count--;
+        if (m_frame_count == 0) {
+            return InterpretResult::OK;
+        }
+        // Discards the arguments, the locals and the callee of the returning function
+        m_stack_top = frame->m_slots - m_stack.data();
+        frame = &m_frames[m_frame_count - 1];
+        push(*frame, result);
+#ifdef JIT
+        // Returns to the native code, that called the returning function
+        if (m_frame_count == m_exitFrameCount) {
+            return InterpretResult::OK;
+        }
+#endif
+        VM_NEXT();
+    }
+    VM_CASE(RETURN_INLINED) : {
+        uint8_t const count = *frame->m_instruction_pointer++;
+        // Discards the callee, the arguments and the locals of the inlined function below its result
+        m_stack[m_stack_top - 1 - count] = m_stack[m_stack_top - 1];
+        m_stack_top -= count;
+        VM_NEXT();
+    }
+    VM_CASE(SET_GLOBAL) : {
+        uint16_t const slot = getShort(*frame);
+        if (!setGlobal(*frame, slot, peek(*frame))) {
+            VM_ERROR();
+        }
+        VM_NEXT();
+    }
+    VM_CASE(SET_LOCAL) : {
+        uint8_t const slot = *frame->m_instruction_pointer++;
+        frame->m_slots[slot + 1] = peek(*frame);
+        VM_NEXT();
+    }
+    VM_CASE(SET_LOCAL_POP) : {
+        uint8_t const slot = *frame->m_instruction_pointer++;
+        frame->m_slots[slot + 1] = pop(*frame);
+        VM_NEXT();
+    }
+    VM_CASE(SUBTRACT) : {
+        cppLox::Types::Value const a = pop(*frame);
+        cppLox::Types::Value const b = pop(*frame);
+        VM_QUICKEN(a, b, 1, SUBTRACT_NUM_NUM);
+        VM_CHECKED(result, subtract(b, a));
+        push(*frame, *result);
+        VM_NEXT();
+    }
+    VM_CASE(SUBTRACT_NUM_NUM) : {
+        VM_GUARD_NUMBERS(SUBTRACT);
+        double const a = pop(*frame).as<double>();
+        double const b = pop(*frame).as<double>();
+        push(*frame, cppLox::Types::Value(b - a));
+        VM_NEXT();
+    }
+    VM_CASE(TAIL_CALL) : {
+        uint8_t const arg_count = *frame->m_instruction_pointer++;
+        cppLox::Types::Value val = m_stack[m_stack_top - 1 - arg_count];
+        // Other callees are called like CALL does, their result is returned by the RETURN after this instruction
+        if (!val.is(cppLox::Types::Value::Type::OBJECT) ||
+            !val.as<cppLox::Types::Object *>()->is(cppLox::Types::Object::Type::FUNCTION)) {
+            if (!callFunction(val, arg_count, *frame)) {
+                VM_ERROR();
             }
-        case cppLox::ByteCode::Opcode::PRINT:
-            std::cout << pop(*frame) << std::endl;
-            break;
-        case cppLox::ByteCode::Opcode::SET_GLOBAL:
-            {
-                uint8_t const constant = *frame->m_instruction_pointer++;
-                cppLox::Types::Value value = pop(*frame);
-                cppLox::Types::ObjectString * name = function.chunk()
-                                                         ->getConstant(constant)
-                                                         .as<cppLox::Types::Object *>()
-                                                         ->as<cppLox::Types::ObjectString>();
-                if (!m_memoryMutator->setGlobal(name, value)) {
-                    m_memoryMutator->deleteGlobal(name);
-                    runTimeError(*frame, "Undefined variable '%s'", name->string().c_str());
-                };
-                break;
+            VM_NEXT();
+        }
+        if (!tailCall(*val.as<cppLox::Types::Object *>()->as<cppLox::Types::ObjectFunction>(), arg_count, *frame)) {
+            VM_ERROR();
+        }
+#ifdef JIT
+        // A compiled function is executed as native code, that already returned from the reused frame
+        NativeExecution const execution = runCompiled();
+        if (execution == NativeExecution::RUNTIME_ERROR) {
+            VM_ERROR();
+        }
+        frame = &m_frames[m_frame_count - 1];
+        if (execution == NativeExecution::RETURNED && m_frame_count == m_exitFrameCount) {
+            return InterpretResult::OK;
+        }
+#endif
+        VM_NEXT();
+    }
+    VM_CASE(TRUE) : {
+        push(*frame, cppLox::Types::Value(true));
+        VM_NEXT();
+    }
+#ifdef COMPUTED_GOTO
+    label_UNKNOWN:
+#else
+        default:
+#endif
+        runTimeError(*frame, "Unknown opcode {}", *(frame->m_instruction_pointer - 1));
+        VM_ERROR();
+#ifndef COMPUTED_GOTO
+        }
+#endif
+    }
+}
+
+#undef VM_TRACE_EXECUTION
+#ifdef DEBUG_TRACE_EXECUTION
+#define VM_TRACE_EXECUTION()                                                                                           \
+    do {                                                                                                               \
+        std::cout << cppLox::ByteCode::register_opcode_as_string(                                                      \
+                         static_cast<cppLox::ByteCode::RegisterOpcode>(*frame->m_instruction_pointer))                 \
+                  << std::endl;                                                                                        \
+    } while (false)
+#else
+#define VM_TRACE_EXECUTION()                                                                                           \
+    do {                                                                                                               \
+    } while (false)
+#endif
+
+// The dispatch profile only counts the opcodes of the stack tier
+#undef VM_PROFILE_DISPATCH
+#undef VM_QUICKEN
+#undef VM_GUARD_NUMBERS
+#define VM_PROFILE_DISPATCH()                                                                                          \
+    do {                                                                                                               \
+    } while (false)
+
+#ifndef COMPUTED_GOTO
+#undef VM_CASE
+#define VM_CASE(opcode) case cppLox::ByteCode::RegisterOpcode::opcode
+#endif
+
+// Executes a binary instruction of the register tier - two numbers are combined inline, any other operands are passed
+// to the operator of the virtual machine, that records a runtime error if the operation is not defined for them.
+#define VM_BINARY(operator, operation)                                                                                 \
+    do {                                                                                                               \
+        cppLox::Types::Value & result = destination();                                                                 \
+        cppLox::Types::Value const left = source();                                                                    \
+        cppLox::Types::Value const right = source();                                                                   \
+        if (left.isNumber() && right.isNumber()) [[likely]] {                                                          \
+            result = cppLox::Types::Value(left.as<double>() operator right.as<double>());                              \
+        } else {                                                                                                       \
+            VM_CHECKED(value, operation(left, right));                                                                 \
+            result = *value;                                                                                           \
+        }                                                                                                              \
+    } while (false)
+
+auto VM::runRegisters() -> InterpretResult {
+    CallFrame * frame = &m_frames[m_frame_count - 1];
+    // Reads a source operand, that is either a register or a constant
+    auto const source = [&]() -> cppLox::Types::Value {
+        uint16_t const operand = getShort(*frame);
+        if (operand & REGISTER_CONSTANT_FLAG) {
+            return frame->m_function->registerChunk()->getConstant(operand & ~REGISTER_CONSTANT_FLAG);
+        }
+        return frame->m_slots[operand];
+    };
+    // Reads a destination operand, that is always a register
+    auto const destination = [&]() -> cppLox::Types::Value & { return frame->m_slots[getShort(*frame)]; };
+#ifdef COMPUTED_GOTO
+    // The labels have to be in the same order as the opcodes are declared in the RegisterOpcode enum.
+    static void * dispatchTable[UINT8_MAX + 1] = {
+        &&label_ADD,            &&label_CALL,           &&label_DEFINE_GLOBAL,  &&label_DIVIDE,
+        &&label_EQUAL,          &&label_GET_GLOBAL,     &&label_GREATER,        &&label_GREATER_EQUAL,
+        &&label_JUMP,           &&label_JUMP_IF_FALSE,  &&label_LESS,           &&label_LESS_EQUAL,
+        &&label_LOOP,           &&label_MOVE,           &&label_MULTIPLY,       &&label_NEGATE,
+        &&label_NOT,            &&label_NOT_EQUAL,      &&label_PRINT,          &&label_RETURN,
+        &&label_SET_GLOBAL,     &&label_SUBTRACT};
+    // Filled once like the table of the stack tier
+    [[maybe_unused]] static bool const filled =
+        (std::fill(std::begin(dispatchTable) + static_cast<uint8_t>(cppLox::ByteCode::RegisterOpcode::AMOUNT),
+                   std::end(dispatchTable), &&label_UNKNOWN),
+         true);
+    VM_DISPATCH();
+    {
+#else
+    for (;;) {
+        VM_TRACE_EXECUTION();
+        switch (static_cast<cppLox::ByteCode::RegisterOpcode>(*frame->m_instruction_pointer++)) {
+#endif
+    VM_CASE(ADD) : {
+        VM_BINARY(+, add);
+        VM_NEXT();
+    }
+    VM_CASE(CALL) : {
+        uint16_t const callee = getShort(*frame);
+        uint8_t const arg_count = *frame->m_instruction_pointer++;
+        // The function and its arguments become the first slots of the frame of the callee
+        m_stack_top = (frame->m_slots - m_stack.data()) + callee + arg_count + 1;
+        cppLox::Types::Value function = frame->m_slots[callee];
+        if (!callFunction(function, arg_count, *frame)) {
+            VM_ERROR();
+        }
+        frame = &m_frames[m_frame_count - 1];
+        VM_NEXT();
+    }
+    VM_CASE(DEFINE_GLOBAL) : {
+        uint16_t const slot = getShort(*frame);
+        if (!defineGlobal(slot, source())) {
+            VM_ERROR();
+        }
+        VM_NEXT();
+    }
+    VM_CASE(DIVIDE) : {
+        VM_BINARY(/, divide);
+        VM_NEXT();
+    }
+    VM_CASE(EQUAL) : {
+        cppLox::Types::Value & result = destination();
+        cppLox::Types::Value const left = source();
+        cppLox::Types::Value const right = source();
+        result = left == right;
+        VM_NEXT();
+    }
+    VM_CASE(GET_GLOBAL) : {
+        cppLox::Types::Value & result = destination();
+        uint16_t const slot = getShort(*frame);
+        result = m_memoryMutator->getGlobal(slot);
+        VM_NEXT();
+    }
+    VM_CASE(GREATER) : {
+        VM_BINARY(>, greater);
+        VM_NEXT();
+    }
+    VM_CASE(GREATER_EQUAL) : {
+        VM_BINARY(>=, greaterEqual);
+        VM_NEXT();
+    }
+    VM_CASE(JUMP) : {
+        uint16_t const offset = getShort(*frame);
+        frame->m_instruction_pointer += offset;
+        VM_NEXT();
+    }
+    VM_CASE(JUMP_IF_FALSE) : {
+        cppLox::Types::Value const condition = source();
+        uint16_t const offset = getShort(*frame);
+        if (condition.isFalsey()) {
+            frame->m_instruction_pointer += offset;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(LESS) : {
+        VM_BINARY(<, less);
+        VM_NEXT();
+    }
+    VM_CASE(LESS_EQUAL) : {
+        VM_BINARY(<=, lessEqual);
+        VM_NEXT();
+    }
+    VM_CASE(LOOP) : {
+        uint16_t const offset = getShort(*frame);
+        frame->m_instruction_pointer -= offset;
+        VM_NEXT();
+    }
+    VM_CASE(MOVE) : {
+        cppLox::Types::Value & result = destination();
+        result = source();
+        VM_NEXT();
+    }
+    VM_CASE(MULTIPLY) : {
+        VM_BINARY(*, multiply);
+        VM_NEXT();
+    }
+    VM_CASE(NEGATE) : {
+        cppLox::Types::Value & result = destination();
+        VM_CHECKED(value, negate(source()));
+        result = *value;
+        VM_NEXT();
+    }
+    VM_CASE(NOT) : {
+        cppLox::Types::Value & result = destination();
+        result = !source();
+        VM_NEXT();
+    }
+    VM_CASE(NOT_EQUAL) : {
+        cppLox::Types::Value & result = destination();
+        cppLox::Types::Value const left = source();
+        cppLox::Types::Value const right = source();
+        result = left != right;
+        VM_NEXT();
+    }
+    VM_CASE(PRINT) : {
+        std::cout << source() << std::endl;
+        VM_NEXT();
+    }
+    VM_CASE(RETURN) : {
+        cppLox::Types::Value const result = source();
+        m_frame_count--;
+        if (m_frame_count == 0) {
+            return InterpretResult::OK;
+        }
+        // The result replaces the function in the register of the caller
+        frame->m_slots[0] = result;
+        frame = &m_frames[m_frame_count - 1];
+        VM_NEXT();
+    }
+    VM_CASE(SET_GLOBAL) : {
+        uint16_t const slot = getShort(*frame);
+        if (!setGlobal(*frame, slot, source())) {
+            VM_ERROR();
+        }
+        VM_NEXT();
+    }
+    VM_CASE(SUBTRACT) : {
+        VM_BINARY(-, subtract);
+        VM_NEXT();
+    }
+#ifdef COMPUTED_GOTO
+    label_UNKNOWN:
+#else
+        default:
+#endif
+        runTimeError(*frame, "Unknown opcode {}", *(frame->m_instruction_pointer - 1));
+        VM_ERROR();
+#ifndef COMPUTED_GOTO
+        }
+#endif
+    }
+}
+
+#ifdef JIT
+auto VM::runCompiled() -> NativeExecution {
+    size_t const frameCount = m_frame_count;
+    // Every call of native code nests on the native stack, so deep recursions are interpreted
+    if (frameCount > JIT_FRAMES_MAX) {
+        return NativeExecution::INTERPRET;
+    }
+    for (;;) {
+        // The frames are looked up again, because the calls of the native code can grow them
+        CallFrame & frame = m_frames[frameCount - 1];
+        cppLox::Types::ObjectFunction & function = *frame.m_function;
+        if (function.registerChunk() != nullptr) {
+            return NativeExecution::INTERPRET;
+        }
+        if (function.nativeCode() == nullptr) {
+            // A function, that could not be compiled, passes the threshold and is never compiled again
+            if (function.countInvocation() != m_jitThreshold) {
+                return NativeExecution::INTERPRET;
             }
-        case cppLox::ByteCode::Opcode::SET_LOCAL:
-            {
-                uint8_t const slot = *frame->m_instruction_pointer++;
-                frame->m_slots[slot + 1] = peek(*frame);
-                break;
+            function.setNativeCode(m_jitCompiler.compile(function));
+            if (function.nativeCode() == nullptr) {
+                return NativeExecution::INTERPRET;
             }
-        case cppLox::ByteCode::Opcode::SUBTRACT:
-            {
-                cppLox::Types::Value const a = pop(*frame);
-                cppLox::Types::Value const b = pop(*frame);
-                push(*frame, b - a);
-                break;
+        }
+        if (!function.nativeCode()->entry()(this, frame.m_slots, m_stack.data() + m_stack_top)) {
+            // A runtime error is already recorded, other exceptions are passed on to the embedding code
+            if (m_jitException != nullptr) {
+                std::rethrow_exception(std::exchange(m_jitException, nullptr));
             }
-        case cppLox::ByteCode::Opcode::TRUE:
-            push(*frame, cppLox::Types::Value(true));
-            break;
+            return NativeExecution::RUNTIME_ERROR;
+        }
+        // The native code leaves the frame on a tail call, so the callee is executed in the same frame
+        if (m_frame_count < frameCount) {
+            return NativeExecution::RETURNED;
+        }
+    }
+}
+
+auto VM::runNested(size_t frameCount) -> InterpretResult {
+    switch (runCompiled()) {
+    case NativeExecution::RETURNED:
+        return InterpretResult::OK;
+    case NativeExecution::RUNTIME_ERROR:
+        return InterpretResult::RUNTIME_ERROR;
+    case NativeExecution::INTERPRET:
+        break;
+    }
+    size_t const exitFrameCount = std::exchange(m_exitFrameCount, frameCount);
+    InterpretResult result;
+    try {
+        result = run();
+    } catch (...) {
+        m_exitFrameCount = exitFrameCount;
+        throw;
+    }
+    m_exitFrameCount = exitFrameCount;
+    return result;
+}
+
+auto VM::setJitThreshold(uint32_t threshold) noexcept -> void {
+    m_jitThreshold = threshold;
+}
+#endif
+
+auto VM::defineGlobal(uint16_t slot, cppLox::Types::Value value) -> bool {
+    if (m_memoryMutator->defineGlobal(slot, value)) {
+        recordError("Variable already defined");
+        return false;
+    }
+    return true;
+}
+
+auto VM::setGlobal(CallFrame & frame, uint16_t slot, cppLox::Types::Value value) -> bool {
+    if (!m_memoryMutator->setGlobal(slot, value)) {
+        runTimeError(frame, "Undefined variable '{}'", m_memoryMutator->globalName(slot)->string().c_str());
+        return false;
+    }
+    return true;
+}
+
+auto VM::add(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+    -> std::optional<cppLox::Types::Value> {
+    if (left.isNumber() && right.isNumber()) {
+        return cppLox::Types::Value(left.as<double>() + right.as<double>());
+    }
+    if (left.is(cppLox::Types::Value::Type::OBJECT) && right.is(cppLox::Types::Value::Type::OBJECT)) {
+        cppLox::Types::Object * leftObject = left.as<cppLox::Types::Object *>();
+        cppLox::Types::Object * rightObject = right.as<cppLox::Types::Object *>();
+        if (leftObject->is(cppLox::Types::Object::Type::STRING) &&
+            rightObject->is(cppLox::Types::Object::Type::STRING)) {
+            return cppLox::Types::Value(m_memoryMutator->createYoung<cppLox::Types::ObjectString>(
+                leftObject->as<cppLox::Types::ObjectString>()->string() +
+                rightObject->as<cppLox::Types::ObjectString>()->string()));
         }
     }
+    return recordError("Operands must be two numbers or two strings");
+}
+
+auto VM::subtract(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+    -> std::optional<cppLox::Types::Value> {
+    if (!left.isNumber() || !right.isNumber()) [[unlikely]] {
+        return recordError("subtraction is only defined for numbers");
+    }
+    return cppLox::Types::Value(left.as<double>() - right.as<double>());
+}
+
+auto VM::multiply(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+    -> std::optional<cppLox::Types::Value> {
+    if (!left.isNumber() || !right.isNumber()) [[unlikely]] {
+        return recordError("multiplication is only defined for numbers");
+    }
+    return cppLox::Types::Value(left.as<double>() * right.as<double>());
+}
+
+auto VM::divide(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+    -> std::optional<cppLox::Types::Value> {
+    if (!left.isNumber() || !right.isNumber()) [[unlikely]] {
+        return recordError("division is only defined for numbers");
+    }
+    return cppLox::Types::Value(left.as<double>() / right.as<double>());
+}
+
+// The comparisons report the same message as the comparison operators of the value
+
+auto VM::greater(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+    -> std::optional<cppLox::Types::Value> {
+    if (!left.isNumber() || !right.isNumber()) [[unlikely]] {
+        return recordError("less than is only defined for numbers");
+    }
+    return cppLox::Types::Value(left.as<double>() > right.as<double>());
+}
+
+auto VM::greaterEqual(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+    -> std::optional<cppLox::Types::Value> {
+    if (!left.isNumber() || !right.isNumber()) [[unlikely]] {
+        return recordError("less than is only defined for numbers");
+    }
+    return cppLox::Types::Value(left.as<double>() >= right.as<double>());
+}
+
+auto VM::less(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+    -> std::optional<cppLox::Types::Value> {
+    if (!left.isNumber() || !right.isNumber()) [[unlikely]] {
+        return recordError("less than is only defined for numbers");
+    }
+    return cppLox::Types::Value(left.as<double>() < right.as<double>());
+}
+
+auto VM::lessEqual(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+    -> std::optional<cppLox::Types::Value> {
+    if (!left.isNumber() || !right.isNumber()) [[unlikely]] {
+        return recordError("less than is only defined for numbers");
+    }
+    return cppLox::Types::Value(left.as<double>() <= right.as<double>());
+}
+
+auto VM::negate(cppLox::Types::Value const & operand) -> std::optional<cppLox::Types::Value> {
+    if (!operand.isNumber()) [[unlikely]] {
+        return recordError("Runtime error: unary negation is only defined for numbers");
+    }
+    return cppLox::Types::Value(-operand.as<double>());
 }
 
+#undef VM_ERROR
+#undef VM_CHECKED
+#undef VM_BINARY
+#undef VM_NEXT
+#undef VM_CASE
+#undef VM_DISPATCH
+#undef VM_TRACE_EXECUTION
+#undef VM_PROFILE_DISPATCH
+
+// The compiler guarantees that a function never uses more stack slots than its maximum stack depth, that is checked
+// once per call (see VM::call). So the stack is only checked on every push and pop in debug builds, a violation is
+// thrown immediately because it is a bug in the compiler.
+
 auto VM::push(CallFrame & frame, cppLox::Types::Value value) -> void {
-    if (m_stack_top == STACK_MAX) {
+#ifndef NDEBUG
+    if (m_stack_top >= m_stack.capacity()) {
         runTimeError(frame, "Stack overflow");
+        throwRecordedError();
     }
+#endif
     m_stack[m_stack_top] = value;
     m_stack_top++;
 }
 
 auto VM::pop(CallFrame & frame) -> cppLox::Types::Value {
+#ifndef NDEBUG
     if (m_stack_top == 0) {
         runTimeError(frame, "Stack empty on pop");
+        throwRecordedError();
     }
+#endif
     m_stack_top--;
     return m_stack[m_stack_top];
 }
 
 [[nodiscard]] auto VM::peek(CallFrame & frame) -> cppLox::Types::Value {
+#ifndef NDEBUG
     if (m_stack_top == 0) {
         runTimeError(frame, "Stack empty on peek");
+        throwRecordedError();
     }
+#endif
     return m_stack[m_stack_top - 1];
 }
 
 auto VM::resetStack() noexcept -> void {
     m_stack_top = 0;
+    m_rootTop = 0;
     m_frame_count = 0;
 }
 
+auto VM::setFrameLimit(size_t frameLimit) noexcept -> void {
+    m_frame_limit = std::max<size_t>(frameLimit, 1);
+}
+
 [[nodiscard]] auto VM::getShort(CallFrame & frame) -> uint16_t {
     uint16_t const short_value =
         static_cast<uint16_t>(*frame.m_instruction_pointer << 8 | *(frame.m_instruction_pointer + 1));
@@ -287,42 +1124,100 @@ auto VM::resetStack() noexcept -> void {
     return short_value;
 }
 
-auto VM::callFunction(cppLox::Types::Value & value, uint8_t arg_count, CallFrame & frame) -> void {
+auto VM::callFunction(cppLox::Types::Value & value, uint8_t arg_count, CallFrame & frame) -> bool {
     if (!value.is(cppLox::Types::Value::Type::OBJECT)) {
         runTimeError(frame, "Can only call functions and classes");
+        return false;
     }
     cppLox::Types::Object * object = value.as<cppLox::Types::Object *>();
     if (object->is(cppLox::Types::Object::Type::FUNCTION)) {
         cppLox::Types::ObjectFunction * function = object->as<cppLox::Types::ObjectFunction>();
         if (arg_count != function->arity()) {
-            runTimeError(frame, "Expected %d arguments but got %d", function->arity(), arg_count);
+            runTimeError(frame, "Expected {} arguments but got {}", function->arity(), arg_count);
+            return false;
         }
-        call(*function, arg_count);
-    } else if (object->is(cppLox::Types::Object::Type::NATIVE_FUNCTION)) {
+        return call(*function, arg_count);
+    }
+    if (object->is(cppLox::Types::Object::Type::NATIVE_FUNCTION)) {
         cppLox::Types::ObjectNativeFunction * function = object->as<cppLox::Types::ObjectNativeFunction>();
         auto arity = function->arity();
         if (arity != -1 && arity != arg_count) {
-            runTimeError(frame, "Expected %d arguments but got %d", arity, arg_count);
+            runTimeError(frame, "Expected {} arguments but got {}", arity, arg_count);
+            return false;
+        }
+        cppLox::Types::Value * args = m_stack.data() + m_stack_top - arg_count;
+        cppLox::Types::Value result;
+        if (function->isDirect()) {
+            cppLox::Types::NativeResult const nativeResult = function->call(std::span(args, arg_count));
+            if (nativeResult.error != nullptr) [[unlikely]] {
+                runTimeError(frame, "{}", nativeResult.error);
+                return false;
+            }
+            result = nativeResult.value;
+        } else {
+            // The error callback only records the error, so the native function returns normally
+            result = function->call(arg_count, args, frame,
+                                    [&](CallFrame & frame, std::string_view fmt) { runTimeError(frame, fmt); });
+            if (!m_errorMessage.empty()) [[unlikely]] {
+                return false;
+            }
         }
-        cppLox::Types::Value result =
-            function->call(arg_count, &m_stack[m_stack_top - arg_count], frame,
-                           [&](CallFrame & frame, std::string_view fmt) { runTimeError(frame, fmt); });
         m_stack_top -= arg_count + 1;
         push(frame, result);
-    } else {
-        runTimeError(frame, "Can only call functions and classes");
+        return true;
     }
+    runTimeError(frame, "Can only call functions and classes");
+    return false;
 }
 
-auto VM::call(cppLox::Types::ObjectFunction & function, uint8_t arg_count) -> void {
-    if (m_frame_count == FRAME_MAX) {
-        runTimeError(m_frames[m_frame_count - 1], "Stack overflow");
+auto VM::call(cppLox::Types::ObjectFunction & function, uint8_t arg_count) -> bool {
+    if (m_frame_count >= m_frame_limit ||
+        !m_stack.ensureCapacity(m_stack_top - arg_count - 1 + function.maxStackDepth())) {
+        runTimeError(m_frames[m_frame_count == 0 ? 0 : m_frame_count - 1], "Stack overflow");
+        return false;
+    }
+    if (m_frame_count == m_frames.size()) {
+        m_frames.resize(std::min(m_frames.size() * 2, m_frame_limit));
     }
     CallFrame * frame = &m_frames[m_frame_count++];
     frame->m_function = &function;
-    frame->m_instruction_pointer = function.chunk()->code().data();
-    frame->m_slots = m_stack + m_stack_top - arg_count - 1;
-    run(function);
+    frame->m_instruction_pointer = executedChunk(function)->code().data();
+    frame->m_slots = m_stack.data() + m_stack_top - arg_count - 1;
+    if (function.registerChunk() != nullptr) {
+        // The registers are written without moving the top of the stack, so they are only roots of the garbage
+        // collector below the root top. Registers above it may hold objects, that were freed since, and are cleared
+        size_t const registerTop = (frame->m_slots - m_stack.data()) + function.maxStackDepth();
+        if (registerTop > m_rootTop) {
+            std::fill(m_stack.data() + std::max(m_stack_top, m_rootTop), m_stack.data() + registerTop,
+                      cppLox::Types::Value());
+            m_rootTop = registerTop;
+        }
+    }
+    return true;
+}
+
+auto VM::tailCall(cppLox::Types::ObjectFunction & function, uint8_t arg_count, CallFrame & frame) -> bool {
+    if (arg_count != function.arity()) {
+        runTimeError(frame, "Expected {} arguments but got {}", function.arity(), arg_count);
+        return false;
+    }
+    size_t const base = frame.m_slots - m_stack.data();
+    if (!m_stack.ensureCapacity(base + function.maxStackDepth())) {
+        runTimeError(frame, "Stack overflow");
+        return false;
+    }
+    // The callee and its arguments replace the callee, the arguments and the locals of the returning function
+    std::copy(m_stack.data() + m_stack_top - arg_count - 1, m_stack.data() + m_stack_top, frame.m_slots);
+    m_stack_top = base + arg_count + 1;
+    frame.m_function = &function;
+    frame.m_instruction_pointer = executedChunk(function)->code().data();
+    return true;
+}
+
+template <int16_t ARITY>
+auto VM::defineNative(std::string const & name, cppLox::Types::NativeFunction function) -> void {
+    static_assert(ARITY >= -1);
+    defineNative(name, m_memoryMutator->create<cppLox::Types::ObjectNativeFunction>(function, ARITY));
 }
 
 template <int16_t ARITY>
@@ -331,12 +1226,16 @@ auto VM::defineNative(std::string const & name,
                                                          std::function<void(CallFrame &, std::string_view fmt)>)>
                           function) -> void {
     static_assert(ARITY >= -1);
+    defineNative(name, m_memoryMutator->create<cppLox::Types::ObjectNativeFunction>(function, ARITY));
+}
+
+auto VM::defineNative(std::string const & name, cppLox::Types::Object * function) -> void {
+    // The function is pushed first, so that it is not collected when the name is allocated
+    push(m_frames[m_frame_count], cppLox::Types::Value(function));
     auto nameObj = m_memoryMutator->create<cppLox::Types::ObjectString>(name);
-    cppLox::Types::Object * nativeFunctionObj =
-        m_memoryMutator->create<cppLox::Types::ObjectNativeFunction>(function, ARITY);
     push(m_frames[m_frame_count], cppLox::Types::Value(nameObj));
-    push(m_frames[m_frame_count], cppLox::Types::Value(nativeFunctionObj));
-    m_memoryMutator->setGlobal(nameObj->as<cppLox::Types::ObjectString>(), nativeFunctionObj);
+    m_memoryMutator->defineGlobal(m_memoryMutator->resolveGlobal(nameObj->as<cppLox::Types::ObjectString>()),
+                                  function);
     pop(m_frames[m_frame_count]);
     pop(m_frames[m_frame_count]);
 }
@@ -344,14 +1243,35 @@ auto VM::defineNative(std::string const & name,
 template <class... Args> auto VM::runTimeError(CallFrame & frame, std::string_view fmt, Args &&... args) -> void {
     std::string errorMessage = std::vformat(fmt, std::make_format_args(args...));
     std::string stackTrace = "";
-    for (auto callFrameIndex : std::views::iota(0u, m_frame_count - 1) | std::views::reverse) {
+    for (auto callFrameIndex : std::views::iota(size_t{0}, m_frame_count) | std::views::reverse) {
         CallFrame const & currentFrame = m_frames[callFrameIndex];
-        size_t const instructionIndex =
-            (currentFrame.m_instruction_pointer - 1) - currentFrame.m_function->chunk()->code().data();
-        stackTrace.append(std::format(
-            "[line {}] in {}\n", currentFrame.m_function->chunk()->getLine(instructionIndex),
-            currentFrame.m_function->name()->string() == "" ? "script" : currentFrame.m_function->name()->string()));
+        cppLox::ByteCode::Chunk * chunk = executedChunk(*currentFrame.m_function);
+        size_t const instructionIndex = (currentFrame.m_instruction_pointer - 1) - chunk->code().data();
+        std::string const & name = currentFrame.m_function->name()->string();
+        // An inlined function is listed like the frame it would have been called in
+        std::optional<cppLox::ByteCode::InlinedCall> const inlinedCall = chunk->inlinedCallAt(instructionIndex);
+        if (inlinedCall.has_value()) {
+            cppLox::Types::ObjectFunction const * inlined = chunk->getConstant(inlinedCall->function)
+                                                                 .as<cppLox::Types::Object *>()
+                                                                 ->as<cppLox::Types::ObjectFunction>();
+            stackTrace.append(
+                std::format("[line {}] in {}\n", chunk->getLine(instructionIndex), inlined->name()->string()));
+            stackTrace.append(std::format("[line {}] in {}\n", inlinedCall->line, name == "" ? "script" : name));
+            continue;
+        }
+        stackTrace.append(
+            std::format("[line {}] in {}\n", chunk->getLine(instructionIndex), name == "" ? "script" : name));
     }
+    m_errorMessage = std::format("{}\n{}", errorMessage, stackTrace);
+    resetStack();
+}
+
+auto VM::recordError(std::string_view message) -> std::nullopt_t {
+    m_errorMessage = message;
     resetStack();
-    throw cppLox::Error::RunTimeException(std::format("{}\n{}", errorMessage, stackTrace));
+    return std::nullopt;
+}
+
+auto VM::throwRecordedError() -> void {
+    throw cppLox::Error::RunTimeException(m_errorMessage);
 }
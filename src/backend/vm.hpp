@@ -22,35 +22,82 @@
 
 #include <array>
 #include <cstdint>
+#include <exception>
 #include <format>
 #include <functional>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "../bytecode/chunk.hpp"
 #include "../memory_mutator.hpp"
 #include "../types/value.hpp"
 #include "callframe.hpp"
+#include "dispatch_profile.hpp"
+#ifdef JIT
+#include "jit_compiler.hpp"
+#endif
+#include "value_stack.hpp"
 
 class VMIntegrationTest;
 
 namespace cppLox::Backend {
 
-/// @brief The maximum amount of call frames that can be stored
-#define FRAME_MAX 64
+/// @brief The default limit for the amount of call frames that can be stored
+#define FRAME_MAX 1024
+
+/// @brief The amount of call frames that are allocated up front
+#define FRAMES_INITIAL 64
+
+/// @brief The amount of stack slots that are reserved for every call frame when the size of the stack is determined
+#define FRAME_SLOTS_MAX (2 * (UINT8_MAX + 1))
 
 /// @brief The maximum amount of values that can be stored on the stack
-#define STACK_MAX (FRAME_MAX * UINT8_MAX)
+#define STACK_MAX (FRAME_MAX * FRAME_SLOTS_MAX)
+
+/// @brief The default amount of calls after which a function is compiled by the jit compiler
+#define JIT_THRESHOLD 1000
+
+/// @brief The amount of call frames up to which functions are executed as native code
+/// @details Every call of native code nests on the native stack, deeper calls are interpreted.
+#define JIT_FRAMES_MAX FRAME_MAX
+
+/// @brief The result of executing a program in the virtual machine
+enum class InterpretResult : uint8_t {
+    /// @brief The program was executed until its end
+    OK,
+    /// @brief The program was aborted by a runtime error, that is recorded in the virtual machine
+    RUNTIME_ERROR
+};
 
 /// @brief The virtual machine used by the cpplox interpreter
-class VM {
+/// @details The interpreter loops never throw a runtime error. An error is recorded in the virtual machine and the
+/// loops return, the call frames are unwound by resetting the frame count. Only interpret throws the recorded error as
+/// a RunTimeException to the embedding code.
+class VM : public cppLox::RootSource {
     friend class ::VMIntegrationTest;
+#ifdef JIT
+    friend class JitRuntime;
+#endif
 
   public:
     /// @brief Constructs a new virtual machine
     /// @param memoryMutator The memory mutator that is used by the virtual machine
-    VM(std::shared_ptr<cppLox::MemoryMutator> memoryMutator);
+    /// @param frameLimit The maximum amount of nested calls
+    VM(std::shared_ptr<cppLox::MemoryMutator> memoryMutator, size_t frameLimit = FRAME_MAX);
 
     /// @brief Destructor of the virtual machine
-    ~VM() = default;
+    ~VM() override;
+
+    /// @brief The virtual machine is registered as a root source by its address, so it can not be copied
+    VM(VM const &) = delete;
+
+    /// @brief The virtual machine is registered as a root source by its address, so it can not be copied
+    auto operator=(VM const &) -> VM & = delete;
+
+    /// @brief Marks the values on the stack and the functions of the call frames as reachable
+    /// @param memoryMutator The memory mutator that collects the garbage
+    auto markRoots(cppLox::MemoryMutator & memoryMutator) -> void override;
 
     /// @brief Gets two bytes from the chunk and returns them as a 16-bit integer
     /// @param chunk The chunk to get the bytes from
@@ -58,10 +105,22 @@ class VM {
     /// @return The 16-bit integer
     [[nodiscard]] auto getShort(CallFrame & frame) -> uint16_t;
 
-    /// @brief Interprets the given chunk
-    /// @param chunk The chunk to interpret
+    /// @brief Interprets the given function
+    /// @details The function is executed using the register bytecode, if it was compiled for the register tier. All
+    /// functions of a program have to be compiled for the same tier.
+    /// @param function The function to interpret
+    /// @throws cppLox::Error::RunTimeException if the program was aborted by a runtime error
     auto interpret(cppLox::Types::ObjectFunction & function) -> void;
 
+    /// @brief Interprets the given function without throwing runtime errors
+    /// @param function The function to interpret
+    /// @return The result of the execution, the message of a runtime error is available through errorMessage
+    [[nodiscard]] auto tryInterpret(cppLox::Types::ObjectFunction & function) -> InterpretResult;
+
+    /// @brief Gets the message of the runtime error, that aborted the last program
+    /// @return The message and the stack trace of the error or an empty string if the program did not fail
+    [[nodiscard]] auto errorMessage() const noexcept -> std::string const &;
+
     /// @brief Peeks at the top value of the stack
     /// @return The top value of the stack
     [[nodiscard]] auto peek(CallFrame & frame) -> cppLox::Types::Value;
@@ -77,51 +136,209 @@ class VM {
     /// @brief Resets the stack
     auto resetStack() noexcept -> void;
 
+    /// @brief Sets the maximum amount of nested calls
+    /// @param frameLimit The maximum amount of nested calls
+    auto setFrameLimit(size_t frameLimit) noexcept -> void;
+
+#ifdef JIT
+    /// @brief Sets the amount of calls after which a function is compiled by the jit compiler
+    /// @param threshold The amount of calls, 0 disables the jit compiler
+    auto setJitThreshold(uint32_t threshold) noexcept -> void;
+#endif
+
+#ifdef PROFILE_DISPATCH
+    /// @brief Gets the profile of the opcodes that were dispatched by the stack tier of the virtual machine
+    /// @return The dispatch profile
+    [[nodiscard]] auto dispatchProfile() const noexcept -> DispatchProfile const & {
+        return m_dispatchProfile;
+    }
+#endif
+
   private:
-    /// @brief Throws a runtime exception with the given message
+    /// @brief Records a runtime error with the given message and the stack trace of the call frames
+    /// @details The stack is reset, the caller has to leave the interpreter loop.
     /// @tparam ...Args The types of the arguments
     /// @param fmt The format string
     /// @param ...args The arguments to the format string
     template <class... Args> auto runTimeError(CallFrame & frame, std::string_view fmt, Args &&... args) -> void;
 
+    /// @brief Records a runtime error with the given message, that is reported without a stack trace
+    /// @param message The message of the error
+    /// @return An empty optional, that is returned by the failed operation
+    auto recordError(std::string_view message) -> std::nullopt_t;
+
+    /// @brief Throws the recorded runtime error as a RunTimeException
+    [[noreturn]] auto throwRecordedError() -> void;
+
     /// @brief Calls the given function with the given argument count
     /// @param value The value to call
     /// @param arg_count The amount of arguments to pass to the function
     /// @param frame The call frame
-    auto callFunction(cppLox::Types::Value & value, uint8_t arg_count, CallFrame & frame) -> void;
+    /// @return false if the call failed with a runtime error
+    [[nodiscard]] auto callFunction(cppLox::Types::Value & value, uint8_t arg_count, CallFrame & frame) -> bool;
 
-    /// @brief Calls the given function with the given argument count
+    /// @brief Pushes a new call frame for the given function, that is executed by the next dispatch of the vm
+    /// @param function The function to call
+    /// @param arg_count The amount of arguments to pass to the function
+    /// @return false if the call failed with a runtime error
+    [[nodiscard]] auto call(cppLox::Types::ObjectFunction & function, uint8_t arg_count) -> bool;
+
+    /// @brief Calls the given lox function in tail position by reusing the given call frame
     /// @param function The function to call
     /// @param arg_count The amount of arguments to pass to the function
-    auto call(cppLox::Types::ObjectFunction & function, uint8_t arg_count) -> void;
+    /// @param frame The call frame of the returning function, that is reused by the callee
+    /// @return false if the call failed with a runtime error
+    [[nodiscard]] auto tailCall(cppLox::Types::ObjectFunction & function, uint8_t arg_count, CallFrame & frame)
+        -> bool;
+
+    /// @brief Defines the global variable in the given slot
+    /// @param slot The slot of the global variable
+    /// @param value The value of the variable
+    /// @return false if the variable was already defined
+    [[nodiscard]] auto defineGlobal(uint16_t slot, cppLox::Types::Value value) -> bool;
+
+    /// @brief Assigns the given value to the global variable in the given slot
+    /// @param frame The call frame
+    /// @param slot The slot of the global variable
+    /// @param value The value to assign
+    /// @return false if the variable is not defined
+    [[nodiscard]] auto setGlobal(CallFrame & frame, uint16_t slot, cppLox::Types::Value value) -> bool;
+
+    /// @brief Executes the call frames until the outermost call frame returns
+    /// @return The result of the execution
+    [[nodiscard]] auto run() -> InterpretResult;
+
+#ifdef JIT
+    /// @brief The outcome of executing a function as native code
+    enum class NativeExecution : uint8_t {
+        /// @brief The function was executed and returned
+        RETURNED,
+        /// @brief The function is not compiled and has to be interpreted
+        INTERPRET,
+        /// @brief The function was aborted by a runtime error
+        RUNTIME_ERROR
+    };
+
+    /// @brief Executes the function of the top call frame as native code, if it was compiled by the jit compiler
+    /// @details The function is compiled, when it was called as often as the threshold of the jit compiler determines.
+    /// @return The outcome of the execution
+    [[nodiscard]] auto runCompiled() -> NativeExecution;
 
-    /// @brief Runs the given function
-    /// @param function The function to run
-    auto run(cppLox::Types::ObjectFunction & function) -> void;
+    /// @brief Executes the function of the top call frame until it returned to the given amount of call frames
+    /// @param frameCount The amount of call frames after the function returned
+    /// @return The result of the execution
+    [[nodiscard]] auto runNested(size_t frameCount) -> InterpretResult;
+#endif
+
+    /// @brief Executes the call frames using the register bytecode of the functions until the outermost call frame
+    /// returns
+    /// @return The result of the execution
+    [[nodiscard]] auto runRegisters() -> InterpretResult;
+
+    // The operators of the instructions, that can fail. Each operator records a runtime error and returns an empty
+    // optional, if it is not defined for its operands.
+
+    /// @brief Adds two numbers or concatenates two strings
+    [[nodiscard]] auto add(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Subtracts two numbers
+    [[nodiscard]] auto subtract(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Multiplies two numbers
+    [[nodiscard]] auto multiply(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Divides two numbers
+    [[nodiscard]] auto divide(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Determines whether the left number is greater than the right number
+    [[nodiscard]] auto greater(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Determines whether the left number is greater than or equal to the right number
+    [[nodiscard]] auto greaterEqual(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Determines whether the left number is less than the right number
+    [[nodiscard]] auto less(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Determines whether the left number is less than or equal to the right number
+    [[nodiscard]] auto lessEqual(cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+        -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Negates a number
+    [[nodiscard]] auto negate(cppLox::Types::Value const & operand) -> std::optional<cppLox::Types::Value>;
 
     /// @brief Defines a native function with the given name and function
     /// @tparam ARITY The arity of the function
     /// @param name The name of the function
     /// @param function The function that is wrapped in the native function object
     template <int16_t ARITY>
+    auto defineNative(std::string const & name, cppLox::Types::NativeFunction function) -> void;
+
+    /// @brief Defines a native function with the given name and function, that reports errors through a callback
+    /// @details Calls of the function are slower than calls of a NativeFunction
+    /// @tparam ARITY The arity of the function
+    /// @param name The name of the function
+    /// @param function The function that is wrapped in the native function object
+    template <int16_t ARITY>
     auto defineNative(std::string const & name,
                       std::function<cppLox::Types::Value(int, cppLox::Types::Value *, CallFrame &,
                                                          std::function<void(CallFrame &, std::string_view fmt)>)>
                           function) -> void;
 
-    /// @brief The stack
-    cppLox::Types::Value m_stack[STACK_MAX];
+    /// @brief Stores the given native function object in the global variable with the given name
+    /// @param name The name of the function
+    /// @param function The native function object
+    auto defineNative(std::string const & name, cppLox::Types::Object * function) -> void;
+
+    /// @brief The stack, that is committed lazily as it grows
+    ValueStack m_stack;
 
     /// @brief The index of the top of the stack
     size_t m_stack_top;
 
+    /// @brief The slots below this index hold no freed objects, even above the top of the stack, and are marked as
+    /// roots of the garbage collector
+    size_t m_rootTop;
+
     /// @brief The memory manager.
     std::shared_ptr<cppLox::MemoryMutator> m_memoryMutator;
 
-    /// @brief The call frames
-    std::array<CallFrame, FRAME_MAX> m_frames;
+    /// @brief The call frames, grown on demand up to the frame limit
+    std::vector<CallFrame> m_frames;
 
     /// @brief The count of the current call frame
     size_t m_frame_count;
+
+    /// @brief The maximum amount of nested calls
+    size_t m_frame_limit;
+
+    /// @brief The message of the runtime error, that aborted the last program, or an empty string
+    std::string m_errorMessage;
+
+#ifdef JIT
+    /// @brief The jit compiler, that compiles the hot functions
+    JitCompiler m_jitCompiler;
+
+    /// @brief The amount of calls after which a function is compiled by the jit compiler
+    uint32_t m_jitThreshold;
+
+    /// @brief An exception, that is not a runtime error and occurred in native code, it is rethrown once the native
+    /// code returned
+    std::exception_ptr m_jitException;
+
+    /// @brief The amount of call frames at which the interpreter returns to the native code, that called it
+    size_t m_exitFrameCount;
+#endif
+
+#ifdef PROFILE_DISPATCH
+    /// @brief The profile of the dispatched opcodes
+    DispatchProfile m_dispatchProfile;
+#endif
 };
 } // namespace cppLox::Backend
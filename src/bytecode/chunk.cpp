@@ -20,9 +20,12 @@
 
 #include "chunk.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <format>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 
 #include "../types/value_formatter.hpp"
 #include "opcode_formatter.hpp"
@@ -30,19 +33,58 @@
 using namespace cppLox::ByteCode;
 
 auto Chunk::write(uint8_t byte, int line) -> void {
+    // A new run only starts, when the line changes
+    if (m_lines.empty() || m_lines.back().line != line) {
+        m_lines.push_back(LineRun{static_cast<uint32_t>(m_code.size()), line});
+    }
     m_code.push_back(byte);
-    m_lines.push_back(line);
 }
 
 auto Chunk::write(Opcode byte, int line) -> void {
-    m_code.push_back(static_cast<uint8_t>(byte));
-    m_lines.push_back(line);
+    write(static_cast<uint8_t>(byte), line);
+}
+
+auto Chunk::write(std::span<uint8_t const> bytes, int line) -> void {
+    if (bytes.empty()) {
+        return;
+    }
+    if (m_lines.empty() || m_lines.back().line != line) {
+        m_lines.push_back(LineRun{static_cast<uint32_t>(m_code.size()), line});
+    }
+    m_code.insert(m_code.end(), bytes.begin(), bytes.end());
 }
 
 auto Chunk::writeAt(size_t offset, uint8_t byte) -> void {
     m_code[offset] = byte;
 }
 
+auto Chunk::truncate(size_t size) -> void {
+    m_code.resize(size);
+    std::erase_if(m_lines, [size](LineRun const & run) { return run.start >= size; });
+    std::erase_if(m_inlinedCalls, [size](InlinedCall const & call) { return call.start >= size; });
+}
+
+auto Chunk::addInlinedCall(InlinedCall const & call) -> void {
+    m_inlinedCalls.push_back(call);
+}
+
+[[nodiscard]] auto Chunk::inlinedCallAt(size_t offset) const -> std::optional<InlinedCall> {
+    for (InlinedCall const & call : m_inlinedCalls) {
+        if (offset >= call.start && offset < call.end) {
+            return call;
+        }
+    }
+    return std::nullopt;
+}
+
+[[nodiscard]] auto Chunk::getInlinedCall(size_t index) const -> InlinedCall const & {
+    return m_inlinedCalls[index];
+}
+
+[[nodiscard]] auto Chunk::getInlinedCallCount() const -> size_t {
+    return m_inlinedCalls.size();
+}
+
 auto Chunk::disassemble(std::string_view const & name) const -> void {
     std::cout << std::format("== {} ==", name) << std::endl;
 
@@ -54,36 +96,62 @@ auto Chunk::disassemble(std::string_view const & name) const -> void {
 auto Chunk::disassembleInstruction(size_t offset) const -> size_t {
     std::cout << std::format("{:#06X} ", offset);
 
-    if (offset > 0 && m_lines[offset] == m_lines[offset - 1]) {
+    if (offset > 0 && getLine(offset) == getLine(offset - 1)) {
         std::cout << "   | ";
     } else {
-        std::cout << std::format(" {:<4}", m_lines[offset]);
+        std::cout << std::format(" {:<4}", getLine(offset));
     }
 
     uint8_t instruction = m_code[offset];
     switch (static_cast<Opcode>(instruction)) {
     case Opcode::ADD:
         return simpleInstruction(instruction, offset);
+    case Opcode::ADD_NUM_NUM:
+        return simpleInstruction(instruction, offset);
     case Opcode::CALL:
         return byteInstruction(instruction, offset);
+    case Opcode::CALL_INLINED:
+        return inlinedCallInstruction(instruction, offset);
     case Opcode::CONSTANT:
         return constantInstruction(instruction, offset);
+    case Opcode::CONSTANT_LONG:
+        return constantLongInstruction(instruction, offset);
     case Opcode::DEFINE_GLOBAL:
-        return constantInstruction(instruction, offset);
+        return globalInstruction(instruction, offset);
     case Opcode::DIVIDE:
         return simpleInstruction(instruction, offset);
+    case Opcode::DIVIDE_NUM_NUM:
+        return simpleInstruction(instruction, offset);
     case Opcode::EQUAL:
         return simpleInstruction(instruction, offset);
+    case Opcode::EQUAL_JUMP_IF_FALSE:
+        return jumpInstruction(instruction, 1, offset);
     case Opcode::FALSE:
         return simpleInstruction(instruction, offset);
     case Opcode::GET_GLOBAL:
-        return constantInstruction(instruction, offset);
+        return globalInstruction(instruction, offset);
     case Opcode::GET_LOCAL:
         return byteInstruction(instruction, offset);
+    case Opcode::GET_LOCAL_CONSTANT:
+        return byteConstantInstruction(instruction, offset);
+    case Opcode::GET_LOCAL_GET_LOCAL:
+        return twoByteInstruction(instruction, offset);
     case Opcode::GREATER:
         return simpleInstruction(instruction, offset);
     case Opcode::GREATER_EQUAL:
         return simpleInstruction(instruction, offset);
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+        return jumpInstruction(instruction, 1, offset);
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+        return jumpInstruction(instruction, 1, offset);
+    case Opcode::GREATER_EQUAL_NUM_NUM:
+        return simpleInstruction(instruction, offset);
+    case Opcode::GREATER_JUMP_IF_FALSE:
+        return jumpInstruction(instruction, 1, offset);
+    case Opcode::GREATER_JUMP_IF_FALSE_NUM_NUM:
+        return jumpInstruction(instruction, 1, offset);
+    case Opcode::GREATER_NUM_NUM:
+        return simpleInstruction(instruction, offset);
     case Opcode::JUMP:
         return jumpInstruction(instruction, 1, offset);
     case Opcode::JUMP_IF_FALSE:
@@ -92,30 +160,58 @@ auto Chunk::disassembleInstruction(size_t offset) const -> size_t {
         return simpleInstruction(instruction, offset);
     case Opcode::LESS_EQUAL:
         return simpleInstruction(instruction, offset);
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+        return jumpInstruction(instruction, 1, offset);
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+        return jumpInstruction(instruction, 1, offset);
+    case Opcode::LESS_EQUAL_NUM_NUM:
+        return simpleInstruction(instruction, offset);
+    case Opcode::LESS_JUMP_IF_FALSE:
+        return jumpInstruction(instruction, 1, offset);
+    case Opcode::LESS_JUMP_IF_FALSE_NUM_NUM:
+        return jumpInstruction(instruction, 1, offset);
+    case Opcode::LESS_NUM_NUM:
+        return simpleInstruction(instruction, offset);
     case Opcode::LOOP:
         return jumpInstruction(instruction, -1, offset);
     case Opcode::MULTIPLY:
         return simpleInstruction(instruction, offset);
+    case Opcode::MULTIPLY_NUM_NUM:
+        return simpleInstruction(instruction, offset);
     case Opcode::NEGATE:
         return simpleInstruction(instruction, offset);
     case Opcode::NOT_EQUAL:
         return simpleInstruction(instruction, offset);
+    case Opcode::NOT_EQUAL_JUMP_IF_FALSE:
+        return jumpInstruction(instruction, 1, offset);
     case Opcode::NULL_:
         return simpleInstruction(instruction, offset);
     case Opcode::NOT:
         return simpleInstruction(instruction, offset);
     case Opcode::POP:
         return simpleInstruction(instruction, offset);
+    case Opcode::POP_JUMP_IF_FALSE:
+        return jumpInstruction(instruction, 1, offset);
+    case Opcode::POP_JUMP_IF_TRUE:
+        return jumpInstruction(instruction, 1, offset);
     case Opcode::PRINT:
         return simpleInstruction(instruction, offset);
     case Opcode::RETURN:
         return simpleInstruction(instruction, offset);
+    case Opcode::RETURN_INLINED:
+        return byteInstruction(instruction, offset);
     case Opcode::SET_GLOBAL:
-        return constantInstruction(instruction, offset);
+        return globalInstruction(instruction, offset);
     case Opcode::SET_LOCAL:
         return byteInstruction(instruction, offset);
+    case Opcode::SET_LOCAL_POP:
+        return byteInstruction(instruction, offset);
     case Opcode::SUBTRACT:
         return simpleInstruction(instruction, offset);
+    case Opcode::SUBTRACT_NUM_NUM:
+        return simpleInstruction(instruction, offset);
+    case Opcode::TAIL_CALL:
+        return byteInstruction(instruction, offset);
     case Opcode::TRUE:
         return simpleInstruction(instruction, offset);
     default:
@@ -130,8 +226,43 @@ auto Chunk::simpleInstruction(uint8_t opcode, size_t offset) const -> size_t {
 }
 
 auto Chunk::addConstant(cppLox::Types::Value const & value) -> size_t {
-    m_constants.push_back(value);
-    return m_constants.size() - 1;
+    auto const [constant, added] = m_constantIndices.try_emplace(constantKey(value), m_constants.size());
+    if (added) {
+        m_constants.push_back(value);
+    }
+    return constant->second;
+}
+
+[[nodiscard]] auto Chunk::findConstant(cppLox::Types::Value const & value) const -> std::optional<size_t> {
+    auto const constant = m_constantIndices.find(constantKey(value));
+    if (constant == m_constantIndices.end()) {
+        return std::nullopt;
+    }
+    return constant->second;
+}
+
+auto Chunk::popConstant() -> void {
+    m_constantIndices.erase(constantKey(m_constants.back()));
+    m_constants.pop_back();
+}
+
+auto Chunk::constantKey(cppLox::Types::Value const & value) -> ConstantKey {
+    // Numbers are identified by their bits, since 0 and -0 are equal but print differently and NaN equals nothing
+    switch (value.getType()) {
+    case cppLox::Types::Value::Type::BOOL:
+        return ConstantKey{value.getType(), value.as<bool>() ? 1u : 0u};
+    case cppLox::Types::Value::Type::NUMBER:
+        return ConstantKey{value.getType(), std::bit_cast<uint64_t>(value.as<double>())};
+    case cppLox::Types::Value::Type::OBJECT:
+        // Strings are interned, so equal strings are the same object
+        return ConstantKey{value.getType(), reinterpret_cast<uintptr_t>(value.as<cppLox::Types::Object *>())};
+    default:
+        return ConstantKey{value.getType(), 0};
+    }
+}
+
+auto Chunk::ConstantKeyHash::operator()(ConstantKey const & key) const -> size_t {
+    return std::hash<uint64_t>{}(key.payload) ^ static_cast<size_t>(key.type);
 }
 
 auto Chunk::byteInstruction(uint8_t opcode, size_t offset) const -> size_t {
@@ -140,6 +271,35 @@ auto Chunk::byteInstruction(uint8_t opcode, size_t offset) const -> size_t {
     return offset + 2;
 }
 
+auto Chunk::globalInstruction(uint8_t opcode, size_t offset) const -> size_t {
+    uint16_t slot = static_cast<uint16_t>(m_code[offset + 1] << 8 | m_code[offset + 2]);
+    std::cout << std::format("{:>16}{:>16}", static_cast<Opcode>(opcode), unsigned(slot)) << std::endl;
+    return offset + 3;
+}
+
+auto Chunk::twoByteInstruction(uint8_t opcode, size_t offset) const -> size_t {
+    std::cout << std::format("{:>16}{:>16}{:>16}", static_cast<Opcode>(opcode), unsigned(m_code[offset + 1]),
+                             unsigned(m_code[offset + 2]))
+              << std::endl;
+    return offset + 3;
+}
+
+auto Chunk::byteConstantInstruction(uint8_t opcode, size_t offset) const -> size_t {
+    uint8_t constant = m_code[offset + 2];
+    std::cout << std::format("{:>16}{:>16}{:>16} '{}'", static_cast<Opcode>(opcode), unsigned(m_code[offset + 1]),
+                             unsigned(constant), m_constants[constant])
+              << std::endl;
+    return offset + 3;
+}
+
+auto Chunk::constantLongInstruction(uint8_t opcode, size_t offset) const -> size_t {
+    uint16_t const constant = static_cast<uint16_t>(m_code[offset + 1] << 8 | m_code[offset + 2]);
+    std::cout << std::format("{:>16}{:>16} '{}'", static_cast<Opcode>(opcode), unsigned(constant),
+                             m_constants[constant])
+              << std::endl;
+    return offset + 3;
+}
+
 auto Chunk::constantInstruction(uint8_t opcode, size_t offset) const -> size_t {
     uint8_t constant = m_code[offset + 1];
     std::cout << std::format("{:>16}{:>16} '{}'", static_cast<Opcode>(opcode), unsigned(constant),
@@ -153,13 +313,28 @@ auto Chunk::getByte(size_t offset) const -> uint8_t {
 }
 
 auto Chunk::getLine(size_t offset) const -> size_t {
-    return m_lines[offset];
+    // The line of an offset is stored in the last run, that starts at or before it
+    auto const run = std::upper_bound(m_lines.begin(), m_lines.end(), offset,
+                                      [](size_t value, LineRun const & lineRun) { return value < lineRun.start; });
+    return static_cast<size_t>(std::prev(run)->line);
+}
+
+auto Chunk::getLineRunCount() const -> size_t {
+    return m_lines.size();
+}
+
+auto Chunk::getLineRun(size_t index) const -> LineRun const & {
+    return m_lines[index];
 }
 
 auto Chunk::getConstant(size_t offset) -> cppLox::Types::Value & {
     return m_constants[offset];
 }
 
+auto Chunk::getConstantCount() const -> size_t {
+    return m_constants.size();
+}
+
 auto Chunk::getSize() const -> size_t {
     return m_code.size();
 }
@@ -175,3 +350,12 @@ auto Chunk::jumpInstruction(uint8_t opcode, int sign, int offset) const -> size_
               << std::endl;
     return offset + 3;
 }
+
+auto Chunk::inlinedCallInstruction(uint8_t opcode, size_t offset) const -> size_t {
+    uint16_t const constant = static_cast<uint16_t>(m_code[offset + 2] << 8 | m_code[offset + 3]);
+    uint16_t const jump = static_cast<uint16_t>(m_code[offset + 4] << 8 | m_code[offset + 5]);
+    std::cout << std::format("{:>16}{:>16}{:>16} '{}' -> {}", static_cast<Opcode>(opcode), unsigned(m_code[offset + 1]),
+                             unsigned(constant), m_constants[constant], offset + 6 + jump)
+              << std::endl;
+    return offset + 6;
+}
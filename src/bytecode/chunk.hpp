@@ -21,7 +21,10 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
+#include <span>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "../types/value.hpp"
@@ -29,6 +32,30 @@
 
 namespace cppLox::ByteCode {
 
+/// @brief The body of a function, that was inlined into a chunk at a call.
+struct InlinedCall {
+    /// @brief The offset of the first instruction of the body.
+    size_t start;
+
+    /// @brief The offset after the last instruction of the body, that can report a runtime error.
+    size_t end;
+
+    /// @brief The index of the constant holding the inlined function.
+    size_t function;
+
+    /// @brief The line of the call, that was inlined.
+    int line;
+};
+
+/// @brief A run of bytes of a chunk, that originate from the same line.
+struct LineRun {
+    /// @brief The offset of the first byte of the run.
+    uint32_t start;
+
+    /// @brief The line number of the bytes of the run.
+    int line;
+};
+
 /// @brief A chunk of bytecode.
 class Chunk {
   public:
@@ -48,35 +75,85 @@ class Chunk {
     /// @param line The line number where the opcode originates from the source code.
     auto write(Opcode byte, int line) -> void;
 
+    /// @brief Writes bytes, that originate from the same line, to the chunk.
+    /// @param bytes The bytes to write.
+    /// @param line The line number where the bytes originate from the source code.
+    auto write(std::span<uint8_t const> bytes, int line) -> void;
+
     /// @brief Writes a byte to the chunk.
     /// @param offset The offset to write the byte at.
     /// @param byte The byte to write.
     auto writeAt(size_t offset, uint8_t byte) -> void;
 
+    /// @brief Removes the bytes from the given offset to the end of the chunk.
+    /// @param size The size of the chunk after the bytes were removed.
+    auto truncate(size_t size) -> void;
+
+    /// @brief Records the body of a function, that was inlined into the chunk.
+    /// @param call The inlined call.
+    auto addInlinedCall(InlinedCall const & call) -> void;
+
+    /// @brief Gets the inlined call, whose body contains the instruction at the given offset.
+    /// @param offset The offset of the instruction.
+    /// @return The inlined call or an empty optional if the instruction was not inlined.
+    [[nodiscard]] auto inlinedCallAt(size_t offset) const -> std::optional<InlinedCall>;
+
+    /// @brief Gets the inlined call at the given index.
+    /// @param index The index of the inlined call.
+    /// @return The inlined call at the given index.
+    [[nodiscard]] auto getInlinedCall(size_t index) const -> InlinedCall const &;
+
+    /// @brief Gets the amount of inlined calls recorded in the chunk.
+    /// @return The amount of inlined calls recorded in the chunk.
+    [[nodiscard]] auto getInlinedCallCount() const -> size_t;
+
     /// @brief Disassembles the chunk.
     /// @param name The name of the chunk.
     auto disassemble(std::string_view const & name) const -> void;
 
-    /// @brief Adds a constant to the chunk.
+    /// @brief Adds a constant to the chunk, unless the chunk already contains the same constant.
     /// @param value The value to add.
-    /// @return The index of the added constant.
+    /// @return The index of the added constant or of the constant, that was added before.
     [[nodiscard]] auto addConstant(cppLox::Types::Value const & value) -> size_t;
 
+    /// @brief Finds the given constant in the chunk.
+    /// @param value The value to find.
+    /// @return The index of the constant or an empty optional if the chunk does not contain the constant.
+    [[nodiscard]] auto findConstant(cppLox::Types::Value const & value) const -> std::optional<size_t>;
+
+    /// @brief Removes the constant, that was added last, from the chunk.
+    auto popConstant() -> void;
+
     /// @brief Gets the byte at the given index.
     /// @param index The index of the byte.
     /// @return The byte at the given index.
     [[nodiscard]] auto getByte(size_t index) const -> uint8_t;
 
     /// @brief Gets the line number of the given index.
+    /// @details The lines are stored as runs of bytes, that originate from the same line, so the run of the index is
+    /// searched.
     /// @param index The index of the opcode.
     /// @return The line number of the opcode at the given index.
     [[nodiscard]] auto getLine(size_t index) const -> size_t;
 
+    /// @brief Gets the amount of runs of bytes, that originate from the same line, in the line table of the chunk.
+    /// @return The amount of runs in the line table.
+    [[nodiscard]] auto getLineRunCount() const -> size_t;
+
+    /// @brief Gets the run of bytes, that originate from the same line, at the given index of the line table.
+    /// @param index The index of the run.
+    /// @return The run at the given index.
+    [[nodiscard]] auto getLineRun(size_t index) const -> LineRun const &;
+
     /// @brief Gets the constant at the given index.
     /// @param index The index of the constant.
     /// @return The constant at the given index.
     [[nodiscard]] auto getConstant(size_t index) -> cppLox::Types::Value &;
 
+    /// @brief Gets the amount of constants stored in the chunk.
+    /// @return The amount of constants stored in the chunk.
+    [[nodiscard]] auto getConstantCount() const -> size_t;
+
     /// @brief Gets the size of the chunk.
     /// @return The size of the chunk.
     [[nodiscard]] auto getSize() const -> size_t;
@@ -91,6 +168,27 @@ class Chunk {
     [[nodiscard]] auto code() -> std::vector<uint8_t> &;
 
   private:
+    /// @brief The identity of a constant, that is used to find a constant, that was added before.
+    struct ConstantKey {
+        /// @brief The type of the constant.
+        cppLox::Types::Value::Type type;
+
+        /// @brief The bits of the number, the boolean or the address of the object.
+        uint64_t payload;
+
+        auto operator==(ConstantKey const & other) const -> bool = default;
+    };
+
+    /// @brief Hashes the identity of a constant.
+    struct ConstantKeyHash {
+        auto operator()(ConstantKey const & key) const -> size_t;
+    };
+
+    /// @brief Gets the identity of the given constant.
+    /// @param value The constant.
+    /// @return The identity of the constant.
+    [[nodiscard]] static auto constantKey(cppLox::Types::Value const & value) -> ConstantKey;
+
     /// @brief Disassembles a simple instruction.
     /// @param opcode The opcode of the instruction.
     /// @param index The index of the instruction.
@@ -101,12 +199,36 @@ class Chunk {
     /// @param index The index of the instruction.
     [[nodiscard]] auto constantInstruction(uint8_t opcode, size_t index) const -> size_t;
 
+    /// @brief Disassembles a constant instruction with a two byte constant index.
+    /// @param opcode The opcode of the instruction.
+    /// @param offset The offset of the instruction.
+    /// @return The index of the next instruction.
+    [[nodiscard]] auto constantLongInstruction(uint8_t opcode, size_t offset) const -> size_t;
+
+    /// @brief Disassembles an instruction that accesses a global variable.
+    /// @param opcode The opcode of the instruction.
+    /// @param offset The offset of the instruction.
+    /// @return The index of the next instruction.
+    [[nodiscard]] auto globalInstruction(uint8_t opcode, size_t offset) const -> size_t;
+
     /// @brief Disassembles a byte instruction.
     /// @param opcode The opcode of the instruction.
     /// @param offset The offset of the instruction.
     /// @return The index of the next instruction.
     [[nodiscard]] auto byteInstruction(uint8_t opcode, size_t offset) const -> size_t;
 
+    /// @brief Disassembles an instruction with two byte operands.
+    /// @param opcode The opcode of the instruction.
+    /// @param offset The offset of the instruction.
+    /// @return The index of the next instruction.
+    [[nodiscard]] auto twoByteInstruction(uint8_t opcode, size_t offset) const -> size_t;
+
+    /// @brief Disassembles an instruction with a byte operand followed by a constant operand.
+    /// @param opcode The opcode of the instruction.
+    /// @param offset The offset of the instruction.
+    /// @return The index of the next instruction.
+    [[nodiscard]] auto byteConstantInstruction(uint8_t opcode, size_t offset) const -> size_t;
+
     /// @brief Disassembles a jump instruction.
     /// @param opcode The opcode of the instruction.
     /// @param sign Whether the jump is forward or backward.
@@ -114,13 +236,26 @@ class Chunk {
     /// @return The index of the next instruction.
     [[nodiscard]] auto jumpInstruction(uint8_t opcode, int sign, int offset) const -> size_t;
 
+    /// @brief Disassembles a call, whose callee was inlined.
+    /// @param opcode The opcode of the instruction.
+    /// @param offset The offset of the instruction.
+    /// @return The index of the next instruction.
+    [[nodiscard]] auto inlinedCallInstruction(uint8_t opcode, size_t offset) const -> size_t;
+
     /// @brief The bytecode stored in the chunk.
     std::vector<uint8_t> m_code;
 
-    /// @brief The line numbers of the opcodes, stored in the chunk.
-    std::vector<int> m_lines;
+    /// @brief The line numbers of the bytes, stored in the chunk as runs of bytes that originate from the same line,
+    /// ordered by their start.
+    std::vector<LineRun> m_lines;
 
     /// @brief The value constants stored in the chunk.
     std::vector<cppLox::Types::Value> m_constants;
+
+    /// @brief The index of every constant stored in the chunk, so every constant is only stored once.
+    std::unordered_map<ConstantKey, size_t, ConstantKeyHash> m_constantIndices;
+
+    /// @brief The functions, that were inlined into the chunk, ordered by their offset.
+    std::vector<InlinedCall> m_inlinedCalls;
 };
 } // namespace cppLox::ByteCode
\ No newline at end of file
@@ -0,0 +1,89 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+
+/**
+ * @file image.hpp
+ * @brief This file contains the constants of the binary format of compiled programs.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace cppLox::ByteCode {
+
+/// @brief The magic number at the start of every image.
+constexpr std::array<uint8_t, 4> IMAGE_MAGIC = {'L', 'O', 'X', 'C'};
+
+/// @brief The version of the image format.
+/// @details The opcodes are stored by their value, so the version has to be raised whenever the layout of the image or
+/// the instruction set changes.
+constexpr uint16_t IMAGE_VERSION = 1;
+
+/// @brief The size of the header of an image in bytes.
+constexpr size_t IMAGE_HEADER_SIZE = 32;
+
+/// @brief The file extension of images.
+constexpr std::string_view IMAGE_EXTENSION = ".loxc";
+
+/// @brief Flag of an image, whose functions were optimized in ssa form and inlined.
+constexpr uint16_t IMAGE_FLAG_OPTIMIZED = 1;
+
+/// @brief Flag of an image, whose functions are executed on the register tier.
+constexpr uint16_t IMAGE_FLAG_REGISTER_TIER = 2;
+
+/// @brief The index, that marks a function without a name.
+constexpr uint32_t IMAGE_NO_STRING = UINT32_MAX;
+
+/// @brief The kind of a constant stored in an image.
+enum class ImageConstant : uint8_t {
+    /// @brief The null value.
+    NULL_,
+    /// @brief The false value.
+    FALSE,
+    /// @brief The true value.
+    TRUE,
+    /// @brief A number, followed by its eight bytes.
+    NUMBER,
+    /// @brief A string, followed by its index in the string table.
+    STRING,
+    /// @brief A function, followed by its index in the function table.
+    FUNCTION
+};
+
+/// @brief Hashes the source code of a program and the flags it is compiled with.
+/// @details The 64 bit FNV-1a hash keys the images in the cache directory and is stored in their header.
+/// @param source The source code of the program.
+/// @param flags The flags of the image.
+/// @return The hash of the source code and the flags.
+[[nodiscard]] constexpr auto image_hash(std::string_view source, uint16_t flags) -> uint64_t {
+    uint64_t hash = 14695981039346656037ULL;
+    auto const combine = [&hash](uint8_t byte) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    };
+    for (char const character : source) {
+        combine(static_cast<uint8_t>(character));
+    }
+    combine(static_cast<uint8_t>(flags));
+    combine(static_cast<uint8_t>(flags >> 8));
+    return hash;
+}
+
+} // namespace cppLox::ByteCode
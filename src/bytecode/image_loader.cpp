@@ -0,0 +1,489 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+
+/**
+ * @file image_loader.cpp
+ * @brief This file contains the implementation of the ImageLoader class.
+ */
+
+#include "image_loader.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "image.hpp"
+#include "opcode.hpp"
+
+using namespace cppLox::ByteCode;
+
+/// @brief Maps the given file into memory, so it can only be read
+/// @param path The path of the file
+/// @return The mapped bytes of the file or an empty optional if the file can not be mapped
+static auto mapFile(std::filesystem::path const & path) -> std::optional<std::span<uint8_t const>> {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return std::nullopt;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return std::nullopt;
+    }
+    void * memory = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (memory == nullptr) {
+        return std::nullopt;
+    }
+    return std::span<uint8_t const>(static_cast<uint8_t const *>(memory), static_cast<size_t>(size.QuadPart));
+#else
+    int const file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return std::nullopt;
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0) {
+        close(file);
+        return std::nullopt;
+    }
+    // The mapping stays valid, when the cache replaces the file
+    void * memory = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (memory == MAP_FAILED) {
+        return std::nullopt;
+    }
+    return std::span<uint8_t const>(static_cast<uint8_t const *>(memory), static_cast<size_t>(status.st_size));
+#endif
+}
+
+/// @brief Determines whether an instruction is a jump
+/// @param opcode The opcode of the instruction
+/// @return true if the instruction has a jump offset as its operand, false otherwise
+static auto isJump(Opcode opcode) -> bool {
+    switch (opcode) {
+    case Opcode::EQUAL_JUMP_IF_FALSE:
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::GREATER_JUMP_IF_FALSE:
+    case Opcode::GREATER_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::JUMP:
+    case Opcode::JUMP_IF_FALSE:
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::LESS_JUMP_IF_FALSE:
+    case Opcode::LESS_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::LOOP:
+    case Opcode::NOT_EQUAL_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_TRUE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @brief Determines whether a value is a function
+/// @param value The value
+/// @return true if the value is a lox function, false otherwise
+static auto isFunction(cppLox::Types::Value const & value) -> bool {
+    return value.is(cppLox::Types::Value::Type::OBJECT) &&
+           value.as<cppLox::Types::Object *>()->is(cppLox::Types::Object::Type::FUNCTION);
+}
+
+/// @brief Unmaps the bytes of a file, that were mapped into memory
+/// @param bytes The mapped bytes of the file
+static auto unmapFile(std::span<uint8_t const> bytes) -> void {
+#ifdef _WIN32
+    UnmapViewOfFile(bytes.data());
+#else
+    munmap(const_cast<uint8_t *>(bytes.data()), bytes.size());
+#endif
+}
+
+ImageLoader::ImageLoader(std::shared_ptr<cppLox::MemoryMutator> memoryMutator)
+    : m_memoryMutator(memoryMutator), m_flags(0) {
+    m_memoryMutator->addRootSource(this);
+}
+
+ImageLoader::~ImageLoader() {
+    m_memoryMutator->removeRootSource(this);
+}
+
+auto ImageLoader::loadFile(std::filesystem::path const & path, std::optional<uint64_t> hash)
+    -> std::optional<cppLox::Types::ObjectFunction *> {
+    std::optional<std::span<uint8_t const>> const image = mapFile(path);
+    if (!image.has_value()) {
+        return std::nullopt;
+    }
+    std::optional<cppLox::Types::ObjectFunction *> const script = load(*image, hash);
+    unmapFile(*image);
+    return script;
+}
+
+auto ImageLoader::load(std::span<uint8_t const> image, std::optional<uint64_t> hash)
+    -> std::optional<cppLox::Types::ObjectFunction *> {
+    m_strings.clear();
+    m_functions.clear();
+    m_globals.clear();
+    Reader reader(image);
+    std::span<uint8_t const> const magic = reader.bytes(IMAGE_MAGIC.size());
+    if (reader.failed() || !std::equal(magic.begin(), magic.end(), IMAGE_MAGIC.begin())) {
+        return std::nullopt;
+    }
+    uint64_t const version = reader.read(2);
+    uint64_t const flags = reader.read(2);
+    uint64_t const sourceHash = reader.read(8);
+    uint64_t const opcodeCount = reader.read(4);
+    uint64_t const stringCount = reader.read(4);
+    uint64_t const globalCount = reader.read(4);
+    uint64_t const functionCount = reader.read(4);
+    // Every entry of a table takes at least one byte, so the tables can not hold more entries than bytes are left
+    if (reader.failed() || version != IMAGE_VERSION || opcodeCount != Opcode::AMOUNT ||
+        (hash.has_value() && *hash != sourceHash) || functionCount == 0 ||
+        stringCount + globalCount + functionCount > reader.remaining()) {
+        return std::nullopt;
+    }
+    m_flags = static_cast<uint16_t>(flags);
+    for (uint64_t string = 0; string < stringCount; string++) {
+        std::span<uint8_t const> const characters = reader.bytes(reader.read(4));
+        if (reader.failed()) {
+            return std::nullopt;
+        }
+        m_strings.push_back(
+            m_memoryMutator->create<cppLox::Types::ObjectString>(std::string(characters.begin(), characters.end()))
+                ->as<cppLox::Types::ObjectString>());
+    }
+    for (uint64_t global = 0; global < globalCount; global++) {
+        uint16_t const slot = static_cast<uint16_t>(reader.read(2));
+        uint64_t const name = reader.read(4);
+        if (reader.failed() || name >= m_strings.size()) {
+            return std::nullopt;
+        }
+        size_t const resolvedSlot = m_memoryMutator->resolveGlobal(m_strings[name]);
+        if (resolvedSlot > UINT16_MAX) {
+            return std::nullopt;
+        }
+        m_globals[slot] = static_cast<uint16_t>(resolvedSlot);
+    }
+    for (uint64_t function = 0; function < functionCount; function++) {
+        uint64_t const name = reader.read(4);
+        uint16_t const arity = static_cast<uint16_t>(reader.read(2));
+        if (reader.failed() || (name != IMAGE_NO_STRING && name >= m_strings.size())) {
+            return std::nullopt;
+        }
+        m_functions.push_back(m_memoryMutator
+                                  ->create<cppLox::Types::ObjectFunction>(
+                                      arity, name != IMAGE_NO_STRING ? m_strings[name] : nullptr)
+                                  ->as<cppLox::Types::ObjectFunction>());
+    }
+    for (cppLox::Types::ObjectFunction * function : m_functions) {
+        if (!readBody(reader, *function)) {
+            return std::nullopt;
+        }
+    }
+    if (reader.failed() || reader.remaining() != 0) {
+        return std::nullopt;
+    }
+    return m_functions.front();
+}
+
+auto ImageLoader::flags() const -> uint16_t {
+    return m_flags;
+}
+
+auto ImageLoader::markRoots(cppLox::MemoryMutator & memoryMutator) -> void {
+    // The functions of the last image stay marked, until the loader is destroyed, so the script survives until it runs
+    for (cppLox::Types::ObjectString * string : m_strings) {
+        memoryMutator.markObject(string);
+    }
+    for (cppLox::Types::ObjectFunction * function : m_functions) {
+        memoryMutator.markObject(function);
+    }
+}
+
+auto ImageLoader::readBody(Reader & reader, cppLox::Types::ObjectFunction & function) -> bool {
+    uint64_t const maxStackDepth = reader.read(4);
+    uint64_t const codeSize = reader.read(4);
+    uint64_t const runCount = reader.read(4);
+    uint64_t const constantCount = reader.read(4);
+    uint64_t const inlinedCallCount = reader.read(4);
+    std::span<uint8_t const> const code = reader.bytes(codeSize);
+    if (reader.failed() || runCount > reader.remaining() || (codeSize == 0) != (runCount == 0)) {
+        return false;
+    }
+    function.updateMaxStackDepth(static_cast<uint32_t>(maxStackDepth));
+    std::vector<LineRun> runs(runCount);
+    for (LineRun & run : runs) {
+        run.start = static_cast<uint32_t>(reader.read(4));
+        run.line = static_cast<int>(static_cast<uint32_t>(reader.read(4)));
+    }
+    // The runs have to cover the code in ascending order, before any of them is copied
+    for (size_t run = 0; run < runs.size(); run++) {
+        size_t const end = run + 1 < runs.size() ? runs[run + 1].start : code.size();
+        if ((run == 0 && runs[run].start != 0) || runs[run].start >= end || end > code.size()) {
+            return false;
+        }
+    }
+    Chunk & chunk = *function.chunk();
+    // The bytes of every run are copied at once
+    for (size_t run = 0; run < runs.size(); run++) {
+        size_t const end = run + 1 < runs.size() ? runs[run + 1].start : code.size();
+        chunk.write(code.subspan(runs[run].start, end - runs[run].start), runs[run].line);
+    }
+    if (reader.failed() || constantCount > reader.remaining()) {
+        return false;
+    }
+    for (size_t index = 0; index < constantCount; index++) {
+        std::optional<cppLox::Types::Value> const constant = readConstant(reader);
+        // The constants of a chunk are distinct, so every constant is added at its index
+        if (!constant.has_value() || chunk.addConstant(*constant) != index) {
+            return false;
+        }
+    }
+    if (inlinedCallCount > reader.remaining()) {
+        return false;
+    }
+    for (uint64_t index = 0; index < inlinedCallCount; index++) {
+        InlinedCall call;
+        call.start = reader.read(4);
+        call.end = reader.read(4);
+        call.function = reader.read(4);
+        call.line = static_cast<int>(static_cast<uint32_t>(reader.read(4)));
+        // A runtime error in the body reports the inlined function, so the constant has to be a function
+        if (call.start > call.end || call.end > code.size() || call.function >= chunk.getConstantCount() ||
+            !isFunction(chunk.getConstant(call.function))) {
+            return false;
+        }
+        chunk.addInlinedCall(call);
+    }
+    if (reader.failed()) {
+        return false;
+    }
+    std::optional<std::vector<bool>> const instructions = relocate(chunk);
+    return instructions.has_value() && verify(function, *instructions, static_cast<uint32_t>(maxStackDepth));
+}
+
+auto ImageLoader::readConstant(Reader & reader) -> std::optional<cppLox::Types::Value> {
+    switch (static_cast<ImageConstant>(reader.read(1))) {
+    case ImageConstant::NULL_:
+        return cppLox::Types::Value();
+    case ImageConstant::FALSE:
+        return cppLox::Types::Value(false);
+    case ImageConstant::TRUE:
+        return cppLox::Types::Value(true);
+    case ImageConstant::NUMBER:
+        return cppLox::Types::Value(std::bit_cast<double>(reader.read(8)));
+    case ImageConstant::STRING: {
+        uint64_t const string = reader.read(4);
+        if (string >= m_strings.size()) {
+            return std::nullopt;
+        }
+        return cppLox::Types::Value(static_cast<cppLox::Types::Object *>(m_strings[string]));
+    }
+    case ImageConstant::FUNCTION: {
+        uint64_t const function = reader.read(4);
+        if (function >= m_functions.size()) {
+            return std::nullopt;
+        }
+        return cppLox::Types::Value(static_cast<cppLox::Types::Object *>(m_functions[function]));
+    }
+    }
+    return std::nullopt;
+}
+
+auto ImageLoader::relocate(Chunk & chunk) const -> std::optional<std::vector<bool>> {
+    std::vector<uint8_t> & code = chunk.code();
+    size_t const constantCount = chunk.getConstantCount();
+    std::vector<bool> instructions(code.size(), false);
+    for (size_t offset = 0; offset < code.size();) {
+        if (code[offset] >= Opcode::AMOUNT) {
+            return std::nullopt;
+        }
+        Opcode const opcode = static_cast<Opcode>(code[offset]);
+        size_t const length = instruction_length(opcode);
+        if (offset + length > code.size()) {
+            return std::nullopt;
+        }
+        instructions[offset] = true;
+        switch (opcode) {
+        case Opcode::CONSTANT:
+            if (code[offset + 1] >= constantCount) {
+                return std::nullopt;
+            }
+            break;
+        case Opcode::GET_LOCAL_CONSTANT:
+            if (code[offset + 2] >= constantCount) {
+                return std::nullopt;
+            }
+            break;
+        case Opcode::CONSTANT_LONG:
+        case Opcode::CALL_INLINED: {
+            // The two byte constant of an inlined call follows the amount of arguments
+            size_t const operand = opcode == Opcode::CONSTANT_LONG ? offset + 1 : offset + 2;
+            if (static_cast<size_t>(code[operand] << 8 | code[operand + 1]) >= constantCount) {
+                return std::nullopt;
+            }
+            break;
+        }
+        case Opcode::DEFINE_GLOBAL:
+        case Opcode::GET_GLOBAL:
+        case Opcode::SET_GLOBAL: {
+            auto const global = m_globals.find(static_cast<uint16_t>(code[offset + 1] << 8 | code[offset + 2]));
+            if (global == m_globals.end()) {
+                return std::nullopt;
+            }
+            code[offset + 1] = static_cast<uint8_t>(global->second >> 8);
+            code[offset + 2] = static_cast<uint8_t>(global->second);
+            break;
+        }
+        default:
+            break;
+        }
+        offset += length;
+    }
+    return instructions;
+}
+
+auto ImageLoader::verify(cppLox::Types::ObjectFunction & function, std::vector<bool> const & instructions,
+                         uint32_t maxStackDepth) -> bool {
+    std::vector<uint8_t> const & code = function.chunk()->code();
+    // The depth of the stack before every instruction, that is reached, counted from the slot of the function
+    std::vector<int64_t> depths(code.size(), -1);
+    std::vector<size_t> worklist;
+    int64_t deepest = function.arity() + 1;
+    // Every path into an instruction has to agree on the depth, so a loop can not grow the stack
+    auto const reach = [&](size_t target, int64_t depth) -> bool {
+        if (target >= code.size() || !instructions[target] || (depths[target] != -1 && depths[target] != depth)) {
+            return false;
+        }
+        if (depths[target] == -1) {
+            depths[target] = depth;
+            worklist.push_back(target);
+        }
+        return true;
+    };
+    if (code.empty() || !reach(0, deepest)) {
+        return false;
+    }
+    while (!worklist.empty()) {
+        size_t const offset = worklist.back();
+        worklist.pop_back();
+        Opcode const opcode = static_cast<Opcode>(code[offset]);
+        size_t const next = offset + instruction_length(opcode);
+        int64_t const depth = depths[offset];
+        int64_t const operand = next > offset + 1 ? code[offset + 1] : 0;
+        // The amount of values below the result of a call or an inlined body is not known to stack_effect
+        int64_t consumed = 0;
+        switch (opcode) {
+        case Opcode::CALL:
+        case Opcode::CALL_INLINED:
+        case Opcode::TAIL_CALL:
+        case Opcode::RETURN_INLINED:
+            consumed = operand;
+            break;
+        case Opcode::GET_LOCAL:
+        case Opcode::GET_LOCAL_CONSTANT:
+            if (operand + 1 >= depth) {
+                return false;
+            }
+            break;
+        case Opcode::GET_LOCAL_GET_LOCAL:
+            // The second local is read after the first one was pushed
+            if (operand + 1 >= depth || code[offset + 2] >= depth) {
+                return false;
+            }
+            break;
+        case Opcode::SET_LOCAL:
+        case Opcode::SET_LOCAL_POP:
+            // The local is below the value, that is stored in it
+            if (operand + 2 >= depth) {
+                return false;
+            }
+            break;
+        default:
+            break;
+        }
+        int64_t const after = depth + stack_effect(opcode) - consumed;
+        // No instruction reaches below the slot of the function
+        if (after < 1) {
+            return false;
+        }
+        deepest = std::max(deepest, after);
+        if (isJump(opcode) || opcode == Opcode::CALL_INLINED) {
+            size_t const jump = static_cast<size_t>(code[next - 2] << 8 | code[next - 1]);
+            if (opcode == Opcode::LOOP ? jump > next || !reach(next - jump, after) : !reach(next + jump, after)) {
+                return false;
+            }
+        }
+        // The inlined body starts with the callee and the arguments on the stack, any other callee skips it
+        if (opcode == Opcode::CALL_INLINED && !reach(next, depth)) {
+            return false;
+        }
+        if (opcode != Opcode::CALL_INLINED && opcode != Opcode::JUMP && opcode != Opcode::LOOP &&
+            opcode != Opcode::RETURN && !reach(next, after)) {
+            return false;
+        }
+    }
+    // The virtual machine reserves the maximum stack depth of a function, when it is called
+    return deepest <= maxStackDepth;
+}
+
+ImageLoader::Reader::Reader(std::span<uint8_t const> image) : m_image(image), m_offset(0), m_failed(false) {
+}
+
+auto ImageLoader::Reader::read(size_t size) -> uint64_t {
+    uint64_t value = 0;
+    std::span<uint8_t const> const bytes = this->bytes(size);
+    for (size_t byte = 0; byte < bytes.size(); byte++) {
+        value |= static_cast<uint64_t>(bytes[byte]) << (8 * byte);
+    }
+    return value;
+}
+
+auto ImageLoader::Reader::bytes(size_t size) -> std::span<uint8_t const> {
+    if (m_failed || size > remaining()) {
+        m_failed = true;
+        return {};
+    }
+    std::span<uint8_t const> const bytes = m_image.subspan(m_offset, size);
+    m_offset += size;
+    return bytes;
+}
+
+auto ImageLoader::Reader::remaining() const -> size_t {
+    return m_image.size() - m_offset;
+}
+
+auto ImageLoader::Reader::failed() const -> bool {
+    return m_failed;
+}
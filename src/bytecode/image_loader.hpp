@@ -0,0 +1,158 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+
+/**
+ * @file image_loader.hpp
+ * @brief This file contains the declaration of the ImageLoader class.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "../memory_mutator.hpp"
+#include "../types/object_function.hpp"
+#include "../types/object_string.hpp"
+#include "../types/value.hpp"
+#include "chunk.hpp"
+
+namespace cppLox::ByteCode {
+
+/// @brief Loads a program from an image, that was written by the ImageWriter, instead of compiling it.
+/// @details The file of an image is mapped into memory and the strings and functions are created from the mapped
+/// bytes, so the bytecode of every function is copied once into its chunk, where the virtual machine quickens the
+/// instructions. The structure of the image is checked - the tables, the opcodes and their operands - and every path
+/// through a function is followed, so a damaged image is rejected instead of being executed. The global slots are
+/// resolved by name again, because the slots are only valid in the memory mutator, that compiled the program.
+class ImageLoader : public cppLox::RootSource {
+  public:
+    /// @brief Constructs a new image loader.
+    /// @param memoryMutator The memory mutator, that creates the objects of the loaded program.
+    explicit ImageLoader(std::shared_ptr<cppLox::MemoryMutator> memoryMutator);
+
+    /// @brief Destructor of the image loader.
+    ~ImageLoader() override;
+
+    /// @brief Loads the image in the given file.
+    /// @param path The path of the file.
+    /// @param hash The hash of the source code, that the image has to be compiled from, if it is known.
+    /// @return The script of the image or an empty optional if the file can not be mapped or is not a valid image.
+    [[nodiscard]] auto loadFile(std::filesystem::path const & path, std::optional<uint64_t> hash = std::nullopt)
+        -> std::optional<cppLox::Types::ObjectFunction *>;
+
+    /// @brief Loads the given image.
+    /// @param image The bytes of the image.
+    /// @param hash The hash of the source code, that the image has to be compiled from, if it is known.
+    /// @return The script of the image or an empty optional if the image is not valid.
+    [[nodiscard]] auto load(std::span<uint8_t const> image, std::optional<uint64_t> hash = std::nullopt)
+        -> std::optional<cppLox::Types::ObjectFunction *>;
+
+    /// @brief Gets the flags of the image, that was loaded last.
+    /// @return The flags the program in the image was compiled with.
+    [[nodiscard]] auto flags() const -> uint16_t;
+
+    /// @brief Marks the strings and the functions, that were created while an image is loaded.
+    /// @param memoryMutator The memory mutator that collects the garbage.
+    auto markRoots(cppLox::MemoryMutator & memoryMutator) -> void override;
+
+  private:
+    /// @brief Reads the little-endian numbers of an image.
+    /// @details A read past the end of the image fails the reader, so the image is checked once it was read.
+    class Reader {
+      public:
+        /// @brief Constructs a new reader.
+        /// @param image The bytes of the image.
+        explicit Reader(std::span<uint8_t const> image);
+
+        /// @brief Reads a number.
+        /// @param size The size of the number in bytes.
+        /// @return The number or 0 if the image ended.
+        [[nodiscard]] auto read(size_t size) -> uint64_t;
+
+        /// @brief Reads the given amount of bytes.
+        /// @param size The amount of bytes.
+        /// @return The bytes, that are empty if the image ended.
+        [[nodiscard]] auto bytes(size_t size) -> std::span<uint8_t const>;
+
+        /// @brief Gets the amount of bytes, that were not read yet.
+        /// @return The amount of bytes.
+        [[nodiscard]] auto remaining() const -> size_t;
+
+        /// @brief Checks if a read went past the end of the image.
+        /// @return true if the image ended, false otherwise.
+        [[nodiscard]] auto failed() const -> bool;
+
+      private:
+        /// @brief The bytes of the image.
+        std::span<uint8_t const> m_image;
+
+        /// @brief The offset of the next byte, that is read.
+        size_t m_offset;
+
+        /// @brief Whether a read went past the end of the image.
+        bool m_failed;
+    };
+
+    /// @brief Reads the body of a function.
+    /// @param reader The reader of the image.
+    /// @param function The function, whose body is read.
+    /// @return true if the body is valid, false otherwise.
+    [[nodiscard]] auto readBody(Reader & reader, cppLox::Types::ObjectFunction & function) -> bool;
+
+    /// @brief Reads a constant.
+    /// @param reader The reader of the image.
+    /// @return The constant or an empty optional if the constant is not valid.
+    [[nodiscard]] auto readConstant(Reader & reader) -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Checks the instructions of a chunk and moves its global operands to the resolved global slots.
+    /// @param chunk The chunk.
+    /// @return Whether an instruction starts at each offset of the chunk or an empty optional if the instructions are
+    /// not valid.
+    [[nodiscard]] auto relocate(Chunk & chunk) const -> std::optional<std::vector<bool>>;
+
+    /// @brief Follows every path through the instructions of a function and checks, that the jumps land on an
+    /// instruction, that the local slots are on the stack and that the stack stays within the maximum stack depth.
+    /// @param function The function.
+    /// @param instructions Whether an instruction starts at each offset of the chunk of the function.
+    /// @param maxStackDepth The maximum stack depth of the function, that is stored in the image.
+    /// @return true if the instructions are valid, false otherwise.
+    [[nodiscard]] static auto verify(cppLox::Types::ObjectFunction & function, std::vector<bool> const & instructions,
+                                     uint32_t maxStackDepth) -> bool;
+
+    /// @brief The memory mutator, that creates the objects of the loaded program.
+    std::shared_ptr<cppLox::MemoryMutator> m_memoryMutator;
+
+    /// @brief The flags of the image, that was loaded last.
+    uint16_t m_flags;
+
+    /// @brief The strings of the string table of the image, that is loaded.
+    std::vector<cppLox::Types::ObjectString *> m_strings;
+
+    /// @brief The functions of the function table of the image, that is loaded.
+    std::vector<cppLox::Types::ObjectFunction *> m_functions;
+
+    /// @brief The resolved global slot of every global slot of the image, that is loaded.
+    std::unordered_map<uint16_t, uint16_t> m_globals;
+};
+
+} // namespace cppLox::ByteCode
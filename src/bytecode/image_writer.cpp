@@ -0,0 +1,195 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+
+/**
+ * @file image_writer.cpp
+ * @brief This file contains the implementation of the ImageWriter class.
+ */
+
+#include "image_writer.hpp"
+
+#include <bit>
+#include <format>
+#include <fstream>
+#include <random>
+#include <system_error>
+
+#include "image.hpp"
+#include "opcode.hpp"
+
+using namespace cppLox::ByteCode;
+
+/// @brief Appends the given number to the given bytes in little-endian byte order.
+/// @param bytes The bytes the number is appended to.
+/// @param value The number to append.
+/// @param size The size of the number in bytes.
+static auto append(std::vector<uint8_t> & bytes, uint64_t value, size_t size) -> void {
+    for (size_t byte = 0; byte < size; byte++) {
+        bytes.push_back(static_cast<uint8_t>(value >> (8 * byte)));
+    }
+}
+
+auto ImageWriter::write(cppLox::Types::ObjectFunction & script, cppLox::MemoryMutator const & memoryMutator,
+                        uint64_t hash, uint16_t flags) -> std::optional<std::vector<uint8_t>> {
+    m_functions.clear();
+    m_functionIndices.clear();
+    m_strings.clear();
+    m_stringIndices.clear();
+    m_globals.clear();
+    m_functionTable.clear();
+    [[maybe_unused]] uint32_t const scriptIndex = functionIndex(&script);
+    // Writing a function adds the functions it references to the end of the table
+    for (size_t index = 0; index < m_functions.size(); index++) {
+        if (!writeFunction(*m_functions[index], memoryMutator)) {
+            return std::nullopt;
+        }
+    }
+    std::vector<uint8_t> image(IMAGE_MAGIC.begin(), IMAGE_MAGIC.end());
+    append(image, IMAGE_VERSION, 2);
+    append(image, flags, 2);
+    append(image, hash, 8);
+    append(image, Opcode::AMOUNT, 4);
+    append(image, m_strings.size(), 4);
+    append(image, m_globals.size(), 4);
+    append(image, m_functions.size(), 4);
+    for (cppLox::Types::ObjectString * string : m_strings) {
+        append(image, string->string().size(), 4);
+        image.insert(image.end(), string->string().begin(), string->string().end());
+    }
+    for (auto const & [slot, name] : m_globals) {
+        append(image, slot, 2);
+        append(image, name, 4);
+    }
+    // The functions are created before their bodies are read, so the bodies can reference every function
+    for (cppLox::Types::ObjectFunction * function : m_functions) {
+        append(image, function->name() != nullptr ? stringIndex(function->name()) : IMAGE_NO_STRING, 4);
+        append(image, function->arity(), 2);
+    }
+    image.insert(image.end(), m_functionTable.begin(), m_functionTable.end());
+    return image;
+}
+
+auto ImageWriter::save(std::vector<uint8_t> const & image, std::filesystem::path const & path) -> bool {
+    std::error_code error;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+    // Processes, that save the same image at the same time, write to different temporary files
+    std::filesystem::path temporary = path;
+    temporary += std::format(".{:08x}.tmp", std::random_device()());
+    std::ofstream file(temporary, std::ios::binary);
+    file.write(reinterpret_cast<char const *>(image.data()), static_cast<std::streamsize>(image.size()));
+    file.close();
+    if (!file) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+auto ImageWriter::writeFunction(cppLox::Types::ObjectFunction & function, cppLox::MemoryMutator const & memoryMutator)
+    -> bool {
+    Chunk & chunk = *function.chunk();
+    append(m_functionTable, function.maxStackDepth(), 4);
+    append(m_functionTable, chunk.getSize(), 4);
+    append(m_functionTable, chunk.getLineRunCount(), 4);
+    append(m_functionTable, chunk.getConstantCount(), 4);
+    append(m_functionTable, chunk.getInlinedCallCount(), 4);
+    std::vector<uint8_t> const & code = chunk.code();
+    m_functionTable.insert(m_functionTable.end(), code.begin(), code.end());
+    for (size_t offset = 0; offset < code.size(); offset += instruction_length(static_cast<Opcode>(code[offset]))) {
+        Opcode const opcode = static_cast<Opcode>(code[offset]);
+        if (opcode == Opcode::DEFINE_GLOBAL || opcode == Opcode::GET_GLOBAL || opcode == Opcode::SET_GLOBAL) {
+            uint16_t const slot = static_cast<uint16_t>(code[offset + 1] << 8 | code[offset + 2]);
+            if (!m_globals.contains(slot)) {
+                m_globals.emplace(slot, stringIndex(memoryMutator.globalName(slot)));
+            }
+        }
+    }
+    for (size_t run = 0; run < chunk.getLineRunCount(); run++) {
+        append(m_functionTable, chunk.getLineRun(run).start, 4);
+        append(m_functionTable, static_cast<uint32_t>(chunk.getLineRun(run).line), 4);
+    }
+    for (size_t constant = 0; constant < chunk.getConstantCount(); constant++) {
+        if (!writeConstant(chunk.getConstant(constant))) {
+            return false;
+        }
+    }
+    for (size_t index = 0; index < chunk.getInlinedCallCount(); index++) {
+        InlinedCall const & call = chunk.getInlinedCall(index);
+        append(m_functionTable, call.start, 4);
+        append(m_functionTable, call.end, 4);
+        append(m_functionTable, call.function, 4);
+        append(m_functionTable, static_cast<uint32_t>(call.line), 4);
+    }
+    return true;
+}
+
+auto ImageWriter::writeConstant(cppLox::Types::Value const & constant) -> bool {
+    switch (constant.getType()) {
+    case cppLox::Types::Value::Type::NULL_:
+        m_functionTable.push_back(static_cast<uint8_t>(ImageConstant::NULL_));
+        return true;
+    case cppLox::Types::Value::Type::BOOL:
+        m_functionTable.push_back(
+            static_cast<uint8_t>(constant.as<bool>() ? ImageConstant::TRUE : ImageConstant::FALSE));
+        return true;
+    case cppLox::Types::Value::Type::NUMBER:
+        m_functionTable.push_back(static_cast<uint8_t>(ImageConstant::NUMBER));
+        append(m_functionTable, std::bit_cast<uint64_t>(constant.as<double>()), 8);
+        return true;
+    case cppLox::Types::Value::Type::OBJECT:
+        break;
+    }
+    cppLox::Types::Object * object = constant.as<cppLox::Types::Object *>();
+    if (object->is(cppLox::Types::Object::Type::STRING)) {
+        m_functionTable.push_back(static_cast<uint8_t>(ImageConstant::STRING));
+        append(m_functionTable, stringIndex(object->as<cppLox::Types::ObjectString>()), 4);
+        return true;
+    }
+    if (object->is(cppLox::Types::Object::Type::FUNCTION)) {
+        m_functionTable.push_back(static_cast<uint8_t>(ImageConstant::FUNCTION));
+        append(m_functionTable, functionIndex(object->as<cppLox::Types::ObjectFunction>()), 4);
+        return true;
+    }
+    // Native functions are defined by the virtual machine, that runs the image
+    return false;
+}
+
+auto ImageWriter::functionIndex(cppLox::Types::ObjectFunction * function) -> uint32_t {
+    auto [iterator, inserted] = m_functionIndices.try_emplace(function, static_cast<uint32_t>(m_functions.size()));
+    if (inserted) {
+        m_functions.push_back(function);
+        // The names are written with the signatures of the functions, after the string table
+        if (function->name() != nullptr) {
+            [[maybe_unused]] uint32_t const nameIndex = stringIndex(function->name());
+        }
+    }
+    return iterator->second;
+}
+
+auto ImageWriter::stringIndex(cppLox::Types::ObjectString * string) -> uint32_t {
+    auto [iterator, inserted] = m_stringIndices.try_emplace(string, static_cast<uint32_t>(m_strings.size()));
+    if (inserted) {
+        m_strings.push_back(string);
+    }
+    return iterator->second;
+}
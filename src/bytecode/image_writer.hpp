@@ -0,0 +1,115 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+
+/**
+ * @file image_writer.hpp
+ * @brief This file contains the declaration of the ImageWriter class.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "../memory_mutator.hpp"
+#include "../types/object_function.hpp"
+#include "../types/object_string.hpp"
+#include "chunk.hpp"
+
+namespace cppLox::ByteCode {
+
+/// @brief Serializes a compiled program into an image, that is loaded instead of compiling the program again.
+/// @details An image starts with a header of IMAGE_HEADER_SIZE bytes - the magic number, the version, the flags, the
+/// hash of the source code, the amount of opcodes and the sizes of the string, global and function tables - followed
+/// by the tables. The string table holds the length and the characters of every string. The global table holds the
+/// global slot and the name of every global variable, that is accessed by the bytecode, because the slots are only
+/// valid in the memory mutator, that compiled the program. The function table holds the name and the arity of every
+/// function, starting with the script, followed by the maximum stack depth, the bytecode, the line table, the
+/// constants and the inlined calls of every function. Strings and functions are referenced by their index, so
+/// functions can reference each other. All numbers are stored in little-endian byte order.
+class ImageWriter {
+  public:
+    /// @brief Constructs a new image writer.
+    ImageWriter() = default;
+
+    /// @brief Destructor of the image writer.
+    ~ImageWriter() = default;
+
+    /// @brief Serializes the given script and all the functions it references.
+    /// @param script The compiled script.
+    /// @param memoryMutator The memory mutator, that resolved the global slots of the script.
+    /// @param hash The hash of the source code of the script.
+    /// @param flags The flags the script was compiled with.
+    /// @return The image or an empty optional if the script references a value, that can not be stored.
+    [[nodiscard]] auto write(cppLox::Types::ObjectFunction & script, cppLox::MemoryMutator const & memoryMutator,
+                             uint64_t hash, uint16_t flags) -> std::optional<std::vector<uint8_t>>;
+
+    /// @brief Saves the given image in a file.
+    /// @details The image is written to a temporary file first, that replaces the file at the given path, so other
+    /// processes never load a partially written image.
+    /// @param image The image to save.
+    /// @param path The path of the file.
+    /// @return true if the image was saved, false otherwise.
+    [[nodiscard]] static auto save(std::vector<uint8_t> const & image, std::filesystem::path const & path) -> bool;
+
+  private:
+    /// @brief Writes a function to the function table.
+    /// @param function The function to write.
+    /// @param memoryMutator The memory mutator, that resolved the global slots of the function.
+    /// @return true if the function was written, false if it references a value, that can not be stored.
+    [[nodiscard]] auto writeFunction(cppLox::Types::ObjectFunction & function,
+                                     cppLox::MemoryMutator const & memoryMutator) -> bool;
+
+    /// @brief Writes a constant to the function table.
+    /// @param constant The constant to write.
+    /// @return true if the constant was written, false if it can not be stored.
+    [[nodiscard]] auto writeConstant(cppLox::Types::Value const & constant) -> bool;
+
+    /// @brief Gets the index of the given function in the function table and adds it, if it was not added yet.
+    /// @param function The function.
+    /// @return The index of the function.
+    [[nodiscard]] auto functionIndex(cppLox::Types::ObjectFunction * function) -> uint32_t;
+
+    /// @brief Gets the index of the given string in the string table and adds it, if it was not added yet.
+    /// @param string The string.
+    /// @return The index of the string.
+    [[nodiscard]] auto stringIndex(cppLox::Types::ObjectString * string) -> uint32_t;
+
+    /// @brief The functions in the order of the function table.
+    std::vector<cppLox::Types::ObjectFunction *> m_functions;
+
+    /// @brief The index of every function in the function table.
+    std::unordered_map<cppLox::Types::ObjectFunction *, uint32_t> m_functionIndices;
+
+    /// @brief The strings in the order of the string table.
+    std::vector<cppLox::Types::ObjectString *> m_strings;
+
+    /// @brief The index of every string in the string table.
+    std::unordered_map<cppLox::Types::ObjectString *, uint32_t> m_stringIndices;
+
+    /// @brief The index of the name of every global slot, that is accessed by the bytecode.
+    std::map<uint16_t, uint32_t> m_globals;
+
+    /// @brief The serialized function table.
+    std::vector<uint8_t> m_functionTable;
+};
+
+} // namespace cppLox::ByteCode
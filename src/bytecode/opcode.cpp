@@ -24,26 +24,52 @@
     switch (value) {
     case Opcode::ADD:
         return "ADD";
+    case Opcode::ADD_NUM_NUM:
+        return "ADD_NUM_NUM";
     case Opcode::CALL:
         return "CALL";
+    case Opcode::CALL_INLINED:
+        return "CALL_INLINED";
     case Opcode::CONSTANT:
         return "CONSTANT";
+    case Opcode::CONSTANT_LONG:
+        return "CONSTANT_LONG";
     case Opcode::DEFINE_GLOBAL:
         return "DEFINE_GLOBAL";
     case Opcode::DIVIDE:
         return "DIVIDE";
+    case Opcode::DIVIDE_NUM_NUM:
+        return "DIVIDE_NUM_NUM";
     case Opcode::EQUAL:
         return "EQUAL";
+    case Opcode::EQUAL_JUMP_IF_FALSE:
+        return "EQUAL_JUMP_IF_FALSE";
     case Opcode::FALSE:
         return "FALSE";
     case Opcode::GET_GLOBAL:
         return "GET_GLOBAL";
     case Opcode::GET_LOCAL:
         return "GET_LOCAL";
+    case Opcode::GET_LOCAL_CONSTANT:
+        return "GET_LOCAL_CONSTANT";
+    case Opcode::GET_LOCAL_GET_LOCAL:
+        return "GET_LOCAL_GET_LOCAL";
     case Opcode::GREATER:
         return "GREATER";
     case Opcode::GREATER_EQUAL:
         return "GREATER_EQUAL";
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+        return "GREATER_EQUAL_JUMP_IF_FALSE";
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+        return "GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM";
+    case Opcode::GREATER_EQUAL_NUM_NUM:
+        return "GREATER_EQUAL_NUM_NUM";
+    case Opcode::GREATER_JUMP_IF_FALSE:
+        return "GREATER_JUMP_IF_FALSE";
+    case Opcode::GREATER_JUMP_IF_FALSE_NUM_NUM:
+        return "GREATER_JUMP_IF_FALSE_NUM_NUM";
+    case Opcode::GREATER_NUM_NUM:
+        return "GREATER_NUM_NUM";
     case Opcode::JUMP_IF_FALSE:
         return "JUMP_IF_FALSE";
     case Opcode::JUMP:
@@ -52,36 +78,169 @@
         return "LESS";
     case Opcode::LESS_EQUAL:
         return "LESS_EQUAL";
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+        return "LESS_EQUAL_JUMP_IF_FALSE";
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+        return "LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM";
+    case Opcode::LESS_EQUAL_NUM_NUM:
+        return "LESS_EQUAL_NUM_NUM";
+    case Opcode::LESS_JUMP_IF_FALSE:
+        return "LESS_JUMP_IF_FALSE";
+    case Opcode::LESS_JUMP_IF_FALSE_NUM_NUM:
+        return "LESS_JUMP_IF_FALSE_NUM_NUM";
+    case Opcode::LESS_NUM_NUM:
+        return "LESS_NUM_NUM";
     case Opcode::LOOP:
         return "LOOP";
     case Opcode::MULTIPLY:
         return "MULTIPLY";
+    case Opcode::MULTIPLY_NUM_NUM:
+        return "MULTIPLY_NUM_NUM";
     case Opcode::NEGATE:
         return "NEGATE";
     case Opcode::NOT:
         return "NOT";
     case Opcode::NOT_EQUAL:
         return "NOT_EQUAL";
+    case Opcode::NOT_EQUAL_JUMP_IF_FALSE:
+        return "NOT_EQUAL_JUMP_IF_FALSE";
     case Opcode::NULL_:
         return "NULL_";
     case Opcode::POP:
         return "POP";
+    case Opcode::POP_JUMP_IF_FALSE:
+        return "POP_JUMP_IF_FALSE";
+    case Opcode::POP_JUMP_IF_TRUE:
+        return "POP_JUMP_IF_TRUE";
     case Opcode::PRINT:
         return "PRINT";
     case Opcode::RETURN:
         return "RETURN";
+    case Opcode::RETURN_INLINED:
+        return "RETURN_INLINED";
     case Opcode::SET_GLOBAL:
         return "SET_GLOBAL";
     case Opcode::SET_LOCAL:
         return "SET_LOCAL";
+    case Opcode::SET_LOCAL_POP:
+        return "SET_LOCAL_POP";
     case Opcode::SUBTRACT:
         return "SUBTRACT";
+    case Opcode::SUBTRACT_NUM_NUM:
+        return "SUBTRACT_NUM_NUM";
+    case Opcode::TAIL_CALL:
+        return "TAIL_CALL";
     case Opcode::TRUE:
         return "TRUE";
     }
     return "Unknown opcode";
 }
 
+[[nodiscard]] auto cppLox::ByteCode::stack_effect(const cppLox::ByteCode::Opcode value) -> int8_t {
+    switch (value) {
+    case Opcode::CONSTANT:
+    case Opcode::CONSTANT_LONG:
+    case Opcode::FALSE:
+    case Opcode::GET_GLOBAL:
+    case Opcode::GET_LOCAL:
+    case Opcode::NULL_:
+    case Opcode::TRUE:
+        return 1;
+    case Opcode::GET_LOCAL_CONSTANT:
+    case Opcode::GET_LOCAL_GET_LOCAL:
+        return 2;
+    case Opcode::CALL:
+    case Opcode::CALL_INLINED:
+    case Opcode::JUMP:
+    case Opcode::JUMP_IF_FALSE:
+    case Opcode::LOOP:
+    case Opcode::NEGATE:
+    case Opcode::NOT:
+    case Opcode::RETURN_INLINED:
+    case Opcode::SET_GLOBAL:
+    case Opcode::SET_LOCAL:
+    case Opcode::TAIL_CALL:
+        return 0;
+    case Opcode::ADD:
+    case Opcode::ADD_NUM_NUM:
+    case Opcode::DEFINE_GLOBAL:
+    case Opcode::DIVIDE:
+    case Opcode::DIVIDE_NUM_NUM:
+    case Opcode::EQUAL:
+    case Opcode::GREATER:
+    case Opcode::GREATER_EQUAL:
+    case Opcode::GREATER_EQUAL_NUM_NUM:
+    case Opcode::GREATER_NUM_NUM:
+    case Opcode::LESS:
+    case Opcode::LESS_EQUAL:
+    case Opcode::LESS_EQUAL_NUM_NUM:
+    case Opcode::LESS_NUM_NUM:
+    case Opcode::MULTIPLY:
+    case Opcode::MULTIPLY_NUM_NUM:
+    case Opcode::NOT_EQUAL:
+    case Opcode::POP:
+    case Opcode::POP_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_TRUE:
+    case Opcode::PRINT:
+    case Opcode::RETURN:
+    case Opcode::SET_LOCAL_POP:
+    case Opcode::SUBTRACT:
+    case Opcode::SUBTRACT_NUM_NUM:
+        return -1;
+    case Opcode::EQUAL_JUMP_IF_FALSE:
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::GREATER_JUMP_IF_FALSE:
+    case Opcode::GREATER_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::LESS_JUMP_IF_FALSE:
+    case Opcode::LESS_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::NOT_EQUAL_JUMP_IF_FALSE:
+        return -2;
+    }
+    return 0;
+}
+
+[[nodiscard]] auto cppLox::ByteCode::instruction_length(const cppLox::ByteCode::Opcode value) -> size_t {
+    switch (value) {
+    case Opcode::CALL:
+    case Opcode::CONSTANT:
+    case Opcode::GET_LOCAL:
+    case Opcode::RETURN_INLINED:
+    case Opcode::SET_LOCAL:
+    case Opcode::SET_LOCAL_POP:
+    case Opcode::TAIL_CALL:
+        return 2;
+    case Opcode::CONSTANT_LONG:
+    case Opcode::DEFINE_GLOBAL:
+    case Opcode::EQUAL_JUMP_IF_FALSE:
+    case Opcode::GET_GLOBAL:
+    case Opcode::GET_LOCAL_CONSTANT:
+    case Opcode::GET_LOCAL_GET_LOCAL:
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::GREATER_JUMP_IF_FALSE:
+    case Opcode::GREATER_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::JUMP:
+    case Opcode::JUMP_IF_FALSE:
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::LESS_JUMP_IF_FALSE:
+    case Opcode::LESS_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::LOOP:
+    case Opcode::NOT_EQUAL_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_TRUE:
+    case Opcode::SET_GLOBAL:
+        return 3;
+    case Opcode::CALL_INLINED:
+        return 6;
+    default:
+        return 1;
+    }
+}
+
 [[nodiscard]] auto cppLox::ByteCode::operator<<(std::ostream & os, Opcode const & opcode) -> std::ostream & {
     return os << cppLox::ByteCode::opcode_as_string(opcode);
 }
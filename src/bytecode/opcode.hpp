@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -32,27 +33,61 @@ namespace cppLox::ByteCode {
 enum Opcode : uint8_t {
     /// @brief Pops the top two values off the stack, adds them, and pushes the result back on the stack.
     ADD,
+    /// @brief Quickened form of ADD for two numbers - falls back to ADD for other operands.
+    ADD_NUM_NUM,
     /// @brief Calls the function at the given index on the stack.
     CALL,
+    /// @brief Calls the function at the given index on the stack like CALL, unless it is the function in the given two
+    /// byte constant, whose body was inlined after this instruction - then the body is executed in place, any other
+    /// callee is called and the body is skipped by the given offset.
+    CALL_INLINED,
     /// @brief Pushes the given constant onto the stack.
     CONSTANT,
-    /// @brief Defines a global variable
+    /// @brief Wide form of CONSTANT - pushes the constant with the given two byte index onto the stack.
+    CONSTANT_LONG,
+    /// @brief Defines the global variable in the given two byte global slot
     DEFINE_GLOBAL,
     /// @brief Pops the top two values off the stack, divides them, and pushes the result back on the stack.
     DIVIDE,
+    /// @brief Quickened form of DIVIDE for two numbers - falls back to DIVIDE for other operands.
+    DIVIDE_NUM_NUM,
     /// @brief Pops the top two values off the stack, compares them, and pushes the result back on the stack.
     EQUAL,
+    /// @brief Superinstruction for EQUAL, JUMP_IF_FALSE and POP - pops the top two values off the stack and jumps to
+    /// the given offset if they are not equal.
+    EQUAL_JUMP_IF_FALSE,
     /// @brief Pushes the false value onto the stack.
     FALSE,
-    /// @brief Gets the value of the global variable with the name of the given index on the stack and pushes it onto
-    /// the stack.
+    /// @brief Gets the value of the global variable in the given two byte global slot and pushes it onto the stack.
     GET_GLOBAL,
     /// @brief Gets the value of the local variable with the given index on the stack and pushes it onto the stack.
     GET_LOCAL,
+    /// @brief Superinstruction for GET_LOCAL and CONSTANT - pushes the local variable and the constant with the given
+    /// indices onto the stack.
+    GET_LOCAL_CONSTANT,
+    /// @brief Superinstruction for two GET_LOCAL instructions - pushes the local variables with the given indices onto
+    /// the stack.
+    GET_LOCAL_GET_LOCAL,
     /// @brief Pops the top two values off the stack, compares them, and pushes the result back on the stack.
     GREATER,
     /// @brief Pops the top two values off the stack, compares them, and pushes the result back on the stack.
     GREATER_EQUAL,
+    /// @brief Superinstruction for GREATER_EQUAL, JUMP_IF_FALSE and POP - pops the top two values off the stack and
+    /// jumps to the given offset if the first one is less than the second one.
+    GREATER_EQUAL_JUMP_IF_FALSE,
+    /// @brief Quickened form of GREATER_EQUAL_JUMP_IF_FALSE for two numbers - falls back to the generic form for
+    /// other operands.
+    GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM,
+    /// @brief Quickened form of GREATER_EQUAL for two numbers - falls back to GREATER_EQUAL for other operands.
+    GREATER_EQUAL_NUM_NUM,
+    /// @brief Superinstruction for GREATER, JUMP_IF_FALSE and POP - pops the top two values off the stack and jumps to
+    /// the given offset if the first one is less than or equal to the second one.
+    GREATER_JUMP_IF_FALSE,
+    /// @brief Quickened form of GREATER_JUMP_IF_FALSE for two numbers - falls back to the generic form for
+    /// other operands.
+    GREATER_JUMP_IF_FALSE_NUM_NUM,
+    /// @brief Quickened form of GREATER for two numbers - falls back to GREATER for other operands.
+    GREATER_NUM_NUM,
     /// @brief Jumps to the given offset.
     JUMP,
     /// @brief Jumps to the given offset if the top value on the stack is false.
@@ -61,30 +96,68 @@ enum Opcode : uint8_t {
     LESS,
     /// @brief Pops the top two values off the stack, compares them, and pushes the result back on the stack.
     LESS_EQUAL,
+    /// @brief Superinstruction for LESS_EQUAL, JUMP_IF_FALSE and POP - pops the top two values off the stack and jumps
+    /// to the given offset if the first one is greater than the second one.
+    LESS_EQUAL_JUMP_IF_FALSE,
+    /// @brief Quickened form of LESS_EQUAL_JUMP_IF_FALSE for two numbers - falls back to the generic form for
+    /// other operands.
+    LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM,
+    /// @brief Quickened form of LESS_EQUAL for two numbers - falls back to LESS_EQUAL for other operands.
+    LESS_EQUAL_NUM_NUM,
+    /// @brief Superinstruction for LESS, JUMP_IF_FALSE and POP - pops the top two values off the stack and jumps to the
+    /// given offset if the first one is greater than or equal to the second one.
+    LESS_JUMP_IF_FALSE,
+    /// @brief Quickened form of LESS_JUMP_IF_FALSE for two numbers - falls back to the generic form for
+    /// other operands.
+    LESS_JUMP_IF_FALSE_NUM_NUM,
+    /// @brief Quickened form of LESS for two numbers - falls back to LESS for other operands.
+    LESS_NUM_NUM,
     /// @brief Adds an offset to the instruction pointer, like JUMP
     LOOP,
     /// @brief Pops the top two values off the stack, multiplies them, and pushes the result back on the stack.
     MULTIPLY,
+    /// @brief Quickened form of MULTIPLY for two numbers - falls back to MULTIPLY for other operands.
+    MULTIPLY_NUM_NUM,
     /// @brief Pops the top value off the stack, negates it, and pushes the result back on the stack.
     NEGATE,
     /// @brief Pops the top value off the stack, negates it, and pushes the result back on the stack.
     NOT,
     /// @brief Pops the top two values off the stack, compares them, and pushes the result back on the stack.
     NOT_EQUAL,
+    /// @brief Superinstruction for NOT_EQUAL, JUMP_IF_FALSE and POP - pops the top two values off the stack and jumps
+    /// to the given offset if they are equal.
+    NOT_EQUAL_JUMP_IF_FALSE,
     /// @brief Pushes the null value onto the stack.
     NULL_,
     /// @brief Pops the top value off the stack.
     POP,
+    /// @brief Superinstruction for JUMP_IF_FALSE and POP - pops the top value off the stack and jumps to the given
+    /// offset if it is false.
+    POP_JUMP_IF_FALSE,
+    /// @brief Superinstruction for NOT and POP_JUMP_IF_FALSE - pops the top value off the stack and jumps to the given
+    /// offset if it is truthy.
+    POP_JUMP_IF_TRUE,
     /// @brief Pops the top value off the stack and prints it.
     PRINT,
     /// @brief Pops the top value off the stack and returns it.
     RETURN,
-    /// @brief  Sets the global variable with the given name at the given index on the stack.
+    /// @brief Ends the body of an inlined function - pops the result off the stack, discards the given amount of values
+    /// below it, the callee, the arguments and the locals, and pushes the result back onto the stack.
+    RETURN_INLINED,
+    /// @brief Sets the global variable in the given two byte global slot to the value on top of the stack.
     SET_GLOBAL,
     /// @brief Sets the local variable with the given index on the stack.
     SET_LOCAL,
+    /// @brief Superinstruction for SET_LOCAL and POP - pops the top value off the stack and stores it in the local
+    /// variable with the given index.
+    SET_LOCAL_POP,
     /// @brief Pops the top two values off the stack, subtracts them, and pushes the result back on the stack.
     SUBTRACT,
+    /// @brief Quickened form of SUBTRACT for two numbers - falls back to SUBTRACT for other operands.
+    SUBTRACT_NUM_NUM,
+    /// @brief Calls the function at the given index on the stack in tail position - a lox function reuses the call
+    /// frame of the calling function, every other callee is called like CALL does.
+    TAIL_CALL,
     /// @brief Pushes the true value onto the stack.
     TRUE,
     AMOUNT
@@ -95,6 +168,18 @@ enum Opcode : uint8_t {
 /// @return The string representation of the given opcode.
 [[nodiscard]] auto opcode_as_string(const Opcode value) -> std::string_view;
 
+/// @brief Gets the amount of values that the given opcode adds to the stack (negative if values are removed)
+/// @details CALL, CALL_INLINED and TAIL_CALL replace the callee with the result and RETURN_INLINED discards the
+/// values below the result, the values that are consumed as well are not known here
+/// @param value The opcode to get the stack effect of.
+/// @return The stack effect of the given opcode.
+[[nodiscard]] auto stack_effect(const Opcode value) -> int8_t;
+
+/// @brief Gets the length of an instruction with the given opcode
+/// @param value The opcode of the instruction.
+/// @return The length of the instruction including its operands in bytes.
+[[nodiscard]] auto instruction_length(const Opcode value) -> size_t;
+
 /// @brief Prints the given opcode to the given output stream.
 /// @param os The output stream to print to.
 /// @param opcode The opcode to print.
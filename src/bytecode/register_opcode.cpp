@@ -0,0 +1,72 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file register_opcode.cpp
+ * @brief This file contains the functions for the RegisterOpcode enum.
+ */
+
+#include "register_opcode.hpp"
+
+[[nodiscard]] auto cppLox::ByteCode::register_opcode_as_string(const cppLox::ByteCode::RegisterOpcode value)
+    -> std::string_view {
+    switch (value) {
+    case RegisterOpcode::ADD:
+        return "ADD";
+    case RegisterOpcode::CALL:
+        return "CALL";
+    case RegisterOpcode::DEFINE_GLOBAL:
+        return "DEFINE_GLOBAL";
+    case RegisterOpcode::DIVIDE:
+        return "DIVIDE";
+    case RegisterOpcode::EQUAL:
+        return "EQUAL";
+    case RegisterOpcode::GET_GLOBAL:
+        return "GET_GLOBAL";
+    case RegisterOpcode::GREATER:
+        return "GREATER";
+    case RegisterOpcode::GREATER_EQUAL:
+        return "GREATER_EQUAL";
+    case RegisterOpcode::JUMP:
+        return "JUMP";
+    case RegisterOpcode::JUMP_IF_FALSE:
+        return "JUMP_IF_FALSE";
+    case RegisterOpcode::LESS:
+        return "LESS";
+    case RegisterOpcode::LESS_EQUAL:
+        return "LESS_EQUAL";
+    case RegisterOpcode::LOOP:
+        return "LOOP";
+    case RegisterOpcode::MOVE:
+        return "MOVE";
+    case RegisterOpcode::MULTIPLY:
+        return "MULTIPLY";
+    case RegisterOpcode::NEGATE:
+        return "NEGATE";
+    case RegisterOpcode::NOT:
+        return "NOT";
+    case RegisterOpcode::NOT_EQUAL:
+        return "NOT_EQUAL";
+    case RegisterOpcode::PRINT:
+        return "PRINT";
+    case RegisterOpcode::RETURN:
+        return "RETURN";
+    case RegisterOpcode::SET_GLOBAL:
+        return "SET_GLOBAL";
+    case RegisterOpcode::SUBTRACT:
+        return "SUBTRACT";
+    }
+    return "Unknown opcode";
+}
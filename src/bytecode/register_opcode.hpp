@@ -0,0 +1,89 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file register_opcode.hpp
+ * @brief This file contains the RegisterOpcode enum and the declaration some functions for it.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace cppLox::ByteCode {
+
+/// @brief Marks an operand that refers to a constant instead of a register
+#define REGISTER_CONSTANT_FLAG 0x8000
+
+/// @brief The opcodes of the register based intermediate language
+/// @details Every register operand is a 16-bit slot index relative to the call frame. Source operands can refer to a
+/// constant instead, if REGISTER_CONSTANT_FLAG is set. The slots of a function are the same positions, that the stack
+/// based bytecode of the function uses.
+enum class RegisterOpcode : uint8_t {
+    /// @brief Adds the two source operands and stores the result in the destination register.
+    ADD,
+    /// @brief Calls the function in the given register with the given amount of arguments in the registers after it,
+    /// the result is stored in the register of the function.
+    CALL,
+    /// @brief Defines the global variable in the given global slot using the source operand.
+    DEFINE_GLOBAL,
+    /// @brief Divides the two source operands and stores the result in the destination register.
+    DIVIDE,
+    /// @brief Compares the two source operands and stores the result in the destination register.
+    EQUAL,
+    /// @brief Loads the global variable in the given global slot into the destination register.
+    GET_GLOBAL,
+    /// @brief Compares the two source operands and stores the result in the destination register.
+    GREATER,
+    /// @brief Compares the two source operands and stores the result in the destination register.
+    GREATER_EQUAL,
+    /// @brief Jumps forward by the given offset.
+    JUMP,
+    /// @brief Jumps forward by the given offset if the source operand is false.
+    JUMP_IF_FALSE,
+    /// @brief Compares the two source operands and stores the result in the destination register.
+    LESS,
+    /// @brief Compares the two source operands and stores the result in the destination register.
+    LESS_EQUAL,
+    /// @brief Jumps backward by the given offset.
+    LOOP,
+    /// @brief Copies the source operand into the destination register.
+    MOVE,
+    /// @brief Multiplies the two source operands and stores the result in the destination register.
+    MULTIPLY,
+    /// @brief Negates the source operand and stores the result in the destination register.
+    NEGATE,
+    /// @brief Inverts the source operand and stores the result in the destination register.
+    NOT,
+    /// @brief Compares the two source operands and stores the result in the destination register.
+    NOT_EQUAL,
+    /// @brief Prints the source operand.
+    PRINT,
+    /// @brief Returns the source operand.
+    RETURN,
+    /// @brief Sets the global variable in the given global slot to the source operand.
+    SET_GLOBAL,
+    /// @brief Subtracts the two source operands and stores the result in the destination register.
+    SUBTRACT,
+    AMOUNT
+};
+
+/// @brief Converts the given register opcode to a string
+/// @param value The register opcode to convert.
+/// @return The string representation of the given register opcode.
+[[nodiscard]] auto register_opcode_as_string(const RegisterOpcode value) -> std::string_view;
+
+} // namespace cppLox::ByteCode
@@ -0,0 +1,33 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file tier.hpp
+ * @brief This file contains the Tier enum.
+ */
+
+#pragma once
+
+namespace cppLox::ByteCode {
+
+/// @brief The bytecode formats that a program can be compiled to and executed in
+enum class Tier {
+    /// @brief Stack based bytecode, where the instructions implicitly operate on the top of the stack
+    STACK,
+    /// @brief Register based bytecode, where the operands of the instructions are slots of the call frame
+    REGISTER
+};
+
+} // namespace cppLox::ByteCode
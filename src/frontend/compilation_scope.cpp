@@ -28,6 +28,10 @@ CompilationScope::CompilationScope(cppLox::Types::ObjectFunction * function, Fun
     m_scopeDepth = 0;
     m_currentFunctionType = type;
     m_localScope = std::make_shared<LocalScope>();
+    // The function that is called occupies the first slot
+    m_stackDepth = 1;
+    m_lastInstruction = -1;
+    m_lastJumpTarget = -1;
 }
 CompilationScope::CompilationScope(std::shared_ptr<CompilationScope> enclosing,
                                    cppLox::Types::ObjectFunction * function, FunctionType type) {
@@ -36,6 +40,10 @@ CompilationScope::CompilationScope(std::shared_ptr<CompilationScope> enclosing,
     m_scopeDepth = 0;
     m_currentFunctionType = type;
     m_localScope = std::make_shared<LocalScope>();
+    // The function that is called occupies the first slot
+    m_stackDepth = 1;
+    m_lastInstruction = -1;
+    m_lastJumpTarget = -1;
 }
 
 auto CompilationScope::enclosing() const -> std::shared_ptr<CompilationScope> const & {
@@ -67,3 +75,50 @@ auto CompilationScope::endScope() -> void {
     m_scopeDepth--;
     m_localScope = m_localScope->enclosing().value();
 }
+
+auto CompilationScope::stackDepth() const -> uint32_t {
+    return m_stackDepth;
+}
+
+auto CompilationScope::adjustStackDepth(int32_t effect) -> void {
+    m_stackDepth += effect;
+    m_function->updateMaxStackDepth(m_stackDepth);
+}
+
+auto CompilationScope::recordJump(int32_t offset) -> void {
+    m_jumpStackDepths[offset] = m_stackDepth;
+}
+
+auto CompilationScope::restoreJump(int32_t offset) -> void {
+    auto jump = m_jumpStackDepths.find(offset);
+    if (jump != m_jumpStackDepths.end()) {
+        m_stackDepth = jump->second;
+        m_jumpStackDepths.erase(jump);
+    }
+}
+
+auto CompilationScope::recordInstruction(int32_t offset) -> void {
+    m_lastInstruction = offset;
+}
+
+auto CompilationScope::recordJumpTarget(int32_t offset) -> void {
+    m_lastJumpTarget = offset;
+}
+
+auto CompilationScope::fusableInstruction(int32_t offset) const -> std::optional<int32_t> {
+    if (m_lastInstruction == -1 || m_lastJumpTarget == offset) {
+        return std::nullopt;
+    }
+    return m_lastInstruction;
+}
+
+auto CompilationScope::referenceConstant(size_t index) -> void {
+    if (index >= m_constantReferences.size()) {
+        m_constantReferences.resize(index + 1, 0);
+    }
+    m_constantReferences[index]++;
+}
+
+[[nodiscard]] auto CompilationScope::releaseConstant(size_t index) -> bool {
+    return --m_constantReferences[index] == 0;
+}
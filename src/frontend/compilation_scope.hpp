@@ -23,6 +23,8 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 #include "../types/object_function.hpp"
 #include "function_type.hpp"
@@ -72,6 +74,48 @@ class CompilationScope {
     /// @brief Ends the current scope.
     auto endScope() -> void;
 
+    /// @brief Gets the amount of values that are on the stack at the current position in the bytecode.
+    [[nodiscard]] auto stackDepth() const -> uint32_t;
+
+    /// @brief Adjusts the stack depth by the effect of an emitted instruction and updates the maximum stack depth of
+    /// the function.
+    /// @param effect The amount of values that are added to the stack (negative if values are removed).
+    auto adjustStackDepth(int32_t effect) -> void;
+
+    /// @brief Remembers the stack depth at the given jump, so it can be restored when the jump is patched.
+    /// @param offset The offset of the jump operand.
+    auto recordJump(int32_t offset) -> void;
+
+    /// @brief Restores the stack depth that was recorded for the given jump.
+    /// @details The bytecode that is emitted after the jump target is reached by both the jump and the instructions
+    /// before it, that leave the same amount of values on the stack as the jump does.
+    /// @param offset The offset of the jump operand.
+    auto restoreJump(int32_t offset) -> void;
+
+    /// @brief Remembers the offset of the instruction that was emitted last.
+    /// @param offset The offset of the opcode of the instruction.
+    auto recordInstruction(int32_t offset) -> void;
+
+    /// @brief Remembers that the given offset is the target of a jump.
+    /// @param offset The offset of the jump target.
+    auto recordJumpTarget(int32_t offset) -> void;
+
+    /// @brief Gets the offset of the instruction that was emitted last, if it can be fused with the instruction that is
+    /// emitted at the given offset.
+    /// @details An instruction can not be fused with its successor, if the successor is the target of a jump.
+    /// @param offset The offset of the instruction that is emitted next.
+    /// @return The offset of the last instruction or an empty optional if the instructions can not be fused.
+    [[nodiscard]] auto fusableInstruction(int32_t offset) const -> std::optional<int32_t>;
+
+    /// @brief Counts an instruction, that loads the constant with the given index.
+    /// @param index The index of the constant in the chunk of the function.
+    auto referenceConstant(size_t index) -> void;
+
+    /// @brief Uncounts an instruction, that loaded the constant with the given index and was removed again.
+    /// @param index The index of the constant in the chunk of the function.
+    /// @return true if no other instruction loads the constant, false otherwise.
+    [[nodiscard]] auto releaseConstant(size_t index) -> bool;
+
   private:
     /// @brief The enclosing scope.
     std::shared_ptr<CompilationScope> m_enclosing;
@@ -87,5 +131,20 @@ class CompilationScope {
 
     /// @brief The current compiler context.
     std::shared_ptr<LocalScope> m_localScope;
+
+    /// @brief The amount of values that are on the stack at the current position in the bytecode.
+    uint32_t m_stackDepth;
+
+    /// @brief The stack depth at the jumps that have not been patched yet.
+    std::unordered_map<int32_t, uint32_t> m_jumpStackDepths;
+
+    /// @brief The offset of the instruction that was emitted last or -1 if no instruction was emitted yet.
+    int32_t m_lastInstruction;
+
+    /// @brief The offset of the last jump target or -1 if there is none.
+    int32_t m_lastJumpTarget;
+
+    /// @brief The amount of instructions, that load each constant, since the constants are shared by the instructions.
+    std::vector<uint32_t> m_constantReferences;
 };
 } // namespace cppLox::Frontend
\ No newline at end of file
@@ -26,12 +26,33 @@
 #include <ranges>
 
 #include "../bytecode/opcode.hpp"
+#include "../middleend/inliner.hpp"
+#include "../middleend/peephole_optimizer.hpp"
+#include "../middleend/ssa_optimizer.hpp"
 #include "../types/object_string.hpp"
 #include "lexer.hpp"
+#include "register_emitter.hpp"
 
 using namespace cppLox::Frontend;
 
-Compiler::Compiler(std::shared_ptr<cppLox::MemoryMutator> memoryMutator) : m_memoryMutator(memoryMutator) {
+Compiler::Compiler(std::shared_ptr<cppLox::MemoryMutator> memoryMutator, cppLox::ByteCode::Tier tier,
+                   CompilerOptions options)
+    : m_memoryMutator(memoryMutator), m_tier(tier),
+      m_superinstructions(options.superinstructions && tier == cppLox::ByteCode::Tier::STACK),
+      m_constantFolding(options.constantFolding), m_peepholeOptimization(options.peepholeOptimization),
+      m_optimize(options.optimize && tier == cppLox::ByteCode::Tier::STACK),
+      m_inlining(options.inlining && tier == cppLox::ByteCode::Tier::STACK) {
+    m_memoryMutator->addRootSource(this);
+}
+
+Compiler::~Compiler() {
+    m_memoryMutator->removeRootSource(this);
+}
+
+auto Compiler::markRoots(cppLox::MemoryMutator & memoryMutator) -> void {
+    for (CompilationScope * scope = m_currentScope.get(); scope != nullptr; scope = scope->enclosing().get()) {
+        memoryMutator.markObject(scope->function());
+    }
 }
 
 auto Compiler::advance(std::vector<Token> const & tokens) -> void {
@@ -71,9 +92,22 @@ auto Compiler::beginScope() -> void {
 
 auto Compiler::binary(std::vector<Token> const & tokens) -> void {
     Token::Type operatorType = m_previous->type();
+    std::optional<FoldableConstant> left = foldableConstant();
+    int32_t const rightStart = currentChunk()->getSize();
     // Compile the right operand.
     ParseRule<cppLox::Frontend::Compiler> * rule = getRule(operatorType);
     parsePrecedence((Precedence)((int)rule->precedence() + 1), tokens);
+    // Only a right operand, that consists of nothing but the constant, can be folded
+    std::optional<FoldableConstant> right = foldableConstant();
+    if (left.has_value() && right.has_value() && right->start == rightStart) {
+        std::optional<cppLox::Types::Value> result = fold(operatorType, left->value, right->value);
+        if (result.has_value()) {
+            retractConstant(right.value());
+            retractConstant(left.value());
+            emitFolded(result.value());
+            return;
+        }
+    }
     // Emit the operator instruction.
     switch (operatorType) {
     case Token::Type::BANG_EQUAL:
@@ -121,6 +155,8 @@ auto Compiler::block(std::vector<Token> const & tokens) -> void {
 auto Compiler::call(std::vector<Token> const & tokens) -> void {
     uint8_t argCount = argumentList(tokens);
     emitBytes(cppLox::ByteCode::Opcode::CALL, argCount);
+    // The arguments are consumed by the call as well
+    m_currentScope->adjustStackDepth(-argCount);
 }
 
 auto Compiler::check(Token::Type type) const -> bool {
@@ -133,13 +169,32 @@ auto Compiler::compile(std::vector<Token> const & tokens) -> std::optional<cppLo
     m_currentTokenIndex = 0;
     m_panicMode = false;
     m_hadError = false;
+    m_compiledFunctions.clear();
     initCompiler(FunctionType::SCRIPT);
     advance(tokens);
     while (m_current->type() != Token::Type::END_OF_FILE) {
         declaration(tokens);
     }
     consume(Token::Type::END_OF_FILE, "Expect end of expression", tokens);
-    return m_hadError == true ? std::nullopt : std::optional<cppLox::Types::ObjectFunction *>(endCompilation());
+    if (m_hadError) {
+        return std::nullopt;
+    }
+    cppLox::Types::ObjectFunction * function = endCompilation();
+    // The callees have to be complete before they are inlined, so the calls are inlined once the unit was compiled
+    if (m_inlining) {
+        [[maybe_unused]] std::vector<cppLox::Types::ObjectFunction *> const callers =
+            cppLox::MiddleEnd::Inliner().optimize(m_compiledFunctions);
+#ifdef DEBUG_PRINT_CODE
+        for (cppLox::Types::ObjectFunction * caller : callers) {
+            caller->chunk()->disassemble(caller->name() != nullptr ? caller->name()->string() : "<script>");
+        }
+#endif
+    }
+    if (m_tier == cppLox::ByteCode::Tier::REGISTER && !RegisterEmitter().emit(*function)) {
+        error("Too many registers or constants for the register tier");
+        return std::nullopt;
+    }
+    return function;
 }
 
 auto Compiler::consume(Token::Type type, std::string message, std::vector<Token> const & tokens) -> void {
@@ -186,12 +241,13 @@ auto Compiler::declareVariable(std::vector<Token> const & tokens) -> void {
     m_currentScope->localScope()->addLocal(*m_previous, [&](std::string & message) { error(message); });
 }
 
-auto Compiler::defineVariable(uint8_t global) -> void {
+auto Compiler::defineVariable(uint16_t global) -> void {
     if (m_currentScope->scopeDepth() > 0) {
         m_currentScope->localScope()->markInitialized(m_currentScope->scopeDepth());
         return;
     }
-    emitBytes(cppLox::ByteCode::Opcode::DEFINE_GLOBAL, global);
+    emitByte(cppLox::ByteCode::Opcode::DEFINE_GLOBAL);
+    emitShort(global);
 }
 
 auto inline Compiler::emitByte(uint8_t byte) -> void {
@@ -199,20 +255,88 @@ auto inline Compiler::emitByte(uint8_t byte) -> void {
 }
 
 auto inline Compiler::emitByte(cppLox::ByteCode::Opcode opcode) -> void {
+    m_currentScope->recordInstruction(currentChunk()->getSize());
     emitByte(static_cast<uint8_t>(opcode));
+    m_currentScope->adjustStackDepth(cppLox::ByteCode::stack_effect(opcode));
+}
+
+auto inline Compiler::emitShort(uint16_t operand) -> void {
+    emitByte(static_cast<uint8_t>((operand >> 8) & 0xff));
+    emitByte(static_cast<uint8_t>(operand & 0xff));
 }
 
 auto inline Compiler::emitConstant(cppLox::Types::Value value) -> void {
-    emitBytes(cppLox::ByteCode::Opcode::CONSTANT, (uint8_t)currentChunk()->addConstant(value));
+    size_t const constant = makeConstant(value);
+    if (constant > UINT8_MAX) {
+        emitByte(cppLox::ByteCode::Opcode::CONSTANT_LONG);
+        emitShort(static_cast<uint16_t>(constant));
+        return;
+    }
+    if (fuseWithLastInstruction(cppLox::ByteCode::Opcode::GET_LOCAL, cppLox::ByteCode::Opcode::GET_LOCAL_CONSTANT,
+                                cppLox::ByteCode::Opcode::CONSTANT)) {
+        emitByte(static_cast<uint8_t>(constant));
+        return;
+    }
+    emitBytes(cppLox::ByteCode::Opcode::CONSTANT, static_cast<uint8_t>(constant));
 }
 
 auto inline Compiler::emitJump(cppLox::ByteCode::Opcode opcode) -> int32_t {
     emitByte(opcode);
+    return emitJumpOffset();
+}
+
+auto inline Compiler::emitJumpOffset() -> int32_t {
     emitByte(0xff);
     emitByte(0xff);
+    m_currentScope->recordJump(currentChunk()->getSize() - 2);
     return currentChunk()->getSize() - 2;
 }
 
+auto Compiler::emitConditionalJump() -> int32_t {
+    if (!m_superinstructions) {
+        int32_t jump = emitJump(cppLox::ByteCode::Opcode::JUMP_IF_FALSE);
+        emitByte(cppLox::ByteCode::Opcode::POP);
+        return jump;
+    }
+    static constexpr std::array<std::pair<cppLox::ByteCode::Opcode, cppLox::ByteCode::Opcode>, 6> comparisons = {
+        {{cppLox::ByteCode::Opcode::EQUAL, cppLox::ByteCode::Opcode::EQUAL_JUMP_IF_FALSE},
+         {cppLox::ByteCode::Opcode::GREATER, cppLox::ByteCode::Opcode::GREATER_JUMP_IF_FALSE},
+         {cppLox::ByteCode::Opcode::GREATER_EQUAL, cppLox::ByteCode::Opcode::GREATER_EQUAL_JUMP_IF_FALSE},
+         {cppLox::ByteCode::Opcode::LESS, cppLox::ByteCode::Opcode::LESS_JUMP_IF_FALSE},
+         {cppLox::ByteCode::Opcode::LESS_EQUAL, cppLox::ByteCode::Opcode::LESS_EQUAL_JUMP_IF_FALSE},
+         {cppLox::ByteCode::Opcode::NOT_EQUAL, cppLox::ByteCode::Opcode::NOT_EQUAL_JUMP_IF_FALSE}}};
+    for (auto const & [comparison, superinstruction] : comparisons) {
+        if (fuseWithLastInstruction(comparison, superinstruction, cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE)) {
+            return emitJumpOffset();
+        }
+    }
+    return emitJump(cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE);
+}
+
+auto Compiler::patchConditionalJump(int32_t offset) -> void {
+    patchJump(offset);
+    if (!m_superinstructions) {
+        emitByte(cppLox::ByteCode::Opcode::POP);
+    }
+}
+
+auto Compiler::emitPop() -> void {
+    if (!fuseWithLastInstruction(cppLox::ByteCode::Opcode::SET_LOCAL, cppLox::ByteCode::Opcode::SET_LOCAL_POP,
+                                 cppLox::ByteCode::Opcode::POP)) {
+        emitByte(cppLox::ByteCode::Opcode::POP);
+    }
+}
+
+auto Compiler::emitTailCall() -> void {
+    if (m_tier != cppLox::ByteCode::Tier::STACK) {
+        return;
+    }
+    std::optional<int32_t> offset = m_currentScope->fusableInstruction(currentChunk()->getSize());
+    if (offset.has_value() && currentChunk()->getByte(offset.value()) == cppLox::ByteCode::Opcode::CALL) {
+        currentChunk()->writeAt(offset.value(), cppLox::ByteCode::Opcode::TAIL_CALL);
+    }
+}
+
 auto inline Compiler::emitLoop(int32_t loopStart) -> void {
     emitByte(cppLox::ByteCode::Opcode::LOOP);
     int32_t offset = currentChunk()->getSize() - loopStart + 2;
@@ -244,9 +368,20 @@ auto Compiler::endScope() -> void {
 auto Compiler::endCompilation() -> cppLox::Types::ObjectFunction * {
     emitReturn();
     cppLox::Types::ObjectFunction * function = m_currentScope->function();
+    if (m_peepholeOptimization) {
+        cppLox::MiddleEnd::PeepholeOptimizer().optimize(*function->chunk());
+    }
+    // Blocks that became empty leave jumps to jumps behind, so the new chunk is cleaned up once more
+    if (m_optimize && cppLox::MiddleEnd::SsaOptimizer().optimize(*function, m_superinstructions) &&
+        m_peepholeOptimization) {
+        cppLox::MiddleEnd::PeepholeOptimizer().optimize(*function->chunk());
+    }
 #ifdef DEBUG_PRINT_CODE
     function->chunk()->disassemble(function->name() != nullptr ? function->name()->string() : "<script>");
 #endif
+    if (m_inlining) {
+        m_compiledFunctions.push_back(function);
+    }
     if (m_currentScope->enclosing().get() != nullptr) {
         m_currentScope = m_currentScope->enclosing();
     }
@@ -278,7 +413,138 @@ auto Compiler::expression(std::vector<Token> const & tokens) -> void {
 auto Compiler::expressionStatement(std::vector<Token> const & tokens) -> void {
     expression(tokens);
     consume(Token::Type::SEMICOLON, "Expect ';' after expression", tokens);
-    emitByte(cppLox::ByteCode::Opcode::POP);
+    emitPop();
+}
+
+auto Compiler::fold(Token::Type operatorType, cppLox::Types::Value const & left, cppLox::Types::Value const & right)
+    -> std::optional<cppLox::Types::Value> {
+    auto isString = [](cppLox::Types::Value const & value) {
+        return value.is(cppLox::Types::Value::Type::OBJECT) &&
+               value.as<cppLox::Types::Object *>()->is(cppLox::Types::Object::Type::STRING);
+    };
+    switch (operatorType) {
+    case Token::Type::BANG_EQUAL:
+        return cppLox::Types::Value(left != right);
+    case Token::Type::EQUAL_EQUAL:
+        return cppLox::Types::Value(left == right);
+    case Token::Type::PLUS:
+        if (isString(left) && isString(right)) {
+            // The concatenation is interned like every other string constant
+            return cppLox::Types::Value(m_memoryMutator->create<cppLox::Types::ObjectString>(
+                left.as<cppLox::Types::Object *>()->as<cppLox::Types::ObjectString>()->string() +
+                right.as<cppLox::Types::Object *>()->as<cppLox::Types::ObjectString>()->string()));
+        }
+        break;
+    default:
+        break;
+    }
+    // The remaining operations are only defined for numbers
+    if (!left.isNumber() || !right.isNumber()) {
+        return std::nullopt;
+    }
+    double const a = left.as<double>();
+    double const b = right.as<double>();
+    switch (operatorType) {
+    case Token::Type::GREATER:
+        return cppLox::Types::Value(a > b);
+    case Token::Type::GREATER_EQUAL:
+        return cppLox::Types::Value(a >= b);
+    case Token::Type::LESS:
+        return cppLox::Types::Value(a < b);
+    case Token::Type::LESS_EQUAL:
+        return cppLox::Types::Value(a <= b);
+    case Token::Type::MINUS:
+        return cppLox::Types::Value(a - b);
+    case Token::Type::PLUS:
+        return cppLox::Types::Value(a + b);
+    case Token::Type::SLASH:
+        return cppLox::Types::Value(a / b);
+    case Token::Type::STAR:
+        return cppLox::Types::Value(a * b);
+    default:
+        return std::nullopt;
+    }
+}
+
+auto Compiler::fold(Token::Type operatorType, cppLox::Types::Value const & operand)
+    -> std::optional<cppLox::Types::Value> {
+    switch (operatorType) {
+    case Token::Type::BANG:
+        return !operand;
+    case Token::Type::MINUS:
+        if (operand.isNumber()) {
+            return cppLox::Types::Value(-operand.as<double>());
+        }
+        return std::nullopt;
+    default:
+        return std::nullopt;
+    }
+}
+
+auto Compiler::foldableConstant() const -> std::optional<FoldableConstant> {
+    if (!m_constantFolding) {
+        return std::nullopt;
+    }
+    std::optional<int32_t> offset = m_currentScope->fusableInstruction(currentChunk()->getSize());
+    if (!offset.has_value()) {
+        return std::nullopt;
+    }
+    int32_t const instruction = offset.value();
+    switch (static_cast<cppLox::ByteCode::Opcode>(currentChunk()->getByte(instruction))) {
+    case cppLox::ByteCode::Opcode::CONSTANT:
+        {
+            size_t const index = currentChunk()->getByte(instruction + 1);
+            return FoldableConstant{instruction, instruction, currentChunk()->getConstant(index), index};
+        }
+    case cppLox::ByteCode::Opcode::CONSTANT_LONG:
+        {
+            size_t const index = static_cast<size_t>(currentChunk()->getByte(instruction + 1) << 8 |
+                                                     currentChunk()->getByte(instruction + 2));
+            return FoldableConstant{instruction, instruction, currentChunk()->getConstant(index), index};
+        }
+    case cppLox::ByteCode::Opcode::GET_LOCAL_CONSTANT:
+        {
+            size_t const index = currentChunk()->getByte(instruction + 2);
+            return FoldableConstant{instruction, instruction + 2, currentChunk()->getConstant(index), index};
+        }
+    case cppLox::ByteCode::Opcode::FALSE:
+        return FoldableConstant{instruction, instruction, cppLox::Types::Value(false), std::nullopt};
+    case cppLox::ByteCode::Opcode::NULL_:
+        return FoldableConstant{instruction, instruction, cppLox::Types::Value(), std::nullopt};
+    case cppLox::ByteCode::Opcode::TRUE:
+        return FoldableConstant{instruction, instruction, cppLox::Types::Value(true), std::nullopt};
+    default:
+        return std::nullopt;
+    }
+}
+
+auto Compiler::retractConstant(FoldableConstant const & constant) -> void {
+    cppLox::ByteCode::Chunk * chunk = currentChunk();
+    auto const opcode = static_cast<cppLox::ByteCode::Opcode>(chunk->getByte(constant.instruction));
+    // Equal constants are shared, so only a constant, that no other instruction loads, can be reused
+    if (constant.index.has_value() && m_currentScope->releaseConstant(constant.index.value()) &&
+        constant.index.value() == chunk->getConstantCount() - 1) {
+        chunk->popConstant();
+    }
+    chunk->truncate(constant.start);
+    if (opcode == cppLox::ByteCode::Opcode::GET_LOCAL_CONSTANT) {
+        // The local is still loaded, so the folded result can be fused with it again
+        chunk->writeAt(constant.instruction, cppLox::ByteCode::Opcode::GET_LOCAL);
+        m_currentScope->recordInstruction(constant.instruction);
+    } else {
+        m_currentScope->recordInstruction(-1);
+    }
+    m_currentScope->adjustStackDepth(-1);
+}
+
+auto Compiler::emitFolded(cppLox::Types::Value value) -> void {
+    if (value.is(cppLox::Types::Value::Type::BOOL)) {
+        emitByte(value.as<bool>() ? cppLox::ByteCode::Opcode::TRUE : cppLox::ByteCode::Opcode::FALSE);
+    } else if (value.is(cppLox::Types::Value::Type::NULL_)) {
+        emitByte(cppLox::ByteCode::Opcode::NULL_);
+    } else {
+        emitConstant(value);
+    }
 }
 
 auto Compiler::forStatement(std::vector<Token> const & tokens) -> void {
@@ -291,19 +557,18 @@ auto Compiler::forStatement(std::vector<Token> const & tokens) -> void {
     } else {
         expressionStatement(tokens);
     }
-    int loopStart = currentChunk()->getSize();
+    int loopStart = markJumpTarget();
     int exitJump = -1;
     if (!match(Token::Type::SEMICOLON, tokens)) {
         expression(tokens);
         consume(Token::Type::SEMICOLON, "Expect ';' after loop condition", tokens);
-        exitJump = emitJump(cppLox::ByteCode::Opcode::JUMP_IF_FALSE);
-        emitByte(cppLox::ByteCode::Opcode::POP);
+        exitJump = emitConditionalJump();
     }
     if (!match(Token::Type::RIGHT_PARENTHESES, tokens)) {
         int bodyJump = emitJump(cppLox::ByteCode::Opcode::JUMP);
-        int incrementStart = currentChunk()->getSize();
+        int incrementStart = markJumpTarget();
         expression(tokens);
-        emitByte(cppLox::ByteCode::Opcode::POP);
+        emitPop();
         consume(Token::Type::RIGHT_PARENTHESES, "Expect ')' after for clauses", tokens);
         emitLoop(loopStart);
         loopStart = incrementStart;
@@ -312,14 +577,27 @@ auto Compiler::forStatement(std::vector<Token> const & tokens) -> void {
     statement(tokens);
     emitLoop(loopStart);
     if (exitJump != -1) {
-        patchJump(exitJump);
-        emitByte(cppLox::ByteCode::Opcode::POP);
+        patchConditionalJump(exitJump);
     }
     endScope();
 }
 
+auto Compiler::fuseWithLastInstruction(cppLox::ByteCode::Opcode last, cppLox::ByteCode::Opcode superinstruction,
+                                       cppLox::ByteCode::Opcode next) -> bool {
+    if (!m_superinstructions) {
+        return false;
+    }
+    std::optional<int32_t> offset = m_currentScope->fusableInstruction(currentChunk()->getSize());
+    if (!offset.has_value() || currentChunk()->getByte(offset.value()) != last) {
+        return false;
+    }
+    currentChunk()->writeAt(offset.value(), superinstruction);
+    m_currentScope->adjustStackDepth(cppLox::ByteCode::stack_effect(next));
+    return true;
+}
+
 auto Compiler::funDeclaration(std::vector<Token> const & tokens) -> void {
-    uint8_t global = parseVariable("Expect function name", tokens);
+    uint16_t global = parseVariable("Expect function name", tokens);
     markInitialized();
     function(FunctionType::FUNCTION, tokens);
     defineVariable(global);
@@ -335,8 +613,10 @@ auto Compiler::function(FunctionType type, std::vector<Token> const & tokens) ->
             if (m_currentScope->function()->arity() > 255) {
                 error("Cannot have more than 255 parameters");
             }
-            uint8_t constant = parseVariable("Expect parameter name", tokens);
+            uint16_t constant = parseVariable("Expect parameter name", tokens);
             defineVariable(constant);
+            // The arguments are already on the stack when the function is called
+            m_currentScope->adjustStackDepth(1);
         } while (match(Token::Type::COMMA, tokens));
     }
     consume(Token::Type::RIGHT_PARENTHESES, "Expect ')' after parameters", tokens);
@@ -350,30 +630,31 @@ auto Compiler::getRule(Token::Type type) -> ParseRule<Compiler> * {
     return &(m_rules[static_cast<size_t>(type)]);
 }
 
-auto Compiler::identifierConstant(Token const & name) -> uint8_t {
-    return currentChunk()->addConstant(
-        cppLox::Types::Value(m_memoryMutator->create<cppLox::Types::ObjectString>(name.lexeme())));
+auto Compiler::identifierSlot(Token const & name) -> uint16_t {
+    size_t const slot = m_memoryMutator->resolveGlobal(
+        m_memoryMutator->create<cppLox::Types::ObjectString>(name.lexeme())->as<cppLox::Types::ObjectString>());
+    if (slot > UINT16_MAX) {
+        error("Too many global variables");
+        return 0;
+    }
+    return static_cast<uint16_t>(slot);
 }
 
 auto Compiler::ifStatement(std::vector<Token> const & tokens) -> void {
     consume(Token::Type::LEFT_PARENTHESES, "Expect '(' after 'if'", tokens);
     expression(tokens);
     consume(Token::Type::RIGHT_PARENTHESES, "Expect ')' after condition", tokens);
-    int thenJump = emitJump(cppLox::ByteCode::Opcode::JUMP_IF_FALSE);
-    emitByte(cppLox::ByteCode::Opcode::POP);
+    int thenJump = emitConditionalJump();
     if (m_current->type() != Token::Type::END_OF_FILE) {
         statement(tokens);
     }
-    patchJump(thenJump);
-    emitByte(cppLox::ByteCode::Opcode::POP);
-    if (match(Token::Type::ELSE, tokens)) {
-        int elseJump = emitJump(cppLox::ByteCode::Opcode::JUMP);
-        patchJump(thenJump);
-        if (m_current->type() != Token::Type::END_OF_FILE) {
-            statement(tokens);
-        }
-        patchJump(elseJump);
+    // The condition is popped exactly once on both paths
+    int elseJump = emitJump(cppLox::ByteCode::Opcode::JUMP);
+    patchConditionalJump(thenJump);
+    if (match(Token::Type::ELSE, tokens) && m_current->type() != Token::Type::END_OF_FILE) {
+        statement(tokens);
     }
+    patchJump(elseJump);
 }
 
 auto Compiler::initCompiler(FunctionType type) -> void {
@@ -409,12 +690,14 @@ auto Compiler::grouping(std::vector<Token> const & tokens, bool canAssign) -> vo
     consume(Token::Type::RIGHT_PARENTHESES, "Expect ')' after expression", tokens);
 }
 
-auto Compiler::makeConstant(cppLox::Types::Value value) -> void {
-    auto constant = currentChunk()->addConstant(value);
-    if (constant > UINT8_MAX) {
+auto Compiler::makeConstant(cppLox::Types::Value value) -> size_t {
+    size_t const constant = currentChunk()->addConstant(value);
+    if (constant > UINT16_MAX) {
         error("Too many constants in one chunk");
+        return 0;
     }
-    emitBytes(static_cast<uint8_t>(cppLox::ByteCode::Opcode::CONSTANT), (uint8_t)constant);
+    m_currentScope->referenceConstant(constant);
+    return constant;
 }
 
 auto Compiler::markInitialized() -> void {
@@ -424,6 +707,11 @@ auto Compiler::markInitialized() -> void {
     m_currentScope->localScope()->markInitialized(m_currentScope->scopeDepth());
 }
 
+auto Compiler::markJumpTarget() -> int32_t {
+    m_currentScope->recordJumpTarget(currentChunk()->getSize());
+    return currentChunk()->getSize();
+}
+
 auto Compiler::match(Token::Type type, std::vector<Token> const & tokens) -> bool {
     if (m_current->type() != type) {
         return false;
@@ -433,21 +721,32 @@ auto Compiler::match(Token::Type type, std::vector<Token> const & tokens) -> boo
 }
 
 auto Compiler::namedVariable(Token const & name, std::vector<Token> const & tokens, bool canAssign) -> void {
-    uint8_t getOp, setOp;
+    cppLox::ByteCode::Opcode getOp, setOp;
     int32_t arg = resolveLocal(name, *m_currentScope->localScope().get());
     if (arg != -1) {
         getOp = cppLox::ByteCode::Opcode::GET_LOCAL;
         setOp = cppLox::ByteCode::Opcode::SET_LOCAL;
     } else {
-        arg = identifierConstant(name);
+        arg = identifierSlot(name);
         getOp = cppLox::ByteCode::Opcode::GET_GLOBAL;
         setOp = cppLox::ByteCode::Opcode::SET_GLOBAL;
     }
     if (canAssign && match(Token::Type::EQUAL, tokens)) {
         expression(tokens);
-        emitBytes(setOp, (uint8_t)arg);
+        emitByte(setOp);
+    } else if (getOp == cppLox::ByteCode::Opcode::GET_LOCAL &&
+               fuseWithLastInstruction(cppLox::ByteCode::Opcode::GET_LOCAL,
+                                       cppLox::ByteCode::Opcode::GET_LOCAL_GET_LOCAL, getOp)) {
+        emitByte((uint8_t)arg);
+        return;
     } else {
-        emitBytes(getOp, (uint8_t)arg);
+        emitByte(getOp);
+    }
+    // Locals are addressed by a one byte stack slot, globals by a two byte global slot
+    if (getOp == cppLox::ByteCode::Opcode::GET_GLOBAL) {
+        emitShort((uint16_t)arg);
+    } else {
+        emitByte((uint8_t)arg);
     }
 }
 
@@ -488,13 +787,13 @@ auto Compiler::parsePrecedence(Precedence precedence, std::vector<Token> const &
     }
 }
 
-auto Compiler::parseVariable(std::string message, std::vector<Token> const & tokens) -> uint8_t {
+auto Compiler::parseVariable(std::string message, std::vector<Token> const & tokens) -> uint16_t {
     consume(Token::Type::IDENTIFIER, message, tokens);
     declareVariable(tokens);
     if (m_currentScope->scopeDepth() > 0) {
         return 0;
     }
-    return identifierConstant(*m_previous);
+    return identifierSlot(*m_previous);
 }
 
 auto Compiler::patchJump(int32_t offset) -> void {
@@ -505,6 +804,8 @@ auto Compiler::patchJump(int32_t offset) -> void {
     }
     currentChunk()->writeAt(offset, (jump >> 8) & 0xff);
     currentChunk()->writeAt(offset + 1, jump & 0xff);
+    m_currentScope->restoreJump(offset);
+    markJumpTarget();
 }
 
 auto Compiler::printStatement(std::vector<Token> const & tokens, bool canAssign) -> void {
@@ -523,6 +824,7 @@ auto Compiler::returnStatement(std::vector<Token> const & tokens) -> void {
     } else {
         expression(tokens);
         consume(Token::Type::SEMICOLON, "Expect ';' after return value", tokens);
+        emitTailCall();
         emitByte(cppLox::ByteCode::Opcode::RETURN);
     }
 }
@@ -598,7 +900,7 @@ auto Compiler::variable(std::vector<Token> const & tokens, bool canAssign) -> vo
 }
 
 auto Compiler::variableDeclaration(std::vector<Token> const & tokens) -> void {
-    uint8_t global = parseVariable("Expect variable name", tokens);
+    uint16_t global = parseVariable("Expect variable name", tokens);
     if (match(Token::Type::EQUAL, tokens)) {
         expression(tokens);
     } else {
@@ -610,7 +912,17 @@ auto Compiler::variableDeclaration(std::vector<Token> const & tokens) -> void {
 
 auto Compiler::unary(std::vector<Token> const & tokens, bool canAssign) -> void {
     auto operatorType = m_previous->type();
+    int32_t const operandStart = currentChunk()->getSize();
     parsePrecedence(Precedence::UNARY, tokens);
+    std::optional<FoldableConstant> operand = foldableConstant();
+    if (operand.has_value() && operand->start == operandStart) {
+        std::optional<cppLox::Types::Value> result = fold(operatorType, operand->value);
+        if (result.has_value()) {
+            retractConstant(operand.value());
+            emitFolded(result.value());
+            return;
+        }
+    }
     switch (operatorType) {
     case Token::Type::BANG:
         emitByte(cppLox::ByteCode::Opcode::NOT);
@@ -624,14 +936,12 @@ auto Compiler::unary(std::vector<Token> const & tokens, bool canAssign) -> void
 }
 
 auto Compiler::whileStatement(std::vector<Token> const & tokens) -> void {
-    int32_t loopStart = currentChunk()->getSize();
+    int32_t loopStart = markJumpTarget();
     consume(Token::Type::LEFT_PARENTHESES, "Expect '(' after 'while'", tokens);
     expression(tokens);
     consume(Token::Type::RIGHT_PARENTHESES, "Expect ')' after condition", tokens);
-    int32_t exitJump = emitJump(cppLox::ByteCode::Opcode::JUMP_IF_FALSE);
-    emitByte(cppLox::ByteCode::Opcode::POP);
+    int32_t exitJump = emitConditionalJump();
     statement(tokens);
     emitLoop(loopStart);
-    patchJump(exitJump);
-    emitByte(cppLox::ByteCode::Opcode::POP);
+    patchConditionalJump(exitJump);
 }
\ No newline at end of file
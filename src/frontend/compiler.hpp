@@ -29,9 +29,11 @@
 #include <vector>
 
 #include "../bytecode/chunk.hpp"
+#include "../bytecode/tier.hpp"
 #include "../memory_mutator.hpp"
 #include "../types/object_function.hpp"
 #include "compilation_scope.hpp"
+#include "compiler_options.hpp"
 #include "function_type.hpp"
 #include "parse_rule.hpp"
 #include "precedence.hpp"
@@ -43,14 +45,28 @@ template <typename T1, typename T2, class... Args>
 concept IsPackOfEitherOf = (... && (std::is_same_v<Args, T1> || std::is_same_v<Args, T2>));
 
 /// @brief The compiler used by the cpplox interpreter.
-class Compiler {
+class Compiler : public cppLox::RootSource {
 
   public:
     /// @brief Constructs a new compiler.
-    Compiler(std::shared_ptr<cppLox::MemoryMutator> memoryMutator);
+    /// @param memoryMutator The memory mutator used to allocate the objects of the compiled program.
+    /// @param tier The tier of the virtual machine the program is compiled for.
+    /// @param options The optimizations applied to the compiled program.
+    Compiler(std::shared_ptr<cppLox::MemoryMutator> memoryMutator,
+             cppLox::ByteCode::Tier tier = cppLox::ByteCode::Tier::STACK, CompilerOptions options = {});
 
     /// @brief Destructor of the compiler.
-    ~Compiler() = default;
+    ~Compiler() override;
+
+    /// @brief The compiler is registered as a root source by its address, so it can not be copied.
+    Compiler(Compiler const &) = delete;
+
+    /// @brief The compiler is registered as a root source by its address, so it can not be copied.
+    auto operator=(Compiler const &) -> Compiler & = delete;
+
+    /// @brief Marks the functions, that are being compiled, as reachable.
+    /// @param memoryMutator The memory mutator that collects the garbage.
+    auto markRoots(cppLox::MemoryMutator & memoryMutator) -> void override;
 
     /// @brief Compiles the given tokens.
     /// @param tokens The tokens that are compiled.
@@ -58,6 +74,19 @@ class Compiler {
     [[nodiscard]] auto compile(std::vector<Token> const & tokens) -> std::optional<cppLox::Types::ObjectFunction *>;
 
   private:
+    /// @brief A constant, that is loaded by the last instruction of the chunk and can be folded into an operation.
+    struct FoldableConstant {
+        /// @brief The offset of the instruction that loads the constant.
+        int32_t instruction;
+        /// @brief The offset the bytecode of the constant starts at. Behind the instruction, if the constant was fused
+        /// into a superinstruction that loads a local first.
+        int32_t start;
+        /// @brief The value of the constant.
+        cppLox::Types::Value value;
+        /// @brief The index of the constant in the chunk or an empty optional if it is loaded by its own instruction.
+        std::optional<size_t> index;
+    };
+
     /// @brief Advances to the next token.
     /// @param tokens The tokens that are compiled.
     auto advance(std::vector<Token> const & tokens) -> void;
@@ -104,9 +133,9 @@ class Compiler {
     /// @param tokens The tokens that are compiled.
     auto declareVariable(std::vector<Token> const & tokens) -> void;
 
-    /// @brief Emits a DEFINE_GLOBAL opcode and the index of the variable in the chunk.
-    /// @param global The index of the variable in the chunk.
-    auto defineVariable(uint8_t global) -> void;
+    /// @brief Emits a DEFINE_GLOBAL opcode and the slot of the variable.
+    /// @param global The slot of the global variable.
+    auto defineVariable(uint16_t global) -> void;
 
     /// @brief Emits a byte.
     /// @param byte The byte to emit.
@@ -127,6 +156,10 @@ class Compiler {
     /// @param byte The byte to emit.
     auto inline emitByte(cppLox::ByteCode::Opcode byte) -> void;
 
+    /// @brief Emits a two byte operand.
+    /// @param operand The operand to emit.
+    auto inline emitShort(uint16_t operand) -> void;
+
     /// @brief Emits a constant.
     /// @param value The value to emit.
     auto inline emitConstant(cppLox::Types::Value value) -> void;
@@ -136,6 +169,39 @@ class Compiler {
     /// @return The index of the jump instruction in the chunk.
     auto inline emitJump(cppLox::ByteCode::Opcode opcode) -> int32_t;
 
+    /// @brief Emits the placeholder for the offset of a jump instruction, whose opcode was already emitted.
+    /// @return The index of the offset in the chunk.
+    auto inline emitJumpOffset() -> int32_t;
+
+    /// @brief Emits a jump, that is taken if the condition on top of the stack is false, and pops the condition.
+    /// @details If the condition is a comparison, the comparison is fused with the jump.
+    /// @return The index of the jump offset in the chunk.
+    auto emitConditionalJump() -> int32_t;
+
+    /// @brief Patches a jump emitted by emitConditionalJump, popping the condition if the jump did not.
+    /// @param offset The index of the jump offset in the chunk.
+    auto patchConditionalJump(int32_t offset) -> void;
+
+    /// @brief Emits a POP instruction, that is fused with the instruction before it if possible.
+    auto emitPop() -> void;
+
+    /// @brief Turns the call, that was emitted last, into a tail call, before the returned value is returned.
+    /// @details Only a call that is the last instruction before the RETURN and no jump target is in tail position.
+    auto emitTailCall() -> void;
+
+    /// @brief Replaces the last instruction with the given superinstruction, if it has the given opcode and can be
+    /// fused with the instruction that is emitted next.
+    /// @param last The opcode the last instruction needs to have.
+    /// @param superinstruction The superinstruction that replaces the last instruction.
+    /// @param next The instruction that is fused into the superinstruction, its operands still need to be emitted.
+    /// @return true if the instructions were fused, false otherwise.
+    auto fuseWithLastInstruction(cppLox::ByteCode::Opcode last, cppLox::ByteCode::Opcode superinstruction,
+                                 cppLox::ByteCode::Opcode next) -> bool;
+
+    /// @brief Marks the current end of the chunk as a jump target, so it is not fused with the instruction before it.
+    /// @return The index of the jump target in the chunk.
+    auto markJumpTarget() -> int32_t;
+
     /// @brief Emits a loop instruction.
     /// @param loopStart The index of the loop start.
     auto inline emitLoop(int32_t loopStart) -> void;
@@ -168,6 +234,34 @@ class Compiler {
     /// @param tokens The tokens that are compiled.
     auto expressionStatement(std::vector<Token> const & tokens) -> void;
 
+    /// @brief Evaluates a binary operation on two constants at compile time.
+    /// @param operatorType The type of the operator token.
+    /// @param left The left operand.
+    /// @param right The right operand.
+    /// @return The result or an empty optional if the operation has to report an error at runtime.
+    [[nodiscard]] auto fold(Token::Type operatorType, cppLox::Types::Value const & left,
+                            cppLox::Types::Value const & right) -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Evaluates a unary operation on a constant at compile time.
+    /// @param operatorType The type of the operator token.
+    /// @param operand The operand.
+    /// @return The result or an empty optional if the operation has to report an error at runtime.
+    [[nodiscard]] auto fold(Token::Type operatorType, cppLox::Types::Value const & operand)
+        -> std::optional<cppLox::Types::Value>;
+
+    /// @brief Gets the constant that is loaded by the last instruction, if it can be folded into the next operation.
+    /// @details Like fusing, folding is not possible if the end of the chunk is the target of a jump.
+    /// @return The constant or an empty optional if the last instruction does not load a constant.
+    [[nodiscard]] auto foldableConstant() const -> std::optional<FoldableConstant>;
+
+    /// @brief Removes the instruction, that loads the given constant, from the end of the chunk.
+    /// @param constant The constant that was folded.
+    auto retractConstant(FoldableConstant const & constant) -> void;
+
+    /// @brief Emits the instruction that loads the result of a folded operation.
+    /// @param value The result of the operation.
+    auto emitFolded(cppLox::Types::Value value) -> void;
+
     /// @brief Compiles a for statement.
     /// @param tokens The tokens that are compiled.
     auto forStatement(std::vector<Token> const & tokens) -> void;
@@ -185,10 +279,10 @@ class Compiler {
     /// @return The rule for the given token type.
     [[nodiscard]] auto getRule(Token::Type type) -> ParseRule<Compiler> *;
 
-    /// @brief Compiles an identifier expression.
+    /// @brief Resolves the slot of the global variable with the name of the identifier.
     /// @param name The name of the identifier.
-    /// @return The index of the identifier in the chunk.
-    [[nodiscard]] auto identifierConstant(Token const & name) -> uint8_t;
+    /// @return The slot of the global variable.
+    [[nodiscard]] auto identifierSlot(Token const & name) -> uint16_t;
 
     /// @brief Compiles an if statement.
     /// @param tokens The tokens that are compiled.
@@ -202,9 +296,10 @@ class Compiler {
     /// @param tokens The tokens that are compiled.
     auto literal(std::vector<Token> const & tokens, bool canAssign) -> void;
 
-    /// @brief Makes a constant from the given value.
+    /// @brief Makes a constant from the given value, that is loaded by the instruction that is emitted next.
     /// @param value The value to make a constant from.
-    auto makeConstant(cppLox::Types::Value value) -> void;
+    /// @return The index of the constant in the current chunk.
+    [[nodiscard]] auto makeConstant(cppLox::Types::Value value) -> size_t;
 
     auto markInitialized() -> void;
 
@@ -237,8 +332,8 @@ class Compiler {
     /// @brief Parses a variable.
     /// @param errorMessage The error message to display if no identifier is detected.
     /// @param tokens The tokens that are compiled.
-    /// @return The index of the variable in the chunk.
-    [[nodiscard]] auto parseVariable(std::string errorMessage, std::vector<Token> const & tokens) -> uint8_t;
+    /// @return The slot of the variable, if it is a global variable.
+    [[nodiscard]] auto parseVariable(std::string errorMessage, std::vector<Token> const & tokens) -> uint16_t;
 
     /// @brief Changes the size of the jump offset at the given offset in the chunk.
     /// @param offset The offset of the jump instruction.
@@ -377,6 +472,20 @@ class Compiler {
     size_t m_currentTokenIndex;
     /// @brief The memory manager.
     std::shared_ptr<cppLox::MemoryMutator> m_memoryMutator;
+    /// @brief The tier of the virtual machine the program is compiled for.
+    cppLox::ByteCode::Tier m_tier;
+    /// @brief Whether common instruction sequences are fused into superinstructions.
+    bool m_superinstructions;
+    /// @brief Whether operations on literals are evaluated at compile time.
+    bool m_constantFolding;
+    /// @brief Whether the bytecode of the compiled functions is optimized by the peephole optimizer.
+    bool m_peepholeOptimization;
+    /// @brief Whether the compiled functions are optimized in ssa form.
+    bool m_optimize;
+    /// @brief Whether the calls of small functions are inlined into their callers.
+    bool m_inlining;
+    /// @brief The functions compiled in the current compilation unit, that calls are inlined between.
+    std::vector<cppLox::Types::ObjectFunction *> m_compiledFunctions;
     /// @brief The rules for the different token types.
     static inline std::array<ParseRule<Compiler>, static_cast<size_t>(Token::Type::AMOUNT)> m_rules = makeRules();
     /// @brief Whether the compiler is in panic mode.
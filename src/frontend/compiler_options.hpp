@@ -0,0 +1,41 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+
+/**
+ * @file compiler_options.hpp
+ * @brief This file contains the CompilerOptions struct.
+ */
+
+#pragma once
+
+namespace cppLox::Frontend {
+
+/// @brief The optimizations the compiler applies to the compiled program.
+struct CompilerOptions {
+    /// @brief Whether common instruction sequences are fused into superinstructions. Only used by the stack tier, the
+    /// register tier fuses instructions itself.
+    bool superinstructions = true;
+    /// @brief Whether operations, whose operands are all literals, are evaluated at compile time.
+    bool constantFolding = true;
+    /// @brief Whether the bytecode of every compiled function is optimized by the peephole optimizer.
+    bool peepholeOptimization = true;
+    /// @brief Whether every compiled function is optimized in ssa form. Only used by the stack tier.
+    bool optimize = false;
+    /// @brief Whether the calls of small functions are inlined into their callers. Only used by the stack tier.
+    bool inlining = false;
+};
+
+} // namespace cppLox::Frontend
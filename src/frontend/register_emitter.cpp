@@ -0,0 +1,406 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file register_emitter.cpp
+ * @brief This file contains the implementation of the RegisterEmitter class.
+ */
+
+#include "register_emitter.hpp"
+
+#include "../bytecode/opcode.hpp"
+
+using namespace cppLox::Frontend;
+
+using cppLox::ByteCode::instruction_length;
+using cppLox::ByteCode::Opcode;
+using cppLox::ByteCode::RegisterOpcode;
+
+/// @brief Gets the register opcode of an arithmetic or comparison stack opcode
+/// @param opcode The stack opcode
+/// @return The register opcode that performs the same operation
+static auto registerOpcode(Opcode opcode) -> RegisterOpcode {
+    switch (opcode) {
+    case Opcode::ADD:
+        return RegisterOpcode::ADD;
+    case Opcode::DIVIDE:
+        return RegisterOpcode::DIVIDE;
+    case Opcode::EQUAL:
+        return RegisterOpcode::EQUAL;
+    case Opcode::GREATER:
+        return RegisterOpcode::GREATER;
+    case Opcode::GREATER_EQUAL:
+        return RegisterOpcode::GREATER_EQUAL;
+    case Opcode::LESS:
+        return RegisterOpcode::LESS;
+    case Opcode::LESS_EQUAL:
+        return RegisterOpcode::LESS_EQUAL;
+    case Opcode::MULTIPLY:
+        return RegisterOpcode::MULTIPLY;
+    case Opcode::NEGATE:
+        return RegisterOpcode::NEGATE;
+    case Opcode::NOT:
+        return RegisterOpcode::NOT;
+    case Opcode::NOT_EQUAL:
+        return RegisterOpcode::NOT_EQUAL;
+    default:
+        return RegisterOpcode::SUBTRACT;
+    }
+}
+
+[[nodiscard]] auto RegisterEmitter::emit(cppLox::Types::ObjectFunction & function) -> bool {
+    if (function.registerChunk() != nullptr) {
+        return true;
+    }
+    // The functions that are declared in the function are stored in its constants
+    for (size_t index = 0; index < function.chunk()->getConstantCount(); index++) {
+        cppLox::Types::Value constant = function.chunk()->getConstant(index);
+        if (constant.is(cppLox::Types::Value::Type::OBJECT) &&
+            constant.as<cppLox::Types::Object *>()->is(cppLox::Types::Object::Type::FUNCTION)) {
+            if (!emit(*constant.as<cppLox::Types::Object *>()->as<cppLox::Types::ObjectFunction>())) {
+                return false;
+            }
+        }
+    }
+    m_source = function.chunk();
+    m_target = std::make_unique<cppLox::ByteCode::Chunk>();
+    // The function and its arguments are already stored in the first registers
+    m_stack.assign(function.arity() + 1, Operand{Operand::Kind::SLOT, 0});
+    m_jumpTargets.clear();
+    m_jumpDepths.clear();
+    m_labels.clear();
+    m_forwardJumps.clear();
+    m_specialConstants.clear();
+    m_line = 0;
+    m_failed = false;
+    // The register bytecode uses the same constant indices as the stack bytecode
+    for (size_t index = 0; index < m_source->getConstantCount(); index++) {
+        static_cast<void>(m_target->addConstant(m_source->getConstant(index)));
+    }
+    translate();
+    if (m_failed) {
+        return false;
+    }
+    function.setRegisterChunk(std::move(m_target));
+    return true;
+}
+
+auto RegisterEmitter::translate() -> void {
+    std::vector<uint8_t> const & code = m_source->code();
+    for (size_t offset = 0; offset < code.size(); offset += instruction_length(static_cast<Opcode>(code[offset]))) {
+        if (code[offset] == Opcode::JUMP || code[offset] == Opcode::JUMP_IF_FALSE) {
+            m_jumpTargets.insert(offset + 3 + static_cast<size_t>(code[offset + 1] << 8 | code[offset + 2]));
+        } else if (code[offset] == Opcode::LOOP) {
+            m_jumpTargets.insert(offset + 3 - static_cast<size_t>(code[offset + 1] << 8 | code[offset + 2]));
+        }
+    }
+
+    bool reachable = true;
+    for (size_t offset = 0; offset <= code.size();) {
+        if (m_jumpTargets.contains(offset)) {
+            // Every path that reaches a jump target has to leave the values in their registers
+            if (reachable) {
+                flush();
+            } else if (auto depth = m_jumpDepths.find(offset); depth != m_jumpDepths.end()) {
+                m_stack.assign(depth->second, Operand{Operand::Kind::SLOT, 0});
+            }
+            m_labels[offset] = m_target->getSize();
+            reachable = true;
+        }
+        if (offset == code.size()) {
+            break;
+        }
+        m_line = static_cast<int>(m_source->getLine(offset));
+        auto const opcode = static_cast<Opcode>(code[offset]);
+        size_t next = offset + instruction_length(opcode);
+        switch (opcode) {
+        case Opcode::ADD:
+        case Opcode::DIVIDE:
+        case Opcode::EQUAL:
+        case Opcode::GREATER:
+        case Opcode::GREATER_EQUAL:
+        case Opcode::LESS:
+        case Opcode::LESS_EQUAL:
+        case Opcode::MULTIPLY:
+        case Opcode::NOT_EQUAL:
+        case Opcode::SUBTRACT:
+            {
+                Operand const right = m_stack.back();
+                m_stack.pop_back();
+                Operand const left = m_stack.back();
+                m_stack.pop_back();
+                size_t const reg = destination(m_stack.size(), next);
+                emitOpcode(registerOpcode(opcode));
+                emitShort(reg);
+                emitSource(left, m_stack.size());
+                emitSource(right, m_stack.size() + 1);
+                pushResult(reg);
+                break;
+            }
+        case Opcode::NEGATE:
+        case Opcode::NOT:
+            {
+                Operand const operand = m_stack.back();
+                m_stack.pop_back();
+                size_t const reg = destination(m_stack.size(), next);
+                emitOpcode(registerOpcode(opcode));
+                emitShort(reg);
+                emitSource(operand, m_stack.size());
+                pushResult(reg);
+                break;
+            }
+        case Opcode::CALL:
+            {
+                size_t const argCount = code[offset + 1];
+                size_t const callee = m_stack.size() - argCount - 1;
+                // The callee uses the function and the arguments as the first registers of its frame
+                for (size_t position = callee; position < m_stack.size(); position++) {
+                    materialize(position);
+                }
+                emitOpcode(RegisterOpcode::CALL);
+                emitShort(callee);
+                emitByte(static_cast<uint8_t>(argCount));
+                m_stack.resize(callee);
+                pushResult(callee);
+                break;
+            }
+        case Opcode::CONSTANT:
+            m_stack.push_back(Operand{Operand::Kind::CONSTANT, code[offset + 1]});
+            break;
+        case Opcode::CONSTANT_LONG:
+            m_stack.push_back(
+                Operand{Operand::Kind::CONSTANT, static_cast<uint16_t>(code[offset + 1] << 8 | code[offset + 2])});
+            break;
+        case Opcode::FALSE:
+            m_stack.push_back(Operand{Operand::Kind::CONSTANT, constant(cppLox::Types::Value(false))});
+            break;
+        case Opcode::NULL_:
+            m_stack.push_back(Operand{Operand::Kind::CONSTANT, constant(cppLox::Types::Value())});
+            break;
+        case Opcode::TRUE:
+            m_stack.push_back(Operand{Operand::Kind::CONSTANT, constant(cppLox::Types::Value(true))});
+            break;
+        case Opcode::DEFINE_GLOBAL:
+            emitOpcode(RegisterOpcode::DEFINE_GLOBAL);
+            emitShort(static_cast<uint16_t>(code[offset + 1] << 8 | code[offset + 2]));
+            emitSource(m_stack.back(), m_stack.size() - 1);
+            m_stack.pop_back();
+            break;
+        case Opcode::GET_GLOBAL:
+            {
+                // Globals can be changed by every call, so they are always loaded into a register
+                size_t const reg = destination(m_stack.size(), next);
+                emitOpcode(RegisterOpcode::GET_GLOBAL);
+                emitShort(reg);
+                emitShort(static_cast<uint16_t>(code[offset + 1] << 8 | code[offset + 2]));
+                pushResult(reg);
+                break;
+            }
+        case Opcode::SET_GLOBAL:
+            emitOpcode(RegisterOpcode::SET_GLOBAL);
+            emitShort(static_cast<uint16_t>(code[offset + 1] << 8 | code[offset + 2]));
+            emitSource(m_stack.back(), m_stack.size() - 1);
+            break;
+        case Opcode::GET_LOCAL:
+            {
+                // The stack bytecode stores the locals after the slot of the function
+                size_t const reg = code[offset + 1] + 1;
+                if (reg < m_stack.size()) {
+                    materialize(reg);
+                }
+                m_stack.push_back(Operand{Operand::Kind::REGISTER, static_cast<uint16_t>(reg)});
+                break;
+            }
+        case Opcode::SET_LOCAL:
+            {
+                size_t const reg = code[offset + 1] + 1;
+                size_t const top = m_stack.size() - 1;
+                materializeReadsOf(reg, top);
+                Operand const value = m_stack.back();
+                if (!(value.kind == Operand::Kind::REGISTER && value.index == reg)) {
+                    emitOpcode(RegisterOpcode::MOVE);
+                    emitShort(reg);
+                    emitSource(value, top);
+                }
+                m_stack.pop_back();
+                pushResult(reg);
+                break;
+            }
+        case Opcode::JUMP:
+            {
+                size_t const target = next + static_cast<size_t>(code[offset + 1] << 8 | code[offset + 2]);
+                flush();
+                emitOpcode(RegisterOpcode::JUMP);
+                m_forwardJumps.emplace_back(m_target->getSize(), target);
+                emitShort(0);
+                m_jumpDepths[target] = m_stack.size();
+                reachable = false;
+                break;
+            }
+        case Opcode::JUMP_IF_FALSE:
+            {
+                size_t const target = next + static_cast<size_t>(code[offset + 1] << 8 | code[offset + 2]);
+                for (size_t position = 0; position + 1 < m_stack.size(); position++) {
+                    materialize(position);
+                }
+                // The condition only needs to be stored if it is still used after the jump, like the result of and/or
+                bool const conditionDropped = next < code.size() && code[next] == Opcode::POP &&
+                                              target < code.size() && code[target] == Opcode::POP;
+                if (!conditionDropped) {
+                    materialize(m_stack.size() - 1);
+                }
+                emitOpcode(RegisterOpcode::JUMP_IF_FALSE);
+                emitSource(m_stack.back(), m_stack.size() - 1);
+                m_forwardJumps.emplace_back(m_target->getSize(), target);
+                emitShort(0);
+                m_jumpDepths[target] = m_stack.size();
+                break;
+            }
+        case Opcode::LOOP:
+            {
+                size_t const target = next - static_cast<size_t>(code[offset + 1] << 8 | code[offset + 2]);
+                flush();
+                emitOpcode(RegisterOpcode::LOOP);
+                emitShort(m_target->getSize() + 2 - m_labels[target]);
+                reachable = false;
+                break;
+            }
+        case Opcode::POP:
+            m_stack.pop_back();
+            break;
+        case Opcode::PRINT:
+            emitOpcode(RegisterOpcode::PRINT);
+            emitSource(m_stack.back(), m_stack.size() - 1);
+            m_stack.pop_back();
+            break;
+        case Opcode::RETURN:
+            emitOpcode(RegisterOpcode::RETURN);
+            emitSource(m_stack.back(), m_stack.size() - 1);
+            m_stack.pop_back();
+            reachable = false;
+            break;
+        default:
+            m_failed = true;
+            return;
+        }
+        offset = next;
+    }
+
+    for (auto const & [operand, target] : m_forwardJumps) {
+        size_t const jump = m_labels[target] - (operand + 2);
+        if (jump > UINT16_MAX) {
+            m_failed = true;
+            return;
+        }
+        m_target->writeAt(operand, (jump >> 8) & 0xff);
+        m_target->writeAt(operand + 1, jump & 0xff);
+    }
+}
+
+auto RegisterEmitter::emitByte(uint8_t byte) -> void {
+    m_target->write(byte, m_line);
+}
+
+auto RegisterEmitter::emitOpcode(RegisterOpcode opcode) -> void {
+    emitByte(static_cast<uint8_t>(opcode));
+}
+
+auto RegisterEmitter::emitShort(size_t operand) -> void {
+    if (operand > UINT16_MAX) {
+        m_failed = true;
+    }
+    emitByte((operand >> 8) & 0xff);
+    emitByte(operand & 0xff);
+}
+
+auto RegisterEmitter::emitSource(Operand const & operand, size_t position) -> void {
+    size_t const index = operand.kind == Operand::Kind::SLOT ? position : operand.index;
+    if (index >= REGISTER_CONSTANT_FLAG) {
+        m_failed = true;
+    }
+    emitShort(operand.kind == Operand::Kind::CONSTANT ? index | REGISTER_CONSTANT_FLAG : index);
+}
+
+auto RegisterEmitter::materialize(size_t position) -> void {
+    Operand const operand = m_stack[position];
+    if (operand.kind == Operand::Kind::SLOT) {
+        return;
+    }
+    if (!(operand.kind == Operand::Kind::REGISTER && operand.index == position)) {
+        emitOpcode(RegisterOpcode::MOVE);
+        emitShort(position);
+        emitSource(operand, position);
+    }
+    m_stack[position] = Operand{Operand::Kind::SLOT, 0};
+}
+
+auto RegisterEmitter::flush() -> void {
+    for (size_t position = 0; position < m_stack.size(); position++) {
+        materialize(position);
+    }
+}
+
+auto RegisterEmitter::materializeReadsOf(size_t reg, size_t end) -> void {
+    for (size_t position = 0; position < end; position++) {
+        if (m_stack[position].kind == Operand::Kind::REGISTER && m_stack[position].index == reg) {
+            materialize(position);
+        }
+    }
+}
+
+[[nodiscard]] auto RegisterEmitter::isRead(size_t reg, size_t end) const -> bool {
+    for (size_t position = 0; position < end; position++) {
+        if (m_stack[position].kind == Operand::Kind::REGISTER && m_stack[position].index == reg) {
+            return true;
+        }
+    }
+    return false;
+}
+
+[[nodiscard]] auto RegisterEmitter::destination(size_t position, size_t & offset) -> size_t {
+    std::vector<uint8_t> const & code = m_source->code();
+    if (offset + 1 < code.size() && code[offset] == Opcode::SET_LOCAL && !m_jumpTargets.contains(offset)) {
+        size_t const reg = code[offset + 1] + 1;
+        // Another value on the stack still needs the old value of the local
+        if (!isRead(reg, position)) {
+            offset += instruction_length(Opcode::SET_LOCAL);
+            return reg;
+        }
+    }
+    return position;
+}
+
+auto RegisterEmitter::pushResult(size_t reg) -> void {
+    size_t const position = m_stack.size();
+    if (reg == position) {
+        m_stack.push_back(Operand{Operand::Kind::SLOT, 0});
+        return;
+    }
+    if (reg < position) {
+        m_stack[reg] = Operand{Operand::Kind::SLOT, 0};
+    }
+    m_stack.push_back(Operand{Operand::Kind::REGISTER, static_cast<uint16_t>(reg)});
+}
+
+[[nodiscard]] auto RegisterEmitter::constant(cppLox::Types::Value value) -> uint16_t {
+    for (auto const & [specialConstant, index] : m_specialConstants) {
+        if (specialConstant == value) {
+            return index;
+        }
+    }
+    size_t const index = m_target->addConstant(value);
+    m_specialConstants.emplace_back(value, static_cast<uint16_t>(index));
+    return static_cast<uint16_t>(index);
+}
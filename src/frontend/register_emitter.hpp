@@ -0,0 +1,159 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file register_emitter.hpp
+ * @brief This file contains the declaration of the RegisterEmitter class.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "../bytecode/chunk.hpp"
+#include "../bytecode/register_opcode.hpp"
+#include "../types/object_function.hpp"
+
+namespace cppLox::Frontend {
+
+/// @brief The backend of the compiler that emits the register based bytecode of a function.
+/// @details The register bytecode is derived from the stack bytecode of a function. Every position on the stack is
+/// mapped to the register with the same index, so the call frames of both tiers have the same layout. Constants and
+/// reads of local variables are not copied to the stack, but used as operands of the instruction that consumes them,
+/// and an assignment to a local variable is folded into the instruction that computes the assigned value. That way
+/// `GET_LOCAL a; GET_LOCAL b; ADD; SET_LOCAL c; POP` becomes a single `ADD c, a, b`.
+class RegisterEmitter {
+  public:
+    /// @brief Constructs a new register emitter.
+    RegisterEmitter() = default;
+
+    /// @brief Destructor of the register emitter.
+    ~RegisterEmitter() = default;
+
+    /// @brief Emits the register bytecode for the given function and all the functions that are declared in it.
+    /// @param function The function to emit the register bytecode for.
+    /// @return true if the bytecode was emitted, false if the function uses too many registers or constants.
+    [[nodiscard]] auto emit(cppLox::Types::ObjectFunction & function) -> bool;
+
+  private:
+    /// @brief A value on the simulated stack of the function.
+    struct Operand {
+        /// @brief The possible locations of a value.
+        enum class Kind : uint8_t {
+            /// @brief The value is stored in the register of its stack position.
+            SLOT,
+            /// @brief The value is the value of the register with the given index.
+            REGISTER,
+            /// @brief The value is the constant with the given index.
+            CONSTANT
+        };
+
+        /// @brief The location of the value.
+        Kind kind;
+
+        /// @brief The index of the register or constant.
+        uint16_t index;
+    };
+
+    /// @brief Emits the register bytecode for the stack bytecode of the current function.
+    auto translate() -> void;
+
+    /// @brief Emits a byte.
+    /// @param byte The byte to emit.
+    auto emitByte(uint8_t byte) -> void;
+
+    /// @brief Emits an opcode.
+    /// @param opcode The opcode to emit.
+    auto emitOpcode(cppLox::ByteCode::RegisterOpcode opcode) -> void;
+
+    /// @brief Emits a 16-bit operand.
+    /// @param operand The operand to emit.
+    auto emitShort(size_t operand) -> void;
+
+    /// @brief Emits the given value as a source operand.
+    /// @param operand The value to emit.
+    /// @param position The position of the value on the stack.
+    auto emitSource(Operand const & operand, size_t position) -> void;
+
+    /// @brief Makes sure that the value at the given stack position is stored in its register.
+    /// @param position The position on the stack.
+    auto materialize(size_t position) -> void;
+
+    /// @brief Stores every value on the stack in its register.
+    auto flush() -> void;
+
+    /// @brief Stores every value below the given position, that is read from the given register, in its own register.
+    /// @param reg The register, that is about to be written.
+    /// @param end The first position that is not checked.
+    auto materializeReadsOf(size_t reg, size_t end) -> void;
+
+    /// @brief Checks whether there is a value below the given position that is read from the given register.
+    /// @param reg The register to check for.
+    /// @param end The first position that is not checked.
+    /// @return true if there is a value that is read from the given register, false otherwise.
+    [[nodiscard]] auto isRead(size_t reg, size_t end) const -> bool;
+
+    /// @brief Gets the register the result of the instruction at the given stack position is written to.
+    /// @details If the instruction at the next offset assigns the result to a local variable, the result is written
+    /// directly to the register of the variable and the assignment is skipped.
+    /// @param position The stack position of the result.
+    /// @param offset The offset of the stack instruction after the current one, advanced if the assignment is skipped.
+    /// @return The register the result is written to.
+    [[nodiscard]] auto destination(size_t position, size_t & offset) -> size_t;
+
+    /// @brief Pushes the result of an instruction, that was written to the given register.
+    /// @param reg The register the result was written to.
+    auto pushResult(size_t reg) -> void;
+
+    /// @brief Gets the index of the given special constant, adding it to the register bytecode if needed.
+    /// @param value The constant.
+    /// @return The index of the constant.
+    [[nodiscard]] auto constant(cppLox::Types::Value value) -> uint16_t;
+
+    /// @brief The stack bytecode that is translated.
+    cppLox::ByteCode::Chunk * m_source;
+
+    /// @brief The register bytecode that is emitted.
+    std::unique_ptr<cppLox::ByteCode::Chunk> m_target;
+
+    /// @brief The simulated stack of the function.
+    std::vector<Operand> m_stack;
+
+    /// @brief The offsets of the stack instructions that are the target of a jump.
+    std::set<size_t> m_jumpTargets;
+
+    /// @brief The stack depth at the jumps to the stack instructions with the given offset.
+    std::unordered_map<size_t, size_t> m_jumpDepths;
+
+    /// @brief The offsets of the translated jump targets in the register bytecode.
+    std::unordered_map<size_t, size_t> m_labels;
+
+    /// @brief The forward jumps, that are patched after the translation (operand offset, target offset).
+    std::vector<std::pair<size_t, size_t>> m_forwardJumps;
+
+    /// @brief The special constants that were added to the register bytecode (null, false and true).
+    std::vector<std::pair<cppLox::Types::Value, uint16_t>> m_specialConstants;
+
+    /// @brief The line of the stack instruction that is translated.
+    int m_line;
+
+    /// @brief Whether the function uses more registers, constants or code than the register bytecode can address.
+    bool m_failed;
+};
+} // namespace cppLox::Frontend
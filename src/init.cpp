@@ -20,20 +20,90 @@
 
 #include "init.hpp"
 
+#include <cstdlib>
+#include <filesystem>
+#include <format>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "bytecode/chunk.hpp"
+#include "bytecode/image.hpp"
+#include "bytecode/image_loader.hpp"
+#include "bytecode/image_writer.hpp"
 #include "error/runtime_exception.hpp"
 #include "exit_code.hpp"
+#include "frontend/register_emitter.hpp"
 
-auto cppLox::repl() -> void {
+/// @brief Reads the source code in the given file
+/// @param path The path to the file
+/// @return The source code
+static auto readSource(char const * path) -> std::string {
+    std::string source;
+    std::ifstream file;
+    file.open(path);
+    while (!file.eof()) {
+        std::string line;
+        std::getline(file, line);
+        source.append(line);
+    }
+    return source;
+}
+
+/// @brief Compiles the given source code
+/// @param source The source code, that is cleared once it was tokenized
+/// @param lexer The lexer that will tokenize the source code
+/// @param compiler The compiler that will compile the source code into bytecode
+/// @return The compiled script or an empty optional if the source code contains an error
+static auto compile(std::string & source, cppLox::Frontend::Lexer & lexer, cppLox::Frontend::Compiler & compiler)
+    -> std::optional<cppLox::Types::ObjectFunction *> {
+    std::vector<cppLox::Frontend::Token> tokens = lexer.tokenize(source);
+    source.clear();
+    std::optional<cppLox::Types::ObjectFunction *> script = compiler.compile(tokens);
+    tokens.clear();
+    return script;
+}
+
+/// @brief Gets the flags of an image, that is compiled with the given options
+/// @param tier The tier the program is executed on
+/// @param optimize Whether the compiled functions are optimized
+/// @return The flags of the image
+static auto imageFlags(cppLox::ByteCode::Tier tier, bool optimize) -> uint16_t {
+    return (optimize ? cppLox::ByteCode::IMAGE_FLAG_OPTIMIZED : 0) |
+           (tier == cppLox::ByteCode::Tier::REGISTER ? cppLox::ByteCode::IMAGE_FLAG_REGISTER_TIER : 0);
+}
+
+/// @brief Executes the given script and exits, if a runtime error occurs
+/// @param script The compiled or loaded script
+/// @param tier The tier the script is executed on
+/// @param vm The VM that will interpret the bytecode
+static auto execute(cppLox::Types::ObjectFunction & script, cppLox::ByteCode::Tier tier, cppLox::Backend::VM & vm)
+    -> void {
+    // Images only contain the stack based bytecode, the register based bytecode is derived from it again
+    if (tier == cppLox::ByteCode::Tier::REGISTER && !cppLox::Frontend::RegisterEmitter().emit(script)) {
+        std::cerr << "Too many registers or constants for the register tier" << std::endl;
+        exit(cppLox::EXIT_CODE_COMPILATION_ERROR);
+    }
+    try {
+        vm.interpret(script);
+    } catch (cppLox::Error::RunTimeException e) {
+        std::cout << e.what() << std::endl;
+        exit(cppLox::EXIT_CODE_RUNTIME_ERROR);
+    }
+#ifdef PROFILE_DISPATCH
+    vm.dispatchProfile().report(std::cerr);
+#endif
+}
+
+auto cppLox::repl(cppLox::ByteCode::Tier tier, bool optimize) -> void {
     cppLox::Frontend::Lexer lexer;
     std::shared_ptr<MemoryMutator> memoryMutator = std::make_shared<MemoryMutator>();
     cppLox::Backend::VM vm(memoryMutator);
-    cppLox::Frontend::Compiler compiler(memoryMutator);
+    cppLox::Frontend::Compiler compiler(memoryMutator, tier, {.optimize = optimize, .inlining = optimize});
     std::string line;
     while (true) {
         std::cout << "> ";
@@ -49,33 +119,79 @@ auto cppLox::repl() -> void {
     }
 }
 
-auto cppLox::runFile(char const * path) -> void {
-    cppLox::Frontend::Lexer lexer;
+auto cppLox::runFile(char const * path, cppLox::ByteCode::Tier tier, bool optimize) -> void {
     std::shared_ptr<MemoryMutator> memoryMutator = std::make_shared<MemoryMutator>();
     cppLox::Backend::VM vm(memoryMutator);
-    cppLox::Frontend::Compiler compiler(memoryMutator);
-    std::string source;
-    std::ifstream file;
-    file.open(path);
-    while (!file.eof()) {
-        std::string line;
-        std::getline(file, line);
-        source.append(line);
+    cppLox::ByteCode::ImageLoader loader(memoryMutator);
+    if (std::string_view(path).ends_with(cppLox::ByteCode::IMAGE_EXTENSION)) {
+        std::optional<cppLox::Types::ObjectFunction *> script = loader.loadFile(path);
+        if (!script.has_value()) {
+            std::cerr << std::format("Could not load the image '{}'", path) << std::endl;
+            exit(cppLox::EXIT_CODE_INPUT_OUTPUT_ERROR);
+        }
+        // An image is executed on the tier it was compiled for
+        execute(**script,
+                loader.flags() & cppLox::ByteCode::IMAGE_FLAG_REGISTER_TIER ? cppLox::ByteCode::Tier::REGISTER
+                                                                            : cppLox::ByteCode::Tier::STACK,
+                vm);
+        return;
     }
-    try {
-        cppLox::run(source, lexer, compiler, vm);
-    } catch (cppLox::Error::RunTimeException e) {
-        std::cout << e.what() << std::endl;
-        exit(cppLox::EXIT_CODE_RUNTIME_ERROR);
+    std::string source = readSource(path);
+    uint16_t const flags = imageFlags(tier, optimize);
+    uint64_t const hash = cppLox::ByteCode::image_hash(source, flags);
+    // The cache is keyed by the hash of the source code, so an image is compiled again when the script changes
+    char const * cacheDirectory = std::getenv("CPPLOX_CACHE_DIR");
+    std::filesystem::path cachedImage;
+    if (cacheDirectory != nullptr && *cacheDirectory != '\0') {
+        cachedImage = std::filesystem::path(cacheDirectory) /
+                      std::format("{:016x}{}", hash, cppLox::ByteCode::IMAGE_EXTENSION);
+        std::optional<cppLox::Types::ObjectFunction *> script = loader.loadFile(cachedImage, hash);
+        if (script.has_value()) {
+            execute(**script, tier, vm);
+            return;
+        }
+    }
+    cppLox::Frontend::Lexer lexer;
+    cppLox::Frontend::Compiler compiler(memoryMutator, tier, {.optimize = optimize, .inlining = optimize});
+    std::optional<cppLox::Types::ObjectFunction *> script = compile(source, lexer, compiler);
+    if (!script.has_value()) {
+        return;
+    }
+    if (!cachedImage.empty()) {
+        // The program runs, even if the cache can not be written
+        std::optional<std::vector<uint8_t>> image =
+            cppLox::ByteCode::ImageWriter().write(**script, *memoryMutator, hash, flags);
+        if (image.has_value()) {
+            [[maybe_unused]] bool const saved = cppLox::ByteCode::ImageWriter::save(*image, cachedImage);
+        }
+    }
+    execute(**script, tier, vm);
+}
+
+auto cppLox::compileFile(char const * path, cppLox::ByteCode::Tier tier, bool optimize) -> void {
+    std::shared_ptr<MemoryMutator> memoryMutator = std::make_shared<MemoryMutator>();
+    std::string source = readSource(path);
+    uint16_t const flags = imageFlags(tier, optimize);
+    uint64_t const hash = cppLox::ByteCode::image_hash(source, flags);
+    cppLox::Frontend::Lexer lexer;
+    cppLox::Frontend::Compiler compiler(memoryMutator, tier, {.optimize = optimize, .inlining = optimize});
+    std::optional<cppLox::Types::ObjectFunction *> script = compile(source, lexer, compiler);
+    if (!script.has_value()) {
+        exit(cppLox::EXIT_CODE_COMPILATION_ERROR);
+    }
+    std::filesystem::path const imagePath =
+        std::filesystem::path(path).replace_extension(cppLox::ByteCode::IMAGE_EXTENSION);
+    std::optional<std::vector<uint8_t>> image =
+        cppLox::ByteCode::ImageWriter().write(**script, *memoryMutator, hash, flags);
+    if (!image.has_value() || !cppLox::ByteCode::ImageWriter::save(*image, imagePath)) {
+        std::cerr << std::format("Could not write the image '{}'", imagePath.string()) << std::endl;
+        exit(cppLox::EXIT_CODE_INPUT_OUTPUT_ERROR);
     }
 }
 
 auto cppLox::run(std::string & source, cppLox::Frontend::Lexer & lexer, cppLox::Frontend::Compiler & compiler,
                  cppLox::Backend::VM & vm) -> void {
-    std::vector<cppLox::Frontend::Token> tokens = lexer.tokenize(source);
-    source.clear();
-    std::optional<cppLox::Types::ObjectFunction *> main_fun = compiler.compile(tokens);
-    tokens.clear();
+    std::optional<cppLox::Types::ObjectFunction *> main_fun = compile(source, lexer, compiler);
     if (!main_fun.has_value()) {
         return;
     }
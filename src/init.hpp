@@ -23,6 +23,7 @@
 #include <string>
 
 #include "backend/vm.hpp"
+#include "bytecode/tier.hpp"
 #include "frontend/compiler.hpp"
 #include "frontend/lexer.hpp"
 #include "frontend/token.hpp"
@@ -30,11 +31,26 @@
 namespace cppLox {
 
 /// @brief Starts the REPL
-auto repl() -> void;
+/// @param tier The tier of the virtual machine the input is executed on
+/// @param optimize Whether the compiled functions are optimized in ssa form and small functions are inlined
+auto repl(cppLox::ByteCode::Tier tier = cppLox::ByteCode::Tier::STACK, bool optimize = false) -> void;
 
 /// @brief Executes the program declared in the given file
+/// @details An image, that was written by compileFile, is loaded instead of compiled. If the environment variable
+/// CPPLOX_CACHE_DIR names a directory, the image of a program is stored there after it was compiled and loaded, when
+/// the same program is executed again.
 /// @param path The path to the file
-auto runFile(char const * path) -> void;
+/// @param tier The tier of the virtual machine the program is executed on
+/// @param optimize Whether the compiled functions are optimized in ssa form and small functions are inlined
+auto runFile(char const * path, cppLox::ByteCode::Tier tier = cppLox::ByteCode::Tier::STACK, bool optimize = false)
+    -> void;
+
+/// @brief Compiles the program declared in the given file into an image, that is stored next to the file
+/// @param path The path to the file
+/// @param tier The tier of the virtual machine the image is executed on
+/// @param optimize Whether the compiled functions are optimized in ssa form and small functions are inlined
+auto compileFile(char const * path, cppLox::ByteCode::Tier tier = cppLox::ByteCode::Tier::STACK,
+                 bool optimize = false) -> void;
 
 /// @brief The main entry point of the program.
 /// @param source The source code to run.
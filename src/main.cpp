@@ -20,6 +20,7 @@
 
 #include <format>
 #include <iostream>
+#include <string_view>
 
 #include "cpplox-config.hpp"
 #include "exit_code.hpp"
@@ -30,12 +31,40 @@
 /// @param argv The arguments passed to the program.
 /// @return The exit code of the program.
 auto main(int argc, char const ** argv) -> int {
-    if (argc == 1) {
-        cppLox::repl();
+    cppLox::ByteCode::Tier tier = cppLox::ByteCode::Tier::STACK;
+    bool optimize = false;
+    bool compile = false;
+    for (; argc > 1 && std::string_view(argv[1]).starts_with("-"); argc--, argv++) {
+        std::string_view const option = argv[1];
+        if (option == "-O") {
+            optimize = true;
+            continue;
+        }
+        if (option == "--compile") {
+            compile = true;
+            continue;
+        }
+        if (!option.starts_with("--tier=")) {
+            std::cout << std::format("Unknown option '{}'", option) << std::endl;
+            exit(cppLox::EXIT_CODE_COMMAND_LINE_USAGE_ERROR);
+        }
+        std::string_view const tierName = option.substr(std::string_view("--tier=").size());
+        if (tierName == "register") {
+            tier = cppLox::ByteCode::Tier::REGISTER;
+        } else if (tierName != "stack") {
+            std::cout << std::format("Unknown tier '{}', expected 'stack' or 'register'", tierName) << std::endl;
+            exit(cppLox::EXIT_CODE_COMMAND_LINE_USAGE_ERROR);
+        }
+    }
+    if (argc == 2 && compile) {
+        cppLox::compileFile(argv[1], tier, optimize);
+    } else if (argc == 1 && !compile) {
+        cppLox::repl(tier, optimize);
     } else if (argc == 2) {
-        cppLox::runFile(argv[1]);
+        cppLox::runFile(argv[1], tier, optimize);
     } else {
-        std::cout << std::format("Usage: {} [script]", PROJECT_NAME) << std::endl;
+        std::cout << std::format("Usage: {} [--tier=stack|register] [-O] [--compile] [script]", PROJECT_NAME)
+                  << std::endl;
         exit(cppLox::EXIT_CODE_COMMAND_LINE_USAGE_ERROR);
     }
     return 0;
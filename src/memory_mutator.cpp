@@ -0,0 +1,315 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file memory_mutator.cpp
+ * @brief This file contains the implementation of the garbage collector of the memory mutator.
+ */
+
+#include "memory_mutator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <initializer_list>
+
+#include "types/object_function.hpp"
+
+using namespace cppLox;
+
+MemoryMutator::MemoryMutator(size_t initialThreshold, double growthFactor, size_t nurserySize)
+    : m_initialThreshold(initialThreshold), m_growthFactor(growthFactor), m_nextCollection(initialThreshold),
+      m_nursery(std::make_unique<std::byte[]>(nurserySize)), m_nurserySize(nurserySize) {
+}
+
+MemoryMutator::~MemoryMutator() {
+    freeNursery();
+}
+
+auto MemoryMutator::addRootSource(RootSource * rootSource) -> void {
+    m_rootSources.push_back(rootSource);
+}
+
+auto MemoryMutator::removeRootSource(RootSource * rootSource) -> void {
+    std::erase(m_rootSources, rootSource);
+}
+
+auto MemoryMutator::setMarkingThreads(size_t threads, size_t threshold) -> void {
+    m_parallelMarker = threads > 1 ? std::make_unique<ParallelMarker>(threads) : nullptr;
+    m_parallelMarkingThreshold = threshold;
+}
+
+auto MemoryMutator::markObject(cppLox::Types::Object * object) -> void {
+    // The old generation is not traced by a minor collection
+    if (m_collectingYoungGeneration || object == nullptr) {
+        return;
+    }
+    // The roots are marked by the threads of the parallel marker
+    if (m_gatheringRoots) {
+        m_grayObjects.push_back(object);
+        return;
+    }
+    if (!object->mark(m_cycle)) {
+        return;
+    }
+    // Strings and native functions do not reference other objects, so there is nothing left to trace
+    if (object->is(cppLox::Types::Object::Type::FUNCTION)) {
+        m_grayObjects.push_back(object);
+    }
+}
+
+auto MemoryMutator::collectGarbage(cppLox::Types::Object * survivor) -> void {
+    auto const start = std::chrono::steady_clock::now();
+    // The survivor was allocated after the objects that are swept, so the sweep keeps it
+    if (m_sweeping) {
+        sweepStep(SIZE_MAX);
+    }
+    if (m_marking) {
+        markObject(survivor);
+        markStep(SIZE_MAX);
+    } else if (m_parallelMarker && m_objects.size() >= m_parallelMarkingThreshold) {
+        markInParallel(survivor);
+    } else {
+        beginCollection(survivor);
+        markStep(SIZE_MAX);
+    }
+    beginSweep();
+    sweepStep(SIZE_MAX);
+    recordPause(CollectionPause::FULL, start);
+}
+
+auto MemoryMutator::collect(cppLox::Types::Object * survivor) -> void {
+    if (m_collectionMode == CollectionMode::INCREMENTAL) {
+        collectIncrementally(survivor);
+    } else {
+        collectGarbage(survivor);
+    }
+}
+
+auto MemoryMutator::collectIncrementally(cppLox::Types::Object * survivor) -> void {
+    auto const start = std::chrono::steady_clock::now();
+    if (m_sweeping) {
+        sweepStep(GC_INCREMENTAL_STEP);
+        recordPause(CollectionPause::SWEEPING_STEP, start);
+    } else if (m_marking) {
+        // Objects allocated while the old generation is marked are marked right away
+        markObject(survivor);
+        if (markStep(GC_INCREMENTAL_STEP)) {
+            beginSweep();
+        }
+        recordPause(CollectionPause::MARKING_STEP, start);
+    } else {
+        beginCollection(survivor);
+        m_marking = true;
+        recordPause(CollectionPause::ROOT_SCAN, start);
+    }
+}
+
+auto MemoryMutator::beginCollection(cppLox::Types::Object * survivor) -> void {
+#ifdef DEBUG_LOG_GARBAGE_COLLECTION
+    std::cout << "-- gc begin" << std::endl;
+#endif
+    // The nursery is emptied first, so only the old generation has to be marked and swept
+    evacuateNursery();
+    // Cycle 0 is reserved for objects that were never marked
+    if (++m_cycle == 0) {
+        m_cycle = 1;
+    }
+    m_scannedGlobals = 0;
+    markObject(survivor);
+    markRoots();
+}
+
+auto MemoryMutator::markInParallel(cppLox::Types::Object * survivor) -> void {
+    // The minor collection, that begins the collection, moves the young roots before they are gathered
+    m_gatheringRoots = true;
+    beginCollection(survivor);
+    for (Global & global : m_globals) {
+        markObject(global.m_name);
+        markValue(global.m_value);
+    }
+    m_scannedGlobals = m_globals.size();
+    m_gatheringRoots = false;
+    m_parallelMarker->mark(m_grayObjects, m_cycle);
+    m_grayObjects.clear();
+}
+
+auto MemoryMutator::beginSweep() -> void {
+    m_marking = false;
+    m_sweeping = true;
+    m_sweepEnd = m_objects.size();
+    m_sweepRead = 0;
+    m_sweepWrite = 0;
+    m_survivingBytes = 0;
+}
+
+auto MemoryMutator::sweepStep(size_t budget) -> bool {
+    for (; budget > 0 && m_sweepRead < m_sweepEnd; budget--) {
+        ObjectArena::Pointer & object = m_objects[m_sweepRead++];
+        if (object->isMarked(m_cycle)) {
+            m_survivingBytes += object->size();
+            m_objects[m_sweepWrite++] = std::move(object);
+            continue;
+        }
+        // The interned strings are weak references, so unreachable strings are removed before they are freed
+        if (object->is(cppLox::Types::Object::Type::STRING)) {
+            auto interned = m_strings.find(object->as<cppLox::Types::ObjectString>());
+            if (interned != m_strings.end() && *interned == object.get()) {
+                m_strings.erase(interned);
+            }
+        }
+        object.reset();
+    }
+    if (m_sweepRead < m_sweepEnd) {
+        return false;
+    }
+    finishCollection();
+    return true;
+}
+
+auto MemoryMutator::finishCollection() -> void {
+#ifdef DEBUG_LOG_GARBAGE_COLLECTION
+    size_t const before = m_bytesAllocated;
+#endif
+    m_sweeping = false;
+    // The objects, that were allocated while sweeping, were appended after the swept objects and survive
+    size_t allocatedBytes = m_survivingBytes;
+    for (size_t index = m_sweepEnd; index < m_objects.size(); index++) {
+        allocatedBytes += m_objects[index]->size();
+    }
+    m_objects.erase(m_objects.begin() + static_cast<std::ptrdiff_t>(m_sweepWrite),
+                    m_objects.begin() + static_cast<std::ptrdiff_t>(m_sweepEnd));
+    m_bytesAllocated = allocatedBytes;
+    // The pages, that were emptied by the previous collection and not reused since, are returned
+    m_arena.trim();
+    m_nextCollection =
+        std::max(static_cast<size_t>(static_cast<double>(m_bytesAllocated) * m_growthFactor), m_initialThreshold);
+#ifdef DEBUG_LOG_GARBAGE_COLLECTION
+    std::cout << std::format("-- gc end\n   collected {} bytes (from {} to {}) next at {}", before - m_bytesAllocated,
+                             before, m_bytesAllocated, m_nextCollection)
+              << std::endl;
+#endif
+}
+
+auto MemoryMutator::collectYoungGeneration() -> void {
+    auto const start = std::chrono::steady_clock::now();
+    evacuateNursery();
+    recordPause(CollectionPause::MINOR, start);
+}
+
+auto MemoryMutator::evacuateNursery() -> void {
+#ifdef DEBUG_LOG_GARBAGE_COLLECTION
+    std::cout << "-- minor gc begin" << std::endl;
+    size_t const before = m_youngBytes;
+    size_t const promotedBefore = m_bytesAllocated;
+#endif
+    m_collectingYoungGeneration = true;
+    for (size_t slot : m_rememberedGlobals) {
+        m_globals[slot].m_remembered = false;
+        markValue(m_globals[slot].m_value);
+    }
+    m_rememberedGlobals.clear();
+    for (RootSource * rootSource : m_rootSources) {
+        rootSource->markRoots(*this);
+    }
+    m_collectingYoungGeneration = false;
+#ifdef DEBUG_LOG_GARBAGE_COLLECTION
+    std::cout << std::format("-- minor gc end\n   promoted {} of {} young bytes", m_bytesAllocated - promotedBefore,
+                             before)
+              << std::endl;
+#endif
+    freeNursery();
+}
+
+auto MemoryMutator::promote(cppLox::Types::Object * object) -> cppLox::Types::Object * {
+    auto forwardingAddress = m_forwardingAddresses.find(object);
+    if (forwardingAddress != m_forwardingAddresses.end()) {
+        return forwardingAddress->second;
+    }
+    cppLox::Types::ObjectString * young = object->as<cppLox::Types::ObjectString>();
+    // The interned strings are hashed by their characters, so the string is removed before it is moved
+    m_strings.erase(young);
+    cppLox::Types::ObjectString * promoted = m_arena.create<cppLox::Types::ObjectString>(std::move(*young));
+    m_strings.insert(promoted);
+    m_objects.push_back(ObjectArena::Pointer(promoted));
+    m_bytesAllocated += promoted->size();
+    m_forwardingAddresses.emplace(object, promoted);
+    // The promoted object was not reachable from the old generation, when its roots were marked
+    if (m_marking) {
+        promoted->mark(m_cycle);
+    }
+    return promoted;
+}
+
+auto MemoryMutator::tenure(cppLox::Types::Object * object) -> cppLox::Types::Object * {
+    cppLox::Types::Object * promoted = promote(object);
+    // The other references to the object are updated by the minor collection, that finds the forwarding address
+    collectYoungGeneration();
+    return promoted;
+}
+
+auto MemoryMutator::freeNursery() -> void {
+    for (cppLox::Types::Object * object : m_youngObjects) {
+        if (!m_forwardingAddresses.contains(object)) {
+            m_strings.erase(object->as<cppLox::Types::ObjectString>());
+        }
+        object->~Object();
+    }
+#ifdef DEBUG_STRESS_GARBAGE_COLLECTOR
+    // References to objects, that were moved or freed, crash instead of reading the stale object
+    std::memset(m_nursery.get(), 0xdd, m_nurseryTop);
+#endif
+    m_youngObjects.clear();
+    m_forwardingAddresses.clear();
+    m_nurseryTop = 0;
+    m_youngBytes = 0;
+}
+
+auto MemoryMutator::markRoots() -> void {
+    for (RootSource * rootSource : m_rootSources) {
+        rootSource->markRoots(*this);
+    }
+}
+
+auto MemoryMutator::markStep(size_t budget) -> bool {
+    // The budget is spent on the references, that are traced, so functions with many constants take longer
+    size_t traced = 0;
+    while (traced < budget) {
+        if (!m_grayObjects.empty()) {
+            cppLox::Types::ObjectFunction * function = m_grayObjects.back()->as<cppLox::Types::ObjectFunction>();
+            m_grayObjects.pop_back();
+            markObject(function->name());
+            traced++;
+            for (cppLox::ByteCode::Chunk * chunk : {function->chunk(), function->registerChunk()}) {
+                if (chunk == nullptr) {
+                    continue;
+                }
+                for (size_t index = 0; index < chunk->getConstantCount(); index++) {
+                    markValue(chunk->getConstant(index));
+                }
+                traced += chunk->getConstantCount();
+            }
+        } else if (m_scannedGlobals < m_globals.size()) {
+            Global & global = m_globals[m_scannedGlobals++];
+            markObject(global.m_name);
+            markValue(global.m_value);
+            traced++;
+        } else {
+            return true;
+        }
+    }
+    return m_grayObjects.empty() && m_scannedGlobals == m_globals.size();
+}
@@ -20,8 +20,13 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <new>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -31,6 +36,9 @@
 #include "types/object_string.hpp"
 #include "types/value.hpp"
 
+#include "object_arena.hpp"
+#include "parallel_marker.hpp"
+#include "pause_histogram.hpp"
 #include "simple_comperator.hpp"
 #include "string_hash.hpp"
 
@@ -39,19 +47,105 @@ class CompilerIntegrationTest;
 
 namespace cppLox {
 
+/// @brief The default amount of allocated bytes after which the first garbage collection is triggered
+#define GC_INITIAL_THRESHOLD (1024 * 1024)
+
+/// @brief The default factor by which the allocated bytes may grow after a garbage collection until the next one
+#define GC_HEAP_GROW_FACTOR 2.0
+
+/// @brief The default size of the nursery, in which short-lived objects are allocated, in bytes
+#define GC_NURSERY_SIZE (256 * 1024)
+
+/// @brief The amount of references, that are traced, or objects, that are swept, by a step of an incremental collection
+#define GC_INCREMENTAL_STEP 1024
+
+/// @brief The default amount of objects in the old generation, from which on it is marked by several threads
+#define GC_PARALLEL_MARKING_THRESHOLD (64 * 1024)
+
+class MemoryMutator;
+
+/// @brief How the old generation is collected.
+enum class CollectionMode : uint8_t {
+    /// @brief The old generation is marked and swept in a single pause.
+    STOP_THE_WORLD,
+    /// @brief The old generation is marked and swept in small steps, that are interleaved with the allocations.
+    INCREMENTAL
+};
+
+/// @brief The kinds of pauses of the garbage collector.
+enum class CollectionPause : uint8_t {
+    /// @brief A minor collection, that empties the nursery.
+    MINOR,
+    /// @brief A collection of the whole heap in a single pause.
+    FULL,
+    /// @brief The scan of the stacks, that starts an incremental collection.
+    ROOT_SCAN,
+    /// @brief A step of an incremental collection, that traces some of the marked objects and global variables.
+    MARKING_STEP,
+    /// @brief A step of an incremental collection, that frees some of the unmarked objects.
+    SWEEPING_STEP
+};
+
+/// @brief A part of the interpreter, that references objects that are not reachable from the globals.
+class RootSource {
+  public:
+    /// @brief Destroys the root source.
+    virtual ~RootSource() = default;
+
+    /// @brief Marks all the objects, that are directly referenced by the root source.
+    /// @details The values are passed by reference, because a minor collection moves the objects out of the nursery.
+    /// @param memoryMutator The memory mutator that collects the garbage.
+    virtual auto markRoots(MemoryMutator & memoryMutator) -> void = 0;
+};
+
 /// @brief The memory mutator that manages the creation and deletion of all objects.
+/// @details Unreachable objects are freed by a tracing mark-and-sweep garbage collector. The roots are the global
+/// variables and the objects referenced by the registered root sources (the stack of the virtual machine and the
+/// functions the compiler is compiling). The interned strings are weak references, that are removed once the string
+/// is unreachable. A garbage collection is triggered when the allocated bytes exceed a threshold, that grows with the
+/// amount of bytes that survived the last collection.
+///
+/// Strings, that are created at runtime, are mostly short-lived. They are allocated in a nursery by bumping a pointer.
+/// When the nursery is full a minor collection moves the young objects, that are reachable, into the old generation
+/// and updates the values that referenced them, so the pause is proportional to the survivors and not to the heap.
+/// The stack is scanned as a root, the global variables are only scanned if a young object was stored in them since
+/// the last minor collection, which the write barrier of the globals records. The objects in the old generation
+/// never reference young objects otherwise, because the functions and their constants are never allocated in the
+/// nursery.
+///
+/// In the incremental mode the old generation is marked and swept in steps, that are taken on allocations, after a
+/// short pause that scans the stacks. The global variables are scanned by the steps as well. The objects that were
+/// reachable when the stacks were scanned survive: The write barrier of the globals marks the value of a global, that
+/// was not scanned yet, before it is overwritten, the objects allocated in the meantime are marked right away and
+/// interning a string marks it, because the unmarked strings are only weakly referenced by the interned strings. The
+/// stack needs no barrier, because every object that is stored on it was reachable when the stacks were scanned or
+/// allocated afterwards.
+///
+/// The objects of the old generation are allocated in an arena, that groups them by their size. The arena is trimmed
+/// at the end of every collection.
+///
+/// A collection, that stops the world, can mark a large old generation using several threads. The roots are gathered
+/// without marking them and handed to the parallel marker, that splits them across its threads.
 class MemoryMutator {
 
     // To access the objects stored in the memory mutator we need to be able to access them. This is done for testing
     // purposes.
-    friend class CompilerIntegrationTest;
+    friend class ::CompilerIntegrationTest;
 
   public:
     /// @brief Creates a new memory mutator.
-    MemoryMutator() = default;
+    /// @param initialThreshold The amount of allocated bytes after which the first garbage collection is triggered.
+    /// @param growthFactor The factor by which the allocated bytes may grow after a garbage collection until the next
+    /// one is triggered.
+    /// @param nurserySize The size of the nursery, in which the young objects are allocated, in bytes.
+    explicit MemoryMutator(size_t initialThreshold = GC_INITIAL_THRESHOLD, double growthFactor = GC_HEAP_GROW_FACTOR,
+                           size_t nurserySize = GC_NURSERY_SIZE);
+
+    /// @brief Destroys the memory mutator and all the objects it allocated.
+    ~MemoryMutator();
 
-    /// @brief Destroys the memory mutator.
-    ~MemoryMutator() = default;
+    MemoryMutator(MemoryMutator const &) = delete;
+    auto operator=(MemoryMutator const &) -> MemoryMutator & = delete;
 
     /// @brief Creates a new object of the given type.
     /// @tparam ...Args The types of the arguments to pass to the constructor.
@@ -62,67 +156,434 @@ class MemoryMutator {
     auto create(Args &&... args) -> cppLox::Types::Object * {
         cppLox::Types::Object * object;
         if constexpr (std::is_same_v<T, cppLox::Types::ObjectString>) {
-            auto string = new T(std::forward<Args>(args)...);
-            auto iterator = this->m_strings.find(string);
+            // The string is only moved into the arena, if it is not interned yet
+            T string(std::forward<Args>(args)...);
+            auto iterator = this->m_strings.find(&string);
             if (iterator != m_strings.end()) {
-                delete string;
-                return static_cast<cppLox::Types::Object *>(*iterator);
+                // The string is referenced by a long-lived object, like a constant of a function, from now on
+                return isYoung(*iterator) ? tenure(*iterator) : shade(*iterator);
             }
-            m_strings.insert(string);
-            object = static_cast<cppLox::Types::Object *>(string);
+            T * interned = m_arena.create<T>(std::move(string));
+            m_strings.insert(interned);
+            object = static_cast<cppLox::Types::Object *>(interned);
         } else {
-            object = static_cast<cppLox::Types::Object *>(new T(std::forward<Args>(args)...));
+            object = static_cast<cppLox::Types::Object *>(m_arena.create<T>(std::forward<Args>(args)...));
         }
 
-        m_objects.push_back(std::unique_ptr<cppLox::Types::Object>(object));
+        m_objects.push_back(ObjectArena::Pointer(object));
+        m_bytesAllocated += object->size();
+#ifdef DEBUG_STRESS_GARBAGE_COLLECTOR
+        collect(object);
+#else
+        if (isCollecting() || m_bytesAllocated > m_nextCollection) {
+            collect(object);
+        }
+#endif
         return object;
     }
 
-    /// @brief Sets the global variable with the given name to the given value.
-    /// @param key The name of the global variable to set.
-    /// @param value The value to set the global variable to.
-    /// @return True if the variable already existed, false if it was created.
-    auto setGlobal(cppLox::Types::ObjectString * key, cppLox::Types::Value value) -> bool {
-        auto bucket = m_globals.find(key);
-        bool exists = bucket != m_globals.end();
-        if (exists) {
-            bucket->second = value;
-        } else {
-            m_globals[key] = value;
+    /// @brief Creates a new short-lived object of the given type in the nursery.
+    /// @details Only strings are allocated in the nursery, because they do not reference other objects, so a minor
+    /// collection never has to trace the objects it moves. The characters of the strings count towards the size of the
+    /// nursery, strings that do not fit into the nursery are allocated in the old generation.
+    /// @tparam T The type of the object to create.
+    /// @tparam ...Args The types of the arguments to pass to the constructor.
+    /// @param ...args The arguments to pass to the constructor.
+    /// @return A pointer to the newly created object, that is only valid until the next allocation moved it.
+    template <cppLox::Types::DerivedFromObject T, class... Args>
+    auto createYoung(Args &&... args) -> cppLox::Types::Object * {
+        static_assert(std::is_same_v<T, cppLox::Types::ObjectString>, "Only strings are allocated in the nursery");
+        T string(std::forward<Args>(args)...);
+        auto iterator = m_strings.find(&string);
+        if (iterator != m_strings.end()) {
+            return isYoung(*iterator) ? static_cast<cppLox::Types::Object *>(*iterator) : shade(*iterator);
+        }
+        // The characters are owned by the string, so they count towards the size of the nursery as well
+        size_t const size = string.size();
+        if (size > m_nurserySize) {
+            return create<T>(std::move(string));
         }
+#ifdef DEBUG_STRESS_GARBAGE_COLLECTOR
+        collectYoungGeneration();
+        collect(nullptr);
+#else
+        if (m_youngBytes + size > m_nurserySize) {
+            collectYoungGeneration();
+            if (isCollecting() || m_bytesAllocated > m_nextCollection) {
+                collect(nullptr);
+            }
+        }
+#endif
+        // The nursery is aligned for every object type and all young objects have the same size. The young bytes
+        // include the objects themselves, so the nursery has room for the object if the young bytes fit
+        T * young = new (m_nursery.get() + m_nurseryTop) T(std::move(string));
+        m_nurseryTop += sizeof(T);
+        m_youngObjects.push_back(young);
+        m_youngBytes += size;
+        m_strings.insert(young);
+        return static_cast<cppLox::Types::Object *>(young);
+    }
+
+    /// @brief Frees all the objects, that are not reachable from the roots, in a single pause.
+    /// @details An incremental collection, that is in progress, is finished.
+    auto collectGarbage() -> void {
+        collectGarbage(nullptr);
+    }
+
+    /// @brief Takes a step of the incremental collection or starts a new one, e.g. while the embedder is idle.
+    auto collectIncrementally() -> void {
+        collectIncrementally(nullptr);
+    }
+
+    /// @brief Sets how the old generation is collected.
+    /// @param mode The collection mode.
+    auto setCollectionMode(CollectionMode mode) noexcept -> void {
+        m_collectionMode = mode;
+    }
+
+    /// @brief Gets how the old generation is collected.
+    /// @return The collection mode.
+    [[nodiscard]] auto collectionMode() const noexcept -> CollectionMode {
+        return m_collectionMode;
+    }
+
+    /// @brief Sets the amount of threads, that mark the old generation in a collection, that stops the world.
+    /// @details The incremental collections are always marked by the thread, that allocates.
+    /// @param threads The amount of threads, including the collecting thread, one marks without starting threads.
+    /// @param threshold The amount of objects in the old generation, from which on they are marked by several threads.
+    auto setMarkingThreads(size_t threads, size_t threshold = GC_PARALLEL_MARKING_THRESHOLD) -> void;
+
+    /// @brief Gets the amount of threads, that mark the old generation in a collection, that stops the world.
+    /// @return The amount of threads, including the collecting thread.
+    [[nodiscard]] auto markingThreads() const noexcept -> size_t {
+        return m_parallelMarker ? m_parallelMarker->threads() : 1;
+    }
+
+    /// @brief Checks if an incremental collection is marking the old generation.
+    /// @return True if the old generation is being marked, false otherwise.
+    [[nodiscard]] auto isMarking() const noexcept -> bool {
+        return m_marking;
+    }
+
+    /// @brief Checks if an incremental collection is in progress.
+    /// @return True if the old generation is being marked or swept, false otherwise.
+    [[nodiscard]] auto isCollecting() const noexcept -> bool {
+        return m_marking || m_sweeping;
+    }
+
+    /// @brief Gets the histogram of the pauses of the given kind.
+    /// @param pause The kind of the pauses.
+    /// @return The histogram of the pause times.
+    [[nodiscard]] auto pauseHistogram(CollectionPause pause) const noexcept -> PauseHistogram const & {
+        return m_pauseHistograms[static_cast<size_t>(pause)];
+    }
+
+    /// @brief Moves the young objects, that are reachable from the roots, into the old generation and frees the others.
+    auto collectYoungGeneration() -> void;
+
+    /// @brief Checks if the given object is allocated in the nursery.
+    /// @param object The object to check.
+    /// @return True if the object is young, false otherwise.
+    [[nodiscard]] auto isYoung(cppLox::Types::Object const * object) const noexcept -> bool {
+        auto const address = reinterpret_cast<uintptr_t>(object);
+        auto const nursery = reinterpret_cast<uintptr_t>(m_nursery.get());
+        return address >= nursery && address < nursery + m_nurserySize;
+    }
+
+    /// @brief Registers a root source, whose objects are kept alive by the garbage collector.
+    /// @param rootSource The root source to register.
+    auto addRootSource(RootSource * rootSource) -> void;
+
+    /// @brief Unregisters the given root source.
+    /// @param rootSource The root source to unregister.
+    auto removeRootSource(RootSource * rootSource) -> void;
+
+    /// @brief Marks the given object and every object it references as reachable.
+    /// @param object The object to mark, nullptr is ignored.
+    auto markObject(cppLox::Types::Object * object) -> void;
+
+    /// @brief Marks the object, that is referenced by the given value, as reachable.
+    /// @details During a minor collection a young object is moved into the old generation and the value is updated.
+    /// @param value The value to mark.
+    auto markValue(cppLox::Types::Value & value) -> void {
+        if (!value.is(cppLox::Types::Value::Type::OBJECT)) {
+            return;
+        }
+        cppLox::Types::Object * object = value.as<cppLox::Types::Object *>();
+        if (!m_collectingYoungGeneration) {
+            markObject(object);
+        } else if (isYoung(object)) {
+            value = cppLox::Types::Value(promote(object));
+        }
+    }
+
+    /// @brief Gets the amount of bytes that are used by the allocated objects.
+    /// @return The allocated bytes of both generations.
+    [[nodiscard]] auto bytesAllocated() const noexcept -> size_t {
+        return m_bytesAllocated + m_youngBytes;
+    }
+
+    /// @brief Resolves the slot of the global variable with the given name.
+    /// @details A slot is handed out the first time a global is referenced, so the compiler can resolve globals that
+    /// are only defined later on. The slot stays undefined until the global is defined at runtime.
+    /// @param name The name of the global variable.
+    /// @return The slot of the global variable.
+    auto resolveGlobal(cppLox::Types::ObjectString * name) -> size_t {
+        auto [iterator, inserted] = m_globalSlots.try_emplace(name, m_globals.size());
+        if (inserted) {
+            m_globals.push_back(Global{name, cppLox::Types::Value(), false, false});
+        }
+        return iterator->second;
+    }
+
+    /// @brief Defines the global variable in the given slot.
+    /// @param slot The slot of the global variable to define.
+    /// @param value The value of the global variable.
+    /// @return True if the variable was already defined, false if it was created.
+    auto defineGlobal(size_t slot, cppLox::Types::Value value) -> bool {
+        Global & global = m_globals[slot];
+        bool const exists = global.m_defined;
+        snapshotGlobal(slot);
+        global.m_value = value;
+        global.m_defined = true;
+        rememberGlobal(slot, value);
         return exists;
     }
 
-    /// @brief Gets the global variable with the given name.
-    /// @param key The name of the global variable to get.
-    /// @return The value of the global variable.
-    auto getGlobal(cppLox::Types::ObjectString * key) const -> cppLox::Types::Value {
-        auto iterator = m_globals.find(key);
-        if (iterator != m_globals.end()) {
-            return iterator->second;
+    /// @brief Sets the global variable in the given slot to the given value.
+    /// @param slot The slot of the global variable to set.
+    /// @param value The value to set the global variable to.
+    /// @return True if the variable was set, false if it is not defined.
+    auto setGlobal(size_t slot, cppLox::Types::Value value) -> bool {
+        Global & global = m_globals[slot];
+        if (!global.m_defined) {
+            return false;
         }
-        return cppLox::Types::Value();
+        snapshotGlobal(slot);
+        global.m_value = value;
+        rememberGlobal(slot, value);
+        return true;
+    }
+
+    /// @brief Gets the global variable in the given slot.
+    /// @param slot The slot of the global variable to get.
+    /// @return The value of the global variable, nil if it is not defined.
+    auto getGlobal(size_t slot) const -> cppLox::Types::Value {
+        return m_globals[slot].m_value;
     }
 
-    /// @brief Deletes the global variable with the given name.
-    /// @param key The name of the global variable to delete.
-    /// @return True if the variable was deleted, false if it didn't exist.
-    auto deleteGlobal(cppLox::Types::ObjectString * key) -> bool {
-        return m_globals.erase(key);
+    /// @brief Gets the name of the global variable in the given slot.
+    /// @param slot The slot of the global variable.
+    /// @return The name of the global variable.
+    auto globalName(size_t slot) const -> cppLox::Types::ObjectString * {
+        return m_globals[slot].m_name;
     }
 
   private:
+    /// @brief Frees all the objects, that are not reachable from the roots.
+    /// @param survivor The object that was allocated last, that survives the collection it triggered, because it is
+    /// not referenced by a root yet. The objects it references survive as well.
+    auto collectGarbage(cppLox::Types::Object * survivor) -> void;
+
+    /// @brief Collects the old generation in the collection mode, after the given object was allocated.
+    /// @param survivor The object that was allocated last, that survives the collection.
+    auto collect(cppLox::Types::Object * survivor) -> void;
+
+    /// @brief Takes a step of the incremental collection or starts a new one.
+    /// @param survivor The object that was allocated last, that survives the collection.
+    auto collectIncrementally(cppLox::Types::Object * survivor) -> void;
+
+    /// @brief Empties the nursery and marks the roots of a new collection.
+    /// @param survivor The object that was allocated last, that survives the collection.
+    auto beginCollection(cppLox::Types::Object * survivor) -> void;
+
+    /// @brief Starts a new collection and marks the old generation using the parallel marker.
+    /// @param survivor The object that was allocated last, that survives the collection.
+    auto markInParallel(cppLox::Types::Object * survivor) -> void;
+
+    /// @brief Starts to sweep the objects, that were allocated before the marking finished.
+    auto beginSweep() -> void;
+
+    /// @brief Frees some of the unmarked objects and removes them from the interned strings.
+    /// @param budget The maximum amount of objects, that are swept.
+    /// @return True if the sweep finished the collection, false otherwise.
+    auto sweepStep(size_t budget) -> bool;
+
+    /// @brief Removes the freed objects and computes the threshold of the next collection.
+    auto finishCollection() -> void;
+
+    /// @brief Records a pause of the garbage collector, that started at the given time.
+    /// @param pause The kind of the pause.
+    /// @param start The start of the pause.
+    auto recordPause(CollectionPause pause, std::chrono::steady_clock::time_point start) -> void {
+        m_pauseHistograms[static_cast<size_t>(pause)].record(std::chrono::steady_clock::now() - start);
+    }
+
+    /// @brief Empties the nursery without recording a pause.
+    auto evacuateNursery() -> void;
+
+    /// @brief Marks the objects of the root sources.
+    auto markRoots() -> void;
+
+    /// @brief Marks the objects, that are referenced by the marked objects and the global variables.
+    /// @param budget The maximum amount of marked objects and global variables, whose references are traced.
+    /// @return True if no marked objects and global variables are left to trace, false otherwise.
+    auto markStep(size_t budget) -> bool;
+
+    /// @brief Marks the given old object, if an incremental collection is in progress, so it is not freed.
+    /// @param object The object, that is referenced again.
+    /// @return The object.
+    auto shade(cppLox::Types::Object * object) -> cppLox::Types::Object * {
+        if (isCollecting()) {
+            markObject(object);
+        }
+        return object;
+    }
+
+    /// @brief The snapshot-at-the-beginning write barrier of the global variables, that marks the overwritten value.
+    /// @param slot The slot of the global variable, that is about to be written.
+    auto snapshotGlobal(size_t slot) -> void {
+        if (m_marking && slot >= m_scannedGlobals && m_globals[slot].m_value.is(cppLox::Types::Value::Type::OBJECT)) {
+            markObject(m_globals[slot].m_value.as<cppLox::Types::Object *>());
+        }
+    }
+
+    /// @brief Moves the given young object into the old generation, unless it was moved already.
+    /// @param object The young object to move.
+    /// @return The object in the old generation.
+    auto promote(cppLox::Types::Object * object) -> cppLox::Types::Object *;
+
+    /// @brief Moves the given young object into the old generation immediately.
+    /// @param object The young object to move.
+    /// @return The object in the old generation.
+    auto tenure(cppLox::Types::Object * object) -> cppLox::Types::Object *;
+
+    /// @brief Frees the young objects, that were not moved into the old generation, and empties the nursery.
+    auto freeNursery() -> void;
+
+    /// @brief The write barrier of the global variables, that records the slots that reference a young object.
+    /// @param slot The slot of the global variable, that was written.
+    /// @param value The value that was written.
+    auto rememberGlobal(size_t slot, cppLox::Types::Value value) -> void {
+        if (value.is(cppLox::Types::Value::Type::OBJECT) && isYoung(value.as<cppLox::Types::Object *>()) &&
+            !m_globals[slot].m_remembered) {
+            m_globals[slot].m_remembered = true;
+            m_rememberedGlobals.push_back(slot);
+        }
+    }
+
+    /// @brief The arena, that the objects of the old generation are allocated in.
+    /// @details It is declared before the objects, so it outlives them.
+    ObjectArena m_arena;
+
     /// @brief The list of all objects that are currently allocated.
-    std::vector<std::unique_ptr<cppLox::Types::Object>> m_objects;
+    std::vector<ObjectArena::Pointer> m_objects;
 
     /// @brief The set of all strings that are currently allocated.
     std::unordered_set<cppLox::Types::ObjectString *, std::hash<cppLox::Types::ObjectString>,
                        cppLox::Types::SimpleComperator<cppLox::Types::ObjectString>>
         m_strings;
 
-    /// @brief The map of all global variables.
-    std::unordered_map<cppLox::Types::ObjectString *, cppLox::Types::Value, std::hash<cppLox::Types::ObjectString>,
+    /// @brief A global variable that was resolved to a slot.
+    struct Global {
+        /// @brief The name of the global variable.
+        cppLox::Types::ObjectString * m_name;
+        /// @brief The value of the global variable.
+        cppLox::Types::Value m_value;
+        /// @brief Whether the global variable is defined.
+        bool m_defined;
+        /// @brief Whether the slot is recorded as a root of the next minor collection.
+        bool m_remembered;
+    };
+
+    /// @brief The global variables indexed by their slot.
+    std::vector<Global> m_globals;
+
+    /// @brief The map of the names of all global variables to their slot.
+    std::unordered_map<cppLox::Types::ObjectString *, size_t, std::hash<cppLox::Types::ObjectString>,
                        cppLox::Types::SimpleComperator<cppLox::Types::ObjectString>>
-        m_globals;
+        m_globalSlots;
+
+    /// @brief The registered root sources.
+    std::vector<RootSource *> m_rootSources;
+
+    /// @brief The marked objects, whose references have not been traced yet, or the roots, that were gathered.
+    std::vector<cppLox::Types::Object *> m_grayObjects;
+
+    /// @brief Whether the roots are gathered for the parallel marker instead of being marked.
+    bool m_gatheringRoots = false;
+
+    /// @brief The parallel marker, if the old generation is marked by several threads.
+    std::unique_ptr<ParallelMarker> m_parallelMarker;
+
+    /// @brief The amount of objects in the old generation, from which on they are marked by several threads.
+    size_t m_parallelMarkingThreshold = GC_PARALLEL_MARKING_THRESHOLD;
+
+    /// @brief The amount of bytes that are used by the allocated objects.
+    size_t m_bytesAllocated = 0;
+
+    /// @brief The amount of allocated bytes after which the first garbage collection is triggered.
+    size_t m_initialThreshold;
+
+    /// @brief The factor by which the allocated bytes may grow after a garbage collection until the next one.
+    double m_growthFactor;
+
+    /// @brief The amount of allocated bytes after which the next garbage collection is triggered.
+    size_t m_nextCollection;
+
+    /// @brief The nursery, in which the young objects are allocated.
+    std::unique_ptr<std::byte[]> m_nursery;
+
+    /// @brief The size of the nursery in bytes.
+    size_t m_nurserySize;
+
+    /// @brief The offset of the next free byte in the nursery.
+    size_t m_nurseryTop = 0;
+
+    /// @brief The objects that are allocated in the nursery.
+    std::vector<cppLox::Types::Object *> m_youngObjects;
+
+    /// @brief The amount of bytes that are used by the young objects.
+    size_t m_youngBytes = 0;
+
+    /// @brief The slots of the global variables, that were written with a young object since the last minor collection.
+    std::vector<size_t> m_rememberedGlobals;
+
+    /// @brief The objects in the old generation, that the young objects were moved to in the current minor collection.
+    std::unordered_map<cppLox::Types::Object *, cppLox::Types::Object *> m_forwardingAddresses;
+
+    /// @brief Whether a minor collection is in progress, in which the roots are moved instead of marked.
+    bool m_collectingYoungGeneration = false;
+
+    /// @brief How the old generation is collected.
+    CollectionMode m_collectionMode = CollectionMode::STOP_THE_WORLD;
+
+    /// @brief Whether an incremental collection is marking the old generation.
+    bool m_marking = false;
+
+    /// @brief The amount of global variables, that were scanned by the current collection.
+    size_t m_scannedGlobals = 0;
+
+    /// @brief Whether an incremental collection is sweeping the old generation.
+    bool m_sweeping = false;
+
+    /// @brief The amount of objects, that are swept, the objects after them were allocated while sweeping.
+    size_t m_sweepEnd = 0;
+
+    /// @brief The index of the next object, that is swept.
+    size_t m_sweepRead = 0;
+
+    /// @brief The index, that the next surviving object is moved to.
+    size_t m_sweepWrite = 0;
+
+    /// @brief The amount of bytes, that are used by the swept objects, that survived.
+    size_t m_survivingBytes = 0;
+
+    /// @brief The histograms of the pause times, indexed by the kind of the pause.
+    std::array<PauseHistogram, 5> m_pauseHistograms;
+
+    /// @brief The current garbage collection cycle, the objects that are reachable are marked with it.
+    /// @details Objects are created in cycle 0, so the first collection is cycle 1.
+    uint32_t m_cycle = 0;
 };
 } // namespace cppLox
\ No newline at end of file
@@ -0,0 +1,587 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file inliner.cpp
+ * @brief This file contains the implementation of the Inliner class.
+ */
+
+#include "inliner.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <unordered_set>
+
+#include "../types/object.hpp"
+
+using namespace cppLox::MiddleEnd;
+
+using cppLox::ByteCode::Opcode;
+
+/// @brief Determines whether an instruction is a jump
+/// @param opcode The opcode of the instruction
+/// @return true if the instruction has a jump offset as its operand, false otherwise
+static auto isJump(Opcode opcode) -> bool {
+    switch (opcode) {
+    case Opcode::EQUAL_JUMP_IF_FALSE:
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::GREATER_JUMP_IF_FALSE:
+    case Opcode::GREATER_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::JUMP:
+    case Opcode::JUMP_IF_FALSE:
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::LESS_JUMP_IF_FALSE:
+    case Opcode::LESS_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::LOOP:
+    case Opcode::NOT_EQUAL_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_TRUE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @brief Determines whether an instruction calls a function
+/// @param opcode The opcode of the instruction
+/// @return true if the instruction calls the function below its arguments, false otherwise
+static auto isCall(Opcode opcode) -> bool {
+    return opcode == Opcode::CALL || opcode == Opcode::CALL_INLINED || opcode == Opcode::TAIL_CALL;
+}
+
+/// @brief Determines whether an instruction replaces the values it pops with a computed value
+/// @param opcode The opcode of the instruction
+/// @return true if the instruction pushes the result of an operation, false otherwise
+static auto computesValue(Opcode opcode) -> bool {
+    switch (opcode) {
+    case Opcode::ADD:
+    case Opcode::ADD_NUM_NUM:
+    case Opcode::DIVIDE:
+    case Opcode::DIVIDE_NUM_NUM:
+    case Opcode::EQUAL:
+    case Opcode::GREATER:
+    case Opcode::GREATER_EQUAL:
+    case Opcode::GREATER_EQUAL_NUM_NUM:
+    case Opcode::GREATER_NUM_NUM:
+    case Opcode::LESS:
+    case Opcode::LESS_EQUAL:
+    case Opcode::LESS_EQUAL_NUM_NUM:
+    case Opcode::LESS_NUM_NUM:
+    case Opcode::MULTIPLY:
+    case Opcode::MULTIPLY_NUM_NUM:
+    case Opcode::NEGATE:
+    case Opcode::NOT:
+    case Opcode::NOT_EQUAL:
+    case Opcode::SUBTRACT:
+    case Opcode::SUBTRACT_NUM_NUM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @brief Gets the function held by a value
+/// @param value The value
+/// @return The function or nullptr if the value is no function
+static auto functionOf(cppLox::Types::Value const & value) -> cppLox::Types::ObjectFunction * {
+    if (!value.is(cppLox::Types::Value::Type::OBJECT) ||
+        !value.as<cppLox::Types::Object *>()->is(cppLox::Types::Object::Type::FUNCTION)) {
+        return nullptr;
+    }
+    return value.as<cppLox::Types::Object *>()->as<cppLox::Types::ObjectFunction>();
+}
+
+/// @brief Gets the index of the constant, that is loaded by a CONSTANT or CONSTANT_LONG instruction
+/// @param code The bytecode, that contains the instruction
+/// @param offset The offset of the instruction
+/// @return The index of the constant
+static auto constantOperand(std::vector<uint8_t> const & code, size_t offset) -> size_t {
+    if (code[offset] == Opcode::CONSTANT_LONG) {
+        return static_cast<size_t>(code[offset + 1] << 8 | code[offset + 2]);
+    }
+    return code[offset + 1];
+}
+
+/// @brief Determines whether two constants can share a slot of the constant table
+/// @param left The first constant
+/// @param right The second constant
+/// @return true if the constants are indistinguishable, false otherwise
+static auto sameConstant(cppLox::Types::Value const & left, cppLox::Types::Value const & right) -> bool {
+    // Numbers are compared by their bits, since 0 and -0 are equal but print differently
+    if (left.isNumber() && right.isNumber()) {
+        return std::bit_cast<uint64_t>(left.as<double>()) == std::bit_cast<uint64_t>(right.as<double>());
+    }
+    return left.isNumber() == right.isNumber() && left == right;
+}
+
+auto Inliner::optimize(std::vector<cppLox::Types::ObjectFunction *> const & functions)
+    -> std::vector<cppLox::Types::ObjectFunction *> {
+    std::vector<cppLox::Types::ObjectFunction *> rewritten;
+    collectGlobals(functions);
+    for (cppLox::Types::ObjectFunction * function : functions) {
+        if (inlineCalls(*function)) {
+            rewritten.push_back(function);
+        }
+    }
+    return rewritten;
+}
+
+auto Inliner::collectGlobals(std::vector<cppLox::Types::ObjectFunction *> const & functions) -> void {
+    std::unordered_map<uint16_t, cppLox::Types::ObjectFunction *> definitions;
+    std::unordered_set<uint16_t> assigned;
+    m_globals.clear();
+    for (cppLox::Types::ObjectFunction * function : functions) {
+        cppLox::ByteCode::Chunk & chunk = *function->chunk();
+        std::optional<std::vector<Instruction>> const instructions = decode(chunk);
+        if (!instructions.has_value()) {
+            continue;
+        }
+        std::vector<uint8_t> const & code = chunk.code();
+        for (size_t index = 0; index < instructions->size(); index++) {
+            Instruction const & instruction = (*instructions)[index];
+            if (instruction.opcode != Opcode::DEFINE_GLOBAL && instruction.opcode != Opcode::SET_GLOBAL) {
+                continue;
+            }
+            auto const slot = static_cast<uint16_t>(code[instruction.offset + 1] << 8 | code[instruction.offset + 2]);
+            // A function declaration defines the global with the function constant, that is pushed right before
+            cppLox::Types::ObjectFunction * defined = nullptr;
+            if (instruction.opcode == Opcode::DEFINE_GLOBAL && index > 0 &&
+                ((*instructions)[index - 1].opcode == Opcode::CONSTANT ||
+                 (*instructions)[index - 1].opcode == Opcode::CONSTANT_LONG)) {
+                defined = functionOf(chunk.getConstant(constantOperand(code, (*instructions)[index - 1].offset)));
+            }
+            if (defined == nullptr || definitions.contains(slot)) {
+                assigned.insert(slot);
+            }
+            definitions[slot] = defined;
+        }
+    }
+    for (auto const & [slot, function] : definitions) {
+        if (!assigned.contains(slot)) {
+            m_globals[slot] = function;
+        }
+    }
+}
+
+auto Inliner::inlineCalls(cppLox::Types::ObjectFunction & caller) -> bool {
+    cppLox::ByteCode::Chunk & chunk = *caller.chunk();
+    std::optional<std::vector<Instruction>> const decoded = decode(chunk);
+    if (!decoded.has_value()) {
+        return false;
+    }
+    std::vector<Instruction> const & instructions = decoded.value();
+    std::optional<std::vector<std::optional<Stack>>> const states = simulate(chunk, instructions, caller.arity());
+    if (!states.has_value()) {
+        return false;
+    }
+    std::vector<uint8_t> const code = chunk.code();
+
+    // The constants, that the inlined bodies add to the constants of the caller
+    std::vector<cppLox::Types::Value> constants;
+    auto const constantIndex = [&chunk, &constants](cppLox::Types::Value const & value) -> std::optional<uint16_t> {
+        if (std::optional<size_t> const existing = chunk.findConstant(value); existing.has_value()) {
+            return static_cast<uint16_t>(existing.value());
+        }
+        for (size_t index = 0; index < constants.size(); index++) {
+            if (sameConstant(constants[index], value)) {
+                return static_cast<uint16_t>(chunk.getConstantCount() + index);
+            }
+        }
+        if (chunk.getConstantCount() + constants.size() > UINT16_MAX) {
+            return std::nullopt;
+        }
+        constants.push_back(value);
+        return static_cast<uint16_t>(chunk.getConstantCount() + constants.size() - 1);
+    };
+
+    // The inlined calls, that are recorded once the positions of the rewritten instructions are known
+    struct InlinedBody {
+        size_t start;
+        size_t end;
+        size_t function;
+        int line;
+    };
+    std::vector<InlinedBody> inlinedBodies;
+    std::vector<Output> output;
+    std::vector<size_t> outputIndices(instructions.size() + 1);
+    uint32_t maxStackDepth = caller.maxStackDepth();
+    for (size_t index = 0; index < instructions.size(); index++) {
+        Instruction const & instruction = instructions[index];
+        size_t const length = cppLox::ByteCode::instruction_length(instruction.opcode);
+        outputIndices[index] = output.size();
+        Body const * body = nullptr;
+        size_t position = 0;
+        uint8_t const argCount = isCall(instruction.opcode) ? code[instruction.offset + 1] : 0;
+        if (instruction.opcode != Opcode::CALL_INLINED && isCall(instruction.opcode) &&
+            states->at(index).has_value()) {
+            Stack const & stack = states->at(index).value();
+            position = stack.size() - argCount - 1;
+            if (stack[position] != nullptr) {
+                body = inlineable(*stack[position], argCount);
+            }
+        }
+        if (body == nullptr) {
+            Output copy{{code.begin() + instruction.offset, code.begin() + instruction.offset + length}, {}, {}};
+            for (size_t byte = instruction.offset; byte < instruction.offset + length; byte++) {
+                copy.lines.push_back(static_cast<int>(chunk.getLine(byte)));
+            }
+            output.push_back(std::move(copy));
+            continue;
+        }
+
+        cppLox::Types::ObjectFunction & callee = *states->at(index).value()[position];
+        cppLox::ByteCode::Chunk & calleeChunk = *callee.chunk();
+        std::vector<uint8_t> const & calleeCode = calleeChunk.code();
+        int const line = static_cast<int>(chunk.getLine(instruction.offset));
+        std::optional<uint16_t> const function = constantIndex(cppLox::Types::Value(&callee));
+        if (!function.has_value()) {
+            return false;
+        }
+        size_t const callIndex = output.size();
+        output.push_back(Output{{static_cast<uint8_t>(Opcode::CALL_INLINED), argCount,
+                                 static_cast<uint8_t>(function.value() >> 8), static_cast<uint8_t>(function.value()), 0,
+                                 0},
+                                std::vector<int>(6, line),
+                                {}});
+        size_t const start = output.size();
+        std::vector<size_t> bodyIndices(body->instructions.size());
+        std::vector<size_t> returnJumps;
+        for (size_t bodyIndex = 0; bodyIndex < body->instructions.size(); bodyIndex++) {
+            Instruction const & bodyInstruction = body->instructions[bodyIndex];
+            size_t const offset = bodyInstruction.offset;
+            bodyIndices[bodyIndex] = output.size();
+            Output inlined{{calleeCode.begin() + offset,
+                            calleeCode.begin() + offset + cppLox::ByteCode::instruction_length(bodyInstruction.opcode)},
+                           {},
+                           {}};
+            for (size_t byte = offset; byte < offset + inlined.bytes.size(); byte++) {
+                inlined.lines.push_back(static_cast<int>(calleeChunk.getLine(byte)));
+            }
+            // The slots of the body start at the callee, that stays on the stack of the caller
+            auto const remapLocal = [&](size_t operand) -> bool {
+                size_t const slot = inlined.bytes[operand] + position;
+                inlined.bytes[operand] = static_cast<uint8_t>(slot);
+                return slot <= UINT8_MAX;
+            };
+            // The constants of the body are moved to the caller, where a large index is loaded by CONSTANT_LONG
+            auto const remapConstant = [&](size_t operand, size_t index) -> bool {
+                std::optional<uint16_t> const constant = constantIndex(calleeChunk.getConstant(index));
+                if (!constant.has_value()) {
+                    return false;
+                }
+                if (constant.value() <= UINT8_MAX) {
+                    inlined.bytes.resize(operand + 1);
+                    inlined.bytes[operand] = static_cast<uint8_t>(constant.value());
+                } else {
+                    // A superinstruction is split into the load of the local and the wide load of the constant
+                    inlined.bytes.resize(operand > 1 ? operand : 0);
+                    if (!inlined.bytes.empty()) {
+                        inlined.bytes.front() = static_cast<uint8_t>(Opcode::GET_LOCAL);
+                    }
+                    inlined.bytes.push_back(static_cast<uint8_t>(Opcode::CONSTANT_LONG));
+                    inlined.bytes.push_back(static_cast<uint8_t>(constant.value() >> 8));
+                    inlined.bytes.push_back(static_cast<uint8_t>(constant.value()));
+                }
+                inlined.lines.resize(inlined.bytes.size(), inlined.lines.front());
+                return true;
+            };
+            bool remapped = true;
+            switch (bodyInstruction.opcode) {
+            case Opcode::CONSTANT:
+            case Opcode::CONSTANT_LONG:
+                inlined.bytes.front() = static_cast<uint8_t>(Opcode::CONSTANT);
+                remapped = remapConstant(1, constantOperand(calleeCode, offset));
+                break;
+            case Opcode::GET_LOCAL:
+            case Opcode::SET_LOCAL:
+            case Opcode::SET_LOCAL_POP:
+                remapped = remapLocal(1);
+                break;
+            case Opcode::GET_LOCAL_CONSTANT:
+                remapped = remapLocal(1) && remapConstant(2, calleeCode[offset + 2]);
+                break;
+            case Opcode::GET_LOCAL_GET_LOCAL:
+                remapped = remapLocal(1) && remapLocal(2);
+                break;
+            case Opcode::RETURN: {
+                // The result replaces the callee, like the return of a called function
+                bool const last = bodyIndex + 1 == body->instructions.size();
+                if (body->depths[bodyIndex] - 1 > UINT8_MAX) {
+                    return false;
+                }
+                inlined.bytes = {static_cast<uint8_t>(Opcode::RETURN_INLINED),
+                                 static_cast<uint8_t>(body->depths[bodyIndex] - 1)};
+                inlined.lines = std::vector<int>(2, last ? line : inlined.lines.front());
+                output.push_back(std::move(inlined));
+                if (!last) {
+                    returnJumps.push_back(output.size());
+                    output.push_back(Output{{static_cast<uint8_t>(Opcode::JUMP), 0, 0}, std::vector<int>(3, line), {}});
+                }
+                continue;
+            }
+            default:
+                inlined.target = bodyInstruction.target;
+                break;
+            }
+            if (!remapped) {
+                return false;
+            }
+            output.push_back(std::move(inlined));
+        }
+        for (size_t inlinedIndex = start; inlinedIndex < output.size(); inlinedIndex++) {
+            if (output[inlinedIndex].target.has_value()) {
+                output[inlinedIndex].target = bodyIndices[output[inlinedIndex].target.value()];
+            }
+        }
+        // Any other callee returns behind the body, where the returns of the body continue as well
+        for (size_t const jump : returnJumps) {
+            output[jump].target = output.size();
+        }
+        output[callIndex].target = output.size();
+        inlinedBodies.push_back(InlinedBody{start, output.size() - 1, function.value(), line});
+        maxStackDepth = std::max<uint32_t>(maxStackDepth, static_cast<uint32_t>(position) + callee.maxStackDepth());
+    }
+    if (inlinedBodies.empty()) {
+        return false;
+    }
+    outputIndices[instructions.size()] = output.size();
+
+    // The jumps of the caller are resolved once every instruction of the caller was placed
+    for (size_t index = 0; index < instructions.size(); index++) {
+        if (instructions[index].target.has_value()) {
+            output[outputIndices[index]].target = outputIndices[instructions[index].target.value()];
+        }
+    }
+    std::vector<size_t> positions(output.size() + 1, 0);
+    for (size_t index = 0; index < output.size(); index++) {
+        positions[index + 1] = positions[index] + output[index].bytes.size();
+    }
+    for (size_t index = 0; index < output.size(); index++) {
+        Output & instruction = output[index];
+        if (!instruction.target.has_value()) {
+            continue;
+        }
+        auto const opcode = static_cast<Opcode>(instruction.bytes.front());
+        size_t const from = positions[index + 1];
+        size_t const destination = positions[instruction.target.value()];
+        bool const backward = opcode == Opcode::LOOP;
+        if (backward ? destination > from : destination < from) {
+            return false;
+        }
+        size_t const distance = backward ? from - destination : destination - from;
+        if (distance > UINT16_MAX) {
+            return false;
+        }
+        size_t const operand = opcode == Opcode::CALL_INLINED ? 4 : 1;
+        instruction.bytes[operand] = static_cast<uint8_t>((distance >> 8) & 0xff);
+        instruction.bytes[operand + 1] = static_cast<uint8_t>(distance & 0xff);
+    }
+
+    chunk.truncate(0);
+    for (Output const & instruction : output) {
+        for (size_t byte = 0; byte < instruction.bytes.size(); byte++) {
+            chunk.write(instruction.bytes[byte], instruction.lines[byte]);
+        }
+    }
+    for (cppLox::Types::Value const & constant : constants) {
+        static_cast<void>(chunk.addConstant(constant));
+    }
+    for (InlinedBody const & inlinedBody : inlinedBodies) {
+        chunk.addInlinedCall(cppLox::ByteCode::InlinedCall{positions[inlinedBody.start], positions[inlinedBody.end],
+                                                           inlinedBody.function, inlinedBody.line});
+    }
+    caller.updateMaxStackDepth(maxStackDepth);
+    return true;
+}
+
+[[nodiscard]] auto Inliner::inlineable(cppLox::Types::ObjectFunction & callee, uint8_t argCount) -> Body const * {
+    if (callee.arity() != argCount) {
+        return nullptr;
+    }
+    auto const cached = m_bodies.find(&callee);
+    if (cached != m_bodies.end()) {
+        return cached->second.has_value() ? &cached->second.value() : nullptr;
+    }
+    std::optional<Body> & body = m_bodies[&callee];
+    cppLox::ByteCode::Chunk & chunk = *callee.chunk();
+    if (chunk.getSize() == 0 || chunk.getSize() > MAX_INLINED_SIZE) {
+        return nullptr;
+    }
+    std::optional<std::vector<Instruction>> instructions = decode(chunk);
+    // Only leaf functions are inlined, so a body never contains another call and recursion can not be unrolled
+    if (!instructions.has_value() || instructions->back().opcode != Opcode::RETURN ||
+        std::any_of(instructions->begin(), instructions->end(),
+                    [](Instruction const & instruction) { return isCall(instruction.opcode); })) {
+        return nullptr;
+    }
+    std::optional<std::vector<std::optional<Stack>>> const states = simulate(chunk, *instructions, callee.arity());
+    if (!states.has_value()) {
+        return nullptr;
+    }
+    std::vector<size_t> depths;
+    for (std::optional<Stack> const & state : *states) {
+        // The depth of an unreachable return is unknown
+        if (!state.has_value()) {
+            return nullptr;
+        }
+        depths.push_back(state->size());
+    }
+    body = Body{std::move(instructions.value()), std::move(depths)};
+    return &body.value();
+}
+
+[[nodiscard]] auto Inliner::decode(cppLox::ByteCode::Chunk & chunk) -> std::optional<std::vector<Instruction>> {
+    std::vector<uint8_t> const & code = chunk.code();
+    std::vector<Instruction> instructions;
+    std::vector<size_t> indices(code.size() + 1, SIZE_MAX);
+    for (size_t offset = 0; offset < code.size();) {
+        auto const opcode = static_cast<Opcode>(code[offset]);
+        size_t const length = cppLox::ByteCode::instruction_length(opcode);
+        if (opcode > Opcode::TRUE || offset + length > code.size()) {
+            return std::nullopt;
+        }
+        std::optional<size_t> target;
+        if (isJump(opcode)) {
+            size_t const operand = static_cast<size_t>(code[offset + 1] << 8 | code[offset + 2]);
+            target = opcode == Opcode::LOOP ? offset + 3 - operand : offset + 3 + operand;
+        }
+        indices[offset] = instructions.size();
+        instructions.push_back(Instruction{offset, opcode, target});
+        offset += length;
+    }
+    // Every jump has to land on an instruction of the chunk
+    for (Instruction & instruction : instructions) {
+        if (instruction.target.has_value()) {
+            if (instruction.target.value() >= code.size() || indices[instruction.target.value()] == SIZE_MAX) {
+                return std::nullopt;
+            }
+            instruction.target = indices[instruction.target.value()];
+        }
+    }
+    if (instructions.empty()) {
+        return std::nullopt;
+    }
+    return instructions;
+}
+
+[[nodiscard]] auto Inliner::simulate(cppLox::ByteCode::Chunk & chunk, std::vector<Instruction> const & instructions,
+                                     uint16_t arity) const -> std::optional<std::vector<std::optional<Stack>>> {
+    std::vector<uint8_t> const & code = chunk.code();
+    std::vector<std::optional<Stack>> states(instructions.size());
+    // The state of the stack, that reaches the instructions jumped to in forward direction
+    std::vector<std::optional<Stack>> incoming(instructions.size());
+    // A join of two paths only keeps the functions that both paths agree on
+    auto const join = [](std::optional<Stack> & into, Stack const & from) -> bool {
+        if (!into.has_value()) {
+            into = from;
+            return true;
+        }
+        if (into->size() != from.size()) {
+            return false;
+        }
+        for (size_t position = 0; position < from.size(); position++) {
+            if (into->at(position) != from[position]) {
+                into->at(position) = nullptr;
+            }
+        }
+        return true;
+    };
+    std::optional<Stack> current = Stack(arity + 1, nullptr);
+    for (size_t index = 0; index < instructions.size(); index++) {
+        Instruction const & instruction = instructions[index];
+        if (incoming[index].has_value() && !join(current, incoming[index].value())) {
+            return std::nullopt;
+        }
+        states[index] = current;
+        if (!current.has_value()) {
+            continue;
+        }
+        Stack & stack = current.value();
+        size_t const length = cppLox::ByteCode::instruction_length(instruction.opcode);
+        uint8_t const first = length > 1 ? code[instruction.offset + 1] : 0;
+        uint8_t const second = length > 2 ? code[instruction.offset + 2] : 0;
+        // The local slots start above the function of the frame
+        auto const local = [&stack](uint8_t slot) -> cppLox::Types::ObjectFunction * {
+            return slot + 1u < stack.size() ? stack[slot + 1u] : nullptr;
+        };
+        int const effect = cppLox::ByteCode::stack_effect(instruction.opcode);
+        size_t const popped = isCall(instruction.opcode) ? first : (effect < 0 ? -effect : 0);
+        if (stack.size() < popped + (isCall(instruction.opcode) ? 1 : 0)) {
+            return std::nullopt;
+        }
+        switch (instruction.opcode) {
+        case Opcode::CONSTANT:
+        case Opcode::CONSTANT_LONG:
+            stack.push_back(functionOf(chunk.getConstant(constantOperand(code, instruction.offset))));
+            break;
+        case Opcode::GET_GLOBAL:
+            stack.push_back(globalFunction(static_cast<uint16_t>(first << 8 | second)));
+            break;
+        case Opcode::GET_LOCAL:
+            stack.push_back(local(first));
+            break;
+        case Opcode::GET_LOCAL_CONSTANT:
+            stack.push_back(local(first));
+            stack.push_back(functionOf(chunk.getConstant(second)));
+            break;
+        case Opcode::GET_LOCAL_GET_LOCAL:
+            stack.push_back(local(first));
+            stack.push_back(local(second));
+            break;
+        case Opcode::SET_LOCAL:
+        case Opcode::SET_LOCAL_POP:
+            if (first + 1u < stack.size()) {
+                stack[first + 1u] = stack.back();
+            }
+            if (instruction.opcode == Opcode::SET_LOCAL_POP) {
+                stack.pop_back();
+            }
+            break;
+        case Opcode::RETURN_INLINED:
+            if (stack.size() <= first) {
+                return std::nullopt;
+            }
+            stack.resize(stack.size() - first);
+            stack.back() = nullptr;
+            break;
+        default:
+            stack.resize(stack.size() - popped);
+            for (int pushed = 0; pushed < effect; pushed++) {
+                stack.push_back(nullptr);
+            }
+            // A call or an operation replaces the value below its operands with its result
+            if ((isCall(instruction.opcode) || computesValue(instruction.opcode)) && !stack.empty()) {
+                stack.back() = nullptr;
+            }
+            break;
+        }
+        if (instruction.target.has_value() && instruction.target.value() > index &&
+            !join(incoming[instruction.target.value()], stack)) {
+            return std::nullopt;
+        }
+        if (instruction.opcode == Opcode::JUMP || instruction.opcode == Opcode::LOOP ||
+            instruction.opcode == Opcode::RETURN) {
+            current = std::nullopt;
+        }
+    }
+    return states;
+}
+
+[[nodiscard]] auto Inliner::globalFunction(uint16_t slot) const -> cppLox::Types::ObjectFunction * {
+    auto const global = m_globals.find(slot);
+    return global != m_globals.end() ? global->second : nullptr;
+}
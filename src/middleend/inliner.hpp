@@ -0,0 +1,141 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file inliner.hpp
+ * @brief This file contains the declaration of the Inliner class.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "../bytecode/chunk.hpp"
+#include "../bytecode/opcode.hpp"
+#include "../types/object_function.hpp"
+
+namespace cppLox::MiddleEnd {
+
+/// @brief Inlines the calls of small functions into the bytecode of their callers.
+/// @details The inliner runs once over all functions of a compilation unit after they were compiled. A call is inlined
+/// if its callee can be resolved at compile time - a function constant, a local variable holding one or a global
+/// variable that is defined once with a function and never assigned - and the callee is a small leaf function, that
+/// takes as many parameters as there are arguments. The call is replaced by a `CALL_INLINED`, that is followed by the
+/// body of the callee. The callee and the arguments stay on the stack and become the first slots of the inlined body,
+/// so its local slots are shifted by the position of the callee and its constants are copied to the caller. Every
+/// `RETURN` of the body becomes a `RETURN_INLINED`, that discards the slots of the body below the result. The
+/// resolution is only an assumption - `CALL_INLINED` compares the callee with the inlined function at runtime and
+/// calls any other callee like `CALL`, before it jumps over the body. The lines of the body are kept and the inlined
+/// call is recorded in the chunk of the caller, so a runtime error inside the body still lists the inlined function.
+class Inliner {
+  public:
+    /// @brief The maximum size of the bytecode of a function, that is inlined.
+    static constexpr size_t MAX_INLINED_SIZE = 48;
+
+    /// @brief Constructs a new inliner.
+    Inliner() = default;
+
+    /// @brief Destructor of the inliner.
+    ~Inliner() = default;
+
+    /// @brief Inlines the calls between the given functions.
+    /// @param functions The functions of the compilation unit.
+    /// @return The functions, whose bytecode was rewritten.
+    auto optimize(std::vector<cppLox::Types::ObjectFunction *> const & functions)
+        -> std::vector<cppLox::Types::ObjectFunction *>;
+
+  private:
+    /// @brief An instruction of a decoded chunk.
+    struct Instruction {
+        /// @brief The offset of the instruction in the chunk.
+        size_t offset;
+
+        /// @brief The opcode of the instruction.
+        cppLox::ByteCode::Opcode opcode;
+
+        /// @brief The index of the instruction the jump lands on, if the instruction is a jump.
+        std::optional<size_t> target;
+    };
+
+    /// @brief The decoded body of a function, that can be inlined.
+    struct Body {
+        /// @brief The instructions of the function.
+        std::vector<Instruction> instructions;
+
+        /// @brief The depth of the stack before every instruction.
+        std::vector<size_t> depths;
+    };
+
+    /// @brief An instruction of a rewritten chunk.
+    struct Output {
+        /// @brief The bytes of the instruction.
+        std::vector<uint8_t> bytes;
+
+        /// @brief The line of every byte of the instruction.
+        std::vector<int> lines;
+
+        /// @brief The index of the output instruction the jump lands on, if the instruction is a jump.
+        std::optional<size_t> target;
+    };
+
+    /// @brief The state of the stack, that is the function every value is known to hold or nullptr.
+    using Stack = std::vector<cppLox::Types::ObjectFunction *>;
+
+    /// @brief Collects the global variables, that are defined once with a function and never assigned.
+    /// @param functions The functions of the compilation unit.
+    auto collectGlobals(std::vector<cppLox::Types::ObjectFunction *> const & functions) -> void;
+
+    /// @brief Inlines the calls of the given function.
+    /// @param caller The function, whose calls are inlined.
+    /// @return true if the bytecode of the function was rewritten, false otherwise.
+    auto inlineCalls(cppLox::Types::ObjectFunction & caller) -> bool;
+
+    /// @brief Gets the body of the given function, if it can be inlined at a call with the given amount of arguments.
+    /// @param callee The called function.
+    /// @param argCount The amount of arguments of the call.
+    /// @return The decoded body or nullptr if the function can not be inlined.
+    [[nodiscard]] auto inlineable(cppLox::Types::ObjectFunction & callee, uint8_t argCount) -> Body const *;
+
+    /// @brief Decodes the instructions of the given chunk.
+    /// @param chunk The chunk that is decoded.
+    /// @return The instructions or an empty optional if the chunk contains an incomplete instruction.
+    [[nodiscard]] static auto decode(cppLox::ByteCode::Chunk & chunk) -> std::optional<std::vector<Instruction>>;
+
+    /// @brief Determines the state of the stack before every instruction of a chunk.
+    /// @param chunk The decoded chunk.
+    /// @param instructions The instructions of the chunk.
+    /// @param arity The arity of the function of the chunk.
+    /// @return The state before every reachable instruction or an empty optional if the depths of the stack do not
+    /// match where control flow joins.
+    [[nodiscard]] auto simulate(cppLox::ByteCode::Chunk & chunk, std::vector<Instruction> const & instructions,
+                                uint16_t arity) const -> std::optional<std::vector<std::optional<Stack>>>;
+
+    /// @brief Gets the function, that the given global variable is known to hold.
+    /// @param slot The global slot of the variable.
+    /// @return The function or nullptr if the variable is not known to hold a function.
+    [[nodiscard]] auto globalFunction(uint16_t slot) const -> cppLox::Types::ObjectFunction *;
+
+    /// @brief The global variables, that are defined once with a function and never assigned.
+    std::unordered_map<uint16_t, cppLox::Types::ObjectFunction *> m_globals;
+
+    /// @brief The decoded bodies of the functions, that were checked for inlining.
+    std::unordered_map<cppLox::Types::ObjectFunction *, std::optional<Body>> m_bodies;
+};
+
+} // namespace cppLox::MiddleEnd
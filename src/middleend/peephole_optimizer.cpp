@@ -0,0 +1,238 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file peephole_optimizer.cpp
+ * @brief This file contains the implementation of the PeepholeOptimizer class.
+ */
+
+#include "peephole_optimizer.hpp"
+
+#include <cstdint>
+
+using namespace cppLox::MiddleEnd;
+
+using cppLox::ByteCode::Opcode;
+
+/// @brief Determines whether an instruction is a jump
+/// @param opcode The opcode of the instruction
+/// @return true if the instruction has a jump offset as its operand, false otherwise
+static auto isJump(Opcode opcode) -> bool {
+    switch (opcode) {
+    case Opcode::EQUAL_JUMP_IF_FALSE:
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::GREATER_JUMP_IF_FALSE:
+    case Opcode::GREATER_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::JUMP:
+    case Opcode::JUMP_IF_FALSE:
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::LESS_JUMP_IF_FALSE:
+    case Opcode::LESS_JUMP_IF_FALSE_NUM_NUM:
+    case Opcode::LOOP:
+    case Opcode::NOT_EQUAL_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_TRUE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @brief Determines whether a jump is always taken
+/// @param opcode The opcode of the jump
+/// @return true if the jump is taken regardless of the values on the stack, false otherwise
+static auto isUnconditional(Opcode opcode) -> bool {
+    return opcode == Opcode::JUMP || opcode == Opcode::LOOP;
+}
+
+auto PeepholeOptimizer::optimize(cppLox::ByteCode::Chunk & chunk) -> void {
+    if (chunk.getSize() == 0) {
+        return;
+    }
+    decode(chunk);
+    collapseJumpChains();
+    removeUnreachableCode();
+    fuseNegatedJumps();
+    removeRedundantJumps();
+    rebuild(chunk);
+}
+
+auto PeepholeOptimizer::decode(cppLox::ByteCode::Chunk & chunk) -> void {
+    std::vector<uint8_t> const & code = chunk.code();
+    m_instructions.clear();
+    m_indices.assign(code.size() + 1, 0);
+    for (size_t offset = 0; offset < code.size();) {
+        auto const opcode = static_cast<Opcode>(code[offset]);
+        size_t const length = cppLox::ByteCode::instruction_length(opcode);
+        std::optional<size_t> target;
+        if (isJump(opcode)) {
+            size_t const operand = static_cast<size_t>(code[offset + 1] << 8 | code[offset + 2]);
+            target = opcode == Opcode::LOOP ? offset + 3 - operand : offset + 3 + operand;
+        }
+        for (size_t byte = offset; byte < offset + length && byte < code.size(); byte++) {
+            m_indices[byte] = m_instructions.size();
+        }
+        m_instructions.push_back(Instruction{offset, opcode, target, true});
+        offset += length;
+    }
+    m_indices[code.size()] = m_instructions.size();
+}
+
+auto PeepholeOptimizer::collapseJumpChains() -> void {
+    for (Instruction & instruction : m_instructions) {
+        if (!instruction.target.has_value()) {
+            continue;
+        }
+        size_t target = instruction.target.value();
+        size_t const from = instruction.offset + 3;
+        // Every jump of the chain is followed at most once, so a jump that loops back to itself ends the chain
+        for (size_t step = 0; step < m_instructions.size(); step++) {
+            size_t const index = indexOf(target);
+            if (index == m_instructions.size()) {
+                break;
+            }
+            Instruction const & next = m_instructions[index];
+            // A jump if false leaves the condition on the stack, so the jump it lands on takes the same branch
+            bool const follows = isUnconditional(next.opcode) ||
+                                 (instruction.opcode == Opcode::JUMP_IF_FALSE && next.opcode == Opcode::JUMP_IF_FALSE);
+            if (!follows) {
+                break;
+            }
+            size_t const candidate = next.target.value();
+            bool const forward = candidate >= from;
+            // Only unconditional jumps can be turned around, since there are no backward conditional jumps
+            if ((!forward && !isUnconditional(instruction.opcode)) ||
+                (forward ? candidate - from : from - candidate) > UINT16_MAX) {
+                break;
+            }
+            target = candidate;
+        }
+        instruction.target = target;
+    }
+}
+
+auto PeepholeOptimizer::fuseNegatedJumps() -> void {
+    std::vector<bool> const targets = jumpTargets();
+    for (size_t index = 0; index + 1 < m_instructions.size(); index++) {
+        Instruction & negation = m_instructions[index];
+        Instruction & jump = m_instructions[index + 1];
+        if (negation.kept && negation.opcode == Opcode::NOT && jump.kept && jump.opcode == Opcode::POP_JUMP_IF_FALSE &&
+            !targets[index + 1]) {
+            negation.kept = false;
+            jump.opcode = Opcode::POP_JUMP_IF_TRUE;
+        }
+    }
+}
+
+auto PeepholeOptimizer::removeUnreachableCode() -> void {
+    std::vector<bool> reachable(m_instructions.size(), false);
+    std::vector<size_t> worklist = {0};
+    while (!worklist.empty()) {
+        size_t const index = worklist.back();
+        worklist.pop_back();
+        if (index >= m_instructions.size() || reachable[index]) {
+            continue;
+        }
+        reachable[index] = true;
+        Instruction const & instruction = m_instructions[index];
+        if (instruction.target.has_value()) {
+            worklist.push_back(indexOf(instruction.target.value()));
+        }
+        if (!isUnconditional(instruction.opcode) && instruction.opcode != Opcode::RETURN) {
+            worklist.push_back(index + 1);
+        }
+    }
+    for (size_t index = 0; index < m_instructions.size(); index++) {
+        m_instructions[index].kept = reachable[index];
+    }
+}
+
+auto PeepholeOptimizer::removeRedundantJumps() -> void {
+    for (size_t index = m_instructions.size(); index-- > 0;) {
+        Instruction & jump = m_instructions[index];
+        if (!jump.kept || jump.opcode != Opcode::JUMP) {
+            continue;
+        }
+        size_t const target = indexOf(jump.target.value());
+        size_t next = index + 1;
+        while (next < target && !m_instructions[next].kept) {
+            next++;
+        }
+        if (next == target) {
+            jump.kept = false;
+        }
+    }
+}
+
+auto PeepholeOptimizer::rebuild(cppLox::ByteCode::Chunk & chunk) -> void {
+    std::vector<uint8_t> const code = chunk.code();
+    std::vector<int> lines(code.size());
+    for (size_t offset = 0; offset < code.size(); offset++) {
+        lines[offset] = static_cast<int>(chunk.getLine(offset));
+    }
+    // A removed instruction is replaced by the next kept instruction, so jumps to it land on that instruction
+    std::vector<size_t> positions(m_instructions.size() + 1);
+    size_t position = 0;
+    for (size_t index = 0; index < m_instructions.size(); index++) {
+        positions[index] = position;
+        if (m_instructions[index].kept) {
+            position += cppLox::ByteCode::instruction_length(m_instructions[index].opcode);
+        }
+    }
+    positions[m_instructions.size()] = position;
+
+    chunk.truncate(0);
+    for (size_t index = 0; index < m_instructions.size(); index++) {
+        Instruction const & instruction = m_instructions[index];
+        if (!instruction.kept) {
+            continue;
+        }
+        size_t const length = cppLox::ByteCode::instruction_length(instruction.opcode);
+        if (!instruction.target.has_value()) {
+            chunk.write(instruction.opcode, lines[instruction.offset]);
+            for (size_t byte = instruction.offset + 1; byte < instruction.offset + length; byte++) {
+                chunk.write(code[byte], lines[byte]);
+            }
+            continue;
+        }
+        size_t const destination = positions[indexOf(instruction.target.value())];
+        size_t const from = positions[index] + length;
+        bool const forward = destination >= from;
+        Opcode opcode = instruction.opcode;
+        if (isUnconditional(opcode)) {
+            opcode = forward ? Opcode::JUMP : Opcode::LOOP;
+        }
+        size_t const distance = forward ? destination - from : from - destination;
+        chunk.write(opcode, lines[instruction.offset]);
+        chunk.write(static_cast<uint8_t>((distance >> 8) & 0xff), lines[instruction.offset + 1]);
+        chunk.write(static_cast<uint8_t>(distance & 0xff), lines[instruction.offset + 2]);
+    }
+}
+
+[[nodiscard]] auto PeepholeOptimizer::indexOf(size_t offset) const -> size_t {
+    return m_indices[offset];
+}
+
+[[nodiscard]] auto PeepholeOptimizer::jumpTargets() const -> std::vector<bool> {
+    std::vector<bool> targets(m_instructions.size() + 1, false);
+    for (Instruction const & instruction : m_instructions) {
+        if (instruction.kept && instruction.target.has_value()) {
+            targets[indexOf(instruction.target.value())] = true;
+        }
+    }
+    return targets;
+}
@@ -0,0 +1,103 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file peephole_optimizer.hpp
+ * @brief This file contains the declaration of the PeepholeOptimizer class.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "../bytecode/chunk.hpp"
+#include "../bytecode/opcode.hpp"
+
+namespace cppLox::MiddleEnd {
+
+/// @brief Optimizes the bytecode of a compiled function by rewriting short instruction sequences.
+/// @details The optimizer runs over the complete chunk of a function after the compiler has emitted it. It redirects
+/// jumps, that land on another jump, to the final target of the chain, fuses `NOT; POP_JUMP_IF_FALSE` into
+/// `POP_JUMP_IF_TRUE`, removes the instructions that can not be reached from the start of the chunk, like the implicit
+/// `NULL_; RETURN` after an explicit return, and drops jumps to the instruction directly following them. The chunk is
+/// then rewritten with the jump offsets patched to the new positions of their targets, while every remaining byte keeps
+/// its line.
+class PeepholeOptimizer {
+  public:
+    /// @brief Constructs a new peephole optimizer.
+    PeepholeOptimizer() = default;
+
+    /// @brief Destructor of the peephole optimizer.
+    ~PeepholeOptimizer() = default;
+
+    /// @brief Optimizes the bytecode of the given chunk.
+    /// @param chunk The chunk that is optimized.
+    auto optimize(cppLox::ByteCode::Chunk & chunk) -> void;
+
+  private:
+    /// @brief An instruction of the optimized chunk.
+    struct Instruction {
+        /// @brief The offset of the instruction in the original chunk.
+        size_t offset;
+
+        /// @brief The opcode of the instruction.
+        cppLox::ByteCode::Opcode opcode;
+
+        /// @brief The original offset of the jump target, if the instruction is a jump.
+        std::optional<size_t> target;
+
+        /// @brief Whether the instruction is kept in the optimized chunk.
+        bool kept;
+    };
+
+    /// @brief Decodes the instructions of the given chunk.
+    /// @param chunk The chunk that is decoded.
+    auto decode(cppLox::ByteCode::Chunk & chunk) -> void;
+
+    /// @brief Redirects the jumps, that land on another jump, to the final target of the chain.
+    auto collapseJumpChains() -> void;
+
+    /// @brief Fuses the negation of a condition with the conditional jump that consumes it.
+    auto fuseNegatedJumps() -> void;
+
+    /// @brief Removes the instructions that can not be reached from the start of the chunk.
+    auto removeUnreachableCode() -> void;
+
+    /// @brief Removes the jumps to the instruction that follows them.
+    auto removeRedundantJumps() -> void;
+
+    /// @brief Writes the kept instructions back to the given chunk.
+    /// @param chunk The chunk that is rewritten.
+    auto rebuild(cppLox::ByteCode::Chunk & chunk) -> void;
+
+    /// @brief Gets the index of the instruction at the given offset of the original chunk.
+    /// @param offset The original offset, the size of the original chunk refers to the end of the chunk.
+    /// @return The index of the instruction, the amount of instructions for the end of the chunk.
+    [[nodiscard]] auto indexOf(size_t offset) const -> size_t;
+
+    /// @brief Determines which instructions are the target of a jump.
+    /// @return Whether a kept jump lands on the instruction for every instruction.
+    [[nodiscard]] auto jumpTargets() const -> std::vector<bool>;
+
+    /// @brief The decoded instructions of the chunk.
+    std::vector<Instruction> m_instructions;
+
+    /// @brief The index of the instruction at every offset of the original chunk.
+    std::vector<size_t> m_indices;
+};
+
+} // namespace cppLox::MiddleEnd
@@ -0,0 +1,654 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file ssa_builder.cpp
+ * @brief This file contains the implementation of the SsaBuilder class.
+ */
+
+#include "ssa_builder.hpp"
+
+#include <algorithm>
+
+#include "../types/object.hpp"
+
+using namespace cppLox::MiddleEnd;
+
+using cppLox::ByteCode::Opcode;
+
+/// @brief Gets the amount of values an instruction pops from the stack
+/// @param opcode The opcode of the instruction, that is not a superinstruction
+/// @param operand The operand of the instruction
+/// @return The amount of values the instruction pops
+static auto popCount(Opcode opcode, size_t operand) -> size_t {
+    switch (opcode) {
+    case Opcode::ADD:
+    case Opcode::DIVIDE:
+    case Opcode::EQUAL:
+    case Opcode::GREATER:
+    case Opcode::GREATER_EQUAL:
+    case Opcode::LESS:
+    case Opcode::LESS_EQUAL:
+    case Opcode::MULTIPLY:
+    case Opcode::NOT_EQUAL:
+    case Opcode::SUBTRACT:
+        return 2;
+    case Opcode::CALL:
+    case Opcode::TAIL_CALL:
+        return operand + 1;
+    case Opcode::DEFINE_GLOBAL:
+    case Opcode::NEGATE:
+    case Opcode::NOT:
+    case Opcode::POP:
+    case Opcode::POP_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_TRUE:
+    case Opcode::PRINT:
+    case Opcode::RETURN:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/// @brief Determines whether an instruction pushes a value
+/// @param opcode The opcode of the instruction, that is not a superinstruction
+/// @return true if the instruction pushes a value, false otherwise
+static auto pushesValue(Opcode opcode) -> bool {
+    switch (opcode) {
+    case Opcode::ADD:
+    case Opcode::CALL:
+    case Opcode::CONSTANT:
+    case Opcode::DIVIDE:
+    case Opcode::EQUAL:
+    case Opcode::FALSE:
+    case Opcode::GET_GLOBAL:
+    case Opcode::GET_LOCAL:
+    case Opcode::GREATER:
+    case Opcode::GREATER_EQUAL:
+    case Opcode::LESS:
+    case Opcode::LESS_EQUAL:
+    case Opcode::MULTIPLY:
+    case Opcode::NEGATE:
+    case Opcode::NOT:
+    case Opcode::NOT_EQUAL:
+    case Opcode::NULL_:
+    case Opcode::SUBTRACT:
+    case Opcode::TAIL_CALL:
+    case Opcode::TRUE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @brief Determines whether an instruction ends a basic block
+/// @param opcode The opcode of the instruction, that is not a superinstruction
+/// @return true if the instruction jumps or returns, false otherwise
+static auto endsBlock(Opcode opcode) -> bool {
+    switch (opcode) {
+    case Opcode::JUMP:
+    case Opcode::JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_FALSE:
+    case Opcode::POP_JUMP_IF_TRUE:
+    case Opcode::RETURN:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @brief Gets the comparison a fused comparison and jump starts with
+/// @param opcode The opcode of the fused instruction
+/// @return The opcode of the comparison or AMOUNT, if the instruction is no fused comparison
+static auto fusedComparison(Opcode opcode) -> Opcode {
+    switch (opcode) {
+    case Opcode::EQUAL_JUMP_IF_FALSE:
+        return Opcode::EQUAL;
+    case Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+        return Opcode::GREATER_EQUAL;
+    case Opcode::GREATER_JUMP_IF_FALSE:
+        return Opcode::GREATER;
+    case Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+        return Opcode::LESS_EQUAL;
+    case Opcode::LESS_JUMP_IF_FALSE:
+        return Opcode::LESS;
+    case Opcode::NOT_EQUAL_JUMP_IF_FALSE:
+        return Opcode::NOT_EQUAL;
+    default:
+        return Opcode::AMOUNT;
+    }
+}
+
+/// @brief Gets the types of a constant
+/// @param constant The constant
+/// @return The flag of the type of the constant
+static auto typeOf(cppLox::Types::Value const & constant) -> uint8_t {
+    switch (constant.getType()) {
+    case cppLox::Types::Value::Type::BOOL:
+        return BOOL_TYPE;
+    case cppLox::Types::Value::Type::NULL_:
+        return NULL_TYPE;
+    case cppLox::Types::Value::Type::NUMBER:
+        return NUMBER_TYPE;
+    case cppLox::Types::Value::Type::OBJECT:
+        return constant.as<cppLox::Types::Object *>()->is(cppLox::Types::Object::Type::STRING) ? STRING_TYPE
+                                                                                               : OBJECT_TYPE;
+    }
+    return ANY_TYPE;
+}
+
+[[nodiscard]] auto SsaBuilder::build(cppLox::Types::ObjectFunction & function) -> std::optional<SsaFunction> {
+    SsaFunction ssaFunction(function);
+    if (!decode(*function.chunk()) || !createBlocks(ssaFunction)) {
+        return std::nullopt;
+    }
+    orderBlocks(ssaFunction);
+    if (!computeDepths(ssaFunction)) {
+        return std::nullopt;
+    }
+    createValues(ssaFunction);
+    removeTrivialPhis(ssaFunction);
+    computeDominators(ssaFunction);
+    if (!findLoops(ssaFunction)) {
+        return std::nullopt;
+    }
+    return ssaFunction;
+}
+
+[[nodiscard]] auto SsaBuilder::decode(cppLox::ByteCode::Chunk & chunk) -> bool {
+    std::vector<uint8_t> const & code = chunk.code();
+    m_instructions.clear();
+    for (size_t offset = 0; offset < code.size();) {
+        if (code[offset] >= static_cast<uint8_t>(Opcode::AMOUNT)) {
+            return false;
+        }
+        auto const opcode = static_cast<Opcode>(code[offset]);
+        size_t const length = cppLox::ByteCode::instruction_length(opcode);
+        if (offset + length > code.size()) {
+            return false;
+        }
+        int const line = static_cast<int>(chunk.getLine(offset));
+        size_t const first = length > 1 ? code[offset + 1] : 0;
+        size_t const second = length > 2 ? code[offset + 2] : 0;
+        size_t const operand = first << 8 | second;
+        auto const add = [&](Opcode decoded, size_t decodedOperand) {
+            m_instructions.push_back(Instruction{offset, decoded, decodedOperand, line});
+        };
+        switch (opcode) {
+        case Opcode::CALL:
+        case Opcode::CONSTANT:
+        case Opcode::TAIL_CALL:
+            add(opcode, first);
+            break;
+        case Opcode::CONSTANT_LONG:
+            // The width of the index is chosen again, when the function is emitted
+            add(Opcode::CONSTANT, operand);
+            break;
+        case Opcode::GET_LOCAL:
+        case Opcode::SET_LOCAL:
+            // The operand of a local counts from the first slot after the called function
+            add(opcode, first + 1);
+            break;
+        case Opcode::GET_LOCAL_CONSTANT:
+            add(Opcode::GET_LOCAL, first + 1);
+            add(Opcode::CONSTANT, second);
+            break;
+        case Opcode::GET_LOCAL_GET_LOCAL:
+            add(Opcode::GET_LOCAL, first + 1);
+            add(Opcode::GET_LOCAL, second + 1);
+            break;
+        case Opcode::SET_LOCAL_POP:
+            add(Opcode::SET_LOCAL, first + 1);
+            add(Opcode::POP, 0);
+            break;
+        case Opcode::DEFINE_GLOBAL:
+        case Opcode::GET_GLOBAL:
+        case Opcode::SET_GLOBAL:
+            add(opcode, operand);
+            break;
+        case Opcode::JUMP:
+        case Opcode::JUMP_IF_FALSE:
+        case Opcode::POP_JUMP_IF_FALSE:
+        case Opcode::POP_JUMP_IF_TRUE:
+            add(opcode, offset + 3 + operand);
+            break;
+        case Opcode::LOOP:
+            if (operand > offset + 3) {
+                return false;
+            }
+            add(Opcode::JUMP, offset + 3 - operand);
+            break;
+        case Opcode::EQUAL_JUMP_IF_FALSE:
+        case Opcode::GREATER_EQUAL_JUMP_IF_FALSE:
+        case Opcode::GREATER_JUMP_IF_FALSE:
+        case Opcode::LESS_EQUAL_JUMP_IF_FALSE:
+        case Opcode::LESS_JUMP_IF_FALSE:
+        case Opcode::NOT_EQUAL_JUMP_IF_FALSE:
+            add(fusedComparison(opcode), 0);
+            add(Opcode::POP_JUMP_IF_FALSE, offset + 3 + operand);
+            break;
+        case Opcode::ADD:
+        case Opcode::DIVIDE:
+        case Opcode::EQUAL:
+        case Opcode::FALSE:
+        case Opcode::GREATER:
+        case Opcode::GREATER_EQUAL:
+        case Opcode::LESS:
+        case Opcode::LESS_EQUAL:
+        case Opcode::MULTIPLY:
+        case Opcode::NEGATE:
+        case Opcode::NOT:
+        case Opcode::NOT_EQUAL:
+        case Opcode::NULL_:
+        case Opcode::POP:
+        case Opcode::PRINT:
+        case Opcode::RETURN:
+        case Opcode::SUBTRACT:
+        case Opcode::TRUE:
+            add(opcode, 0);
+            break;
+        default:
+            // The quickened instructions are only written by the vm
+            return false;
+        }
+        offset += length;
+    }
+    return !m_instructions.empty();
+}
+
+[[nodiscard]] auto SsaBuilder::createBlocks(SsaFunction & function) -> bool {
+    size_t const size = function.function().chunk()->getSize();
+    std::vector<bool> starts(size, false);
+    std::vector<bool> leaders(size, false);
+    for (Instruction const & instruction : m_instructions) {
+        starts[instruction.offset] = true;
+    }
+    leaders[0] = true;
+    for (size_t index = 0; index < m_instructions.size(); index++) {
+        Instruction const & instruction = m_instructions[index];
+        if (!endsBlock(instruction.opcode)) {
+            continue;
+        }
+        if (instruction.opcode != Opcode::RETURN) {
+            if (instruction.operand >= size || !starts[instruction.operand]) {
+                return false;
+            }
+            leaders[instruction.operand] = true;
+        }
+        if (index + 1 < m_instructions.size()) {
+            leaders[m_instructions[index + 1].offset] = true;
+        }
+    }
+
+    std::vector<BasicBlock> & blocks = function.blocks();
+    std::vector<BlockId> blockAt(size, NO_BLOCK);
+    m_starts.clear();
+    for (size_t index = 0; index < m_instructions.size(); index++) {
+        size_t const offset = m_instructions[index].offset;
+        if (leaders[offset] && (index == 0 || m_instructions[index - 1].offset != offset)) {
+            blockAt[offset] = static_cast<BlockId>(blocks.size());
+            m_starts.push_back(index);
+            blocks.push_back(BasicBlock{offset, {}, Terminator::FALL_THROUGH, 0, NO_BLOCK, NO_BLOCK, {}, {}, {}, {},
+                                        NO_BLOCK, SIZE_MAX, false});
+        }
+    }
+    m_starts.push_back(m_instructions.size());
+
+    for (BlockId block = 0; block < blocks.size(); block++) {
+        Instruction const & last = m_instructions[m_starts[block + 1] - 1];
+        BasicBlock & basicBlock = blocks[block];
+        basicBlock.terminatorLine = last.line;
+        switch (last.opcode) {
+        case Opcode::JUMP:
+            basicBlock.terminator = Terminator::JUMP;
+            break;
+        case Opcode::JUMP_IF_FALSE:
+            basicBlock.terminator = Terminator::JUMP_IF_FALSE;
+            break;
+        case Opcode::POP_JUMP_IF_FALSE:
+            basicBlock.terminator = Terminator::POP_JUMP_IF_FALSE;
+            break;
+        case Opcode::POP_JUMP_IF_TRUE:
+            basicBlock.terminator = Terminator::POP_JUMP_IF_TRUE;
+            break;
+        case Opcode::RETURN:
+            basicBlock.terminator = Terminator::RETURN;
+            break;
+        default:
+            basicBlock.terminator = Terminator::FALL_THROUGH;
+            break;
+        }
+        if (basicBlock.terminator != Terminator::FALL_THROUGH && basicBlock.terminator != Terminator::RETURN) {
+            basicBlock.target = blockAt[last.operand];
+        }
+        if (basicBlock.terminator != Terminator::JUMP && basicBlock.terminator != Terminator::RETURN) {
+            // A block can only fall through to the block after it
+            if (block + 1 == blocks.size()) {
+                return false;
+            }
+            basicBlock.next = block + 1;
+        }
+    }
+    return true;
+}
+
+auto SsaBuilder::orderBlocks(SsaFunction & function) -> void {
+    std::vector<BasicBlock> & blocks = function.blocks();
+    std::vector<BlockId> postorder;
+    // Every entry holds a block and the index of the next successor to visit
+    std::vector<std::pair<BlockId, size_t>> stack = {{0, 0}};
+    blocks[0].reachable = true;
+    while (!stack.empty()) {
+        auto & [block, next] = stack.back();
+        std::vector<BlockId> const successors = function.successors(block);
+        if (next == successors.size()) {
+            postorder.push_back(block);
+            stack.pop_back();
+            continue;
+        }
+        BlockId const successor = successors[next++];
+        if (!blocks[successor].reachable) {
+            blocks[successor].reachable = true;
+            stack.emplace_back(successor, 0);
+        }
+    }
+    function.order().assign(postorder.rbegin(), postorder.rend());
+
+    blocks[0].predecessors.push_back(NO_BLOCK);
+    for (BlockId const block : function.order()) {
+        for (BlockId const successor : function.successors(block)) {
+            blocks[successor].predecessors.push_back(block);
+        }
+    }
+}
+
+[[nodiscard]] auto SsaBuilder::computeDepths(SsaFunction & function) -> bool {
+    std::vector<BasicBlock> & blocks = function.blocks();
+    m_depths.assign(blocks.size(), SIZE_MAX);
+    size_t const arity = function.function().arity();
+    m_depths[0] = arity + 1;
+    for (BlockId const block : function.order()) {
+        size_t depth = m_depths[block];
+        for (size_t index = m_starts[block]; index < m_starts[block + 1]; index++) {
+            Instruction const & instruction = m_instructions[index];
+            size_t const pops = popCount(instruction.opcode, instruction.operand);
+            bool const peeks = instruction.opcode == Opcode::JUMP_IF_FALSE ||
+                               instruction.opcode == Opcode::SET_GLOBAL || instruction.opcode == Opcode::SET_LOCAL;
+            bool const accessesSlot =
+                instruction.opcode == Opcode::GET_LOCAL || instruction.opcode == Opcode::SET_LOCAL;
+            // The called function and the parameters are never popped
+            if (depth < pops + arity + 1 || (peeks && depth < 2) || (accessesSlot && instruction.operand >= depth)) {
+                return false;
+            }
+            depth = depth - pops + (pushesValue(instruction.opcode) ? 1 : 0);
+        }
+        for (BlockId const successor : function.successors(block)) {
+            if (m_depths[successor] == SIZE_MAX) {
+                m_depths[successor] = depth;
+            } else if (m_depths[successor] != depth) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+auto SsaBuilder::createValues(SsaFunction & function) -> void {
+    std::vector<BasicBlock> & blocks = function.blocks();
+    cppLox::ByteCode::Chunk & chunk = *function.function().chunk();
+    int const firstLine = m_instructions.front().line;
+    std::vector<ValueId> parameters;
+    for (size_t slot = 0; slot <= function.function().arity(); slot++) {
+        parameters.push_back(function.addValue(SsaValue{SsaValue::Kind::PARAMETER, Opcode::NULL_,
+                                                        static_cast<uint16_t>(slot), {}, 0, firstLine, ANY_TYPE,
+                                                        NO_VALUE}));
+    }
+
+    for (BlockId const block : function.order()) {
+        BasicBlock & basicBlock = blocks[block];
+        if (basicBlock.predecessors.size() == 1 && basicBlock.predecessors.front() == NO_BLOCK) {
+            basicBlock.entry = parameters;
+        } else if (basicBlock.predecessors.size() == 1) {
+            // The only predecessor comes first in reverse postorder, unless the block loops back to itself
+            basicBlock.entry = blocks[basicBlock.predecessors.front()].exit;
+        } else {
+            for (size_t slot = 0; slot < m_depths[block]; slot++) {
+                basicBlock.entry.push_back(function.addValue(SsaValue{SsaValue::Kind::PHI, Opcode::NULL_,
+                                                                      static_cast<uint16_t>(slot), {}, block,
+                                                                      m_instructions[m_starts[block]].line, 0,
+                                                                      NO_VALUE}));
+            }
+        }
+
+        std::vector<ValueId> stack = basicBlock.entry;
+        for (size_t index = m_starts[block]; index < m_starts[block + 1]; index++) {
+            Instruction const & instruction = m_instructions[index];
+            auto const step = [&](SsaStep::Kind kind, size_t operand, ValueId value) {
+                basicBlock.steps.push_back(SsaStep{kind, instruction.opcode, static_cast<uint16_t>(operand), value,
+                                                   instruction.line, false});
+            };
+            switch (instruction.opcode) {
+            case Opcode::GET_LOCAL:
+                step(SsaStep::Kind::LOAD, instruction.operand, stack[instruction.operand]);
+                stack.push_back(stack[instruction.operand]);
+                break;
+            case Opcode::SET_LOCAL:
+                step(SsaStep::Kind::STORE, instruction.operand, stack.back());
+                stack[instruction.operand] = stack.back();
+                break;
+            case Opcode::POP:
+                step(SsaStep::Kind::POP, 0, stack.back());
+                stack.pop_back();
+                break;
+            case Opcode::DEFINE_GLOBAL:
+            case Opcode::PRINT:
+                step(SsaStep::Kind::EFFECT, instruction.operand, stack.back());
+                stack.pop_back();
+                break;
+            case Opcode::SET_GLOBAL:
+                step(SsaStep::Kind::EFFECT, instruction.operand, stack.back());
+                break;
+            case Opcode::JUMP:
+            case Opcode::RETURN:
+                break;
+            case Opcode::JUMP_IF_FALSE:
+                break;
+            case Opcode::POP_JUMP_IF_FALSE:
+            case Opcode::POP_JUMP_IF_TRUE:
+                stack.pop_back();
+                break;
+            case Opcode::CONSTANT:
+            case Opcode::FALSE:
+            case Opcode::NULL_:
+            case Opcode::TRUE:
+                {
+                    uint8_t types = BOOL_TYPE;
+                    if (instruction.opcode == Opcode::CONSTANT) {
+                        types = typeOf(chunk.getConstant(instruction.operand));
+                    } else if (instruction.opcode == Opcode::NULL_) {
+                        types = NULL_TYPE;
+                    }
+                    ValueId const value = function.addValue(SsaValue{SsaValue::Kind::CONSTANT, instruction.opcode,
+                                                                     static_cast<uint16_t>(instruction.operand), {},
+                                                                     block, instruction.line, types, NO_VALUE});
+                    step(SsaStep::Kind::DEFINE, 0, value);
+                    stack.push_back(value);
+                    break;
+                }
+            default:
+                {
+                    size_t const pops = popCount(instruction.opcode, instruction.operand);
+                    std::vector<ValueId> operands(stack.end() - static_cast<std::ptrdiff_t>(pops), stack.end());
+                    stack.resize(stack.size() - pops);
+                    ValueId const value = function.addValue(SsaValue{SsaValue::Kind::INSTRUCTION, instruction.opcode,
+                                                                     static_cast<uint16_t>(instruction.operand),
+                                                                     std::move(operands), block, instruction.line, 0,
+                                                                     NO_VALUE});
+                    step(SsaStep::Kind::DEFINE, 0, value);
+                    stack.push_back(value);
+                    break;
+                }
+            }
+        }
+        basicBlock.exit = std::move(stack);
+    }
+
+    // The operands of the phis are known once every predecessor was visited
+    for (BlockId const block : function.order()) {
+        BasicBlock const & basicBlock = blocks[block];
+        for (ValueId const entry : basicBlock.entry) {
+            SsaValue & phi = function.value(entry);
+            if (phi.kind != SsaValue::Kind::PHI || phi.block != block) {
+                continue;
+            }
+            for (BlockId const predecessor : basicBlock.predecessors) {
+                phi.operands.push_back(predecessor == NO_BLOCK ? parameters[phi.operand]
+                                                               : blocks[predecessor].exit[phi.operand]);
+            }
+        }
+    }
+}
+
+auto SsaBuilder::removeTrivialPhis(SsaFunction & function) -> void {
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (ValueId id = 0; id < function.valueCount(); id++) {
+            SsaValue const & phi = function.value(id);
+            if (phi.kind != SsaValue::Kind::PHI || phi.replacement != NO_VALUE) {
+                continue;
+            }
+            ValueId unique = NO_VALUE;
+            bool trivial = true;
+            for (ValueId const operand : phi.operands) {
+                ValueId const value = function.canonical(operand);
+                if (value == id || value == unique) {
+                    continue;
+                }
+                trivial = unique == NO_VALUE;
+                unique = value;
+                if (!trivial) {
+                    break;
+                }
+            }
+            if (trivial && unique != NO_VALUE) {
+                function.value(id).replacement = unique;
+                changed = true;
+            }
+        }
+    }
+}
+
+auto SsaBuilder::computeDominators(SsaFunction & function) -> void {
+    std::vector<BasicBlock> & blocks = function.blocks();
+    std::vector<BlockId> const & order = function.order();
+    std::vector<size_t> position(blocks.size(), SIZE_MAX);
+    for (size_t index = 0; index < order.size(); index++) {
+        position[order[index]] = index;
+    }
+    // The iterative algorithm of Cooper, Harvey and Kennedy, the first block temporarily dominates itself
+    blocks[0].dominator = 0;
+    auto const intersect = [&](BlockId first, BlockId second) {
+        while (first != second) {
+            while (position[first] > position[second]) {
+                first = blocks[first].dominator;
+            }
+            while (position[second] > position[first]) {
+                second = blocks[second].dominator;
+            }
+        }
+        return first;
+    };
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (BlockId const block : order) {
+            if (block == 0) {
+                continue;
+            }
+            BlockId dominator = NO_BLOCK;
+            for (BlockId const predecessor : blocks[block].predecessors) {
+                if (predecessor == NO_BLOCK || blocks[predecessor].dominator == NO_BLOCK) {
+                    continue;
+                }
+                dominator = dominator == NO_BLOCK ? predecessor : intersect(predecessor, dominator);
+            }
+            if (blocks[block].dominator != dominator) {
+                blocks[block].dominator = dominator;
+                changed = true;
+            }
+        }
+    }
+    blocks[0].dominator = NO_BLOCK;
+}
+
+[[nodiscard]] auto SsaBuilder::findLoops(SsaFunction & function) -> bool {
+    std::vector<BasicBlock> & blocks = function.blocks();
+    std::vector<BlockId> const & order = function.order();
+    std::vector<size_t> position(blocks.size(), SIZE_MAX);
+    for (size_t index = 0; index < order.size(); index++) {
+        position[order[index]] = index;
+    }
+    std::vector<Loop> loops;
+    for (BlockId const block : order) {
+        for (BlockId const header : function.successors(block)) {
+            if (position[header] > position[block]) {
+                continue;
+            }
+            // An edge against the reverse postorder, whose target does not dominate its source, enters a loop
+            // in the middle
+            if (!function.dominates(header, block)) {
+                return false;
+            }
+            auto loop = std::find_if(loops.begin(), loops.end(), [&](Loop const & l) { return l.header == header; });
+            if (loop == loops.end()) {
+                loops.push_back(Loop{header, std::vector<bool>(blocks.size(), false), SIZE_MAX, {}, {}});
+                loop = loops.end() - 1;
+                loop->body[header] = true;
+            }
+            std::vector<BlockId> worklist = {block};
+            while (!worklist.empty()) {
+                BlockId const member = worklist.back();
+                worklist.pop_back();
+                if (loop->body[member]) {
+                    continue;
+                }
+                loop->body[member] = true;
+                for (BlockId const predecessor : blocks[member].predecessors) {
+                    if (predecessor != NO_BLOCK) {
+                        worklist.push_back(predecessor);
+                    }
+                }
+            }
+        }
+    }
+    auto const size = [](Loop const & loop) { return std::count(loop.body.begin(), loop.body.end(), true); };
+    std::stable_sort(loops.begin(), loops.end(), [&](Loop const & first, Loop const & second) {
+        return size(first) > size(second);
+    });
+    for (size_t index = 0; index < loops.size(); index++) {
+        for (size_t outer = index; outer-- > 0;) {
+            if (loops[outer].body[loops[index].header]) {
+                loops[index].parent = outer;
+                break;
+            }
+        }
+        for (BlockId block = 0; block < blocks.size(); block++) {
+            if (loops[index].body[block]) {
+                blocks[block].loop = index;
+            }
+        }
+    }
+    function.loops() = std::move(loops);
+    return true;
+}
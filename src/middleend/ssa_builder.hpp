@@ -0,0 +1,117 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file ssa_builder.hpp
+ * @brief This file contains the declaration of the SsaBuilder class.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "../bytecode/chunk.hpp"
+#include "../bytecode/opcode.hpp"
+#include "../types/object_function.hpp"
+#include "ssa_function.hpp"
+
+namespace cppLox::MiddleEnd {
+
+/// @brief Lowers the stack based bytecode of a function into static single assignment form.
+/// @details The superinstructions are split into their parts, then the chunk is divided into basic blocks. The
+/// builder tracks the value of every stack slot through each block and places a phi for every slot at the start of
+/// a block with several predecessors. Phis that merge a single value are removed afterwards. Finally the dominator
+/// tree and the natural loops of the function are computed.
+class SsaBuilder {
+  public:
+    /// @brief Constructs a new ssa builder.
+    SsaBuilder() = default;
+
+    /// @brief Destructor of the ssa builder.
+    ~SsaBuilder() = default;
+
+    /// @brief Lowers the bytecode of the given function into ssa form.
+    /// @param function The function that is lowered.
+    /// @return The function in ssa form or an empty optional, if the bytecode uses instructions the builder does not
+    /// know or the height of the stack differs between the paths to a block.
+    [[nodiscard]] auto build(cppLox::Types::ObjectFunction & function) -> std::optional<SsaFunction>;
+
+  private:
+    /// @brief An instruction of the chunk, a superinstruction is decoded into several instructions.
+    struct Instruction {
+        /// @brief The offset of the original instruction in the chunk.
+        size_t offset;
+
+        /// @brief The opcode of the instruction, that is never a superinstruction.
+        cppLox::ByteCode::Opcode opcode;
+
+        /// @brief The constant index, stack slot, global slot, argument count or jump target of the instruction.
+        size_t operand;
+
+        /// @brief The line of the instruction.
+        int line;
+    };
+
+    /// @brief Decodes the instructions of the given chunk.
+    /// @param chunk The chunk that is decoded.
+    /// @return true if every instruction of the chunk is supported, false otherwise.
+    [[nodiscard]] auto decode(cppLox::ByteCode::Chunk & chunk) -> bool;
+
+    /// @brief Divides the decoded instructions into basic blocks.
+    /// @param function The function the blocks are added to.
+    /// @return true if every jump lands on the start of an instruction, false otherwise.
+    [[nodiscard]] auto createBlocks(SsaFunction & function) -> bool;
+
+    /// @brief Orders the reachable blocks in reverse postorder and collects the predecessors of every block.
+    /// @param function The function whose blocks are ordered.
+    auto orderBlocks(SsaFunction & function) -> void;
+
+    /// @brief Computes the height of the stack at the start of every reachable block.
+    /// @param function The function whose blocks are analyzed.
+    /// @return true if the height is the same on every path to a block and never drops below the parameters, false
+    /// otherwise.
+    [[nodiscard]] auto computeDepths(SsaFunction & function) -> bool;
+
+    /// @brief Creates the values and steps of every reachable block.
+    /// @param function The function whose values are created.
+    auto createValues(SsaFunction & function) -> void;
+
+    /// @brief Replaces the phis, that merge the same value on every edge, by that value.
+    /// @param function The function whose phis are simplified.
+    auto removeTrivialPhis(SsaFunction & function) -> void;
+
+    /// @brief Computes the immediate dominator of every reachable block.
+    /// @param function The function whose dominator tree is computed.
+    auto computeDominators(SsaFunction & function) -> void;
+
+    /// @brief Finds the natural loops of the function.
+    /// @param function The function whose loops are found.
+    /// @return true if the control flow graph is reducible, false otherwise.
+    [[nodiscard]] auto findLoops(SsaFunction & function) -> bool;
+
+    /// @brief The decoded instructions of the chunk.
+    std::vector<Instruction> m_instructions;
+
+    /// @brief The index of the first instruction of every block and the amount of instructions at the end.
+    std::vector<size_t> m_starts;
+
+    /// @brief The height of the stack at the start of every block.
+    std::vector<size_t> m_depths;
+};
+
+} // namespace cppLox::MiddleEnd
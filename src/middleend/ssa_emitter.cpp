@@ -0,0 +1,499 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file ssa_emitter.cpp
+ * @brief This file contains the implementation of the SsaEmitter class.
+ */
+
+#include "ssa_emitter.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace cppLox::MiddleEnd;
+
+using cppLox::ByteCode::Opcode;
+
+/// @brief The amount of attempts to find the values, that need a spill slot
+static constexpr size_t MAX_ATTEMPTS = 8;
+
+/// @brief Gets the fused comparison and jump of a comparison
+/// @param opcode The opcode of the comparison
+/// @return The opcode of the fused instruction or AMOUNT, if the instruction can not be fused with a jump
+static auto fusedJump(Opcode opcode) -> Opcode {
+    switch (opcode) {
+    case Opcode::EQUAL:
+        return Opcode::EQUAL_JUMP_IF_FALSE;
+    case Opcode::GREATER:
+        return Opcode::GREATER_JUMP_IF_FALSE;
+    case Opcode::GREATER_EQUAL:
+        return Opcode::GREATER_EQUAL_JUMP_IF_FALSE;
+    case Opcode::LESS:
+        return Opcode::LESS_JUMP_IF_FALSE;
+    case Opcode::LESS_EQUAL:
+        return Opcode::LESS_EQUAL_JUMP_IF_FALSE;
+    case Opcode::NOT_EQUAL:
+        return Opcode::NOT_EQUAL_JUMP_IF_FALSE;
+    default:
+        return Opcode::AMOUNT;
+    }
+}
+
+[[nodiscard]] auto SsaEmitter::emit(SsaFunction & function, bool superinstructions) -> bool {
+    m_function = &function;
+    m_superinstructions = superinstructions;
+    m_spills.clear();
+    m_spillSlots.assign(function.valueCount(), SIZE_MAX);
+    m_hoisted.assign(function.valueCount(), false);
+    m_preheaders.assign(function.blocks().size(), SIZE_MAX);
+    std::vector<Loop> const & loops = function.loops();
+    for (size_t loop = 0; loop < loops.size(); loop++) {
+        if (loops[loop].hoisted.empty()) {
+            continue;
+        }
+        m_preheaders[loops[loop].header] = loop;
+        for (ValueId const value : loops[loop].hoisted) {
+            m_hoisted[value] = true;
+            m_spillSlots[value] = m_spills.size();
+            m_spills.push_back(value);
+        }
+    }
+    // Every attempt spills the values, that the previous attempt could not load
+    for (size_t attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+        if (!emitFunction()) {
+            return false;
+        }
+        if (m_requests.empty()) {
+            return encode();
+        }
+        for (ValueId const value : m_requests) {
+            m_spillSlots[value] = m_spills.size();
+            m_spills.push_back(value);
+        }
+    }
+    return false;
+}
+
+[[nodiscard]] auto SsaEmitter::emitFunction() -> bool {
+    std::vector<BasicBlock> const & blocks = m_function->blocks();
+    m_code.clear();
+    m_labels.assign(blocks.size() * 2, SIZE_MAX);
+    m_lastLabel = SIZE_MAX;
+    m_requests.clear();
+    m_failed = false;
+    m_depth = m_function->function().arity() + 1u;
+    m_maxDepth = m_depth;
+
+    // The spill slots of the parameters are initialized with the parameter, every other spill slot with null
+    int const line = blocks[0].steps.empty() ? blocks[0].terminatorLine : blocks[0].steps.front().line;
+    for (ValueId const spill : m_spills) {
+        SsaValue const & value = m_function->value(spill);
+        if (value.kind == SsaValue::Kind::PARAMETER) {
+            appendLocal(Opcode::GET_LOCAL, value.operand, line);
+        } else {
+            append(Opcode::NULL_, 0, line);
+        }
+    }
+    for (BlockId block = 0; block < blocks.size() && !m_failed; block++) {
+        if (!blocks[block].reachable) {
+            continue;
+        }
+        if (m_preheaders[block] != SIZE_MAX) {
+            emitPreheader(m_preheaders[block]);
+        }
+        emitBlock(block);
+    }
+    return !m_failed;
+}
+
+auto SsaEmitter::emitPreheader(size_t loop) -> void {
+    Loop const & entered = m_function->loops()[loop];
+    BasicBlock const & header = m_function->blocks()[entered.header];
+    bind(m_function->blocks().size() + entered.header);
+    m_stack.clear();
+    for (size_t slot = 0; slot < header.entry.size(); slot++) {
+        bool const read = header.liveIn[slot] || entered.preheaderReads[slot];
+        ValueId const value = read ? m_function->loopEntryValue(loop, slot) : NO_VALUE;
+        m_stack.push_back(Entry{value, value, false, 0, {}});
+    }
+    m_depth = header.entry.size() + m_spills.size();
+    for (ValueId const hoisted : entered.hoisted) {
+        SsaValue const & value = m_function->value(hoisted);
+        for (ValueId const operand : value.operands) {
+            load(m_function->canonical(operand), value.line);
+        }
+        append(value.opcode, value.operand, value.line);
+        appendLocal(Opcode::SET_LOCAL, m_function->function().arity() + 1u + m_spillSlots[hoisted], value.line);
+        append(Opcode::POP, 0, value.line);
+    }
+}
+
+auto SsaEmitter::emitBlock(BlockId block) -> void {
+    BasicBlock const & basicBlock = m_function->blocks()[block];
+    bind(block);
+    // The slots of the first block hold the parameters, if the function never jumps back to its start
+    bool const entered = basicBlock.predecessors.size() == 1 && basicBlock.predecessors.front() == NO_BLOCK;
+    m_stack.clear();
+    for (size_t slot = 0; slot < basicBlock.entry.size(); slot++) {
+        ValueId const value = m_function->canonical(basicBlock.entry[slot]);
+        m_stack.push_back(Entry{value, entered || basicBlock.liveIn[slot] ? value : NO_VALUE, false, 0, {}});
+    }
+    m_depth = basicBlock.entry.size() + m_spills.size();
+    m_maxDepth = std::max(m_maxDepth, m_depth);
+
+    int const line = basicBlock.steps.empty() ? basicBlock.terminatorLine : basicBlock.steps.front().line;
+    for (size_t slot = 0; slot < basicBlock.entry.size(); slot++) {
+        ValueId const value = m_function->canonical(basicBlock.entry[slot]);
+        SsaValue const & phi = m_function->value(value);
+        if (phi.kind != SsaValue::Kind::PHI || phi.block != block || phi.operand != slot ||
+            m_spillSlots[value] == SIZE_MAX) {
+            continue;
+        }
+        size_t const held = findHeld(value);
+        if (held == SIZE_MAX) {
+            m_failed = true;
+            return;
+        }
+        appendLocal(Opcode::GET_LOCAL, slotOf(held), line);
+        appendLocal(Opcode::SET_LOCAL, m_function->function().arity() + 1u + m_spillSlots[value], line);
+        append(Opcode::POP, 0, line);
+    }
+    for (SsaStep const & step : basicBlock.steps) {
+        emitStep(step);
+        if (m_failed) {
+            return;
+        }
+    }
+    emitTerminator(block);
+}
+
+auto SsaEmitter::emitStep(SsaStep const & step) -> void {
+    switch (step.kind) {
+    case SsaStep::Kind::LOAD:
+        m_stack.push_back(Entry{m_function->canonical(step.value), NO_VALUE, true, step.line, {}});
+        break;
+    case SsaStep::Kind::DEFINE:
+        {
+            ValueId const id = step.value;
+            ValueId const value = m_function->canonical(id);
+            SsaValue const & definition = m_function->value(id);
+            size_t const count = definition.operands.size();
+            // A replaced or hoisted value was computed before, so its operands are dropped
+            if (value != id || m_hoisted[id] || definition.kind == SsaValue::Kind::CONSTANT) {
+                discard(count, step.line);
+                m_stack.push_back(Entry{value, NO_VALUE, true, step.line, {}});
+                break;
+            }
+            bool const pendingOperands = std::all_of(m_stack.end() - static_cast<std::ptrdiff_t>(count),
+                                                     m_stack.end(), [](Entry const & entry) { return entry.pending; });
+            if (pendingOperands && m_function->isPure(id) && !m_function->mayThrow(id) &&
+                m_spillSlots[id] == SIZE_MAX) {
+                Entry entry{id, NO_VALUE, true, step.line, {}};
+                entry.operands.assign(std::make_move_iterator(m_stack.end() - static_cast<std::ptrdiff_t>(count)),
+                                      std::make_move_iterator(m_stack.end()));
+                m_stack.resize(m_stack.size() - count);
+                m_stack.push_back(std::move(entry));
+                break;
+            }
+            flush();
+            consume(count);
+            append(definition.opcode, definition.operand, step.line);
+            m_stack.push_back(Entry{id, id, false, step.line, {}});
+            if (m_spillSlots[id] != SIZE_MAX) {
+                appendLocal(Opcode::SET_LOCAL, m_function->function().arity() + 1u + m_spillSlots[id], step.line);
+            }
+            break;
+        }
+    case SsaStep::Kind::POP:
+        discard(1, step.line);
+        break;
+    case SsaStep::Kind::STORE:
+        {
+            ValueId const value = m_function->canonical(step.value);
+            size_t const slot = step.operand;
+            Entry const & target = m_stack[slot];
+            // Storing the value a slot already holds is skipped, just like storing a value no one reads
+            if (slot + 1 == m_stack.size() || (target.pending ? target.value : target.held) == value) {
+                break;
+            }
+            // The value of a removed store is left pending, so it is dropped if no one else uses it
+            if (step.removed) {
+                m_stack[slot].value = value;
+                break;
+            }
+            flush();
+            if (m_stack.back().held != value) {
+                m_failed = true;
+                break;
+            }
+            appendLocal(Opcode::SET_LOCAL, slotOf(slot), step.line);
+            m_stack[slot].value = value;
+            m_stack[slot].held = value;
+            break;
+        }
+    case SsaStep::Kind::EFFECT:
+        flush();
+        if (m_stack.back().held != m_function->canonical(step.value)) {
+            m_failed = true;
+            break;
+        }
+        append(step.opcode, step.operand, step.line);
+        if (step.opcode != Opcode::SET_GLOBAL) {
+            m_stack.pop_back();
+        }
+        break;
+    }
+}
+
+auto SsaEmitter::emitTerminator(BlockId block) -> void {
+    BasicBlock const & basicBlock = m_function->blocks()[block];
+    int const line = basicBlock.terminatorLine;
+    flush();
+    switch (basicBlock.terminator) {
+    case Terminator::FALL_THROUGH:
+        checkEdge(block, basicBlock.next);
+        break;
+    case Terminator::JUMP:
+        checkEdge(block, basicBlock.target);
+        append(Opcode::JUMP, 0, line, labelOf(basicBlock.target, block));
+        break;
+    case Terminator::JUMP_IF_FALSE:
+        if (m_stack.back().held != m_stack.back().value) {
+            m_failed = true;
+            break;
+        }
+        checkEdge(block, basicBlock.next);
+        checkEdge(block, basicBlock.target);
+        append(Opcode::JUMP_IF_FALSE, 0, line, labelOf(basicBlock.target, block));
+        break;
+    case Terminator::POP_JUMP_IF_FALSE:
+    case Terminator::POP_JUMP_IF_TRUE:
+        consume(1);
+        checkEdge(block, basicBlock.next);
+        checkEdge(block, basicBlock.target);
+        append(basicBlock.terminator == Terminator::POP_JUMP_IF_FALSE ? Opcode::POP_JUMP_IF_FALSE
+                                                                      : Opcode::POP_JUMP_IF_TRUE,
+               0, line, labelOf(basicBlock.target, block));
+        break;
+    case Terminator::RETURN:
+        if (m_stack.back().held != m_stack.back().value) {
+            m_failed = true;
+            break;
+        }
+        append(Opcode::RETURN, 0, line);
+        break;
+    }
+}
+
+auto SsaEmitter::checkEdge(BlockId block, BlockId successor) -> void {
+    BasicBlock const & entered = m_function->blocks()[successor];
+    if (m_stack.size() != entered.entry.size()) {
+        m_failed = true;
+        return;
+    }
+    size_t const loop = m_preheaders[successor];
+    bool const preheader = loop != SIZE_MAX && !m_function->loops()[loop].body[block];
+    for (size_t slot = 0; slot < entered.entry.size(); slot++) {
+        bool const read = entered.liveIn[slot] || (preheader && m_function->loops()[loop].preheaderReads[slot]);
+        if (read && m_stack[slot].held != m_function->edgeValue(successor, block, slot)) {
+            m_failed = true;
+            return;
+        }
+    }
+}
+
+auto SsaEmitter::flush() -> void {
+    size_t first = m_stack.size();
+    while (first > 0 && m_stack[first - 1].pending) {
+        first--;
+    }
+    for (size_t index = first; index < m_stack.size(); index++) {
+        materialize(m_stack[index]);
+    }
+}
+
+auto SsaEmitter::materialize(Entry & entry) -> void {
+    if (!entry.pending) {
+        return;
+    }
+    if (entry.operands.empty() || findHeld(entry.value) != SIZE_MAX) {
+        load(entry.value, entry.line);
+    } else {
+        for (Entry & operand : entry.operands) {
+            materialize(operand);
+        }
+        SsaValue const & value = m_function->value(entry.value);
+        append(value.opcode, value.operand, entry.line);
+    }
+    entry.pending = false;
+    entry.held = entry.value;
+    entry.operands.clear();
+}
+
+auto SsaEmitter::load(ValueId value, int line) -> void {
+    SsaValue const & definition = m_function->value(value);
+    if (definition.kind == SsaValue::Kind::CONSTANT) {
+        bool const wide = definition.opcode == Opcode::CONSTANT && definition.operand > UINT8_MAX;
+        append(wide ? Opcode::CONSTANT_LONG : definition.opcode, definition.operand, line);
+        return;
+    }
+    size_t const held = findHeld(value);
+    if (held != SIZE_MAX) {
+        appendLocal(Opcode::GET_LOCAL, slotOf(held), line);
+    } else if (m_spillSlots[value] != SIZE_MAX) {
+        appendLocal(Opcode::GET_LOCAL, m_function->function().arity() + 1u + m_spillSlots[value], line);
+    } else {
+        // The placeholder keeps the height of the stack, the next attempt loads the value from its spill slot
+        m_requests.insert(value);
+        append(Opcode::NULL_, 0, line);
+    }
+}
+
+auto SsaEmitter::consume(size_t count) -> void {
+    for (size_t index = 0; index < count; index++) {
+        if (m_stack.back().pending || m_stack.back().held != m_stack.back().value) {
+            m_failed = true;
+        }
+        m_stack.pop_back();
+    }
+}
+
+auto SsaEmitter::discard(size_t count, int line) -> void {
+    for (size_t index = 0; index < count; index++) {
+        if (!m_stack.back().pending) {
+            append(Opcode::POP, 0, line);
+        }
+        m_stack.pop_back();
+    }
+}
+
+[[nodiscard]] auto SsaEmitter::findHeld(ValueId value) const -> size_t {
+    // The first slot holds the called function, that can not be read by GET_LOCAL
+    for (size_t slot = m_stack.size(); slot-- > 1;) {
+        if (!m_stack[slot].pending && m_stack[slot].held == value) {
+            return slot;
+        }
+    }
+    return SIZE_MAX;
+}
+
+auto SsaEmitter::append(Opcode opcode, size_t operand, int line, size_t label) -> void {
+    // A call pops the arguments and replaces the called function with the result
+    if (opcode == Opcode::CALL || opcode == Opcode::TAIL_CALL) {
+        m_depth -= operand;
+    } else {
+        m_depth = static_cast<size_t>(static_cast<std::ptrdiff_t>(m_depth) + cppLox::ByteCode::stack_effect(opcode));
+    }
+    m_maxDepth = std::max(m_maxDepth, m_depth);
+    if (m_superinstructions && !m_code.empty() && m_lastLabel != m_code.size()) {
+        Instruction & last = m_code.back();
+        Opcode fused = Opcode::AMOUNT;
+        if (last.opcode == Opcode::GET_LOCAL && opcode == Opcode::GET_LOCAL) {
+            fused = Opcode::GET_LOCAL_GET_LOCAL;
+        } else if (last.opcode == Opcode::GET_LOCAL && opcode == Opcode::CONSTANT) {
+            fused = Opcode::GET_LOCAL_CONSTANT;
+        } else if (last.opcode == Opcode::SET_LOCAL && opcode == Opcode::POP) {
+            fused = Opcode::SET_LOCAL_POP;
+        } else if (opcode == Opcode::POP_JUMP_IF_FALSE) {
+            fused = fusedJump(last.opcode);
+        }
+        if (fused != Opcode::AMOUNT) {
+            last.opcode = fused;
+            last.second = operand;
+            last.label = label;
+            return;
+        }
+    }
+    m_code.push_back(Instruction{opcode, operand, 0, line, label});
+}
+
+auto SsaEmitter::appendLocal(Opcode opcode, size_t slot, int line) -> void {
+    // The operand of a local counts from the first slot after the called function
+    if (slot == 0 || slot - 1 > UINT8_MAX) {
+        m_failed = true;
+        return;
+    }
+    append(opcode, slot - 1, line);
+}
+
+auto SsaEmitter::bind(size_t label) -> void {
+    m_labels[label] = m_code.size();
+    m_lastLabel = m_code.size();
+}
+
+[[nodiscard]] auto SsaEmitter::labelOf(BlockId block, BlockId predecessor) const -> size_t {
+    size_t const loop = m_preheaders[block];
+    if (loop != SIZE_MAX && !m_function->loops()[loop].body[predecessor]) {
+        return m_function->blocks().size() + block;
+    }
+    return block;
+}
+
+[[nodiscard]] auto SsaEmitter::slotOf(size_t slot) const -> size_t {
+    return slot <= m_function->function().arity() ? slot : slot + m_spills.size();
+}
+
+[[nodiscard]] auto SsaEmitter::encode() -> bool {
+    std::vector<size_t> offsets(m_code.size() + 1);
+    for (size_t index = 0; index < m_code.size(); index++) {
+        offsets[index + 1] = offsets[index] + cppLox::ByteCode::instruction_length(m_code[index].opcode);
+    }
+    // The bytes are collected first, so the chunk stays untouched if a jump can not be encoded
+    std::vector<std::pair<uint8_t, int>> bytes;
+    for (size_t index = 0; index < m_code.size(); index++) {
+        Instruction const & instruction = m_code[index];
+        Opcode opcode = instruction.opcode;
+        size_t operand = instruction.operand;
+        if (instruction.label != SIZE_MAX) {
+            size_t const destination = offsets[m_labels[instruction.label]];
+            size_t const from = offsets[index + 1];
+            bool const forward = destination >= from;
+            if (opcode == Opcode::JUMP) {
+                opcode = forward ? Opcode::JUMP : Opcode::LOOP;
+            } else if (!forward) {
+                return false;
+            }
+            operand = forward ? destination - from : from - destination;
+            if (operand > UINT16_MAX) {
+                return false;
+            }
+        }
+        bytes.emplace_back(static_cast<uint8_t>(opcode), instruction.line);
+        switch (cppLox::ByteCode::instruction_length(opcode)) {
+        case 2:
+            bytes.emplace_back(static_cast<uint8_t>(operand), instruction.line);
+            break;
+        case 3:
+            if (opcode == Opcode::GET_LOCAL_CONSTANT || opcode == Opcode::GET_LOCAL_GET_LOCAL) {
+                bytes.emplace_back(static_cast<uint8_t>(operand), instruction.line);
+                bytes.emplace_back(static_cast<uint8_t>(instruction.second), instruction.line);
+            } else {
+                bytes.emplace_back(static_cast<uint8_t>((operand >> 8) & 0xff), instruction.line);
+                bytes.emplace_back(static_cast<uint8_t>(operand & 0xff), instruction.line);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    cppLox::ByteCode::Chunk & chunk = *m_function->function().chunk();
+    chunk.truncate(0);
+    for (auto const & [byte, line] : bytes) {
+        chunk.write(byte, line);
+    }
+    m_function->function().updateMaxStackDepth(static_cast<uint32_t>(m_maxDepth));
+    return true;
+}
@@ -0,0 +1,222 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file ssa_emitter.hpp
+ * @brief This file contains the declaration of the SsaEmitter class.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "../bytecode/chunk.hpp"
+#include "../bytecode/opcode.hpp"
+#include "ssa_function.hpp"
+
+namespace cppLox::MiddleEnd {
+
+/// @brief Emits a function in static single assignment form back into stack based bytecode.
+/// @details The emitter replays the steps of every block on a simulated stack. Loads and instructions without side
+/// effects, that can not raise a runtime error, are only pushed once their value is needed, so a value that is popped
+/// right away costs nothing. Values that are used again after they left the stack, like the hoisted loop invariants
+/// and the values that replace common subexpressions, are kept in spill slots, that follow the parameters. Every
+/// other stack slot moves up by the amount of spill slots. The stores a value already holds and the dead stores are
+/// skipped. The chunk is only rewritten, if every block leaves the stack slots the next block reads in the expected
+/// state.
+class SsaEmitter {
+  public:
+    /// @brief Constructs a new ssa emitter.
+    SsaEmitter() = default;
+
+    /// @brief Destructor of the ssa emitter.
+    ~SsaEmitter() = default;
+
+    /// @brief Emits the given function into its chunk.
+    /// @param function The function in ssa form.
+    /// @param superinstructions Whether the emitted chunk may contain superinstructions.
+    /// @return true if the chunk was rewritten, false if it was left untouched.
+    [[nodiscard]] auto emit(SsaFunction & function, bool superinstructions) -> bool;
+
+  private:
+    /// @brief An entry of the simulated stack.
+    struct Entry {
+        /// @brief The value the steps expect in the stack slot.
+        ValueId value;
+
+        /// @brief The value the stack slot holds at runtime or NO_VALUE, if it is unknown.
+        ValueId held;
+
+        /// @brief Whether the value was not pushed yet.
+        bool pending;
+
+        /// @brief The line of the step, that pushed the entry.
+        int line;
+
+        /// @brief The pending entries, that the instruction of a pending value consumes.
+        std::vector<Entry> operands;
+    };
+
+    /// @brief An instruction of the emitted chunk.
+    struct Instruction {
+        /// @brief The opcode of the instruction.
+        cppLox::ByteCode::Opcode opcode;
+
+        /// @brief The first operand of the instruction.
+        size_t operand;
+
+        /// @brief The second operand of a superinstruction with two operands.
+        size_t second;
+
+        /// @brief The line of the instruction.
+        int line;
+
+        /// @brief The label a jump lands on or SIZE_MAX.
+        size_t label;
+    };
+
+    /// @brief Emits the complete function with the current spill slots.
+    /// @return true if the function was emitted, false if it can not be emitted.
+    [[nodiscard]] auto emitFunction() -> bool;
+
+    /// @brief Emits the computation of the hoisted values in front of a loop.
+    /// @param loop The index of the loop.
+    auto emitPreheader(size_t loop) -> void;
+
+    /// @brief Emits a basic block.
+    /// @param block The block that is emitted.
+    auto emitBlock(BlockId block) -> void;
+
+    /// @brief Emits the instruction that leaves a basic block.
+    /// @param block The block that is left.
+    auto emitTerminator(BlockId block) -> void;
+
+    /// @brief Emits a step of a basic block.
+    /// @param step The step that is emitted.
+    auto emitStep(SsaStep const & step) -> void;
+
+    /// @brief Checks that the stack slots hold the values, that the given successor expects.
+    /// @param block The block that is left.
+    /// @param successor The block that is entered.
+    auto checkEdge(BlockId block, BlockId successor) -> void;
+
+    /// @brief Pushes every pending entry of the simulated stack.
+    auto flush() -> void;
+
+    /// @brief Pushes a pending entry.
+    /// @param entry The entry that is pushed.
+    auto materialize(Entry & entry) -> void;
+
+    /// @brief Pushes the given value without computing it.
+    /// @details A value, that is neither a literal nor held by a stack slot or spill slot, is requested to be spilled
+    /// by the next attempt.
+    /// @param value The canonical value that is pushed.
+    /// @param line The line of the load.
+    auto load(ValueId value, int line) -> void;
+
+    /// @brief Pops the given amount of entries from the simulated stack, that were pushed with the expected value.
+    /// @param count The amount of entries.
+    auto consume(size_t count) -> void;
+
+    /// @brief Pops the given amount of entries from the simulated stack, pushed entries are popped at runtime.
+    /// @param count The amount of entries.
+    /// @param line The line of the pops.
+    auto discard(size_t count, int line) -> void;
+
+    /// @brief Finds a stack slot, that holds the given value at runtime.
+    /// @param value The canonical value.
+    /// @return The index of the stack slot or SIZE_MAX, if no stack slot holds the value.
+    [[nodiscard]] auto findHeld(ValueId value) const -> size_t;
+
+    /// @brief Appends an instruction to the emitted chunk and fuses it with the previous instruction, if possible.
+    /// @param opcode The opcode of the instruction.
+    /// @param operand The operand of the instruction.
+    /// @param line The line of the instruction.
+    /// @param label The label a jump lands on.
+    auto append(cppLox::ByteCode::Opcode opcode, size_t operand, int line, size_t label = SIZE_MAX) -> void;
+
+    /// @brief Appends an instruction, that reads or writes a stack slot.
+    /// @param opcode GET_LOCAL or SET_LOCAL.
+    /// @param slot The stack slot of the emitted function.
+    /// @param line The line of the instruction.
+    auto appendLocal(cppLox::ByteCode::Opcode opcode, size_t slot, int line) -> void;
+
+    /// @brief Binds a label to the next emitted instruction.
+    /// @param label The label that is bound.
+    auto bind(size_t label) -> void;
+
+    /// @brief Gets the label of the given block, when it is entered from the given predecessor.
+    /// @param block The block that is entered.
+    /// @param predecessor The block that enters the block.
+    /// @return The label of the preheader, if the block starts a loop and is entered from outside, the label of the
+    /// block otherwise.
+    [[nodiscard]] auto labelOf(BlockId block, BlockId predecessor) const -> size_t;
+
+    /// @brief Gets the stack slot of the emitted function for a stack slot of the original function.
+    /// @param slot The original stack slot.
+    /// @return The stack slot after the spill slots were inserted behind the parameters.
+    [[nodiscard]] auto slotOf(size_t slot) const -> size_t;
+
+    /// @brief Writes the emitted instructions into the chunk of the function.
+    /// @return true if every jump can be encoded, false otherwise.
+    [[nodiscard]] auto encode() -> bool;
+
+    /// @brief The function that is emitted.
+    SsaFunction * m_function = nullptr;
+
+    /// @brief Whether the emitted chunk may contain superinstructions.
+    bool m_superinstructions = false;
+
+    /// @brief The spilled values in the order of their spill slots.
+    std::vector<ValueId> m_spills;
+
+    /// @brief The index of the spill slot of every value or SIZE_MAX.
+    std::vector<size_t> m_spillSlots;
+
+    /// @brief Whether the value is hoisted in front of its loop for every value.
+    std::vector<bool> m_hoisted;
+
+    /// @brief The values the current attempt needs in a spill slot.
+    std::set<ValueId> m_requests;
+
+    /// @brief The index of the loop, whose preheader starts in front of a block, for every block or SIZE_MAX.
+    std::vector<size_t> m_preheaders;
+
+    /// @brief The simulated stack.
+    std::vector<Entry> m_stack;
+
+    /// @brief The emitted instructions.
+    std::vector<Instruction> m_code;
+
+    /// @brief The index of the instruction every label is bound to.
+    std::vector<size_t> m_labels;
+
+    /// @brief The index of the instruction the last label was bound to.
+    size_t m_lastLabel = SIZE_MAX;
+
+    /// @brief The height of the stack at runtime after the emitted instructions.
+    size_t m_depth = 0;
+
+    /// @brief The maximal height of the stack at runtime.
+    size_t m_maxDepth = 0;
+
+    /// @brief Whether the function can not be emitted.
+    bool m_failed = false;
+};
+
+} // namespace cppLox::MiddleEnd
@@ -0,0 +1,199 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file ssa_function.cpp
+ * @brief This file contains the implementation of the static single assignment form of a function.
+ */
+
+#include "ssa_function.hpp"
+
+#include <algorithm>
+
+using namespace cppLox::MiddleEnd;
+
+using cppLox::ByteCode::Opcode;
+
+SsaFunction::SsaFunction(cppLox::Types::ObjectFunction & function) : m_function(&function) {}
+
+[[nodiscard]] auto SsaFunction::function() const -> cppLox::Types::ObjectFunction & {
+    return *m_function;
+}
+
+auto SsaFunction::addValue(SsaValue value) -> ValueId {
+    m_values.push_back(std::move(value));
+    return static_cast<ValueId>(m_values.size() - 1);
+}
+
+[[nodiscard]] auto SsaFunction::value(ValueId id) -> SsaValue & {
+    return m_values[id];
+}
+
+[[nodiscard]] auto SsaFunction::value(ValueId id) const -> SsaValue const & {
+    return m_values[id];
+}
+
+[[nodiscard]] auto SsaFunction::valueCount() const -> size_t {
+    return m_values.size();
+}
+
+[[nodiscard]] auto SsaFunction::canonical(ValueId id) const -> ValueId {
+    while (m_values[id].replacement != NO_VALUE) {
+        id = m_values[id].replacement;
+    }
+    return id;
+}
+
+[[nodiscard]] auto SsaFunction::blocks() -> std::vector<BasicBlock> & {
+    return m_blocks;
+}
+
+[[nodiscard]] auto SsaFunction::blocks() const -> std::vector<BasicBlock> const & {
+    return m_blocks;
+}
+
+[[nodiscard]] auto SsaFunction::order() -> std::vector<BlockId> & {
+    return m_order;
+}
+
+[[nodiscard]] auto SsaFunction::order() const -> std::vector<BlockId> const & {
+    return m_order;
+}
+
+[[nodiscard]] auto SsaFunction::loops() -> std::vector<Loop> & {
+    return m_loops;
+}
+
+[[nodiscard]] auto SsaFunction::loops() const -> std::vector<Loop> const & {
+    return m_loops;
+}
+
+[[nodiscard]] auto SsaFunction::successors(BlockId block) const -> std::vector<BlockId> {
+    BasicBlock const & basicBlock = m_blocks[block];
+    switch (basicBlock.terminator) {
+    case Terminator::FALL_THROUGH:
+        return {basicBlock.next};
+    case Terminator::JUMP:
+        return {basicBlock.target};
+    case Terminator::JUMP_IF_FALSE:
+    case Terminator::POP_JUMP_IF_FALSE:
+    case Terminator::POP_JUMP_IF_TRUE:
+        return {basicBlock.next, basicBlock.target};
+    case Terminator::RETURN:
+        break;
+    }
+    return {};
+}
+
+[[nodiscard]] auto SsaFunction::edgeValue(BlockId block, BlockId predecessor, size_t slot) const -> ValueId {
+    BasicBlock const & basicBlock = m_blocks[block];
+    ValueId const entry = canonical(basicBlock.entry[slot]);
+    SsaValue const & value = m_values[entry];
+    if (value.kind != SsaValue::Kind::PHI || value.block != block) {
+        return entry;
+    }
+    auto const position = std::find(basicBlock.predecessors.begin(), basicBlock.predecessors.end(), predecessor);
+    return canonical(value.operands[static_cast<size_t>(position - basicBlock.predecessors.begin())]);
+}
+
+[[nodiscard]] auto SsaFunction::loopEntryValue(size_t loop, size_t slot) const -> ValueId {
+    Loop const & entered = m_loops[loop];
+    ValueId value = NO_VALUE;
+    for (BlockId const predecessor : m_blocks[entered.header].predecessors) {
+        if (predecessor != NO_BLOCK && entered.body[predecessor]) {
+            continue;
+        }
+        ValueId const incoming = edgeValue(entered.header, predecessor, slot);
+        if (value != NO_VALUE && value != incoming) {
+            return NO_VALUE;
+        }
+        value = incoming;
+    }
+    return value;
+}
+
+[[nodiscard]] auto SsaFunction::dominates(BlockId dominator, BlockId block) const -> bool {
+    for (; block != NO_BLOCK; block = m_blocks[block].dominator) {
+        if (block == dominator) {
+            return true;
+        }
+    }
+    return false;
+}
+
+[[nodiscard]] auto SsaFunction::isConstant(ValueId id) const -> bool {
+    return m_values[canonical(id)].kind == SsaValue::Kind::CONSTANT;
+}
+
+[[nodiscard]] auto SsaFunction::isPure(ValueId id) const -> bool {
+    SsaValue const & value = m_values[canonical(id)];
+    if (value.kind == SsaValue::Kind::CONSTANT) {
+        return true;
+    }
+    if (value.kind != SsaValue::Kind::INSTRUCTION) {
+        return false;
+    }
+    switch (value.opcode) {
+    case Opcode::ADD:
+        return hasOnly(value.operands[0], NUMBER_TYPE) && hasOnly(value.operands[1], NUMBER_TYPE);
+    case Opcode::DIVIDE:
+    case Opcode::EQUAL:
+    case Opcode::GREATER:
+    case Opcode::GREATER_EQUAL:
+    case Opcode::LESS:
+    case Opcode::LESS_EQUAL:
+    case Opcode::MULTIPLY:
+    case Opcode::NEGATE:
+    case Opcode::NOT:
+    case Opcode::NOT_EQUAL:
+    case Opcode::SUBTRACT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+[[nodiscard]] auto SsaFunction::mayThrow(ValueId id) const -> bool {
+    SsaValue const & value = m_values[canonical(id)];
+    if (value.kind != SsaValue::Kind::INSTRUCTION) {
+        return false;
+    }
+    switch (value.opcode) {
+    case Opcode::ADD:
+        return !(hasOnly(value.operands[0], NUMBER_TYPE) && hasOnly(value.operands[1], NUMBER_TYPE)) &&
+               !(hasOnly(value.operands[0], STRING_TYPE) && hasOnly(value.operands[1], STRING_TYPE));
+    case Opcode::DIVIDE:
+    case Opcode::GREATER:
+    case Opcode::GREATER_EQUAL:
+    case Opcode::LESS:
+    case Opcode::LESS_EQUAL:
+    case Opcode::MULTIPLY:
+    case Opcode::SUBTRACT:
+        return !hasOnly(value.operands[0], NUMBER_TYPE) || !hasOnly(value.operands[1], NUMBER_TYPE);
+    case Opcode::NEGATE:
+        return !hasOnly(value.operands[0], NUMBER_TYPE);
+    case Opcode::EQUAL:
+    case Opcode::GET_GLOBAL:
+    case Opcode::NOT:
+    case Opcode::NOT_EQUAL:
+        return false;
+    default:
+        return true;
+    }
+}
+
+[[nodiscard]] auto SsaFunction::hasOnly(ValueId id, uint8_t types) const -> bool {
+    return (m_values[canonical(id)].types & ~types) == 0;
+}
@@ -0,0 +1,342 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file ssa_function.hpp
+ * @brief This file contains the declaration of the static single assignment form of a function.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../bytecode/opcode.hpp"
+#include "../types/object_function.hpp"
+
+namespace cppLox::MiddleEnd {
+
+/// @brief The index of a value of a function in ssa form.
+using ValueId = uint32_t;
+
+/// @brief The index of a basic block of a function in ssa form.
+using BlockId = uint32_t;
+
+/// @brief Marks a missing value.
+inline constexpr ValueId NO_VALUE = UINT32_MAX;
+
+/// @brief Marks a missing basic block, the predecessor of the first block that enters the function.
+inline constexpr BlockId NO_BLOCK = UINT32_MAX;
+
+/// @brief The types a value can have at runtime, a set of types is stored as a combination of the flags.
+enum TypeFlag : uint8_t {
+    /// @brief The value is a number.
+    NUMBER_TYPE = 1 << 0,
+    /// @brief The value is a boolean.
+    BOOL_TYPE = 1 << 1,
+    /// @brief The value is null.
+    NULL_TYPE = 1 << 2,
+    /// @brief The value is a string.
+    STRING_TYPE = 1 << 3,
+    /// @brief The value is another object, like a function.
+    OBJECT_TYPE = 1 << 4,
+    /// @brief The value can have any type.
+    ANY_TYPE = NUMBER_TYPE | BOOL_TYPE | NULL_TYPE | STRING_TYPE | OBJECT_TYPE
+};
+
+/// @brief A value of a function in ssa form.
+struct SsaValue {
+    /// @brief The kind of a value.
+    enum class Kind : uint8_t {
+        /// @brief The value of a stack slot when the function is entered, the called function or a parameter.
+        PARAMETER,
+        /// @brief The value of a stack slot at the start of a block with several predecessors.
+        PHI,
+        /// @brief A literal, that is pushed by CONSTANT, FALSE, NULL_ or TRUE.
+        CONSTANT,
+        /// @brief The result of an instruction.
+        INSTRUCTION
+    };
+
+    /// @brief The kind of the value.
+    Kind kind;
+
+    /// @brief The opcode of a constant or instruction.
+    cppLox::ByteCode::Opcode opcode;
+
+    /// @brief The constant index, global slot or argument count of an instruction, the stack slot of a parameter or a
+    /// phi.
+    uint16_t operand;
+
+    /// @brief The operands of an instruction from the bottom to the top of the stack, one value per predecessor of
+    /// a phi.
+    std::vector<ValueId> operands;
+
+    /// @brief The block the value is defined in.
+    BlockId block;
+
+    /// @brief The line of the instruction, that defines the value.
+    int line;
+
+    /// @brief The types the value can have at runtime.
+    uint8_t types;
+
+    /// @brief The equal value, that replaces the value, or NO_VALUE.
+    ValueId replacement;
+};
+
+/// @brief A stack operation of a basic block.
+/// @details The steps keep the order of the original bytecode. Every stack slot, be it a local variable or a
+/// temporary, holds a value, so the values a step consumes are the ones on top of the stack.
+struct SsaStep {
+    /// @brief The kind of a step.
+    enum class Kind : uint8_t {
+        /// @brief Pushes the value of a stack slot.
+        LOAD,
+        /// @brief Pops the operands of a value and pushes the value.
+        DEFINE,
+        /// @brief Pops the value on top of the stack.
+        POP,
+        /// @brief Stores the value on top of the stack in a stack slot.
+        STORE,
+        /// @brief Prints or defines or assigns a global variable with the value on top of the stack.
+        EFFECT
+    };
+
+    /// @brief The kind of the step.
+    Kind kind;
+
+    /// @brief The opcode of an effect.
+    cppLox::ByteCode::Opcode opcode;
+
+    /// @brief The stack slot of a load or store or the global slot of an effect.
+    uint16_t operand;
+
+    /// @brief The loaded, defined or stored value, the value an effect consumes.
+    ValueId value;
+
+    /// @brief The line of the original instruction.
+    int line;
+
+    /// @brief Whether the step is removed, because it stores a value no one reads.
+    bool removed;
+};
+
+/// @brief How a basic block is left.
+enum class Terminator : uint8_t {
+    /// @brief The block continues with the next block.
+    FALL_THROUGH,
+    /// @brief The block jumps to its target.
+    JUMP,
+    /// @brief The block jumps to its target if the value on top of the stack is falsy, the value is kept.
+    JUMP_IF_FALSE,
+    /// @brief The block pops the value on top of the stack and jumps to its target if the value is false.
+    POP_JUMP_IF_FALSE,
+    /// @brief The block pops the value on top of the stack and jumps to its target if the value is true.
+    POP_JUMP_IF_TRUE,
+    /// @brief The block returns the value on top of the stack.
+    RETURN
+};
+
+/// @brief A basic block of a function in ssa form.
+struct BasicBlock {
+    /// @brief The offset of the first instruction of the block in the original chunk.
+    size_t offset;
+
+    /// @brief The stack operations of the block.
+    std::vector<SsaStep> steps;
+
+    /// @brief How the block is left.
+    Terminator terminator;
+
+    /// @brief The line of the instruction, that leaves the block.
+    int terminatorLine;
+
+    /// @brief The block that is jumped to or NO_BLOCK.
+    BlockId target;
+
+    /// @brief The block that follows the block or NO_BLOCK.
+    BlockId next;
+
+    /// @brief The predecessors of the block, NO_BLOCK stands for the start of the function.
+    std::vector<BlockId> predecessors;
+
+    /// @brief The values of the stack slots at the start of the block.
+    std::vector<ValueId> entry;
+
+    /// @brief The values of the stack slots after the block was left.
+    std::vector<ValueId> exit;
+
+    /// @brief Whether the value of the stack slot is read after the start of the block.
+    std::vector<bool> liveIn;
+
+    /// @brief The immediate dominator of the block or NO_BLOCK.
+    BlockId dominator;
+
+    /// @brief The index of the innermost loop containing the block or SIZE_MAX.
+    size_t loop;
+
+    /// @brief Whether the block can be reached from the start of the function.
+    bool reachable;
+};
+
+/// @brief A natural loop of a function in ssa form.
+struct Loop {
+    /// @brief The block, that every iteration starts with.
+    BlockId header;
+
+    /// @brief Whether the block belongs to the loop for every block of the function.
+    std::vector<bool> body;
+
+    /// @brief The index of the innermost loop containing the loop or SIZE_MAX.
+    size_t parent;
+
+    /// @brief The invariant values, that are computed before the loop is entered.
+    std::vector<ValueId> hoisted;
+
+    /// @brief The stack slots, that the hoisted values read.
+    std::vector<bool> preheaderReads;
+};
+
+/// @brief A function in static single assignment form.
+/// @details Every stack slot of the function gets a new value, whenever it is written. The values of the stack slots
+/// are merged by a phi at the start of a block with several predecessors.
+class SsaFunction {
+  public:
+    /// @brief Constructs a new function in ssa form.
+    /// @param function The function that is lowered into ssa form.
+    explicit SsaFunction(cppLox::Types::ObjectFunction & function);
+
+    /// @brief Destructor of the function in ssa form.
+    ~SsaFunction() = default;
+
+    /// @brief Gets the function, that is lowered into ssa form.
+    /// @return The function, that is lowered into ssa form.
+    [[nodiscard]] auto function() const -> cppLox::Types::ObjectFunction &;
+
+    /// @brief Adds a value to the function.
+    /// @param value The value that is added.
+    /// @return The index of the added value.
+    auto addValue(SsaValue value) -> ValueId;
+
+    /// @brief Gets the value with the given index.
+    /// @param id The index of the value.
+    /// @return The value with the given index.
+    [[nodiscard]] auto value(ValueId id) -> SsaValue &;
+
+    /// @brief Gets the value with the given index.
+    /// @param id The index of the value.
+    /// @return The value with the given index.
+    [[nodiscard]] auto value(ValueId id) const -> SsaValue const &;
+
+    /// @brief Gets the amount of values of the function.
+    /// @return The amount of values of the function.
+    [[nodiscard]] auto valueCount() const -> size_t;
+
+    /// @brief Follows the replacements of a value to the value, that is not replaced.
+    /// @param id The index of the value.
+    /// @return The index of the value that represents the given value.
+    [[nodiscard]] auto canonical(ValueId id) const -> ValueId;
+
+    /// @brief Gets the basic blocks of the function in the order of the original chunk.
+    /// @return The basic blocks of the function.
+    [[nodiscard]] auto blocks() -> std::vector<BasicBlock> &;
+
+    /// @brief Gets the basic blocks of the function in the order of the original chunk.
+    /// @return The basic blocks of the function.
+    [[nodiscard]] auto blocks() const -> std::vector<BasicBlock> const &;
+
+    /// @brief Gets the reachable blocks in reverse postorder.
+    /// @return The reachable blocks in reverse postorder.
+    [[nodiscard]] auto order() -> std::vector<BlockId> &;
+
+    /// @brief Gets the reachable blocks in reverse postorder.
+    /// @return The reachable blocks in reverse postorder.
+    [[nodiscard]] auto order() const -> std::vector<BlockId> const &;
+
+    /// @brief Gets the natural loops of the function, an outer loop comes before the loops it contains.
+    /// @return The natural loops of the function.
+    [[nodiscard]] auto loops() -> std::vector<Loop> &;
+
+    /// @brief Gets the natural loops of the function, an outer loop comes before the loops it contains.
+    /// @return The natural loops of the function.
+    [[nodiscard]] auto loops() const -> std::vector<Loop> const &;
+
+    /// @brief Gets the blocks, that follow the given block.
+    /// @param block The block whose successors are returned.
+    /// @return The fall through successor before the jump target.
+    [[nodiscard]] auto successors(BlockId block) const -> std::vector<BlockId>;
+
+    /// @brief Gets the value a stack slot holds, when the given block is entered from the given predecessor.
+    /// @param block The entered block.
+    /// @param predecessor The predecessor the block is entered from.
+    /// @param slot The stack slot.
+    /// @return The canonical value of the stack slot on the edge.
+    [[nodiscard]] auto edgeValue(BlockId block, BlockId predecessor, size_t slot) const -> ValueId;
+
+    /// @brief Gets the value a stack slot holds, when the given loop is entered.
+    /// @param loop The index of the loop.
+    /// @param slot The stack slot.
+    /// @return The canonical value of the stack slot, NO_VALUE if the edges into the loop disagree on the value.
+    [[nodiscard]] auto loopEntryValue(size_t loop, size_t slot) const -> ValueId;
+
+    /// @brief Determines whether the first block dominates the second block.
+    /// @param dominator The block that may dominate the other block.
+    /// @param block The block that may be dominated.
+    /// @return true if every path from the start of the function to the block passes the dominator, false otherwise.
+    [[nodiscard]] auto dominates(BlockId dominator, BlockId block) const -> bool;
+
+    /// @brief Determines whether a value is a literal.
+    /// @param id The index of the value.
+    /// @return true if the value is pushed by CONSTANT, FALSE, NULL_ or TRUE, false otherwise.
+    [[nodiscard]] auto isConstant(ValueId id) const -> bool;
+
+    /// @brief Determines whether a value only depends on its operands.
+    /// @details Additions are only pure, if both operands are numbers, since concatenating strings allocates a new
+    /// string.
+    /// @param id The index of the value.
+    /// @return true if the value is a literal or the result of an instruction without side effects, false otherwise.
+    [[nodiscard]] auto isPure(ValueId id) const -> bool;
+
+    /// @brief Determines whether computing a value can raise a runtime error.
+    /// @param id The index of the value.
+    /// @return true if the types of the operands do not rule out a runtime error, false otherwise.
+    [[nodiscard]] auto mayThrow(ValueId id) const -> bool;
+
+    /// @brief Determines whether all types of a value are contained in the given types.
+    /// @param id The index of the value.
+    /// @param types The types the value may have.
+    /// @return true if the value can only have the given types, false otherwise.
+    [[nodiscard]] auto hasOnly(ValueId id, uint8_t types) const -> bool;
+
+  private:
+    /// @brief The function, that is lowered into ssa form.
+    cppLox::Types::ObjectFunction * m_function;
+
+    /// @brief The values of the function.
+    std::vector<SsaValue> m_values;
+
+    /// @brief The basic blocks of the function.
+    std::vector<BasicBlock> m_blocks;
+
+    /// @brief The reachable blocks in reverse postorder.
+    std::vector<BlockId> m_order;
+
+    /// @brief The natural loops of the function.
+    std::vector<Loop> m_loops;
+};
+
+} // namespace cppLox::MiddleEnd
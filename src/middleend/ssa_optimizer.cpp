@@ -0,0 +1,426 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file ssa_optimizer.cpp
+ * @brief This file contains the implementation of the SsaOptimizer class.
+ */
+
+#include "ssa_optimizer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "../types/object.hpp"
+#include "ssa_builder.hpp"
+#include "ssa_emitter.hpp"
+
+using namespace cppLox::MiddleEnd;
+
+using cppLox::ByteCode::Opcode;
+
+namespace {
+
+/// @brief Identifies the values, that compute the same result
+struct ValueKey {
+    /// @brief The opcode of the value
+    Opcode opcode;
+
+    /// @brief The operand of the instruction or the type of a constant
+    uint16_t operand;
+
+    /// @brief The bits of a constant
+    uint64_t payload;
+
+    /// @brief The canonical operands of the instruction
+    std::vector<ValueId> operands;
+
+    /// @brief Orders the keys
+    /// @param other The key to compare against
+    /// @return true if the key comes before the other key, false otherwise
+    auto operator<(ValueKey const & other) const -> bool {
+        return std::tie(opcode, operand, payload, operands) <
+               std::tie(other.opcode, other.operand, other.payload, other.operands);
+    }
+};
+
+} // namespace
+
+/// @brief Gets the key of a constant or a pure instruction
+/// @param function The function the value belongs to
+/// @param value The value
+/// @return The key of the value
+static auto keyOf(SsaFunction const & function, SsaValue const & value) -> ValueKey {
+    if (value.kind == SsaValue::Kind::CONSTANT) {
+        if (value.opcode != Opcode::CONSTANT) {
+            return ValueKey{value.opcode, 0, 0, {}};
+        }
+        cppLox::Types::Value const & constant = function.function().chunk()->getConstant(value.operand);
+        uint64_t payload = 0;
+        switch (constant.getType()) {
+        case cppLox::Types::Value::Type::BOOL:
+            payload = constant.as<bool>() ? 1 : 0;
+            break;
+        case cppLox::Types::Value::Type::NULL_:
+            break;
+        case cppLox::Types::Value::Type::NUMBER:
+            // Numbers are compared by their bits, so 0 and -0 stay apart
+            payload = std::bit_cast<uint64_t>(constant.as<double>());
+            break;
+        case cppLox::Types::Value::Type::OBJECT:
+            payload = reinterpret_cast<uintptr_t>(constant.as<cppLox::Types::Object *>());
+            break;
+        }
+        return ValueKey{Opcode::CONSTANT, static_cast<uint16_t>(constant.getType()), payload, {}};
+    }
+    ValueKey key{value.opcode, value.operand, 0, {}};
+    for (ValueId const operand : value.operands) {
+        key.operands.push_back(function.canonical(operand));
+    }
+    switch (value.opcode) {
+    case Opcode::ADD:
+    case Opcode::EQUAL:
+    case Opcode::MULTIPLY:
+    case Opcode::NOT_EQUAL:
+        std::sort(key.operands.begin(), key.operands.end());
+        break;
+    default:
+        break;
+    }
+    return key;
+}
+
+auto SsaOptimizer::optimize(cppLox::Types::ObjectFunction & function, bool superinstructions) -> bool {
+    std::optional<SsaFunction> ssaFunction = SsaBuilder().build(function);
+    if (!ssaFunction.has_value()) {
+        return false;
+    }
+    inferTypes(*ssaFunction);
+    eliminateCommonSubexpressions(*ssaFunction);
+    hoistLoopInvariants(*ssaFunction);
+    eliminateDeadStores(*ssaFunction);
+    return SsaEmitter().emit(*ssaFunction, superinstructions);
+}
+
+auto SsaOptimizer::inferTypes(SsaFunction & function) -> void {
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (ValueId id = 0; id < function.valueCount(); id++) {
+            SsaValue const & value = function.value(id);
+            uint8_t types = 0;
+            auto const typesOf = [&](size_t operand) {
+                return function.value(function.canonical(value.operands[operand])).types;
+            };
+            if (value.kind == SsaValue::Kind::PHI) {
+                for (size_t operand = 0; operand < value.operands.size(); operand++) {
+                    types |= typesOf(operand);
+                }
+            } else if (value.kind == SsaValue::Kind::INSTRUCTION) {
+                switch (value.opcode) {
+                case Opcode::ADD:
+                    // An addition only succeeds for two numbers or two strings
+                    types |= (typesOf(0) & typesOf(1) & NUMBER_TYPE);
+                    types |= (typesOf(0) & typesOf(1) & STRING_TYPE);
+                    break;
+                case Opcode::DIVIDE:
+                case Opcode::MULTIPLY:
+                case Opcode::NEGATE:
+                case Opcode::SUBTRACT:
+                    types = NUMBER_TYPE;
+                    break;
+                case Opcode::EQUAL:
+                case Opcode::GREATER:
+                case Opcode::GREATER_EQUAL:
+                case Opcode::LESS:
+                case Opcode::LESS_EQUAL:
+                case Opcode::NOT:
+                case Opcode::NOT_EQUAL:
+                    types = BOOL_TYPE;
+                    break;
+                default:
+                    types = ANY_TYPE;
+                    break;
+                }
+            } else {
+                continue;
+            }
+            if ((value.types | types) != value.types) {
+                function.value(id).types |= types;
+                changed = true;
+            }
+        }
+    }
+}
+
+auto SsaOptimizer::eliminateCommonSubexpressions(SsaFunction & function) -> void {
+    std::vector<BasicBlock> & blocks = function.blocks();
+    std::vector<std::vector<BlockId>> children(blocks.size());
+    for (BlockId const block : function.order()) {
+        if (blocks[block].dominator != NO_BLOCK) {
+            children[blocks[block].dominator].push_back(block);
+        }
+    }
+    std::map<ValueKey, ValueId> available;
+    std::vector<ValueKey> inserted;
+    // The dominator tree is walked depth first. Every block is visited a second time after its subtree, to forget
+    // the values it made available, the second visit carries the amount of values available before the block.
+    std::vector<std::pair<BlockId, size_t>> stack = {{0, SIZE_MAX}};
+    while (!stack.empty()) {
+        auto const [block, mark] = stack.back();
+        stack.pop_back();
+        if (mark != SIZE_MAX) {
+            for (; inserted.size() > mark; inserted.pop_back()) {
+                available.erase(inserted.back());
+            }
+            continue;
+        }
+        stack.emplace_back(block, inserted.size());
+        std::map<uint16_t, ValueId> globals;
+        for (SsaStep const & step : blocks[block].steps) {
+            if (step.kind == SsaStep::Kind::EFFECT && step.opcode != Opcode::PRINT) {
+                globals[step.operand] = function.canonical(step.value);
+            }
+            if (step.kind != SsaStep::Kind::DEFINE) {
+                continue;
+            }
+            SsaValue & value = function.value(step.value);
+            if (value.kind == SsaValue::Kind::INSTRUCTION &&
+                (value.opcode == Opcode::CALL || value.opcode == Opcode::TAIL_CALL)) {
+                globals.clear();
+            } else if (value.kind == SsaValue::Kind::INSTRUCTION && value.opcode == Opcode::GET_GLOBAL) {
+                auto const [global, added] = globals.try_emplace(value.operand, step.value);
+                if (!added) {
+                    value.replacement = global->second;
+                }
+            } else if (function.isPure(step.value)) {
+                ValueKey key = keyOf(function, value);
+                auto const [position, added] = available.try_emplace(key, step.value);
+                if (added) {
+                    inserted.push_back(std::move(key));
+                } else {
+                    value.replacement = position->second;
+                }
+            }
+        }
+        for (BlockId const child : children[block]) {
+            stack.emplace_back(child, SIZE_MAX);
+        }
+    }
+}
+
+auto SsaOptimizer::hoistLoopInvariants(SsaFunction & function) -> void {
+    std::vector<BasicBlock> & blocks = function.blocks();
+    std::vector<Loop> & loops = function.loops();
+    std::vector<bool> eligible(loops.size(), true);
+    std::vector<bool> calls(loops.size(), false);
+    std::vector<std::set<uint16_t>> assignedGlobals(loops.size());
+    for (size_t index = 0; index < loops.size(); index++) {
+        Loop & loop = loops[index];
+        loop.preheaderReads.assign(blocks[loop.header].entry.size(), false);
+        // The hoisted values are computed in front of the loop, so no iteration may fall through to its start
+        for (BlockId const predecessor : blocks[loop.header].predecessors) {
+            if (predecessor != NO_BLOCK && loop.body[predecessor] && blocks[predecessor].next == loop.header) {
+                eligible[index] = false;
+            }
+        }
+        for (BlockId block = 0; block < blocks.size(); block++) {
+            if (!loop.body[block]) {
+                continue;
+            }
+            for (SsaStep const & step : blocks[block].steps) {
+                if (step.kind == SsaStep::Kind::EFFECT && step.opcode != Opcode::PRINT) {
+                    assignedGlobals[index].insert(step.operand);
+                } else if (step.kind == SsaStep::Kind::DEFINE) {
+                    Opcode const opcode = function.value(step.value).opcode;
+                    calls[index] = calls[index] || (function.value(step.value).kind == SsaValue::Kind::INSTRUCTION &&
+                                                    (opcode == Opcode::CALL || opcode == Opcode::TAIL_CALL));
+                }
+            }
+        }
+    }
+
+    std::vector<size_t> hoistedTo(function.valueCount(), SIZE_MAX);
+    auto const contains = [&](size_t outer, size_t inner) {
+        for (; inner != SIZE_MAX; inner = loops[inner].parent) {
+            if (inner == outer) {
+                return true;
+            }
+        }
+        return false;
+    };
+    for (BlockId const block : function.order()) {
+        std::vector<size_t> enclosing;
+        for (size_t loop = blocks[block].loop; loop != SIZE_MAX; loop = loops[loop].parent) {
+            enclosing.insert(enclosing.begin(), loop);
+        }
+        // Whether every step before the current one is free of side effects and runtime errors
+        bool clean = true;
+        for (SsaStep const & step : blocks[block].steps) {
+            bool const defines = step.kind == SsaStep::Kind::DEFINE && function.canonical(step.value) == step.value;
+            if (defines && !function.isConstant(step.value)) {
+                SsaValue const & value = function.value(step.value);
+                bool const global = value.kind == SsaValue::Kind::INSTRUCTION && value.opcode == Opcode::GET_GLOBAL;
+                for (size_t const loop : enclosing) {
+                    if (!eligible[loop] || (!global && !function.isPure(step.value)) ||
+                        (global && (calls[loop] || assignedGlobals[loop].contains(value.operand))) ||
+                        (function.mayThrow(step.value) && (loops[loop].header != block || !clean))) {
+                        continue;
+                    }
+                    bool const invariant = std::all_of(value.operands.begin(), value.operands.end(), [&](ValueId id) {
+                        ValueId const operand = function.canonical(id);
+                        SsaValue const & definition = function.value(operand);
+                        return function.isConstant(operand) || definition.kind == SsaValue::Kind::PARAMETER ||
+                               (hoistedTo[operand] != SIZE_MAX && contains(hoistedTo[operand], loop)) ||
+                               !loops[loop].body[definition.block];
+                    });
+                    if (!invariant) {
+                        continue;
+                    }
+                    hoistedTo[step.value] = loop;
+                    loops[loop].hoisted.push_back(step.value);
+                    // The preheader reads the operands from the stack slots, that hold them on every entry
+                    for (ValueId const id : value.operands) {
+                        ValueId const operand = function.canonical(id);
+                        if (function.isConstant(operand) || hoistedTo[operand] != SIZE_MAX) {
+                            continue;
+                        }
+                        for (size_t slot = 0; slot < loops[loop].preheaderReads.size(); slot++) {
+                            if (function.loopEntryValue(loop, slot) == operand) {
+                                loops[loop].preheaderReads[slot] = true;
+                                break;
+                            }
+                        }
+                    }
+                    break;
+                }
+            }
+            if (step.kind == SsaStep::Kind::EFFECT ||
+                (defines && hoistedTo[step.value] == SIZE_MAX && function.mayThrow(step.value))) {
+                clean = false;
+            }
+        }
+    }
+}
+
+auto SsaOptimizer::eliminateDeadStores(SsaFunction & function) -> void {
+    std::vector<BasicBlock> & blocks = function.blocks();
+    std::vector<Loop> const & loops = function.loops();
+    std::vector<size_t> headerLoop(blocks.size(), SIZE_MAX);
+    for (size_t index = 0; index < loops.size(); index++) {
+        headerLoop[loops[index].header] = index;
+    }
+    size_t width = 0;
+    for (BlockId const block : function.order()) {
+        width = std::max(width, blocks[block].entry.size() + blocks[block].steps.size() + 1);
+        blocks[block].liveIn.assign(blocks[block].entry.size(), false);
+    }
+
+    auto const liveOut = [&](BlockId block) {
+        std::vector<bool> live(width, false);
+        for (BlockId const successor : function.successors(block)) {
+            std::vector<bool> const & liveIn = blocks[successor].liveIn;
+            size_t const loop = headerLoop[successor];
+            // The preheader of a loop, that is entered from the block, reads the operands of the hoisted values
+            bool const entersLoop = loop != SIZE_MAX && !loops[loop].hoisted.empty() && !loops[loop].body[block];
+            for (size_t slot = 0; slot < liveIn.size(); slot++) {
+                live[slot] = live[slot] || liveIn[slot] || (entersLoop && loops[loop].preheaderReads[slot]);
+            }
+        }
+        return live;
+    };
+    // Walks the block backwards and returns the slots, that are read after the start of the block
+    auto const transfer = [&](BlockId block, std::vector<bool> live, bool remove) {
+        BasicBlock & basicBlock = blocks[block];
+        std::vector<size_t> depths;
+        size_t depth = basicBlock.entry.size();
+        for (SsaStep const & step : basicBlock.steps) {
+            depths.push_back(depth);
+            switch (step.kind) {
+            case SsaStep::Kind::LOAD:
+                depth++;
+                break;
+            case SsaStep::Kind::DEFINE:
+                depth = depth - function.value(step.value).operands.size() + 1;
+                break;
+            case SsaStep::Kind::POP:
+                depth--;
+                break;
+            case SsaStep::Kind::STORE:
+                break;
+            case SsaStep::Kind::EFFECT:
+                depth -= step.opcode == Opcode::SET_GLOBAL ? 0 : 1;
+                break;
+            }
+        }
+        if (basicBlock.terminator != Terminator::FALL_THROUGH && basicBlock.terminator != Terminator::JUMP) {
+            live[depth - 1] = true;
+        }
+        for (size_t index = basicBlock.steps.size(); index-- > 0;) {
+            SsaStep & step = basicBlock.steps[index];
+            size_t const before = depths[index];
+            switch (step.kind) {
+            case SsaStep::Kind::LOAD:
+                live[before] = false;
+                live[step.operand] = true;
+                break;
+            case SsaStep::Kind::DEFINE:
+                {
+                    size_t const operands = function.value(step.value).operands.size();
+                    live[before - operands] = false;
+                    for (size_t slot = before - operands; slot < before; slot++) {
+                        live[slot] = true;
+                    }
+                    break;
+                }
+            case SsaStep::Kind::POP:
+                live[before - 1] = false;
+                break;
+            case SsaStep::Kind::STORE:
+                if (step.operand == before - 1) {
+                    break;
+                }
+                step.removed = remove && !live[step.operand];
+                live[step.operand] = false;
+                live[before - 1] = true;
+                break;
+            case SsaStep::Kind::EFFECT:
+                live[before - 1] = true;
+                break;
+            }
+        }
+        live.resize(basicBlock.entry.size());
+        return live;
+    };
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto block = function.order().rbegin(); block != function.order().rend(); block++) {
+            std::vector<bool> liveIn = transfer(*block, liveOut(*block), false);
+            if (liveIn != blocks[*block].liveIn) {
+                blocks[*block].liveIn = std::move(liveIn);
+                changed = true;
+            }
+        }
+    }
+    for (BlockId const block : function.order()) {
+        static_cast<void>(transfer(block, liveOut(block), true));
+    }
+}
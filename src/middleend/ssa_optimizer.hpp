@@ -0,0 +1,71 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file ssa_optimizer.hpp
+ * @brief This file contains the declaration of the SsaOptimizer class.
+ */
+
+#pragma once
+
+#include "../types/object_function.hpp"
+#include "ssa_function.hpp"
+
+namespace cppLox::MiddleEnd {
+
+/// @brief Optimizes a compiled function in static single assignment form.
+/// @details The optimizer lowers the chunk of a function into ssa form, which already propagates the copies between
+/// local variables. It then infers the types of the values, removes common subexpressions, hoists loop invariant
+/// values in front of their loop and removes the stores to local variables, that are never read. The function is
+/// finally emitted into a new chunk. If the bytecode can not be lowered or emitted, the chunk is left untouched.
+class SsaOptimizer {
+  public:
+    /// @brief Constructs a new ssa optimizer.
+    SsaOptimizer() = default;
+
+    /// @brief Destructor of the ssa optimizer.
+    ~SsaOptimizer() = default;
+
+    /// @brief Optimizes the chunk of the given function.
+    /// @param function The function that is optimized.
+    /// @param superinstructions Whether the emitted chunk may contain superinstructions.
+    /// @return true if the chunk was rewritten, false otherwise.
+    auto optimize(cppLox::Types::ObjectFunction & function, bool superinstructions) -> bool;
+
+  private:
+    /// @brief Computes the types every value can have, starting with no types for every instruction and phi.
+    /// @param function The function whose values are analyzed.
+    auto inferTypes(SsaFunction & function) -> void;
+
+    /// @brief Replaces the values, that a dominating value with the same operands already computed, by that value.
+    /// @details Globals are only reused within a block. A call may change every global, while assigning a global
+    /// makes the assigned value the one that is read afterwards.
+    /// @param function The function whose common subexpressions are eliminated.
+    auto eliminateCommonSubexpressions(SsaFunction & function) -> void;
+
+    /// @brief Moves the values, that are the same in every iteration, in front of their loop.
+    /// @details Values that can raise a runtime error are only moved from the start of the first block of their
+    /// loop, so the error is raised before the same side effects. Globals are only moved out of loops without calls
+    /// and assignments to them.
+    /// @param function The function whose loop invariants are hoisted.
+    auto hoistLoopInvariants(SsaFunction & function) -> void;
+
+    /// @brief Computes which stack slots are read after the start of every block and removes the stores to local
+    /// variables, that are overwritten or popped before they are read.
+    /// @param function The function whose dead stores are eliminated.
+    auto eliminateDeadStores(SsaFunction & function) -> void;
+};
+
+} // namespace cppLox::MiddleEnd
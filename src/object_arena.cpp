@@ -0,0 +1,199 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file object_arena.cpp
+ * @brief This file contains the implementation of the arena, that the objects of the old generation are allocated in.
+ */
+
+#include "object_arena.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+using namespace cppLox;
+
+static_assert(ARENA_CHUNK_SIZE % ARENA_PAGE_SIZE == 0, "A chunk is split into whole pages");
+static_assert(ARENA_MAX_OBJECT_SIZE % ARENA_SIZE_CLASS_GRANULARITY == 0,
+              "The largest size class holds the largest object");
+
+ObjectArena::ObjectArena(bool hugePages) : m_hugePages(hugePages) {
+}
+
+ObjectArena::~ObjectArena() {
+    for (auto [chunk, mapping] : m_chunks) {
+#ifdef _WIN32
+        static_cast<void>(chunk);
+        VirtualFree(mapping, 0, MEM_RELEASE);
+#else
+        static_cast<void>(mapping);
+        munmap(chunk, ARENA_CHUNK_SIZE);
+#endif
+    }
+}
+
+auto ObjectArena::allocate(size_t size) -> void * {
+    size_t const sizeClass = (std::max<size_t>(size, 1) - 1) / ARENA_SIZE_CLASS_GRANULARITY;
+    Page * page = m_availablePages[sizeClass];
+    if (page == nullptr) {
+        page = takePage(sizeClass);
+    }
+    void * slot;
+    if (page->m_freeSlots != nullptr) {
+        slot = page->m_freeSlots;
+        page->m_freeSlots = *static_cast<void **>(slot);
+    } else {
+        slot = reinterpret_cast<std::byte *>(page) + SLOTS_OFFSET + page->m_bumped * page->m_slotSize;
+        page->m_bumped++;
+    }
+    if (++page->m_used == page->m_capacity) {
+        unlink(page);
+    }
+    return slot;
+}
+
+auto ObjectArena::deallocate(void * slot) noexcept -> void {
+    Page * page = reinterpret_cast<Page *>(reinterpret_cast<uintptr_t>(slot) & ~uintptr_t{ARENA_PAGE_SIZE - 1});
+    ObjectArena & arena = *page->m_arena;
+    if (page->m_used == page->m_capacity) {
+        arena.link(page);
+    }
+    *static_cast<void **>(slot) = page->m_freeSlots;
+    page->m_freeSlots = slot;
+    // The last page with free slots of a size class is kept, so a size class, whose objects are allocated and freed in
+    // turns, does not map and return the same page over and over again
+    if (--page->m_used == 0 && (arena.m_availablePages[page->m_sizeClass] != page || page->m_next != nullptr)) {
+        arena.cachePage(page);
+    }
+}
+
+auto ObjectArena::trim() noexcept -> void {
+    if (!m_hugePages) {
+        for (size_t index = 0; index < m_agedPages; index++) {
+#ifdef _WIN32
+            VirtualAlloc(m_cachedPages[index], ARENA_PAGE_SIZE, MEM_RESET, PAGE_READWRITE);
+#else
+            madvise(m_cachedPages[index], ARENA_PAGE_SIZE, MADV_DONTNEED);
+#endif
+        }
+        m_emptyPages.insert(m_emptyPages.end(), m_cachedPages.begin(),
+                            m_cachedPages.begin() + static_cast<std::ptrdiff_t>(m_agedPages));
+        m_cachedPages.erase(m_cachedPages.begin(), m_cachedPages.begin() + static_cast<std::ptrdiff_t>(m_agedPages));
+    }
+    m_agedPages = m_cachedPages.size();
+}
+
+auto ObjectArena::takePage(size_t sizeClass) -> Page * {
+    Page * page;
+    // The cached pages, that were emptied last, are the most likely to be in the caches of the processor still
+    if (!m_cachedPages.empty()) {
+        page = m_cachedPages.back();
+        m_cachedPages.pop_back();
+        m_agedPages = std::min(m_agedPages, m_cachedPages.size());
+    } else {
+        if (m_emptyPages.empty()) {
+            mapChunk();
+        }
+        page = m_emptyPages.back();
+        m_emptyPages.pop_back();
+    }
+    page->m_arena = this;
+    page->m_freeSlots = nullptr;
+    page->m_sizeClass = static_cast<uint32_t>(sizeClass);
+    page->m_slotSize = static_cast<uint32_t>((sizeClass + 1) * ARENA_SIZE_CLASS_GRANULARITY);
+    page->m_capacity = static_cast<uint32_t>((ARENA_PAGE_SIZE - SLOTS_OFFSET) / page->m_slotSize);
+    page->m_used = 0;
+    page->m_bumped = 0;
+    link(page);
+    m_usedPages++;
+    return page;
+}
+
+auto ObjectArena::cachePage(Page * page) noexcept -> void {
+    unlink(page);
+    m_cachedPages.push_back(page);
+    m_usedPages--;
+}
+
+auto ObjectArena::mapChunk() -> void {
+    // Twice the size of a chunk is mapped, so the chunk can be aligned to its size, which aligns the pages as well
+    size_t const mappedSize = 2 * ARENA_CHUNK_SIZE;
+#ifdef _WIN32
+    void * mapping = VirtualAlloc(nullptr, mappedSize, MEM_RESERVE, PAGE_NOACCESS);
+    if (mapping == nullptr) {
+        throw std::bad_alloc();
+    }
+    auto const address = reinterpret_cast<uintptr_t>(mapping);
+    auto * chunk = reinterpret_cast<std::byte *>((address + ARENA_CHUNK_SIZE - 1) & ~uintptr_t{ARENA_CHUNK_SIZE - 1});
+    if (VirtualAlloc(chunk, ARENA_CHUNK_SIZE, MEM_COMMIT, PAGE_READWRITE) == nullptr) {
+        VirtualFree(mapping, 0, MEM_RELEASE);
+        throw std::bad_alloc();
+    }
+#else
+    void * mapping =
+        mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    auto const address = reinterpret_cast<uintptr_t>(mapping);
+    auto * chunk = reinterpret_cast<std::byte *>((address + ARENA_CHUNK_SIZE - 1) & ~uintptr_t{ARENA_CHUNK_SIZE - 1});
+    // The parts before and after the aligned chunk are returned right away
+    size_t const head = static_cast<size_t>(chunk - static_cast<std::byte *>(mapping));
+    if (head > 0) {
+        munmap(mapping, head);
+    }
+    if (ARENA_CHUNK_SIZE - head > 0) {
+        munmap(chunk + ARENA_CHUNK_SIZE, ARENA_CHUNK_SIZE - head);
+    }
+    mapping = chunk;
+#ifdef MADV_HUGEPAGE
+    if (m_hugePages) {
+        madvise(chunk, ARENA_CHUNK_SIZE, MADV_HUGEPAGE);
+    }
+#endif
+#endif
+    m_chunks.emplace_back(chunk, mapping);
+    // The pages are taken from the back, so the pages at the start of the chunk are used first
+    for (size_t offset = ARENA_CHUNK_SIZE; offset > 0; offset -= ARENA_PAGE_SIZE) {
+        m_emptyPages.push_back(reinterpret_cast<Page *>(chunk + offset - ARENA_PAGE_SIZE));
+    }
+}
+
+auto ObjectArena::link(Page * page) noexcept -> void {
+    Page *& first = m_availablePages[page->m_sizeClass];
+    page->m_previous = nullptr;
+    page->m_next = first;
+    if (first != nullptr) {
+        first->m_previous = page;
+    }
+    first = page;
+}
+
+auto ObjectArena::unlink(Page * page) noexcept -> void {
+    if (page->m_previous != nullptr) {
+        page->m_previous->m_next = page->m_next;
+    } else {
+        m_availablePages[page->m_sizeClass] = page->m_next;
+    }
+    if (page->m_next != nullptr) {
+        page->m_next->m_previous = page->m_previous;
+    }
+}
@@ -0,0 +1,210 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file object_arena.hpp
+ * @brief This file contains the arena, that the objects of the old generation are allocated in.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "types/object.hpp"
+
+namespace cppLox {
+
+/// @brief The size of the pages, that the slots of a size class are carved from, in bytes
+#define ARENA_PAGE_SIZE (64 * 1024)
+
+/// @brief The size of the chunks, that are mapped from the operating system at once and split into pages, in bytes
+#define ARENA_CHUNK_SIZE (2 * 1024 * 1024)
+
+/// @brief The difference between the slot sizes of two neighbouring size classes in bytes
+#define ARENA_SIZE_CLASS_GRANULARITY 16
+
+/// @brief The size of the largest object, that can be allocated in the arena, in bytes
+#define ARENA_MAX_OBJECT_SIZE 256
+
+#ifdef HUGE_PAGES
+/// @brief Whether the chunks of the arenas are backed by huge pages by default
+#define ARENA_HUGE_PAGES true
+#else
+/// @brief Whether the chunks of the arenas are backed by huge pages by default
+#define ARENA_HUGE_PAGES false
+#endif
+
+/// @brief An arena, that allocates objects in slots of the size class, that fits them.
+/// @details The arena maps chunks from the operating system, that are split into pages. Every page holds the slots of
+/// a single size class, so the objects of the same size are allocated next to each other, and starts with a header.
+/// The header of the page of a slot is found by aligning the address of the slot down, so freeing an object does not
+/// need to know its size or its arena. Freed slots are kept in a free list per page, untouched slots are handed out by
+/// bumping an index, so a page is only touched, once its slots are needed. A page, whose slots are all freed, is
+/// cached for any size class, unless it is the only page of its size class with free slots. The cached pages, that
+/// were not reused since the arena was trimmed the last time, are returned to the operating system, when it is
+/// trimmed again, so the pages freed by a collection can be reused by the next one without faulting them in again.
+/// The arena is owned by a single memory mutator, that only allocates on one thread, so the free lists are not shared
+/// between threads and need no synchronization.
+class ObjectArena {
+  public:
+    /// @brief Frees the objects, that were allocated in an arena.
+    struct Deleter {
+        /// @brief Destroys the given object and frees its slot.
+        /// @param object The object to free.
+        auto operator()(cppLox::Types::Object * object) const noexcept -> void {
+            object->~Object();
+            ObjectArena::deallocate(object);
+        }
+    };
+
+    /// @brief An object, that is owned by an arena and freed by its deleter.
+    using Pointer = std::unique_ptr<cppLox::Types::Object, Deleter>;
+
+    /// @brief Creates a new empty arena.
+    /// @param hugePages Whether the chunks are backed by huge pages, if the operating system supports it. The pages
+    /// are never returned to the operating system then, because that would split the huge pages.
+    explicit ObjectArena(bool hugePages = ARENA_HUGE_PAGES);
+
+    /// @brief Unmaps all the chunks of the arena, the objects in it have to be freed before.
+    ~ObjectArena();
+
+    ObjectArena(ObjectArena const &) = delete;
+    auto operator=(ObjectArena const &) -> ObjectArena & = delete;
+
+    /// @brief Creates a new object of the given type in the arena.
+    /// @tparam T The type of the object to create.
+    /// @tparam ...Args The types of the arguments to pass to the constructor.
+    /// @param ...args The arguments to pass to the constructor.
+    /// @return A pointer to the newly created object, that is freed using the deleter of the arena.
+    template <cppLox::Types::DerivedFromObject T, class... Args> auto create(Args &&... args) -> T * {
+        static_assert(sizeof(T) <= ARENA_MAX_OBJECT_SIZE, "The object is too large for the size classes of the arena");
+        void * slot = allocate(sizeof(T));
+        try {
+            return new (slot) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(slot);
+            throw;
+        }
+    }
+
+    /// @brief Allocates a slot, that is large enough for the given size.
+    /// @param size The size in bytes, at most ARENA_MAX_OBJECT_SIZE.
+    /// @return The slot, that is aligned to ARENA_SIZE_CLASS_GRANULARITY.
+    auto allocate(size_t size) -> void *;
+
+    /// @brief Frees the given slot.
+    /// @param slot The slot, that was allocated by an arena.
+    static auto deallocate(void * slot) noexcept -> void;
+
+    /// @brief Returns the cached pages, that were not reused since the arena was trimmed the last time, to the
+    /// operating system.
+    auto trim() noexcept -> void;
+
+    /// @brief Gets the amount of pages, that hold slots of a size class.
+    /// @return The amount of pages.
+    [[nodiscard]] auto usedPages() const noexcept -> size_t {
+        return m_usedPages;
+    }
+
+    /// @brief Gets the amount of empty pages, that were not returned to the operating system yet.
+    /// @return The amount of pages.
+    [[nodiscard]] auto cachedPages() const noexcept -> size_t {
+        return m_cachedPages.size();
+    }
+
+    /// @brief Gets the amount of bytes, that are mapped from the operating system.
+    /// @return The mapped bytes.
+    [[nodiscard]] auto mappedBytes() const noexcept -> size_t {
+        return m_chunks.size() * ARENA_CHUNK_SIZE;
+    }
+
+  private:
+    /// @brief The header of a page.
+    struct Page {
+        /// @brief The arena, that owns the page.
+        ObjectArena * m_arena;
+        /// @brief The next page of the size class, that has free slots.
+        Page * m_next;
+        /// @brief The previous page of the size class, that has free slots.
+        Page * m_previous;
+        /// @brief The slots, that were freed, linked through their first bytes.
+        void * m_freeSlots;
+        /// @brief The index of the size class of the slots.
+        uint32_t m_sizeClass;
+        /// @brief The size of the slots in bytes.
+        uint32_t m_slotSize;
+        /// @brief The amount of slots in the page.
+        uint32_t m_capacity;
+        /// @brief The amount of slots, that are allocated.
+        uint32_t m_used;
+        /// @brief The amount of slots, that were handed out by bumping the index.
+        uint32_t m_bumped;
+    };
+
+    /// @brief The offset of the first slot of a page, that follows the header.
+    static constexpr size_t SLOTS_OFFSET =
+        (sizeof(Page) + ARENA_SIZE_CLASS_GRANULARITY - 1) / ARENA_SIZE_CLASS_GRANULARITY * ARENA_SIZE_CLASS_GRANULARITY;
+
+    /// @brief The amount of size classes.
+    static constexpr size_t SIZE_CLASSES = ARENA_MAX_OBJECT_SIZE / ARENA_SIZE_CLASS_GRANULARITY;
+
+    /// @brief Prepares an empty page for the slots of the given size class.
+    /// @param sizeClass The index of the size class.
+    /// @return The page, that has free slots.
+    auto takePage(size_t sizeClass) -> Page *;
+
+    /// @brief Caches the given page, whose slots are all free, so it can be reused by any size class.
+    /// @param page The empty page.
+    auto cachePage(Page * page) noexcept -> void;
+
+    /// @brief Maps a new chunk from the operating system and splits it into empty pages.
+    auto mapChunk() -> void;
+
+    /// @brief Adds the given page to the pages of its size class, that have free slots.
+    /// @param page The page to add.
+    auto link(Page * page) noexcept -> void;
+
+    /// @brief Removes the given page from the pages of its size class, that have free slots.
+    /// @param page The page to remove.
+    auto unlink(Page * page) noexcept -> void;
+
+    /// @brief The pages of each size class, that have free slots.
+    std::array<Page *, SIZE_CLASSES> m_availablePages{};
+
+    /// @brief The empty pages, that are still backed by memory, the pages, that were emptied last, are at the back.
+    std::vector<Page *> m_cachedPages;
+
+    /// @brief The amount of cached pages at the front, that were cached before the arena was trimmed the last time.
+    size_t m_agedPages = 0;
+
+    /// @brief The pages, that are not backed by memory and can be used by any size class.
+    std::vector<Page *> m_emptyPages;
+
+    /// @brief The chunks, that were mapped from the operating system, and the address, that was mapped for them.
+    std::vector<std::pair<void *, void *>> m_chunks;
+
+    /// @brief The amount of pages, that hold slots of a size class.
+    size_t m_usedPages = 0;
+
+    /// @brief Whether the chunks are backed by huge pages.
+    bool m_hugePages;
+};
+} // namespace cppLox
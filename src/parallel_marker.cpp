@@ -0,0 +1,156 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file parallel_marker.cpp
+ * @brief This file contains the implementation of the parallel marker.
+ */
+
+#include "parallel_marker.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+
+#include "types/object_function.hpp"
+
+using namespace cppLox;
+
+ParallelMarker::ParallelMarker(size_t threads) {
+    for (size_t worker = 0; worker < std::max<size_t>(threads, 1); worker++) {
+        m_deques.push_back(std::make_unique<WorkStealingDeque<cppLox::Types::Object *>>());
+    }
+    for (size_t worker = 1; worker < m_deques.size(); worker++) {
+        m_threads.emplace_back(&ParallelMarker::run, this, worker);
+    }
+}
+
+ParallelMarker::~ParallelMarker() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_started.notify_all();
+    for (std::thread & thread : m_threads) {
+        thread.join();
+    }
+}
+
+auto ParallelMarker::mark(std::vector<cppLox::Types::Object *> const & roots, uint32_t cycle) -> void {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_roots = &roots;
+        m_cycle = cycle;
+        m_idleThreads.store(0, std::memory_order_relaxed);
+        m_finishedThreads = 0;
+        m_markings++;
+    }
+    m_started.notify_all();
+    work(0);
+    // The marks of the other threads are visible to the collecting thread, once they reported back under the lock
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this] { return m_finishedThreads == m_threads.size(); });
+    m_roots = nullptr;
+}
+
+auto ParallelMarker::run(size_t worker) -> void {
+    uint64_t markings = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_started.wait(lock, [this, markings] { return m_stopping || m_markings != markings; });
+            if (m_stopping) {
+                return;
+            }
+            markings = m_markings;
+        }
+        work(worker);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_finishedThreads++;
+        }
+        m_finished.notify_one();
+    }
+}
+
+auto ParallelMarker::work(size_t worker) -> void {
+    WorkStealingDeque<cppLox::Types::Object *> & deque = *m_deques[worker];
+    size_t const slice = (m_roots->size() + m_deques.size() - 1) / m_deques.size();
+    for (size_t index = worker * slice; index < std::min(m_roots->size(), (worker + 1) * slice); index++) {
+        markObject((*m_roots)[index], deque);
+    }
+    while (true) {
+        while (std::optional<cppLox::Types::Object *> function = deque.pop()) {
+            trace(*function, deque);
+        }
+        if (std::optional<cppLox::Types::Object *> function = steal(worker)) {
+            trace(*function, deque);
+            continue;
+        }
+        // An idle thread holds no work and its deque stays empty, so all threads being idle means the marking finished
+        m_idleThreads.fetch_add(1, std::memory_order_acq_rel);
+        while (m_idleThreads.load(std::memory_order_acquire) < m_deques.size()) {
+            bool workLeft = false;
+            for (std::unique_ptr<WorkStealingDeque<cppLox::Types::Object *>> const & other : m_deques) {
+                workLeft = workLeft || !other->empty();
+            }
+            if (workLeft) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if (m_idleThreads.load(std::memory_order_acquire) == m_deques.size()) {
+            return;
+        }
+        m_idleThreads.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+auto ParallelMarker::markObject(cppLox::Types::Object * object, WorkStealingDeque<cppLox::Types::Object *> & deque)
+    -> void {
+    if (object == nullptr || !object->markConcurrently(m_cycle)) {
+        return;
+    }
+    // Strings and native functions do not reference other objects, so there is nothing left to trace
+    if (object->is(cppLox::Types::Object::Type::FUNCTION)) {
+        deque.push(object);
+    }
+}
+
+auto ParallelMarker::trace(cppLox::Types::Object * object, WorkStealingDeque<cppLox::Types::Object *> & deque)
+    -> void {
+    cppLox::Types::ObjectFunction * function = object->as<cppLox::Types::ObjectFunction>();
+    markObject(function->name(), deque);
+    for (cppLox::ByteCode::Chunk * chunk : {function->chunk(), function->registerChunk()}) {
+        if (chunk == nullptr) {
+            continue;
+        }
+        for (size_t index = 0; index < chunk->getConstantCount(); index++) {
+            cppLox::Types::Value const & constant = chunk->getConstant(index);
+            if (constant.is(cppLox::Types::Value::Type::OBJECT)) {
+                markObject(constant.as<cppLox::Types::Object *>(), deque);
+            }
+        }
+    }
+}
+
+auto ParallelMarker::steal(size_t worker) -> std::optional<cppLox::Types::Object *> {
+    // The victims are tried in turn, starting after the thief, so the threads do not all rob the same thread
+    for (size_t offset = 1; offset < m_deques.size(); offset++) {
+        if (std::optional<cppLox::Types::Object *> work = m_deques[(worker + offset) % m_deques.size()]->steal()) {
+            return work;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,127 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file parallel_marker.hpp
+ * @brief This file contains the parallel marker, that traces the old generation using a pool of threads.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "types/object.hpp"
+
+#include "work_stealing_deque.hpp"
+
+namespace cppLox {
+
+/// @brief Marks the objects, that are reachable from a root set, using a pool of threads.
+/// @details The root set is split into a slice per thread. Every thread marks the objects of its slice and traces the
+/// functions it marked using its own work-stealing deque. A thread, that runs out of work, steals the oldest work of
+/// the other threads. Marking an object is an atomic exchange of its mark, so every function is traced by a single
+/// thread. The marking is finished, once all threads are idle at the same time, because the work is only pushed into
+/// the deque of a thread, that is not idle. The collecting thread takes part in the marking, so a marker with a single
+/// thread starts no other threads.
+class ParallelMarker {
+  public:
+    /// @brief Creates a new parallel marker and starts its threads.
+    /// @param threads The amount of threads, that mark, including the collecting thread.
+    explicit ParallelMarker(size_t threads);
+
+    /// @brief Stops the threads of the parallel marker.
+    ~ParallelMarker();
+
+    ParallelMarker(ParallelMarker const &) = delete;
+    auto operator=(ParallelMarker const &) -> ParallelMarker & = delete;
+
+    /// @brief Marks the given roots and every object they reference in the given cycle.
+    /// @details Returns after all the threads finished marking.
+    /// @param roots The root set, that may contain duplicates and objects that are marked already.
+    /// @param cycle The garbage collection cycle, the objects are marked with.
+    auto mark(std::vector<cppLox::Types::Object *> const & roots, uint32_t cycle) -> void;
+
+    /// @brief Gets the amount of threads, that mark, including the collecting thread.
+    /// @return The amount of threads.
+    [[nodiscard]] auto threads() const noexcept -> size_t {
+        return m_deques.size();
+    }
+
+  private:
+    /// @brief The loop of a thread of the pool, that waits for a marking to join.
+    /// @param worker The index of the thread.
+    auto run(size_t worker) -> void;
+
+    /// @brief Marks the slice of the roots of the given thread and traces the objects until all threads are idle.
+    /// @param worker The index of the thread.
+    auto work(size_t worker) -> void;
+
+    /// @brief Marks the given object and pushes it into the deque of the thread, if it has references to trace.
+    /// @param object The object to mark, nullptr is ignored.
+    /// @param deque The deque of the thread.
+    auto markObject(cppLox::Types::Object * object, WorkStealingDeque<cppLox::Types::Object *> & deque) -> void;
+
+    /// @brief Marks the objects, that are referenced by the given function.
+    /// @param function The marked function.
+    /// @param deque The deque of the thread.
+    auto trace(cppLox::Types::Object * function, WorkStealingDeque<cppLox::Types::Object *> & deque) -> void;
+
+    /// @brief Steals work from the other threads.
+    /// @param worker The index of the thread, that steals.
+    /// @return The stolen work or nothing, if no work was found.
+    auto steal(size_t worker) -> std::optional<cppLox::Types::Object *>;
+
+    /// @brief The deques of the threads, indexed by the thread.
+    std::vector<std::unique_ptr<WorkStealingDeque<cppLox::Types::Object *>>> m_deques;
+
+    /// @brief The threads of the pool, the collecting thread is not part of it.
+    std::vector<std::thread> m_threads;
+
+    /// @brief Guards the start and the end of a marking.
+    std::mutex m_mutex;
+
+    /// @brief Notifies the threads of the pool, that a marking started or that they are stopped.
+    std::condition_variable m_started;
+
+    /// @brief Notifies the collecting thread, that the threads of the pool finished the marking.
+    std::condition_variable m_finished;
+
+    /// @brief The amount of markings, that were started.
+    uint64_t m_markings = 0;
+
+    /// @brief The amount of threads of the pool, that finished the current marking.
+    size_t m_finishedThreads = 0;
+
+    /// @brief Whether the threads of the pool are stopped.
+    bool m_stopping = false;
+
+    /// @brief The roots of the current marking.
+    std::vector<cppLox::Types::Object *> const * m_roots = nullptr;
+
+    /// @brief The cycle of the current marking.
+    uint32_t m_cycle = 0;
+
+    /// @brief The amount of threads, that are out of work.
+    std::atomic<size_t> m_idleThreads = 0;
+};
+} // namespace cppLox
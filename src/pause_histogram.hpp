@@ -0,0 +1,112 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file pause_histogram.hpp
+ * @brief This file contains the histogram of the pause times of the garbage collector.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iostream>
+
+namespace cppLox {
+
+/// @brief A histogram of the pause times of the garbage collector.
+/// @details The first bucket counts the pauses below one microsecond, every other bucket the pauses from its lower
+/// bound up to twice its lower bound. The last bucket counts all the longer pauses as well.
+class PauseHistogram {
+  public:
+    /// @brief The amount of buckets of the histogram.
+    static constexpr size_t BUCKETS = 24;
+
+    /// @brief Records a pause of the given duration.
+    /// @param pause The duration of the pause.
+    auto record(std::chrono::nanoseconds pause) noexcept -> void {
+        auto const microseconds =
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(pause).count());
+        m_buckets[std::min<size_t>(std::bit_width(microseconds), BUCKETS - 1)]++;
+        m_count++;
+        m_total += pause;
+        m_longest = std::max(m_longest, pause);
+    }
+
+    /// @brief Gets the amount of pauses in the given bucket.
+    /// @param bucket The index of the bucket.
+    /// @return The amount of pauses.
+    [[nodiscard]] auto bucket(size_t bucket) const noexcept -> uint64_t {
+        return m_buckets[bucket];
+    }
+
+    /// @brief Gets the lower bound of the pauses, that are counted in the given bucket.
+    /// @param bucket The index of the bucket.
+    /// @return The lower bound of the bucket.
+    [[nodiscard]] static auto lowerBound(size_t bucket) noexcept -> std::chrono::microseconds {
+        return bucket == 0 ? std::chrono::microseconds(0) : std::chrono::microseconds(uint64_t{1} << (bucket - 1));
+    }
+
+    /// @brief Gets the amount of recorded pauses.
+    /// @return The amount of pauses.
+    [[nodiscard]] auto count() const noexcept -> uint64_t {
+        return m_count;
+    }
+
+    /// @brief Gets the sum of all recorded pauses.
+    /// @return The total duration of the pauses.
+    [[nodiscard]] auto total() const noexcept -> std::chrono::nanoseconds {
+        return m_total;
+    }
+
+    /// @brief Gets the longest recorded pause.
+    /// @return The duration of the longest pause.
+    [[nodiscard]] auto longest() const noexcept -> std::chrono::nanoseconds {
+        return m_longest;
+    }
+
+    /// @brief Prints the buckets, that counted at least one pause, to the given output stream
+    /// @param os The output stream to print to
+    /// @param histogram The histogram to print
+    /// @return The output stream
+    friend auto operator<<(std::ostream & os, PauseHistogram const & histogram) -> std::ostream & {
+        for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+            if (histogram.m_buckets[bucket] != 0) {
+                os << std::format(">= {:>8} us: {}", lowerBound(bucket).count(), histogram.m_buckets[bucket])
+                   << std::endl;
+            }
+        }
+        return os;
+    }
+
+  private:
+    /// @brief The amount of pauses per bucket.
+    std::array<uint64_t, BUCKETS> m_buckets{};
+
+    /// @brief The amount of recorded pauses.
+    uint64_t m_count = 0;
+
+    /// @brief The sum of all recorded pauses.
+    std::chrono::nanoseconds m_total{0};
+
+    /// @brief The longest recorded pause.
+    std::chrono::nanoseconds m_longest{0};
+};
+} // namespace cppLox
@@ -20,6 +20,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <type_traits>
 
@@ -80,10 +83,49 @@ class Object {
     /// @param os The output stream to write to
     virtual void writeToOutputStream(std::ostream & os) const = 0;
 
+    /// @brief Gets the amount of memory that is used by the object, including the memory it owns.
+    /// @return The size of the object in bytes.
+    [[nodiscard]] virtual auto size() const noexcept -> size_t = 0;
+
+    /// @brief Marks the object as reachable in the given garbage collection cycle.
+    /// @param cycle The garbage collection cycle.
+    /// @return True if the object was not marked in the cycle before, false otherwise.
+    auto mark(uint32_t cycle) noexcept -> bool {
+        if (m_markedCycle == cycle) {
+            return false;
+        }
+        m_markedCycle = cycle;
+        return true;
+    }
+
+    /// @brief Marks the object as reachable in the given garbage collection cycle, while other threads mark as well.
+    /// @param cycle The garbage collection cycle.
+    /// @return True if the object was not marked in the cycle before, by this or another thread, false otherwise.
+    auto markConcurrently(uint32_t cycle) noexcept -> bool {
+        std::atomic_ref<uint32_t> markedCycle(m_markedCycle);
+        // Most references lead to objects, that are marked already, which is checked without writing the cache line
+        if (markedCycle.load(std::memory_order_relaxed) == cycle) {
+            return false;
+        }
+        return markedCycle.exchange(cycle, std::memory_order_relaxed) != cycle;
+    }
+
+    /// @brief Checks if the object was marked as reachable in the given garbage collection cycle.
+    /// @param cycle The garbage collection cycle.
+    /// @return True if the object is reachable, false otherwise.
+    [[nodiscard]] auto isMarked(uint32_t cycle) const noexcept -> bool {
+        return m_markedCycle == cycle;
+    }
+
   protected:
     /// @brief The type of the object.
     Type m_type;
 
+    /// @brief The last garbage collection cycle, in which the object was reachable.
+    /// @details Storing the cycle instead of a flag means, that the marks never have to be cleared. This matters for
+    /// objects, that are not allocated by the memory mutator and are therefore never swept.
+    uint32_t m_markedCycle = 0;
+
     /// @brief Constructs a new object.
     Object() = default;
 };
@@ -22,7 +22,20 @@
 
 using namespace cppLox::Types;
 
-ObjectFunction::ObjectFunction(uint16_t arity, ObjectString * name) : m_arity(arity), m_name(name) {
+/// @brief Gets the amount of memory that is used by the given chunk
+/// @param chunk The chunk
+/// @return The size of the chunk in bytes
+static auto chunkSize(cppLox::ByteCode::Chunk const & chunk) -> size_t {
+    // Every run of the line table holds the offset it starts at and its line
+    return sizeof(cppLox::ByteCode::Chunk) + chunk.getSize() * sizeof(uint8_t) +
+           chunk.getLineRunCount() * (sizeof(uint32_t) + sizeof(int)) + chunk.getConstantCount() * sizeof(Value);
+}
+
+ObjectFunction::ObjectFunction(uint16_t arity, ObjectString * name)
+    : m_arity(arity), m_name(name), m_maxStackDepth(1) {
+#ifdef JIT
+    m_invocations = 0;
+#endif
     m_type = Object::Type::FUNCTION;
     m_chunk = std::make_unique<cppLox::ByteCode::Chunk>();
 }
@@ -30,7 +43,16 @@ ObjectFunction::ObjectFunction(uint16_t arity, ObjectString * name) : m_arity(ar
 auto ObjectFunction::operator=(ObjectFunction const & other) -> ObjectFunction & {
     m_arity = other.m_arity;
     m_chunk = std::make_unique<cppLox::ByteCode::Chunk>(*other.m_chunk);
+    m_registerChunk = other.m_registerChunk != nullptr
+                          ? std::make_unique<cppLox::ByteCode::Chunk>(*other.m_registerChunk)
+                          : nullptr;
     m_name = other.m_name;
+    m_maxStackDepth = other.m_maxStackDepth;
+#ifdef JIT
+    // The native code refers to the chunk of the other function, so the copy starts out interpreted
+    m_invocations = 0;
+    m_nativeCode = nullptr;
+#endif
     return *this;
 };
 
@@ -42,10 +64,39 @@ auto ObjectFunction::operator=(ObjectFunction const & other) -> ObjectFunction &
     return m_chunk.get();
 }
 
+[[nodiscard]] auto ObjectFunction::registerChunk() -> cppLox::ByteCode::Chunk * {
+    return m_registerChunk.get();
+}
+
+auto ObjectFunction::setRegisterChunk(std::unique_ptr<cppLox::ByteCode::Chunk> chunk) -> void {
+    m_registerChunk = std::move(chunk);
+}
+
 [[nodiscard]] auto ObjectFunction::name() const -> ObjectString * {
     return m_name;
 }
 
+[[nodiscard]] auto ObjectFunction::size() const noexcept -> size_t {
+    size_t const registerChunkSize = m_registerChunk != nullptr ? chunkSize(*m_registerChunk) : 0;
+    return sizeof(ObjectFunction) + chunkSize(*m_chunk) + registerChunkSize;
+}
+
 auto ObjectFunction::incrementArity() -> void {
     m_arity++;
-}
\ No newline at end of file
+}
+
+[[nodiscard]] auto ObjectFunction::maxStackDepth() const noexcept -> uint32_t {
+    return m_maxStackDepth;
+}
+
+auto ObjectFunction::updateMaxStackDepth(uint32_t depth) noexcept -> void {
+    if (depth > m_maxStackDepth) {
+        m_maxStackDepth = depth;
+    }
+}
+
+#ifdef JIT
+auto ObjectFunction::setNativeCode(std::unique_ptr<cppLox::Backend::NativeCode> nativeCode) -> void {
+    m_nativeCode = std::move(nativeCode);
+}
+#endif
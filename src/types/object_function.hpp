@@ -23,6 +23,9 @@
 #include <memory>
 
 #include "../bytecode/chunk.hpp"
+#ifdef JIT
+#include "../backend/native_code.hpp"
+#endif
 #include "object.hpp"
 #include "object_string.hpp"
 
@@ -50,6 +53,14 @@ class ObjectFunction : public Object {
     /// @return The chunk of the function.
     [[nodiscard]] auto chunk() -> cppLox::ByteCode::Chunk *;
 
+    /// @brief Gets the register based bytecode of the function.
+    /// @return The register based bytecode of the function or nullptr if the function was compiled for the stack tier.
+    [[nodiscard]] auto registerChunk() -> cppLox::ByteCode::Chunk *;
+
+    /// @brief Sets the register based bytecode of the function.
+    /// @param chunk The register based bytecode of the function.
+    auto setRegisterChunk(std::unique_ptr<cppLox::ByteCode::Chunk> chunk) -> void;
+
     /// @brief Gets the name of the function.
     /// @return The name of the function.
     [[nodiscard]] auto name() const -> ObjectString *;
@@ -60,9 +71,39 @@ class ObjectFunction : public Object {
         os << (m_name != nullptr ? "<fn " + m_name->string() + ">" : "<script>");
     }
 
+    /// @brief Gets the amount of memory that is used by the function and its bytecode.
+    /// @return The size of the function in bytes.
+    [[nodiscard]] auto size() const noexcept -> size_t override;
+
     /// @brief Increments the arity of the function.
     auto incrementArity() -> void;
 
+    /// @brief Gets the maximum amount of stack slots that are used by a call of the function.
+    /// @return The maximum amount of stack slots, including the slot of the function itself.
+    [[nodiscard]] auto maxStackDepth() const noexcept -> uint32_t;
+
+    /// @brief Raises the maximum stack depth of the function to the given depth, if it is larger.
+    /// @param depth The stack depth that is reached by the function.
+    auto updateMaxStackDepth(uint32_t depth) noexcept -> void;
+
+#ifdef JIT
+    /// @brief Counts a call of the function, that is executed by the interpreter.
+    /// @return The amount of counted calls, including this one.
+    auto countInvocation() noexcept -> uint32_t {
+        return ++m_invocations;
+    }
+
+    /// @brief Gets the native code of the function.
+    /// @return The native code of the function or nullptr if the function was not compiled by the jit compiler.
+    [[nodiscard]] auto nativeCode() const noexcept -> cppLox::Backend::NativeCode * {
+        return m_nativeCode.get();
+    }
+
+    /// @brief Sets the native code of the function.
+    /// @param nativeCode The native code of the function.
+    auto setNativeCode(std::unique_ptr<cppLox::Backend::NativeCode> nativeCode) -> void;
+#endif
+
   private:
     /// @brief The arity of the function.
     uint16_t m_arity;
@@ -70,8 +111,22 @@ class ObjectFunction : public Object {
     /// @brief The chunk of the function.
     std::unique_ptr<cppLox::ByteCode::Chunk> m_chunk;
 
+    /// @brief The register based bytecode of the function, if it was compiled for the register tier.
+    std::unique_ptr<cppLox::ByteCode::Chunk> m_registerChunk;
+
     /// @brief The name of the function.
     ObjectString * m_name;
+
+    /// @brief The maximum amount of stack slots that are used by a call of the function.
+    uint32_t m_maxStackDepth;
+
+#ifdef JIT
+    /// @brief The amount of calls of the function, that were executed by the interpreter.
+    uint32_t m_invocations;
+
+    /// @brief The native code of the function, if it was compiled by the jit compiler.
+    std::unique_ptr<cppLox::Backend::NativeCode> m_nativeCode;
+#endif
 };
 
 } // namespace cppLox::Types
\ No newline at end of file
@@ -23,6 +23,7 @@
 #include <cstdint>
 #include <functional>
 #include <optional>
+#include <span>
 
 #include "../backend/callframe.hpp"
 #include "object.hpp"
@@ -30,12 +31,33 @@
 
 namespace cppLox::Types {
 
+/// @brief The result of a native function.
+struct NativeResult {
+    /// @brief The value returned by the function.
+    Value value;
+
+    /// @brief The message of the runtime error raised by the function or nullptr if the call succeeded.
+    char const * error = nullptr;
+};
+
+/// @brief A native function, that receives its arguments as a view into the stack of the virtual machine.
+/// @details The function is called directly and reports a runtime error through its result, so calling it neither
+/// allocates nor goes through a type erased wrapper.
+using NativeFunction = auto (*)(std::span<Value> args) -> NativeResult;
+
 /// @brief The Object Native Function class.
 class ObjectNativeFunction : public Object {
   public:
     /// @brief Construct a new Object Native Function.
     /// @param function The function to call.
     /// @param arity The number of arguments the function takes.
+    ObjectNativeFunction(NativeFunction function, int16_t arity);
+
+    /// @brief Construct a new Object Native Function, that reports errors through a callback.
+    /// @details Calling the function is slower than calling a NativeFunction, because the function and the error
+    /// handler are wrapped in a std::function.
+    /// @param function The function to call.
+    /// @param arity The number of arguments the function takes.
     ObjectNativeFunction(
         std::function<Value(int, Value *, cppLox::Backend::CallFrame & frame,
                             std::function<void(cppLox::Backend::CallFrame & frame, std::string_view format)> onError)>
@@ -52,6 +74,20 @@ class ObjectNativeFunction : public Object {
         os << "<native fn>";
     }
 
+    /// @brief Gets the amount of memory that is used by the native function.
+    /// @return The size of the native function in bytes.
+    [[nodiscard]] auto size() const noexcept -> size_t override {
+        return sizeof(ObjectNativeFunction);
+    }
+
+    /// @brief Calls the underlying function.
+    /// @details Only valid if the function was constructed from a NativeFunction (see isDirect).
+    /// @param args The arguments passed to the function.
+    /// @return The result of the function call.
+    auto call(std::span<Value> args) const -> NativeResult {
+        return m_directFunction(args);
+    }
+
     /// @brief Calls the underlying function.
     /// @param argCount The number of arguments passed to the function.
     /// @param args The arguments passed to the function.
@@ -63,8 +99,18 @@ class ObjectNativeFunction : public Object {
 
     auto arity() const -> int16_t;
 
+    /// @brief Determines whether the function is called directly through a NativeFunction.
+    /// @return true if the function was constructed from a NativeFunction, false if it reports errors through a
+    /// callback.
+    [[nodiscard]] auto isDirect() const -> bool {
+        return m_directFunction != nullptr;
+    }
+
   private:
-    /// @brief The function to call.
+    /// @brief The function to call directly or nullptr if the function reports errors through a callback.
+    NativeFunction m_directFunction;
+
+    /// @brief The function to call, if it reports errors through a callback.
     std::function<Value(int, Value *, cppLox::Backend::CallFrame & frame,
                         std::function<void(cppLox::Backend::CallFrame & frame, std::string_view format)> onError)>
         m_function;
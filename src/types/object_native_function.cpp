@@ -22,12 +22,17 @@
 
 using namespace cppLox::Types;
 
+ObjectNativeFunction::ObjectNativeFunction(NativeFunction function, int16_t arity)
+    : m_directFunction(function), m_arity(arity) {
+    m_type = Object::Type::NATIVE_FUNCTION;
+}
+
 ObjectNativeFunction::ObjectNativeFunction(
     std::function<Value(int, Value *, cppLox::Backend::CallFrame & frame,
                         std::function<void(cppLox::Backend::CallFrame & frame, std::string_view format)> onError)>
         function,
     int16_t arity)
-    : m_function(function), m_arity(arity) {
+    : m_directFunction(nullptr), m_function(function), m_arity(arity) {
     m_type = Object::Type::NATIVE_FUNCTION;
 }
 
@@ -22,19 +22,26 @@
 
 using namespace cppLox::Types;
 
-ObjectString::ObjectString(std::string const & string) {
-    m_string = std::make_unique<std::string>(string);
+ObjectString::ObjectString(std::string const & string) : m_string(string) {
     m_type = Object::Type::STRING;
 }
 
 [[nodiscard]] auto ObjectString::string() const -> std::string const & {
-    return *m_string.get();
+    return m_string;
+}
+
+[[nodiscard]] auto ObjectString::size() const noexcept -> size_t {
+    // Short strings keep their characters inside the object
+    auto const characters = reinterpret_cast<std::byte const *>(m_string.data());
+    auto const object = reinterpret_cast<std::byte const *>(this);
+    bool const inlined = characters >= object && characters < object + sizeof(ObjectString);
+    return sizeof(ObjectString) + (inlined ? 0 : m_string.capacity() + 1);
 }
 
 auto ObjectString::operator==(ObjectString const & other) const -> bool {
-    return *m_string.get() == other.string();
+    return m_string == other.string();
 }
 
 auto ObjectString::operator==(ObjectString const * other) const -> bool {
-    return *m_string.get() == other->string();
+    return m_string == other->string();
 }
\ No newline at end of file
@@ -20,7 +20,7 @@
 
 #pragma once
 
-#include <memory>
+#include <cstddef>
 #include <string>
 
 #include "object.hpp"
@@ -34,6 +34,10 @@ class ObjectString : public Object {
     /// @param value The value of the string object.
     ObjectString(std::string const & string);
 
+    /// @brief Moves the string object, that is moved out of the nursery by the garbage collector.
+    /// @param other The string object to move.
+    ObjectString(ObjectString && other) noexcept = default;
+
     /// @brief Destructor of the string object
     ~ObjectString() override = default;
 
@@ -55,12 +59,16 @@ class ObjectString : public Object {
     /// @param os The output stream to write to.
     /// @return The output stream.
     virtual auto writeToOutputStream(std::ostream & os) const -> void override {
-        os << *m_string.get();
+        os << m_string;
     }
 
+    /// @brief Gets the amount of memory that is used by the string object and its characters.
+    /// @return The size of the string object in bytes.
+    [[nodiscard]] auto size() const noexcept -> size_t override;
+
   private:
-    /// @brief The value of the underlying string.
-    std::unique_ptr<std::string> m_string;
+    /// @brief The value of the underlying string, that is stored inline, so a string is allocated at once.
+    std::string m_string;
 };
 
 } // namespace cppLox::Types
\ No newline at end of file
@@ -26,18 +26,41 @@
 
 using namespace cppLox::Types;
 
+#ifdef NAN_BOXING
+
 Value::Value() {
-    this->m_type = Value::Type::NULL_;
+    this->m_bits = NULL_BITS;
+}
+
+Value::Value(Object * value) {
+    this->m_bits = SIGN_BIT | QUIET_NAN | static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+}
+
+[[nodiscard]] auto Value::getType() const -> Value::Type {
+    if ((this->m_bits & QUIET_NAN) != QUIET_NAN) {
+        return Value::Type::NUMBER;
+    }
+    if ((this->m_bits & (SIGN_BIT | QUIET_NAN)) == (SIGN_BIT | QUIET_NAN)) {
+        return Value::Type::OBJECT;
+    }
+    if (this->m_bits == NULL_BITS) {
+        return Value::Type::NULL_;
+    }
+    return Value::Type::BOOL;
 }
 
-Value::Value(bool value) {
-    this->m_type = Value::Type::BOOL;
-    this->m_underlying_value.m_bool = value;
+[[nodiscard]] auto Value::operator==(Value const & other) const -> bool {
+    // NaN never equals itself, so numbers have to be compared as doubles
+    if (this->getType() == Value::Type::NUMBER && other.getType() == Value::Type::NUMBER) {
+        return this->as<double>() == other.as<double>();
+    }
+    return this->m_bits == other.m_bits;
 }
 
-Value::Value(double value) {
-    this->m_type = Value::Type::NUMBER;
-    this->m_underlying_value.m_number = value;
+#else
+
+Value::Value() {
+    this->m_type = Value::Type::NULL_;
 }
 
 Value::Value(Object * value) {
@@ -45,10 +68,6 @@ Value::Value(Object * value) {
     this->m_underlying_value.m_object = value;
 }
 
-[[nodiscard]] auto Value::is(Value::Type type) noexcept -> bool {
-    return type == this->m_type;
-}
-
 [[nodiscard]] auto Value::getType() const -> Value::Type {
     return this->m_type;
 }
@@ -70,82 +89,79 @@ Value::Value(Object * value) {
     return false;
 }
 
+#endif
+
+[[nodiscard]] auto Value::is(Value::Type type) const noexcept -> bool {
+    return type == this->getType();
+}
+
 [[nodiscard]] auto Value::operator!=(Value const & other) const -> bool {
     return !(*this == other);
 }
 
 [[nodiscard]] auto Value::operator-() const -> Value {
-    if (this->m_type != Value::Type::NUMBER) {
+    if (this->getType() != Value::Type::NUMBER) {
         throw cppLox::Error::RunTimeException("Runtime error: unary negation is only defined for numbers");
     }
-    return Value(-this->m_underlying_value.m_number);
+    return Value(-this->as<double>());
 }
 
 [[nodiscard]] auto Value::operator!() const -> Value {
-    if (this->m_type == Value::Type::BOOL) {
-        return Value(!this->m_underlying_value.m_bool);
-    } else if (this->m_type == Value::Type::NUMBER) {
-        return Value(!this->m_underlying_value.m_number);
-    } else if (this->m_type == Value::Type::OBJECT) {
-        // Objects are not nullable so invert to false
-        return Value(false);
-    }
-    // Null values are falsy so invert to true
-    return Value(true);
+    return Value(this->isFalsey());
 }
 
 [[nodiscard]] auto Value::operator+(Value const & other) const -> Value {
-    if (this->m_type != Value::Type::NUMBER || other.m_type != Value::Type::NUMBER) {
+    if (this->getType() != Value::Type::NUMBER || other.getType() != Value::Type::NUMBER) {
         throw cppLox::Error::RunTimeException("addition is only defined for numbers");
     }
-    return Value(this->m_underlying_value.m_number + other.m_underlying_value.m_number);
+    return Value(this->as<double>() + other.as<double>());
 }
 
 [[nodiscard]] auto Value::operator-(Value const & other) const -> Value {
-    if (this->m_type != Value::Type::NUMBER || other.m_type != Value::Type::NUMBER) {
+    if (this->getType() != Value::Type::NUMBER || other.getType() != Value::Type::NUMBER) {
         throw cppLox::Error::RunTimeException("subtraction is only defined for numbers");
     }
-    return Value(this->m_underlying_value.m_number - other.m_underlying_value.m_number);
+    return Value(this->as<double>() - other.as<double>());
 }
 
 [[nodiscard]] auto Value::operator*(Value const & other) const -> Value {
-    if (this->m_type != Value::Type::NUMBER || other.m_type != Value::Type::NUMBER) {
+    if (this->getType() != Value::Type::NUMBER || other.getType() != Value::Type::NUMBER) {
         throw cppLox::Error::RunTimeException("multiplication is only defined for numbers");
     }
-    return Value(this->m_underlying_value.m_number * other.m_underlying_value.m_number);
+    return Value(this->as<double>() * other.as<double>());
 }
 
 [[nodiscard]] auto Value::operator/(Value const & other) const -> Value {
-    if (this->m_type != Value::Type::NUMBER || other.m_type != Value::Type::NUMBER) {
+    if (this->getType() != Value::Type::NUMBER || other.getType() != Value::Type::NUMBER) {
         throw cppLox::Error::RunTimeException("division is only defined for numbers");
     }
-    return Value(this->m_underlying_value.m_number / other.m_underlying_value.m_number);
+    return Value(this->as<double>() / other.as<double>());
 }
 
 [[nodiscard]] auto Value::operator<(Value const & other) const -> Value {
-    if (this->m_type != Value::Type::NUMBER || other.m_type != Value::Type::NUMBER) {
+    if (this->getType() != Value::Type::NUMBER || other.getType() != Value::Type::NUMBER) {
         throw cppLox::Error::RunTimeException("less than is only defined for numbers");
     }
-    return Value(this->m_underlying_value.m_number < other.m_underlying_value.m_number);
+    return Value(this->as<double>() < other.as<double>());
 }
 
 [[nodiscard]] auto Value::operator<=(Value const & other) const -> Value {
-    if (this->m_type != Value::Type::NUMBER || other.m_type != Value::Type::NUMBER) {
+    if (this->getType() != Value::Type::NUMBER || other.getType() != Value::Type::NUMBER) {
         throw cppLox::Error::RunTimeException("less than is only defined for numbers");
     }
-    return Value(this->m_underlying_value.m_number <= other.m_underlying_value.m_number);
+    return Value(this->as<double>() <= other.as<double>());
 }
 
 [[nodiscard]] auto Value::operator>(Value const & other) const -> Value {
-    if (this->m_type != Value::Type::NUMBER || other.m_type != Value::Type::NUMBER) {
+    if (this->getType() != Value::Type::NUMBER || other.getType() != Value::Type::NUMBER) {
         throw cppLox::Error::RunTimeException("less than is only defined for numbers");
     }
-    return Value(this->m_underlying_value.m_number > other.m_underlying_value.m_number);
+    return Value(this->as<double>() > other.as<double>());
 }
 
 [[nodiscard]] auto Value::operator>=(Value const & other) const -> Value {
-    if (this->m_type != Value::Type::NUMBER || other.m_type != Value::Type::NUMBER) {
+    if (this->getType() != Value::Type::NUMBER || other.getType() != Value::Type::NUMBER) {
         throw cppLox::Error::RunTimeException("less than is only defined for numbers");
     }
-    return Value(this->m_underlying_value.m_number >= other.m_underlying_value.m_number);
+    return Value(this->as<double>() >= other.as<double>());
 }
@@ -20,19 +20,36 @@
 
 #pragma once
 
+#include <bit>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <type_traits>
 
 #include "object.hpp"
 
+#ifdef JIT
+namespace cppLox::Backend {
+// forward declaration of the helpers of the jit compiler
+class JitRuntime;
+} // namespace cppLox::Backend
+#endif
+
 namespace cppLox::Types {
 
 template <typename T>
 concept IsAnUnderLyingValueType = std::is_same_v<T, bool> || std::is_same_v<T, double> || std::is_same_v<T, Object *>;
 
 /// @brief A value that can be stored in a variable or on the stack
+/// @details If NAN_BOXING is defined, the value is packed into a single 64-bit word. Numbers are stored as doubles,
+/// all other values are encoded in the unused bits of a quiet NaN. Otherwise the value is a tagged union.
 class Value {
+#ifdef JIT
+    // The native code of the jit compiler reads and writes the values in place
+    friend class cppLox::Backend::JitRuntime;
+#endif
+
   public:
     /// @brief The possible types of a value
     enum class Type {
@@ -50,10 +67,30 @@ class Value {
     Value();
 
     /// @brief Construct a new Value object with type VAL_BOOL
-    Value(bool value);
+    /// @details Defined in the header like the number constructor, so that the results of the quickened instructions
+    /// can be constructed inline
+    Value(bool value) {
+#ifdef NAN_BOXING
+        m_bits = value ? TRUE_BITS : FALSE_BITS;
+#else
+        m_type = Type::BOOL;
+        m_underlying_value.m_bool = value;
+#endif
+    }
 
     /// @brief Construct a new Value object with type VAL_NUMBER
-    Value(double value);
+    Value(double value) {
+#ifdef NAN_BOXING
+        // Every NaN is stored as the canonical quiet NaN, so its payload can not be mistaken for a tagged value. The
+        // sign is kept, so a NaN is printed like in the other value layout
+        m_bits = value != value ? std::bit_cast<uint64_t>(std::numeric_limits<double>::quiet_NaN()) |
+                                      (std::bit_cast<uint64_t>(value) & SIGN_BIT)
+                                : std::bit_cast<uint64_t>(value);
+#else
+        m_type = Type::NUMBER;
+        m_underlying_value.m_number = value;
+#endif
+    }
 
     /// @brief Construct a new Value object with type VAL_OBJECT
     Value(Object * value);
@@ -68,12 +105,43 @@ class Value {
     /// @brief Checks if the value is of the given type
     /// @param type The type to check against
     /// @return true if the value is of the given type, false otherwise
-    [[nodiscard]] auto is(Type type) noexcept -> bool;
+    [[nodiscard]] auto is(Type type) const noexcept -> bool;
+
+    /// @brief Checks if the value is a number
+    /// @details Defined in the header, so that the type guards of the quickened instructions can be inlined
+    /// @return true if the value is a number, false otherwise
+    [[nodiscard]] auto isNumber() const noexcept -> bool {
+#ifdef NAN_BOXING
+        return (m_bits & QUIET_NAN) != QUIET_NAN;
+#else
+        return m_type == Type::NUMBER;
+#endif
+    }
+
+    /// @brief Checks if the value is falsey - like in lox only null and false are, every number and object is truthy
+    /// @details Defined in the header, so that the conditional jumps can inline it
+    /// @return true if the value is null or false, false otherwise
+    [[nodiscard]] auto isFalsey() const noexcept -> bool {
+#ifdef NAN_BOXING
+        return m_bits == NULL_BITS || m_bits == FALSE_BITS;
+#else
+        return m_type == Type::NULL_ || (m_type == Type::BOOL && !m_underlying_value.m_bool);
+#endif
+    }
 
     /// @brief Gets the underlying value as the given type
     /// @tparam T The type to get the underlying value as
     /// @return The underlying value as the given type
-    template <IsAnUnderLyingValueType T> [[nodiscard]] auto as() const -> T const & {
+    template <IsAnUnderLyingValueType T> [[nodiscard]] auto as() const -> T {
+#ifdef NAN_BOXING
+        if constexpr (std::is_same_v<T, bool>) {
+            return m_bits == TRUE_BITS;
+        } else if constexpr (std::is_same_v<T, double>) {
+            return std::bit_cast<double>(m_bits);
+        } else if constexpr (std::is_same_v<T, Object *>) {
+            return reinterpret_cast<Object *>(static_cast<uintptr_t>(m_bits & ~(SIGN_BIT | QUIET_NAN)));
+        } else {
+#else
         if constexpr (std::is_same_v<T, bool>) {
             return m_underlying_value.m_bool;
         } else if constexpr (std::is_same_v<T, double>) {
@@ -81,6 +149,7 @@ class Value {
         } else if constexpr (std::is_same_v<T, Object *>) {
             return m_underlying_value.m_object;
         } else {
+#endif
             throw std::runtime_error("Type not supported");
         }
     }
@@ -90,21 +159,21 @@ class Value {
     /// @param dt The value to print
     /// @return The output stream
     friend auto operator<<(std::ostream & os, Value const & value) -> std::ostream & {
-        switch (value.m_type) {
+        switch (value.getType()) {
         case Value::Type::BOOL:
-            return os << (value.m_underlying_value.m_bool ? "true" : "false");
+            return os << (value.as<bool>() ? "true" : "false");
         case Value::Type::NULL_:
             return os << "null";
         case Value::Type::NUMBER:
             {
                 // Remove trailing zeros and decimal point if there are no fractional digits
-                std::string str = std::to_string(value.m_underlying_value.m_number);
+                std::string str = std::to_string(value.as<double>());
                 str.erase(str.find_last_not_of('0') + 1, std::string::npos);
                 str.erase(str.find_last_not_of('.') + 1, std::string::npos);
                 return os << str;
             }
         case Value::Type::OBJECT:
-            return os << value.m_underlying_value.m_object;
+            return os << value.as<Object *>();
         }
         // should be be unreachable
         return os << "undefined";
@@ -169,6 +238,27 @@ class Value {
     [[nodiscard]] auto operator!() const -> Value;
 
   private:
+#ifdef NAN_BOXING
+    static_assert(sizeof(Object *) <= sizeof(uint64_t), "NaN boxing requires pointers with at most 64 bits");
+
+    /// @brief The bits that are set in every quiet NaN, that does not encode a number
+    static constexpr uint64_t QUIET_NAN = 0x7ffc000000000000;
+
+    /// @brief The sign bit, that marks an object pointer
+    static constexpr uint64_t SIGN_BIT = 0x8000000000000000;
+
+    /// @brief The encoding of null
+    static constexpr uint64_t NULL_BITS = QUIET_NAN | 1;
+
+    /// @brief The encoding of false
+    static constexpr uint64_t FALSE_BITS = QUIET_NAN | 2;
+
+    /// @brief The encoding of true
+    static constexpr uint64_t TRUE_BITS = QUIET_NAN | 3;
+
+    /// @brief The encoded value
+    uint64_t m_bits;
+#else
     /// @brief The type of the value
     Type m_type;
 
@@ -181,5 +271,6 @@ class Value {
         /// @brief The underlying object value
         Object * m_object;
     } m_underlying_value;
+#endif
 };
 } // namespace cppLox::Types
\ No newline at end of file
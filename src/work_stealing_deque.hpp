@@ -0,0 +1,178 @@
+/****************************************************************************
+ * Copyright (C) 2024 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of cpp-lox.                                            *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <"https://www.gnu.org/licenses/gpl-3.0.html">GNU General Public  *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file work_stealing_deque.hpp
+ * @brief This file contains the lock-free deque, that the threads of the parallel marker share their work with.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace cppLox {
+
+/// @brief A lock-free work-stealing deque after Chase and Lev.
+/// @details The owning thread pushes and pops its work at the bottom, while other threads steal the oldest work from
+/// the top. Only a steal and a pop of the last element synchronize using a compare and swap. The buffer grows when it
+/// is full, the buffers it outgrew are kept until the deque is destroyed, because a thief may still read from them.
+/// @tparam T The type of the work, that is copied into the buffer.
+template <typename T> class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "The work is read by thieves, while the owner overwrites it");
+
+  public:
+    /// @brief Creates a new empty deque.
+    /// @param capacity The initial capacity of the deque, that is rounded up to a power of two.
+    explicit WorkStealingDeque(size_t capacity = 1024) {
+        size_t powerOfTwo = 1;
+        while (powerOfTwo < capacity) {
+            powerOfTwo *= 2;
+        }
+        m_buffers.push_back(std::make_unique<Buffer>(powerOfTwo));
+        m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(WorkStealingDeque const &) = delete;
+    auto operator=(WorkStealingDeque const &) -> WorkStealingDeque & = delete;
+
+    /// @brief Pushes work at the bottom of the deque, may only be called by the owning thread.
+    /// @param work The work to push.
+    auto push(T work) -> void {
+        int64_t const bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t const top = m_top.load(std::memory_order_acquire);
+        Buffer * buffer = m_buffer.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<int64_t>(buffer->m_mask)) {
+            buffer = grow(buffer, top, bottom);
+        }
+        buffer->put(bottom, work);
+        // The work is written before the thieves can see the new bottom
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /// @brief Pops the work, that was pushed last, may only be called by the owning thread.
+    /// @return The work or nothing if the deque is empty.
+    auto pop() -> std::optional<T> {
+        int64_t const bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Buffer * buffer = m_buffer.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        // The thieves have to see the smaller bottom before the top is read, or both could take the last element
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        T work = buffer->get(bottom);
+        if (top == bottom) {
+            // The last element is raced for with the thieves
+            bool const won =
+                m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                return std::nullopt;
+            }
+        }
+        return work;
+    }
+
+    /// @brief Steals the work, that was pushed first, may be called by any thread.
+    /// @return The work or nothing if the deque is empty or another thread took the work first.
+    auto steal() -> std::optional<T> {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t const bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return std::nullopt;
+        }
+        T work = m_buffer.load(std::memory_order_acquire)->get(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return work;
+    }
+
+    /// @brief Checks if the deque holds no work, the answer may be outdated as soon as it is returned.
+    /// @return True if the deque is empty, false otherwise.
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return m_top.load(std::memory_order_acquire) >= m_bottom.load(std::memory_order_acquire);
+    }
+
+  private:
+    /// @brief A ring buffer, whose capacity is a power of two.
+    struct Buffer {
+        /// @brief Creates a new buffer.
+        /// @param capacity The capacity of the buffer, that is a power of two.
+        explicit Buffer(size_t capacity)
+            : m_mask(capacity - 1), m_elements(std::make_unique<std::atomic<T>[]>(capacity)) {
+        }
+
+        /// @brief Gets the element at the given index.
+        /// @param index The index of the element, that wraps around the buffer.
+        /// @return The element.
+        auto get(int64_t index) const noexcept -> T {
+            return m_elements[static_cast<size_t>(index) & m_mask].load(std::memory_order_relaxed);
+        }
+
+        /// @brief Sets the element at the given index.
+        /// @param index The index of the element, that wraps around the buffer.
+        /// @param work The element.
+        auto put(int64_t index, T work) noexcept -> void {
+            m_elements[static_cast<size_t>(index) & m_mask].store(work, std::memory_order_relaxed);
+        }
+
+        /// @brief The capacity of the buffer minus one, that maps an index into the buffer.
+        size_t m_mask;
+
+        /// @brief The elements of the buffer.
+        std::unique_ptr<std::atomic<T>[]> m_elements;
+    };
+
+    /// @brief Replaces the given full buffer by one that has twice its capacity.
+    /// @param buffer The full buffer.
+    /// @param top The index of the oldest element.
+    /// @param bottom The index after the newest element.
+    /// @return The new buffer.
+    auto grow(Buffer * buffer, int64_t top, int64_t bottom) -> Buffer * {
+        m_buffers.push_back(std::make_unique<Buffer>(2 * (buffer->m_mask + 1)));
+        Buffer * grown = m_buffers.back().get();
+        for (int64_t index = top; index < bottom; index++) {
+            grown->put(index, buffer->get(index));
+        }
+        m_buffer.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+    // The indices are written by different threads, so they are kept on separate cache lines
+
+    /// @brief The index of the oldest element, that is stolen next.
+    alignas(64) std::atomic<int64_t> m_top = 0;
+
+    /// @brief The index after the newest element, that is popped next.
+    alignas(64) std::atomic<int64_t> m_bottom = 0;
+
+    /// @brief The buffer, that holds the elements.
+    alignas(64) std::atomic<Buffer *> m_buffer;
+
+    /// @brief The current buffer and the buffers, that it replaced, which are only accessed by the owner.
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+};
+} // namespace cppLox
@@ -1,5 +1,6 @@
 #include "base_e2e_test_fixture.hpp"
 
+#include "../../src/error/runtime_exception.hpp"
 #include "../../src/init.hpp"
 
 auto BaseE2ETestFixture::runAndCaptureStdout(std::string & source) -> std::string {
@@ -16,9 +17,44 @@ auto BaseE2ETestFixture::runProgrammThrowingException(std::string & source) -> v
     cppLox::run(source, *lexer, *compiler, *vm);
 }
 
+auto BaseE2ETestFixture::runIsolated(std::vector<std::string> const & sources, RunOptions const & options)
+    -> std::string {
+    cppLox::Frontend::Lexer isolatedLexer;
+    std::shared_ptr<cppLox::MemoryMutator> isolatedMutator = std::make_shared<cppLox::MemoryMutator>();
+    cppLox::Backend::VM isolatedVm(isolatedMutator);
+#ifdef JIT
+    if (options.jitThreshold.has_value()) {
+        isolatedVm.setJitThreshold(*options.jitThreshold);
+    }
+#endif
+    cppLox::Frontend::Compiler isolatedCompiler(isolatedMutator, options.tier, options.compilerOptions);
+    testing::internal::CaptureStdout();
+    // Every source is compiled on its own, like the lines of the repl
+    try {
+        for (std::string source : sources) {
+            cppLox::run(source, isolatedLexer, isolatedCompiler, isolatedVm);
+        }
+    } catch (cppLox::Error::RunTimeException const & exception) {
+        std::cout << exception.what();
+    }
+    return testing::internal::GetCapturedStdout();
+}
+
+auto BaseE2ETestFixture::assertSameOutput(std::vector<std::string> const & sources, std::string const & expected,
+                                          RunOptions const & baseline, RunOptions const & variant) -> void {
+    std::string const baselineOutput = runIsolated(sources, baseline);
+    std::string const variantOutput = runIsolated(sources, variant);
+    ASSERT_EQ(expected, baselineOutput);
+    ASSERT_EQ(baselineOutput, variantOutput);
+}
+
 auto BaseE2ETestFixture::SetUp() -> void {
     lexer = std::make_unique<cppLox::Frontend::Lexer>();
     memoryMutator = std::make_shared<cppLox::MemoryMutator>();
     vm = std::make_unique<cppLox::Backend::VM>(memoryMutator);
+#ifdef JIT
+    // Every function is compiled on its first call, so the end to end tests cover the native code
+    vm->setJitThreshold(1);
+#endif
     compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
 }
\ No newline at end of file
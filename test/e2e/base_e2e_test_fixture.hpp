@@ -1,17 +1,36 @@
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "../../src/backend/vm.hpp"
+#include "../../src/bytecode/tier.hpp"
 #include "../../src/frontend/compiler.hpp"
+#include "../../src/frontend/compiler_options.hpp"
 #include "../../src/frontend/lexer.hpp"
 #include "../../src/frontend/token.hpp"
 #include "../../src/memory_mutator.hpp"
 
+// How runIsolated compiles and executes a program. Without a jit threshold the default threshold of the vm is used.
+struct RunOptions {
+    cppLox::ByteCode::Tier tier = cppLox::ByteCode::Tier::STACK;
+    cppLox::Frontend::CompilerOptions compilerOptions = {};
+    std::optional<uint32_t> jitThreshold = std::nullopt;
+};
+
 class BaseE2ETestFixture : public ::testing::Test {
   protected:
     auto SetUp() -> void override;
     auto runAndCaptureStdout(std::string & source) -> std::string;
     auto runProgramm(std::string & source) -> void;
     auto runProgrammThrowingException(std::string & source) -> void;
+    // Runs the sources with a fresh interpreter and returns the output, a runtime error ends the run and is printed
+    auto runIsolated(std::vector<std::string> const & sources, RunOptions const & options) -> std::string;
+    // Runs the sources once with each of the options and asserts, that both runs print the expected output
+    auto assertSameOutput(std::vector<std::string> const & sources, std::string const & expected,
+                          RunOptions const & baseline, RunOptions const & variant) -> void;
 
   private:
     std::unique_ptr<cppLox::Frontend::Lexer> lexer;
@@ -16,6 +16,19 @@ TEST_F(BinaryOperatorE2ETest, Addition) {
     ASSERT_EQ(expected, output);
 }
 
+TEST_F(BinaryOperatorE2ETest, AdditionOfDifferentTypesAtTheSameInstruction) {
+    // Arrange
+    std::string source =
+        R"(fun add(a, b) { return a + b; } print add(1, 2); print add("a", "b"); print add(3, 4); print add(5, 6);)";
+    std::string expected = "3\nab\n7\n11\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
 TEST_F(BinaryOperatorE2ETest, Division) {
     // Arrange
     std::string source = "print 1 / 2;";
@@ -140,6 +153,31 @@ TEST_F(BinaryOperatorE2ETest, StringConcatenation) {
     ASSERT_EQ(expected, output);
 }
 
+TEST_F(BinaryOperatorE2ETest, StringConcatenationOfLiteralsEqualToLiteral) {
+    // Arrange
+    std::string source = R"(print "Hello, " + "World" == "Hello, World"; var a = "a"; print a + "b" == "a" + "b";)";
+    std::string expected = "true\ntrue\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
+TEST_F(BinaryOperatorE2ETest, ArithmeticOfLiteralsInLoop) {
+    // Arrange
+    std::string source = "var seconds = 0; for (var day = 0; day < 3; day = day + 1) { "
+                         "seconds = seconds + 60 * 60 * 24 - -(1 + 2) / 3; } print seconds; print 1 + 2 < 4 == !false;";
+    std::string expected = "259203\ntrue\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
 TEST_F(BinaryOperatorE2ETest, Subtraction) {
     // Arrange
     std::string source = "print 1 - 2;";
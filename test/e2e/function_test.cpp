@@ -83,3 +83,111 @@ TEST_F(FunctionE2ETest, CallNull) {
     // Act & Assert
     ASSERT_THROW(runProgrammThrowingException(source), cppLox::Error::RunTimeException);
 }
+
+TEST_F(FunctionE2ETest, RecursiveFunction) {
+    // Arrange
+    std::string source = "fun fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } print fib(10);";
+    std::string expected = "55\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
+TEST_F(FunctionE2ETest, DeepRecursion) {
+    // Arrange
+    std::string source = "fun count(n) { if (n == 0) return 0; return count(n - 1) + 1; } print count(500);";
+    std::string expected = "500\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
+TEST_F(FunctionE2ETest, UnboundedRecursion) {
+    // Arrange
+    // A call in tail position reuses the frame, so only a call, whose result is used, recurses
+    std::string source = "fun loop() { return loop() + 1; } loop();";
+
+    // Act & Assert
+    ASSERT_THROW(runProgrammThrowingException(source), cppLox::Error::RunTimeException);
+}
+
+TEST_F(FunctionE2ETest, TailRecursionRunsInConstantStackSpace) {
+    // Arrange
+    std::string source =
+        "fun count(n, total) { if (n == 0) return total; return count(n - 1, total + 1); } print count(100000, 0);";
+    std::string expected = "100000\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
+TEST_F(FunctionE2ETest, MutualTailRecursion) {
+    // Arrange
+    std::string source = "fun isEven(n) { if (n == 0) return true; return isOdd(n - 1); } fun isOdd(n) { if (n == 0) "
+                         "return false; return isEven(n - 1); } print isEven(5001);";
+    std::string expected = "false\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
+TEST_F(FunctionE2ETest, NativeFunctionInTailPosition) {
+    // Arrange
+    std::string source = "fun now() { return clock(); } print now() > 0;";
+    std::string expected = "true\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
+TEST_F(FunctionE2ETest, TailCallWithWrongArgumentCount) {
+    // Arrange
+    std::string source = "fun foo(a) { return a; } fun bar() { return foo(); } bar();";
+
+    // Act & Assert
+    ASSERT_THROW(runProgrammThrowingException(source), cppLox::Error::RunTimeException);
+}
+
+TEST_F(FunctionE2ETest, ReturnInBothBranches) {
+    // Arrange
+    std::string source = "fun sign(n) { if (n < 0) return -1; else return 1; print \"unreachable\"; } "
+                         "fun implicit(n) { if (n) return n; } print sign(-5); print sign(5); print implicit(false);";
+    std::string expected = "-1\n1\nnull\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
+TEST_F(FunctionE2ETest, MoreConstantsThanFitIntoAByte) {
+    // Arrange
+    std::string source = "fun sum() { var total = 0;";
+    for (int number = 1; number <= 300; number++) {
+        source += " total = total + " + std::to_string(number) + ";";
+    }
+    source += " return total; } print sum();";
+    std::string expected = "45150\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
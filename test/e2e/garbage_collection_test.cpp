@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "../../src/backend/vm.hpp"
+#include "../../src/bytecode/tier.hpp"
+#include "../../src/frontend/compiler.hpp"
+#include "../../src/frontend/lexer.hpp"
+#include "../../src/init.hpp"
+#include "../../src/memory_mutator.hpp"
+
+// Runs programs with a heap, that is collected on every allocation, and a nursery, that only fits a few strings, so
+// objects that are not reachable from the roots are freed immediately and the young strings are moved often
+class GarbageCollectionE2ETest
+    : public ::testing::TestWithParam<std::tuple<cppLox::ByteCode::Tier, cppLox::CollectionMode>> {
+  protected:
+    auto runAndCaptureStdout(std::string source) -> std::string {
+        memoryMutator->setCollectionMode(std::get<1>(GetParam()));
+        cppLox::Frontend::Lexer lexer;
+        cppLox::Backend::VM vm(memoryMutator);
+#ifdef JIT
+        vm.setJitThreshold(1);
+#endif
+        cppLox::Frontend::Compiler compiler(memoryMutator, std::get<0>(GetParam()));
+        testing::internal::CaptureStdout();
+        cppLox::run(source, lexer, compiler, vm);
+        return testing::internal::GetCapturedStdout();
+    }
+
+    std::shared_ptr<cppLox::MemoryMutator> memoryMutator = std::make_shared<cppLox::MemoryMutator>(
+        0, GC_HEAP_GROW_FACTOR, 4 * sizeof(cppLox::Types::ObjectString));
+};
+
+TEST_P(GarbageCollectionE2ETest, KeepsReachableStrings) {
+    // Arrange
+    std::string source = "var global = \"a\" + \"b\"; fun concat(x) { var local = x + \"c\"; return local + global; } "
+                         "print concat(\"d\"); print global;";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ("dcab\nab\n", output);
+}
+
+TEST_P(GarbageCollectionE2ETest, KeepsYoungStringsStoredInGlobals) {
+    // Arrange
+    std::string source = "var built = \"\"; var other = \"\"; var i = 0; while (i < 10) { built = built + \"x\"; other "
+                         "= built + \"y\"; i = i + 1; } print built; print other;";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ("xxxxxxxxxx\nxxxxxxxxxxy\n", output);
+}
+
+TEST_P(GarbageCollectionE2ETest, KeepsFunctionsAndTheirConstants) {
+    // Arrange
+    std::string source = "fun greet(name) { return \"Hello, \" + name; } "
+                         "fun twice(name) { return greet(name) + \" \" + greet(name); } print twice(\"World\");";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ("Hello, World Hello, World\n", output);
+}
+
+TEST_P(GarbageCollectionE2ETest, CollectsStringsBuiltInLoop) {
+    // Arrange
+    std::string source = "fun build(n) { var result = \"\"; var i = 0; while (i < n) { result = result + \"x\"; i = i "
+                         "+ 1; } return result; } var built = build(100); print built == \"" +
+                         std::string(100, 'x') + "\";";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ("true\n", output);
+    // Without collections the heap would still hold all the strings, that were built in the loop
+    EXPECT_LT(memoryMutator->bytesAllocated(), 100 * (sizeof(cppLox::Types::ObjectString) + sizeof(std::string)));
+}
+
+INSTANTIATE_TEST_SUITE_P(GarbageCollectionE2ETest, GarbageCollectionE2ETest,
+                         ::testing::Combine(::testing::Values(cppLox::ByteCode::Tier::STACK,
+                                                              cppLox::ByteCode::Tier::REGISTER),
+                                            ::testing::Values(cppLox::CollectionMode::STOP_THE_WORLD,
+                                                              cppLox::CollectionMode::INCREMENTAL)));
@@ -54,4 +54,23 @@ TEST_F(GlobalVariableE2ETest, SameNameWithinSameScopeDoClash) {
 
     // Act & Assert
     ASSERT_THROW(runProgrammThrowingException(source), cppLox::Error::RunTimeException);
-}
\ No newline at end of file
+}
+TEST_F(GlobalVariableE2ETest, ReferencedBeforeDefinition) {
+    // Arrange
+    std::string source = "fun first() { return second() + a; } fun second() { return 1; } var a = 2; print first();";
+    std::string expected = "3\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
+TEST_F(GlobalVariableE2ETest, AssignmentToGlobalDefinedLater) {
+    // Arrange
+    std::string source = "fun set() { a = 1; } set(); var a;";
+
+    // Act & Assert
+    ASSERT_THROW(runProgrammThrowingException(source), cppLox::Error::RunTimeException);
+}
@@ -49,3 +49,46 @@ TEST_F(IfElseStatementE2ETest, FalsyElseStatement) {
     // Assert
     ASSERT_EQ(expected, output);
 }
+
+TEST_F(IfElseStatementE2ETest, ComparisonConditions) {
+    // Arrange
+    std::string source = "{ var a = 1; var b = 2;"
+                         "  if (a == b) print 1; else print 2; if (a != b) print 3; else print 4;"
+                         "  if (a < b) print 5; else print 6; if (a <= b) print 7; else print 8;"
+                         "  if (a > b) print 9; else print 10; if (a >= b) print 11; else print 12; }";
+    std::string expected = "2\n3\n5\n7\n10\n12\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
+TEST_F(IfElseStatementE2ETest, NegatedConditions) {
+    // Arrange
+    std::string source = "var a = false; if (!a) print 1; else print 2; if (!null) print 3; if (!(1 < 2)) print 4; "
+                         "else print 5; a = true; if (!a) print 6; else print 7;";
+    std::string expected = "1\n3\n5\n7\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
+
+TEST_F(IfElseStatementE2ETest, OnlyNullAndFalseAreFalsey) {
+    // Arrange
+    std::string source = "fun check(value) { if (value) return \"truthy\"; return \"falsey\"; } print check(1.1); "
+                         "print check(0); print check(\"\"); print check(\"a\"); print check(check); print "
+                         "check(true); print check(false); print check(null); if (!0) print \"not\"; else print "
+                         "\"zero\"; print 0 and \"and\"; print null or \"or\";";
+    std::string expected = "truthy\ntruthy\ntruthy\ntruthy\ntruthy\ntruthy\nfalsey\nfalsey\nzero\nand\nor\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
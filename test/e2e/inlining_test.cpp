@@ -0,0 +1,100 @@
+#include <string>
+#include <vector>
+
+#include "base_e2e_test_fixture.hpp"
+
+// Runs the same programs with and without inlining and compares the output of both runs
+class InliningE2ETest : public BaseE2ETestFixture {
+  protected:
+    auto assertSameOutputWhenInlined(std::vector<std::string> const & sources, std::string const & expected) -> void {
+        // Functions are compiled by the jit compiler after their second call, so inlined calls also run natively
+        assertSameOutput(sources, expected, {.compilerOptions = {.inlining = false}, .jitThreshold = 2},
+                         {.compilerOptions = {.inlining = true}, .jitThreshold = 2});
+    }
+};
+
+TEST_F(InliningE2ETest, SmallGlobalFunctions) {
+    // Arrange
+    std::string source = "fun square(x) { return x * x; } fun sum(a, b, c) { var s = a + b; return s + c; } fun "
+                         "max(a, b) { if (a > b) return a; return b; } fun run(n) { var total = 0; var i = 0; while "
+                         "(i < n) { total = total + square(i) + sum(i, 1, 2) + max(i, 3); i = i + 1; } return total; "
+                         "} print run(10); print max(2, 1.5);";
+    std::string expected = "411\n2\n";
+
+    // Act & Assert
+    assertSameOutputWhenInlined({source}, expected);
+}
+
+TEST_F(InliningE2ETest, LocalFunctions) {
+    // Arrange
+    std::string source = "fun run(n) { fun twice(v) { return v + v; } var total = 0; var i = 0; while (i < n) { total "
+                         "= total + twice(i); i = i + 1; } return total; } print run(5);";
+    std::string expected = "20\n";
+
+    // Act & Assert
+    assertSameOutputWhenInlined({source}, expected);
+}
+
+TEST_F(InliningE2ETest, ReassignedLocalFallsBackToCall) {
+    // Arrange
+    std::string source = "fun increment(x) { return x + 1; } fun double(x) { return x * 2; } fun run() { var f = "
+                         "increment; var i = 0; while (i < 3) { print f(5); f = double; i = i + 1; } } run();";
+    std::string expected = "6\n10\n10\n";
+
+    // Act & Assert
+    assertSameOutputWhenInlined({source}, expected);
+}
+
+TEST_F(InliningE2ETest, GlobalRedefinedByLaterInput) {
+    // Arrange
+    std::vector<std::string> sources = {"fun scale(x) { return x * 2; } fun apply(x) { return scale(x) + 1; } print "
+                                        "apply(5);",
+                                        "fun tenfold(x) { return x * 10; } scale = tenfold; print apply(5);",
+                                        "fun product(x, y) { return x * y; } scale = product; print apply(5);"};
+    std::string expected = "11\n51\nExpected 2 arguments but got 1\n[line 1] in apply\n[line 1] in main\n";
+
+    // Act & Assert
+    assertSameOutputWhenInlined(sources, expected);
+}
+
+TEST_F(InliningE2ETest, RunTimeErrorInsideInlinedFunction) {
+    // Arrange
+    std::string source = "fun store(value) { undefined = value; return value; } fun update(value) { return "
+                         "store(value) + 1; } update(1);";
+    std::string expected = "Undefined variable 'undefined'\n[line 1] in store\n[line 1] in update\n[line 1] in main\n";
+
+    // Act & Assert
+    assertSameOutputWhenInlined({source}, expected);
+}
+
+TEST_F(InliningE2ETest, RecursiveFunctionsAndNatives) {
+    // Arrange
+    std::string source = "fun one() { return 1; } fun fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } "
+                         "fun add(a, b) { return a + b; } print add(fib(10), one()); print clock() > 0; print add;";
+    std::string expected = "56\ntrue\n<fn add>\n";
+
+    // Act & Assert
+    assertSameOutputWhenInlined({source}, expected);
+}
+
+TEST_F(InliningE2ETest, TailCalls) {
+    // Arrange
+    std::string source = "fun half(x) { return x / 2; } fun run(x) { return half(x); } print run(9); print run(-0);";
+    std::string expected = "4.5\n-0\n";
+
+    // Act & Assert
+    assertSameOutputWhenInlined({source}, expected);
+}
+
+TEST_F(InliningE2ETest, MoreConstantsThanFitIntoAByte) {
+    // Arrange
+    std::string source = "fun half(x) { return x * 0.5; } fun run() { var total = 0;";
+    for (int number = 1; number <= 300; number++) {
+        source += " total = total + " + std::to_string(number) + ";";
+    }
+    source += " return half(total); } print run(); print run();";
+    std::string expected = "22575\n22575\n";
+
+    // Act & Assert
+    assertSameOutputWhenInlined({source}, expected);
+}
@@ -0,0 +1,96 @@
+#ifdef JIT
+
+#include <string>
+
+#include "base_e2e_test_fixture.hpp"
+
+// Runs the same program with and without the jit compiler and compares the output of both runs
+class JitE2ETest : public BaseE2ETestFixture {
+  protected:
+    auto assertSameOutputWithAndWithoutJit(std::string const & source, std::string const & expected) -> void {
+        assertSameOutput({source}, expected, {.jitThreshold = 0}, {.jitThreshold = 2});
+    }
+};
+
+TEST_F(JitE2ETest, RecursiveFunction) {
+    // Arrange
+    std::string source =
+        "fun fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } print fib(20); print fib;";
+    std::string expected = "6765\n<fn fib>\n";
+
+    // Act & Assert
+    assertSameOutputWithAndWithoutJit(source, expected);
+}
+
+TEST_F(JitE2ETest, TailCallsBetweenCompiledAndInterpretedFunctions) {
+    // Arrange
+    std::string source = "fun down(n) { if (n == 0) return \"done\"; if (n == 7) return clock() * 0 + n; return "
+                         "up(n - 1); } fun up(n) { return down(n); } print down(6); print down(5000);";
+    std::string expected = "done\n7\n";
+
+    // Act & Assert
+    assertSameOutputWithAndWithoutJit(source, expected);
+}
+
+TEST_F(JitE2ETest, LoopsAndLocals) {
+    // Arrange
+    std::string source = "fun sum(n) { var total = 0; var i = 0; while (i < n) { if (i == 5) total = total - i; else "
+                         "total = total + i; i = i + 1; } while (total > 100) total = total / 2; return total; } "
+                         "for (var i = 0; i < 4; i = i + 1) print sum(i * 10);";
+    std::string expected = "0\n35\n90\n53.125\n";
+
+    // Act & Assert
+    assertSameOutputWithAndWithoutJit(source, expected);
+}
+
+TEST_F(JitE2ETest, OperandsOfDifferentTypesAtTheSameInstruction) {
+    // Arrange
+    std::string source = "fun add(a, b) { return a + b; } print add(1, 2); print add(3, 4); print add(\"a\", \"b\"); "
+                         "print add(5, 6); print !add(1, 1) == false; print -add(1, 1);";
+    std::string expected = "3\n7\nab\n11\ntrue\n-2\n";
+
+    // Act & Assert
+    assertSameOutputWithAndWithoutJit(source, expected);
+}
+
+TEST_F(JitE2ETest, GlobalsAndNativeFunctions) {
+    // Arrange
+    std::string source = "var count = 0; fun increment() { count = count + 1; return clock() >= 0; } "
+                         "for (var i = 0; i < 10; i = i + 1) increment(); print count; print increment();";
+    std::string expected = "10\ntrue\n";
+
+    // Act & Assert
+    assertSameOutputWithAndWithoutJit(source, expected);
+}
+
+TEST_F(JitE2ETest, RunTimeErrorInCompiledFunction) {
+    // Arrange
+    std::string source = "fun add(a, b) {\nreturn a + b;\n}\nfun call(a, b) {\nreturn add(a, b);\n}\n"
+                         "call(1, 2);\ncall(3, 4);\ncall(5, nil);";
+    std::string expected = "Operands must be two numbers or two strings";
+
+    // Act & Assert
+    assertSameOutputWithAndWithoutJit(source, expected);
+}
+
+TEST_F(JitE2ETest, AssignmentToUndefinedGlobalInCompiledFunction) {
+    // Arrange
+    std::string source = "fun set(value) { if (value > 1) undefined = value; } fun update(value) { set(value); } "
+                         "update(0); update(1); update(2);";
+    std::string expected = "Undefined variable 'undefined'\n[line 1] in set\n[line 1] in update\n[line 1] in main\n";
+
+    // Act & Assert
+    assertSameOutputWithAndWithoutJit(source, expected);
+}
+
+TEST_F(JitE2ETest, NegatedConditions) {
+    // Arrange
+    std::string source = "fun large(n) { var count = 0; var i = 0; while (i < n) { if (!(i < 5)) count = count + 1; "
+                         "i = i + 1; } return count; } print large(3); print large(6); print large(11);";
+    std::string expected = "0\n1\n6\n";
+
+    // Act & Assert
+    assertSameOutputWithAndWithoutJit(source, expected);
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include <string>
+
+#include "base_e2e_test_fixture.hpp"
+
+// Runs the same program with and without the ssa based middle end and compares the output of both runs
+class OptimizerE2ETest : public BaseE2ETestFixture {
+  protected:
+    auto assertSameOutputWhenOptimized(std::string const & source, std::string const & expected) -> void {
+        assertSameOutput({source}, expected, {.compilerOptions = {.optimize = false}},
+                         {.compilerOptions = {.optimize = true}});
+    }
+};
+
+TEST_F(OptimizerE2ETest, LoopInvariants) {
+    // Arrange
+    std::string source = "fun scale(n) { var k = 3; var sum = 0; var i = 0; while (i < n * 2) { sum = sum + i * (k * "
+                         "k + 1); i = i + 1; } return sum; } print scale(5);";
+    std::string expected = "450\n";
+
+    // Act & Assert
+    assertSameOutputWhenOptimized(source, expected);
+}
+
+TEST_F(OptimizerE2ETest, NestedLoops) {
+    // Arrange
+    std::string source = "fun grid(w, h) { var sum = 0; var x = 0; var y = 0; while (y < h) { x = 0; while (x < w) { "
+                         "sum = sum + x * w + y * w; x = x + 1; } y = y + 1; } return sum; } print grid(4, 3);";
+    std::string expected = "120\n";
+
+    // Act & Assert
+    assertSameOutputWhenOptimized(source, expected);
+}
+
+TEST_F(OptimizerE2ETest, CommonSubexpressions) {
+    // Arrange
+    std::string source = "fun area(a, b) { var c = a * b + b * a; var d = a * b - 1; return c * d; } print area(3, 4);";
+    std::string expected = "264\n";
+
+    // Act & Assert
+    assertSameOutputWhenOptimized(source, expected);
+}
+
+TEST_F(OptimizerE2ETest, DeadStores) {
+    // Arrange
+    std::string source = "fun last(a) { var b = a * 2; b = a * 3; a = 0; b = b + a; a = b - 1; return b; } print "
+                         "last(4);";
+    std::string expected = "12\n";
+
+    // Act & Assert
+    assertSameOutputWhenOptimized(source, expected);
+}
+
+TEST_F(OptimizerE2ETest, GlobalVariables) {
+    // Arrange
+    std::string source = "var g = 2; fun twice() { var a = g * g; g = 3; return a + g * g; } print twice(); var count "
+                         "= 0; fun bump() { count = count + 1; return count; } fun sum() { var total = 0; var i = 0; "
+                         "while (i < 3) { total = total + count + bump(); i = i + 1; } return total; } print sum();";
+    std::string expected = "13\n9\n";
+
+    // Act & Assert
+    assertSameOutputWhenOptimized(source, expected);
+}
+
+TEST_F(OptimizerE2ETest, RunTimeErrorInsideLoop) {
+    // Arrange
+    std::string source = "fun count(limit, step) { var i = 0; while (i < limit) { print i; i = i + step * \"a\"; } "
+                         "} count(3, 1);";
+    std::string expected = "0\nmultiplication is only defined for numbers";
+
+    // Act & Assert
+    assertSameOutputWhenOptimized(source, expected);
+}
+
+TEST_F(OptimizerE2ETest, RecursiveFunction) {
+    // Arrange
+    std::string source =
+        "fun fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } print fib(15); print fib;";
+    std::string expected = "610\n<fn fib>\n";
+
+    // Act & Assert
+    assertSameOutputWhenOptimized(source, expected);
+}
+
+TEST_F(OptimizerE2ETest, StringsAndLogicalOperators) {
+    // Arrange
+    std::string source = "fun greet(name, loud) { var greeting = \"Hello, \" + name; if (loud and name != \"\") "
+                         "greeting = greeting + \"!\"; print loud or name == \"Lox\"; return greeting; } "
+                         "print greet(\"Lox\", true); print greet(\"Lox\", false);";
+    std::string expected = "true\nHello, Lox!\ntrue\nHello, Lox\n";
+
+    // Act & Assert
+    assertSameOutputWhenOptimized(source, expected);
+}
+
+TEST_F(OptimizerE2ETest, MoreConstantsThanFitIntoAByte) {
+    // Arrange
+    std::string source = "fun sum(n) { var total = 0;";
+    for (int number = 1; number <= 300; number++) {
+        source += " total = total + " + std::to_string(number) + " * n;";
+    }
+    source += " return total; } print sum(2);";
+    std::string expected = "90300\n";
+
+    // Act & Assert
+    assertSameOutputWhenOptimized(source, expected);
+}
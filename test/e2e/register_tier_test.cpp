@@ -0,0 +1,106 @@
+#include <string>
+
+#include "../../src/bytecode/tier.hpp"
+#include "base_e2e_test_fixture.hpp"
+
+// Runs the same program on the stack and the register tier and compares the output of both runs
+class RegisterTierE2ETest : public BaseE2ETestFixture {
+  protected:
+    auto assertSameOutputOnBothTiers(std::string const & source, std::string const & expected) -> void {
+        assertSameOutput({source}, expected, {.tier = cppLox::ByteCode::Tier::STACK},
+                         {.tier = cppLox::ByteCode::Tier::REGISTER});
+    }
+};
+
+TEST_F(RegisterTierE2ETest, Arithmetic) {
+    // Arrange
+    std::string source = "var a = 3; var b = 4; print -(a * a + b * b) / 5 - 1;";
+    std::string expected = "-6\n";
+
+    // Act & Assert
+    assertSameOutputOnBothTiers(source, expected);
+}
+
+TEST_F(RegisterTierE2ETest, LocalVariables) {
+    // Arrange
+    std::string source = "{ var a = 1; var b = 2; var c = a + b; a = c; c = c * a; b = b; print a; print b; print c; }";
+    std::string expected = "3\n2\n9\n";
+
+    // Act & Assert
+    assertSameOutputOnBothTiers(source, expected);
+}
+
+TEST_F(RegisterTierE2ETest, StringConcatenation) {
+    // Arrange
+    std::string source = "var greeting = \"Hello\"; print greeting + \", \" + \"World\";";
+    std::string expected = "Hello, World\n";
+
+    // Act & Assert
+    assertSameOutputOnBothTiers(source, expected);
+}
+
+TEST_F(RegisterTierE2ETest, FoldedConstants) {
+    // Arrange
+    std::string source = "{ var a = 2; print a * (60 * 60 * 24) + -(3); print \"a\" + \"b\" + \"c\"; print !(1 < 2); }";
+    std::string expected = "172797\nabc\nfalse\n";
+
+    // Act & Assert
+    assertSameOutputOnBothTiers(source, expected);
+}
+
+TEST_F(RegisterTierE2ETest, LogicalOperatorsAndComparisons) {
+    // Arrange
+    std::string source = "print 1 < 2 and 2 <= 2; print false or 1 > 2; print !(3 >= 4) == true; print 1 != 2 or x;";
+    std::string expected = "true\nfalse\ntrue\ntrue\n";
+
+    // Act & Assert
+    assertSameOutputOnBothTiers(source, expected);
+}
+
+TEST_F(RegisterTierE2ETest, Loops) {
+    // Arrange
+    std::string source = "var sum = 0; for (var i = 0; i < 10; i = i + 1) { if (i == 5) sum = sum - i; else sum = sum "
+                         "+ i; } var j = 0; while (j < 3) j = j + 1; print sum; print j;";
+    std::string expected = "35\n3\n";
+
+    // Act & Assert
+    assertSameOutputOnBothTiers(source, expected);
+}
+
+TEST_F(RegisterTierE2ETest, RecursiveFunction) {
+    // Arrange
+    std::string source =
+        "fun fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } print fib(15); print fib;";
+    std::string expected = "610\n<fn fib>\n";
+
+    // Act & Assert
+    assertSameOutputOnBothTiers(source, expected);
+}
+
+TEST_F(RegisterTierE2ETest, NativeFunction) {
+    // Arrange
+    std::string source = "fun later() { return clock() + 1; } print later() > clock();";
+    std::string expected = "true\n";
+
+    // Act & Assert
+    assertSameOutputOnBothTiers(source, expected);
+}
+
+TEST_F(RegisterTierE2ETest, TruthyConditions) {
+    // Arrange
+    std::string source = "fun check(value) { if (value) return 1; return 0; } print check(1.1) + check(0) + "
+                         "check(\"\") + check(check) + check(true) + check(false) + check(null);";
+    std::string expected = "5\n";
+
+    // Act & Assert
+    assertSameOutputOnBothTiers(source, expected);
+}
+
+TEST_F(RegisterTierE2ETest, RunTimeError) {
+    // Arrange
+    std::string source = "fun add(a, b) { return a + b; }\nprint add(1, nil);";
+    std::string expected = "Operands must be two numbers or two strings";
+
+    // Act & Assert
+    assertSameOutputOnBothTiers(source, expected);
+}
@@ -13,3 +13,15 @@ TEST_F(WhileLoopE2ETest, SimpleWhileLoop) {
     // Assert
     ASSERT_EQ(expected, output);
 }
+
+TEST_F(WhileLoopE2ETest, IfElseAtEndOfLoopBody) {
+    // Arrange
+    std::string source = "var i = 0; while (i < 4) { i = i + 1; if (i == 2) print \"two\"; else print i; }";
+    std::string expected = "1\ntwo\n3\n4\n";
+
+    // Act
+    std::string output = runAndCaptureStdout(source);
+
+    // Assert
+    ASSERT_EQ(expected, output);
+}
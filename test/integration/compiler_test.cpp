@@ -5,18 +5,24 @@
 #include <variant>
 
 #include "../../src/bytecode/opcode.hpp"
+#include "../../src/bytecode/register_opcode.hpp"
 #include "../../src/error/runtime_exception.hpp"
 #include "../../src/frontend/compiler.hpp"
 #include "../../src/frontend/token.hpp"
 #include "../../src/memory_mutator.hpp"
 #include "../../src/types/object_function.hpp"
+#include "../../src/types/object_string.hpp"
 
 // Test fixture for Compiler integration tests
 class CompilerIntegrationTest : public ::testing::Test {
   protected:
     CompilerIntegrationTest() {
         memoryMutator = std::make_shared<cppLox::MemoryMutator>();
-        compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+        // The operators are compiled without constant folding, so their literal operands are not folded away, and the
+        // bytecode is not rewritten by the peephole optimizer
+        compiler = std::make_unique<cppLox::Frontend::Compiler>(
+            memoryMutator, cppLox::ByteCode::Tier::STACK,
+            cppLox::Frontend::CompilerOptions{.constantFolding = false, .peepholeOptimization = false});
     }
 
     void SetUp() override {
@@ -93,7 +99,7 @@ TEST_F(CompilerIntegrationTest, CallExpression) {
     objectFunction = compiler->compile(tokens);
 
     // Assert
-    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::GET_GLOBAL, 0, cppLox::ByteCode::Opcode::CALL, 0,
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::GET_GLOBAL, 0, 0, cppLox::ByteCode::Opcode::CALL, 0,
                                        cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::NULL_,
                                        cppLox::ByteCode::Opcode::RETURN);
 }
@@ -194,6 +200,45 @@ TEST_F(CompilerIntegrationTest, ForLoop) {
     // Act
     objectFunction = compiler->compile(tokens);
 
+    // Assert
+    assertChunkContaintsExactlyInOrder(
+        cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::GET_LOCAL_CONSTANT, 0, 1,
+        cppLox::ByteCode::Opcode::LESS_JUMP_IF_FALSE, 0, 15, cppLox::ByteCode::Opcode::JUMP, 0, 9,
+        cppLox::ByteCode::Opcode::GET_LOCAL_CONSTANT, 0, 2, cppLox::ByteCode::Opcode::ADD,
+        cppLox::ByteCode::Opcode::SET_LOCAL_POP, 0, cppLox::ByteCode::Opcode::LOOP, 0, 18,
+        cppLox::ByteCode::Opcode::LOOP, 0, 12, cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::NULL_,
+        cppLox::ByteCode::Opcode::RETURN);
+}
+
+TEST_F(CompilerIntegrationTest, ForLoopWithoutSuperinstructions) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(
+        memoryMutator, cppLox::ByteCode::Tier::STACK,
+        cppLox::Frontend::CompilerOptions{.superinstructions = false, .peepholeOptimization = false});
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::FOR, "for", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::VAR, "var", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "i", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::EQUAL, "=", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "0", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "i", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LESS, "<", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "10", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "i", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::EQUAL, "=", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "i", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PLUS, "+", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
     // Assert
     assertChunkContaintsExactlyInOrder(
         cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::GET_LOCAL, 0,
@@ -261,6 +306,183 @@ TEST_F(CompilerIntegrationTest, GroupingExpression) {
                                        cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
 }
 
+TEST_F(CompilerIntegrationTest, ArithmeticOfNumberLiteralsFolded) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "60", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::STAR, "*", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "60", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::STAR, "*", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::MINUS, "-", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "24", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::POP,
+                                       cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+    // The constants of the operands are removed from the chunk
+    ASSERT_EQ(objectFunction.value()->chunk()->getConstantCount(), 1);
+    ASSERT_EQ(objectFunction.value()->chunk()->getConstant(0), cppLox::Types::Value(-86400.0));
+}
+
+TEST_F(CompilerIntegrationTest, EqualConstantsShared) {
+    // Arrange
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "2", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::POP,
+                                       cppLox::ByteCode::Opcode::CONSTANT, 1, cppLox::ByteCode::Opcode::POP,
+                                       cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::POP,
+                                       cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+    ASSERT_EQ(objectFunction.value()->chunk()->getConstantCount(), 2);
+}
+
+TEST_F(CompilerIntegrationTest, SharedConstantKeptWhenFolded) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PLUS, "+", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "2", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    // The first statement still loads the constant, that the folded operand shared with it
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::POP,
+                                       cppLox::ByteCode::Opcode::CONSTANT, 1, cppLox::ByteCode::Opcode::POP,
+                                       cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+    ASSERT_EQ(objectFunction.value()->chunk()->getConstant(0), cppLox::Types::Value(1.0));
+    ASSERT_EQ(objectFunction.value()->chunk()->getConstant(1), cppLox::Types::Value(3.0));
+}
+
+TEST_F(CompilerIntegrationTest, ConstantWithLargeIndexLoadedByWideInstruction) {
+    // Arrange
+    for (int number = 0; number < 300; number++) {
+        tokens.emplace_back(cppLox::Frontend::Token::Type::NUMBER, std::to_string(number), 1);
+        tokens.emplace_back(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1);
+    }
+    tokens.emplace_back(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1);
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    // Every statement with a constant that fits into a byte takes three bytes
+    ASSERT_TRUE(objectFunction.has_value());
+    cppLox::ByteCode::Chunk * chunk = objectFunction.value()->chunk();
+    ASSERT_EQ(chunk->getConstantCount(), 300);
+    ASSERT_EQ(chunk->getByte(255 * 3), cppLox::ByteCode::Opcode::CONSTANT);
+    ASSERT_EQ(chunk->getByte(255 * 3 + 1), 255);
+    ASSERT_EQ(chunk->getByte(256 * 3), cppLox::ByteCode::Opcode::CONSTANT_LONG);
+    ASSERT_EQ(chunk->getByte(256 * 3 + 1), 1);
+    ASSERT_EQ(chunk->getByte(256 * 3 + 2), 0);
+    ASSERT_EQ(chunk->getConstant(256), cppLox::Types::Value(256.0));
+}
+
+TEST_F(CompilerIntegrationTest, ComparisonOfNumberLiteralsFoldedIntoBoolean) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::BANG, "!", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LESS, "<", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "2", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::FALSE, cppLox::ByteCode::Opcode::POP,
+                                       cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+    ASSERT_EQ(objectFunction.value()->chunk()->getConstantCount(), 0);
+}
+
+TEST_F(CompilerIntegrationTest, ConcatenationOfStringLiteralsFoldedIntoInternedString) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::STRING, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PLUS, "+", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::STRING, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::POP,
+                                       cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+    ASSERT_EQ(objectFunction.value()->chunk()->getConstant(0),
+              cppLox::Types::Value(memoryMutator->create<cppLox::Types::ObjectString>("ab")));
+}
+
+TEST_F(CompilerIntegrationTest, FoldedConstantFusedWithLocal) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::VAR, "var", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::EQUAL, "=", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PLUS, "+", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "2", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::STAR, "*", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "3", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    assertChunkContaintsExactlyInOrder(
+        cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::GET_LOCAL_CONSTANT, 0, 1,
+        cppLox::ByteCode::Opcode::ADD, cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::POP,
+        cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+    ASSERT_EQ(objectFunction.value()->chunk()->getConstant(1), cppLox::Types::Value(6.0));
+}
+
+TEST_F(CompilerIntegrationTest, OperationWithRunTimeErrorNotFolded) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::MINUS, "-", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::TRUE, "true", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::NEGATE,
+                                       cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::NULL_,
+                                       cppLox::ByteCode::Opcode::RETURN);
+}
+
 TEST_F(CompilerIntegrationTest, IfStatement) {
     // Arrange
     tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IF, "if", 1),
@@ -273,9 +495,9 @@ TEST_F(CompilerIntegrationTest, IfStatement) {
     objectFunction = compiler->compile(tokens);
 
     // Assert
-    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::JUMP_IF_FALSE, 0, 1,
-                                       cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::POP,
-                                       cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE, 0,
+                                       3, cppLox::ByteCode::Opcode::JUMP, 0, 0, cppLox::ByteCode::Opcode::NULL_,
+                                       cppLox::ByteCode::Opcode::RETURN);
 }
 
 TEST_F(CompilerIntegrationTest, IfElseStatement) {
@@ -294,10 +516,10 @@ TEST_F(CompilerIntegrationTest, IfElseStatement) {
     objectFunction = compiler->compile(tokens);
 
     // Assert
-    assertChunkContaintsExactlyInOrder(
-        cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::JUMP_IF_FALSE, 0, 8, cppLox::ByteCode::Opcode::POP,
-        cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::PRINT, cppLox::ByteCode::Opcode::POP,
-        cppLox::ByteCode::Opcode::JUMP, 0, 0, cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE, 0,
+                                       6, cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::PRINT,
+                                       cppLox::ByteCode::Opcode::JUMP, 0, 0, cppLox::ByteCode::Opcode::NULL_,
+                                       cppLox::ByteCode::Opcode::RETURN);
 }
 
 TEST_F(CompilerIntegrationTest, LessThanExpression) {
@@ -473,7 +695,7 @@ TEST_F(CompilerIntegrationTest, VariableDeclarationExpression) {
     objectFunction = compiler->compile(tokens);
 
     // Assert
-    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::DEFINE_GLOBAL, 0,
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::DEFINE_GLOBAL, 0, 0,
                                        cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
 }
 
@@ -489,8 +711,8 @@ TEST_F(CompilerIntegrationTest, VariableAssignmentExpression) {
     objectFunction = compiler->compile(tokens);
 
     // Assert
-    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::CONSTANT, 1, cppLox::ByteCode::Opcode::SET_GLOBAL, 0,
-                                       cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::NULL_,
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::SET_GLOBAL, 0,
+                                       0, cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::NULL_,
                                        cppLox::ByteCode::Opcode::RETURN);
 }
 
@@ -528,8 +750,8 @@ TEST_F(CompilerIntegrationTest, VariableDeclarationAndAssignmentExpression) {
     objectFunction = compiler->compile(tokens);
 
     // Assert
-    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::CONSTANT, 1, cppLox::ByteCode::Opcode::DEFINE_GLOBAL,
-                                       0, cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::DEFINE_GLOBAL,
+                                       0, 0, cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
 }
 
 TEST_F(CompilerIntegrationTest, WhileLoopExpression) {
@@ -546,8 +768,377 @@ TEST_F(CompilerIntegrationTest, WhileLoopExpression) {
     objectFunction = compiler->compile(tokens);
 
     // Assert
-    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::JUMP_IF_FALSE, 0, 4,
-                                       cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::LOOP, 0, 8,
-                                       cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::NULL_,
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE, 0,
+                                       3, cppLox::ByteCode::Opcode::LOOP, 0, 7, cppLox::ByteCode::Opcode::NULL_,
                                        cppLox::ByteCode::Opcode::RETURN);
 }
+
+TEST_F(CompilerIntegrationTest, LocalVariablesFusedIntoSuperinstruction) {
+    // Arrange
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::VAR, "var", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::EQUAL, "=", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::VAR, "var", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::EQUAL, "=", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PLUS, "+", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    assertChunkContaintsExactlyInOrder(
+        cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::GET_LOCAL_GET_LOCAL, 0, 0,
+        cppLox::ByteCode::Opcode::ADD, cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::POP,
+        cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+}
+
+TEST_F(CompilerIntegrationTest, MaxStackDepthOfExpression) {
+    // Arrange
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PLUS, "+", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "2", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::STAR, "*", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "3", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    ASSERT_TRUE(objectFunction.has_value());
+    // The script itself and the three operands of the expression
+    ASSERT_EQ(objectFunction.value()->maxStackDepth(), 4);
+}
+
+TEST_F(CompilerIntegrationTest, MaxStackDepthOfFunctionWithParameters) {
+    // Arrange
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::FUN, "fun", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::COMMA, ",", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "c", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IF, "if", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RETURN, "return", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "c", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RETURN, "return", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PLUS, "+", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "c", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    ASSERT_TRUE(objectFunction.has_value());
+    auto functionObject = objectFunction.value()
+                              ->chunk()
+                              ->getConstant(0)
+                              .as<cppLox::Types::Object *>()
+                              ->as<cppLox::Types::ObjectFunction>();
+    // The function, both parameters and the two operands of the addition
+    ASSERT_EQ(functionObject->maxStackDepth(), 5);
+}
+
+TEST_F(CompilerIntegrationTest, RegisterTierFoldsAssignmentOfBinaryExpression) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator, cppLox::ByteCode::Tier::REGISTER);
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::FUN, "fun", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "f", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::COMMA, ",", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::COMMA, ",", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "c", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "c", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::EQUAL, "=", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PLUS, "+", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    ASSERT_TRUE(objectFunction.has_value());
+    auto functionObject = objectFunction.value()
+                              ->chunk()
+                              ->getConstant(0)
+                              .as<cppLox::Types::Object *>()
+                              ->as<cppLox::Types::ObjectFunction>();
+    cppLox::ByteCode::Chunk * chunk = functionObject->registerChunk();
+    ASSERT_NE(chunk, nullptr);
+    // A single ADD writes the sum of the registers of a and b to the register of c
+    std::array<uint8_t, 7> const expected = {static_cast<uint8_t>(cppLox::ByteCode::RegisterOpcode::ADD), 0, 3, 0, 1,
+                                             0, 2};
+    for (auto index : std::views::iota(0u, expected.size())) {
+        EXPECT_EQ(expected[index], chunk->getByte(index)) << "Unexpected byte at index " << index;
+    }
+    EXPECT_EQ(static_cast<uint8_t>(cppLox::ByteCode::RegisterOpcode::RETURN), chunk->getByte(expected.size()));
+}
+
+TEST_F(CompilerIntegrationTest, CallInTailPositionCompiledToTailCall) {
+    // Arrange
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::FUN, "fun", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RETURN, "return", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    ASSERT_TRUE(objectFunction.has_value());
+    objectFunction = objectFunction.value()
+                         ->chunk()
+                         ->getConstant(0)
+                         .as<cppLox::Types::Object *>()
+                         ->as<cppLox::Types::ObjectFunction>();
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::GET_GLOBAL, 0, 0, cppLox::ByteCode::Opcode::GET_LOCAL,
+                                       0, cppLox::ByteCode::Opcode::TAIL_CALL, 1, cppLox::ByteCode::Opcode::RETURN,
+                                       cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+}
+
+TEST_F(CompilerIntegrationTest, CallNotInTailPositionCompiledToCall) {
+    // Arrange
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::FUN, "fun", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RETURN, "return", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PLUS, "+", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    ASSERT_TRUE(objectFunction.has_value());
+    objectFunction = objectFunction.value()
+                         ->chunk()
+                         ->getConstant(0)
+                         .as<cppLox::Types::Object *>()
+                         ->as<cppLox::Types::ObjectFunction>();
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::GET_GLOBAL, 0, 0, cppLox::ByteCode::Opcode::GET_LOCAL,
+                                       0, cppLox::ByteCode::Opcode::CALL, 1, cppLox::ByteCode::Opcode::GET_LOCAL, 0,
+                                       cppLox::ByteCode::Opcode::ADD, cppLox::ByteCode::Opcode::RETURN,
+                                       cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+}
+
+TEST_F(CompilerIntegrationTest, ImplicitReturnAfterReturnRemoved) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::FUN, "fun", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RETURN, "return", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    ASSERT_TRUE(objectFunction.has_value());
+    objectFunction = objectFunction.value()
+                         ->chunk()
+                         ->getConstant(0)
+                         .as<cppLox::Types::Object *>()
+                         ->as<cppLox::Types::ObjectFunction>();
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::GET_GLOBAL, 0, 0, cppLox::ByteCode::Opcode::GET_LOCAL,
+                                       0, cppLox::ByteCode::Opcode::TAIL_CALL, 1, cppLox::ByteCode::Opcode::RETURN);
+}
+
+TEST_F(CompilerIntegrationTest, JumpOverEmptyElseBranchRemoved) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IF, "if", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::TRUE, "true", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PRINT, "print", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "2", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE, 0,
+                                       3, cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::PRINT,
+                                       cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+}
+
+TEST_F(CompilerIntegrationTest, NegatedConditionFusedIntoPopJumpIfTrue) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator);
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IF, "if", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::BANG, "!", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PRINT, "print", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "2", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::GET_GLOBAL, 0, 0,
+                                       cppLox::ByteCode::Opcode::POP_JUMP_IF_TRUE, 0, 3,
+                                       cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::PRINT,
+                                       cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+}
+
+TEST_F(CompilerIntegrationTest, DeadPureExpressionRemovedWhenOptimized) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(
+        memoryMutator, cppLox::ByteCode::Tier::STACK,
+        cppLox::Frontend::CompilerOptions{.constantFolding = false, .peepholeOptimization = false, .optimize = true});
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::VAR, "var", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::EQUAL, "=", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::STAR, "*", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "2", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    assertChunkContaintsExactlyInOrder(cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+}
+
+TEST_F(CompilerIntegrationTest, CommonSubexpressionReusedWhenOptimized) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(
+        memoryMutator, cppLox::ByteCode::Tier::STACK,
+        cppLox::Frontend::CompilerOptions{.constantFolding = false, .peepholeOptimization = false, .optimize = true});
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::VAR, "var", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::EQUAL, "=", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::STAR, "*", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::PLUS, "+", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::STAR, "*", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 1)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    // The product stays on the stack and is read a second time from there
+    assertChunkContaintsExactlyInOrder(
+        cppLox::ByteCode::Opcode::GET_GLOBAL, 0, 0, cppLox::ByteCode::Opcode::GET_LOCAL_GET_LOCAL, 0, 1,
+        cppLox::ByteCode::Opcode::MULTIPLY, cppLox::ByteCode::Opcode::GET_LOCAL, 1, cppLox::ByteCode::Opcode::ADD,
+        cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::NULL_,
+        cppLox::ByteCode::Opcode::RETURN);
+}
+
+TEST_F(CompilerIntegrationTest, SmallFunctionInlinedWhenInlining) {
+    // Arrange
+    compiler = std::make_unique<cppLox::Frontend::Compiler>(memoryMutator, cppLox::ByteCode::Tier::STACK,
+                                                            cppLox::Frontend::CompilerOptions{.inlining = true});
+    tokens = {cppLox::Frontend::Token(cppLox::Frontend::Token::Type::FUN, "fun", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_BRACE, "{", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RETURN, "return", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "b", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_BRACE, "}", 1),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::IDENTIFIER, "a", 2),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::LEFT_PARENTHESES, "(", 2),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::NUMBER, "1", 2),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::RIGHT_PARENTHESES, ")", 2),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::SEMICOLON, ";", 2),
+              cppLox::Frontend::Token(cppLox::Frontend::Token::Type::END_OF_FILE, "", 2)};
+
+    // Act
+    objectFunction = compiler->compile(tokens);
+
+    // Assert
+    // The argument becomes the parameter of the inlined body, that returns in place of the callee
+    assertChunkContaintsExactlyInOrder(
+        cppLox::ByteCode::Opcode::CONSTANT, 0, cppLox::ByteCode::Opcode::DEFINE_GLOBAL, 0, 0,
+        cppLox::ByteCode::Opcode::GET_GLOBAL, 0, 0, cppLox::ByteCode::Opcode::CONSTANT, 1,
+        cppLox::ByteCode::Opcode::CALL_INLINED, 1, 0, 0, 0, 4, cppLox::ByteCode::Opcode::GET_LOCAL, 1,
+        cppLox::ByteCode::Opcode::RETURN_INLINED, 2, cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::NULL_,
+        cppLox::ByteCode::Opcode::RETURN);
+    std::optional<cppLox::ByteCode::InlinedCall> const inlinedCall = objectFunction.value()->chunk()->inlinedCallAt(16);
+    ASSERT_TRUE(inlinedCall.has_value());
+    ASSERT_EQ(inlinedCall->function, 0);
+    ASSERT_EQ(inlinedCall->line, 2);
+    ASSERT_FALSE(objectFunction.value()->chunk()->inlinedCallAt(18).has_value());
+}
@@ -0,0 +1,294 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../src/backend/vm.hpp"
+#include "../../src/bytecode/image.hpp"
+#include "../../src/bytecode/image_loader.hpp"
+#include "../../src/bytecode/image_writer.hpp"
+#include "../../src/bytecode/tier.hpp"
+#include "../../src/error/runtime_exception.hpp"
+#include "../../src/frontend/compiler.hpp"
+#include "../../src/frontend/lexer.hpp"
+#include "../../src/memory_mutator.hpp"
+
+// Compiles programs into images and loads them into a memory mutator, that did not compile them
+class ImageIntegrationTest : public ::testing::Test {
+  protected:
+    std::shared_ptr<cppLox::MemoryMutator> compilingMutator = std::make_shared<cppLox::MemoryMutator>();
+    std::shared_ptr<cppLox::MemoryMutator> loadingMutator = std::make_shared<cppLox::MemoryMutator>();
+    cppLox::Frontend::Compiler compiler{compilingMutator, cppLox::ByteCode::Tier::STACK,
+                                        {.optimize = true, .inlining = true}};
+    cppLox::ByteCode::ImageLoader loader{loadingMutator};
+
+    auto compile(std::string source) -> cppLox::Types::ObjectFunction * {
+        cppLox::Frontend::Lexer lexer;
+        std::optional<cppLox::Types::ObjectFunction *> script = compiler.compile(lexer.tokenize(source));
+        EXPECT_TRUE(script.has_value());
+        return script.value_or(nullptr);
+    }
+
+    auto write(cppLox::Types::ObjectFunction & script, uint64_t hash = 0) -> std::vector<uint8_t> {
+        std::optional<std::vector<uint8_t>> image = cppLox::ByteCode::ImageWriter().write(
+            script, *compilingMutator, hash, cppLox::ByteCode::IMAGE_FLAG_OPTIMIZED);
+        EXPECT_TRUE(image.has_value());
+        return image.value_or(std::vector<uint8_t>());
+    }
+
+    // Compares the chunks of both functions and of the functions in their constants
+    auto assertSameFunction(cppLox::Types::ObjectFunction & expected, cppLox::Types::ObjectFunction & actual) -> void {
+        cppLox::ByteCode::Chunk & expectedChunk = *expected.chunk();
+        cppLox::ByteCode::Chunk & actualChunk = *actual.chunk();
+        ASSERT_EQ(expected.arity(), actual.arity());
+        ASSERT_EQ(expected.maxStackDepth(), actual.maxStackDepth());
+        ASSERT_EQ(expected.name()->string(), actual.name()->string());
+        ASSERT_EQ(expectedChunk.code(), actualChunk.code());
+        ASSERT_EQ(expectedChunk.getLineRunCount(), actualChunk.getLineRunCount());
+        for (size_t offset = 0; offset < expectedChunk.getSize(); offset++) {
+            ASSERT_EQ(expectedChunk.getLine(offset), actualChunk.getLine(offset));
+        }
+        ASSERT_EQ(expectedChunk.getInlinedCallCount(), actualChunk.getInlinedCallCount());
+        for (size_t index = 0; index < expectedChunk.getInlinedCallCount(); index++) {
+            ASSERT_EQ(expectedChunk.getInlinedCall(index).start, actualChunk.getInlinedCall(index).start);
+            ASSERT_EQ(expectedChunk.getInlinedCall(index).end, actualChunk.getInlinedCall(index).end);
+            ASSERT_EQ(expectedChunk.getInlinedCall(index).function, actualChunk.getInlinedCall(index).function);
+        }
+        ASSERT_EQ(expectedChunk.getConstantCount(), actualChunk.getConstantCount());
+        for (size_t index = 0; index < expectedChunk.getConstantCount(); index++) {
+            cppLox::Types::Value & expectedConstant = expectedChunk.getConstant(index);
+            cppLox::Types::Value & actualConstant = actualChunk.getConstant(index);
+            ASSERT_EQ(expectedConstant.getType(), actualConstant.getType());
+            if (!expectedConstant.is(cppLox::Types::Value::Type::OBJECT)) {
+                ASSERT_EQ(expectedConstant, actualConstant);
+                continue;
+            }
+            cppLox::Types::Object * expectedObject = expectedConstant.as<cppLox::Types::Object *>();
+            cppLox::Types::Object * actualObject = actualConstant.as<cppLox::Types::Object *>();
+            ASSERT_EQ(expectedObject->type(), actualObject->type());
+            if (expectedObject->is(cppLox::Types::Object::Type::STRING)) {
+                ASSERT_EQ(expectedObject->as<cppLox::Types::ObjectString>()->string(),
+                          actualObject->as<cppLox::Types::ObjectString>()->string());
+            } else if (expectedObject != &expected) {
+                assertSameFunction(*expectedObject->as<cppLox::Types::ObjectFunction>(),
+                                   *actualObject->as<cppLox::Types::ObjectFunction>());
+            }
+        }
+    }
+
+    // Finds the offset of the code of a function in an image, so a test can damage the body of the function
+    auto codeOffset(std::vector<uint8_t> const & image, cppLox::Types::ObjectFunction & function) -> size_t {
+        std::vector<uint8_t> const & code = function.chunk()->code();
+        auto const found = std::search(image.begin(), image.end(), code.begin(), code.end());
+        EXPECT_NE(image.end(), found);
+        return static_cast<size_t>(found - image.begin());
+    }
+
+    // Finds the offset of the first instruction with the given opcode in the code of a function
+    auto instructionOffset(cppLox::Types::ObjectFunction & function, cppLox::ByteCode::Opcode opcode) -> size_t {
+        std::vector<uint8_t> const & code = function.chunk()->code();
+        size_t offset = 0;
+        while (offset < code.size() && code[offset] != opcode) {
+            offset += cppLox::ByteCode::instruction_length(static_cast<cppLox::ByteCode::Opcode>(code[offset]));
+        }
+        EXPECT_LT(offset, code.size());
+        return offset;
+    }
+
+    auto writeNumber(std::vector<uint8_t> & image, size_t offset, uint32_t number) -> void {
+        for (size_t byte = 0; byte < 4; byte++) {
+            image[offset + byte] = static_cast<uint8_t>(number >> (8 * byte));
+        }
+    }
+
+    // The two byte operands of the instructions are big-endian unlike the numbers of the image
+    auto writeOperand(std::vector<uint8_t> & image, size_t offset, uint16_t operand) -> void {
+        image[offset] = static_cast<uint8_t>(operand >> 8);
+        image[offset + 1] = static_cast<uint8_t>(operand);
+    }
+
+    auto run(cppLox::Types::ObjectFunction & script) -> std::string {
+        cppLox::Backend::VM vm(loadingMutator);
+        testing::internal::CaptureStdout();
+        try {
+            vm.interpret(script);
+        } catch (cppLox::Error::RunTimeException const & exception) {
+            std::cout << exception.what();
+        }
+        return testing::internal::GetCapturedStdout();
+    }
+};
+
+TEST_F(ImageIntegrationTest, LoadedProgramProducesSameOutput) {
+    // Arrange
+    std::string source = "var greeting = \"Hello\"; fun fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - "
+                         "2); } fun square(x) { return x * x; } print greeting + \", world\"; print fib(15); print "
+                         "square(0.5) + 1; print -0; print nil == false; print clock() > 0; print fib;";
+    std::vector<uint8_t> image = write(*compile(source));
+
+    // Act
+    std::optional<cppLox::Types::ObjectFunction *> script = loader.load(image);
+
+    // Assert
+    ASSERT_TRUE(script.has_value());
+    ASSERT_EQ("Hello, world\n610\n1.25\n-0\nfalse\ntrue\n<fn fib>\n", run(**script));
+}
+
+TEST_F(ImageIntegrationTest, LoadedFunctionsMatchCompiledFunctions) {
+    // Arrange
+    std::string source = "fun half(x) { return x * 0.5; } fun run() { var total = 0;";
+    for (int number = 1; number <= 300; number++) {
+        source += " total = total + " + std::to_string(number) + ";";
+    }
+    source += " return half(total); } print run(); print \"done\";";
+    cppLox::Types::ObjectFunction * compiled = compile(source);
+    std::vector<uint8_t> image = write(*compiled);
+
+    // Act
+    std::optional<cppLox::Types::ObjectFunction *> loaded = loader.load(image);
+
+    // Assert
+    ASSERT_TRUE(loaded.has_value());
+    assertSameFunction(*compiled, **loaded);
+    ASSERT_EQ("22575\ndone\n", run(**loaded));
+}
+
+TEST_F(ImageIntegrationTest, GlobalSlotsAreResolvedByName) {
+    // Arrange
+    std::vector<uint8_t> image =
+        write(*compile("var count = 1; fun bump() { count = count + 1; } bump(); print count;"));
+    // The slots of the compiling memory mutator are taken by other globals in the loading one
+    loadingMutator->resolveGlobal(
+        loadingMutator->create<cppLox::Types::ObjectString>("bump")->as<cppLox::Types::ObjectString>());
+    loadingMutator->resolveGlobal(
+        loadingMutator->create<cppLox::Types::ObjectString>("other")->as<cppLox::Types::ObjectString>());
+
+    // Act
+    std::optional<cppLox::Types::ObjectFunction *> script = loader.load(image);
+
+    // Assert
+    ASSERT_TRUE(script.has_value());
+    ASSERT_EQ("2\n", run(**script));
+}
+
+TEST_F(ImageIntegrationTest, InvalidImagesAreRejected) {
+    // Arrange
+    std::vector<uint8_t> image = write(*compile("fun f(a) { return a + 1; } print f(1);"), 42);
+    std::vector<uint8_t> truncated(image.begin(), image.end() - 1);
+    std::vector<uint8_t> otherVersion = image;
+    otherVersion[4]++;
+    std::vector<uint8_t> trailing = image;
+    trailing.push_back(0);
+
+    // Act & Assert
+    ASSERT_TRUE(loader.load(image, 42).has_value());
+    ASSERT_FALSE(loader.load(image, 43).has_value());
+    ASSERT_FALSE(loader.load(truncated).has_value());
+    ASSERT_FALSE(loader.load(otherVersion).has_value());
+    ASSERT_FALSE(loader.load(trailing).has_value());
+    ASSERT_FALSE(loader.load(std::vector<uint8_t>()).has_value());
+}
+
+TEST_F(ImageIntegrationTest, LineRunsOutsideOfTheCodeAreRejected) {
+    // Arrange
+    cppLox::Types::ObjectFunction * script = compile("print 1; print 2;");
+    std::vector<uint8_t> image = write(*script);
+    size_t const code = codeOffset(image, *script);
+    // A second run of lines is added behind the first one, that follows the code
+    auto const withSecondRun = [&](uint32_t start) -> std::vector<uint8_t> {
+        std::vector<uint8_t> changed = image;
+        size_t const runs = code + script->chunk()->getSize();
+        changed.insert(changed.begin() + static_cast<std::ptrdiff_t>(runs + 8), 8, 0);
+        writeNumber(changed, code - 12, 2);
+        writeNumber(changed, runs + 8, start);
+        writeNumber(changed, runs + 12, 2);
+        return changed;
+    };
+    std::vector<uint8_t> notAtStart = withSecondRun(3);
+    writeNumber(notAtStart, code + script->chunk()->getSize(), 1);
+
+    // Act & Assert
+    ASSERT_EQ(1, script->chunk()->getLineRunCount());
+    ASSERT_TRUE(loader.load(withSecondRun(3)).has_value());
+    ASSERT_FALSE(loader.load(withSecondRun(50000000)).has_value());
+    ASSERT_FALSE(loader.load(withSecondRun(static_cast<uint32_t>(script->chunk()->getSize()))).has_value());
+    ASSERT_FALSE(loader.load(withSecondRun(0)).has_value());
+    ASSERT_FALSE(loader.load(notAtStart).has_value());
+}
+
+TEST_F(ImageIntegrationTest, JumpsBesideInstructionsAreRejected) {
+    // Arrange
+    cppLox::Types::ObjectFunction * script = compile("var i = clock() * 0; while (i < 3) i = i + 1; print i;");
+    std::vector<uint8_t> image = write(*script);
+    size_t const code = codeOffset(image, *script);
+    size_t const loop = instructionOffset(*script, cppLox::ByteCode::Opcode::LOOP);
+    std::vector<uint8_t> behindStart = image;
+    writeOperand(behindStart, code + loop + 1, static_cast<uint16_t>(loop + 4));
+    std::vector<uint8_t> intoOperand = image;
+    writeOperand(intoOperand, code + loop + 1, 2);
+    std::vector<uint8_t> behindEnd = image;
+    writeOperand(behindEnd, code + instructionOffset(*script, cppLox::ByteCode::Opcode::LESS_JUMP_IF_FALSE) + 1,
+                 UINT16_MAX);
+
+    // Act & Assert
+    ASSERT_TRUE(loader.load(image).has_value());
+    ASSERT_FALSE(loader.load(behindStart).has_value());
+    ASSERT_FALSE(loader.load(intoOperand).has_value());
+    ASSERT_FALSE(loader.load(behindEnd).has_value());
+}
+
+TEST_F(ImageIntegrationTest, LocalsAboveTheStackAreRejected) {
+    // Arrange
+    cppLox::Types::ObjectFunction * script = compile("fun f(a) { return a; } print f(1);");
+    cppLox::Types::ObjectFunction * function =
+        script->chunk()->getConstant(0).as<cppLox::Types::Object *>()->as<cppLox::Types::ObjectFunction>();
+    std::vector<uint8_t> image = write(*script);
+    std::vector<uint8_t> aboveStack = image;
+    aboveStack[codeOffset(image, *function) + instructionOffset(*function, cppLox::ByteCode::Opcode::GET_LOCAL) + 1] =
+        1;
+
+    // Act & Assert
+    ASSERT_TRUE(loader.load(image).has_value());
+    ASSERT_FALSE(loader.load(aboveStack).has_value());
+}
+
+TEST_F(ImageIntegrationTest, MaximumStackDepthBelowTheStackIsRejected) {
+    // Arrange
+    cppLox::Types::ObjectFunction * script = compile("fun f(a, b) { return a + b * 2; } print f(1, 2);");
+    cppLox::Types::ObjectFunction * function =
+        script->chunk()->getConstant(0).as<cppLox::Types::Object *>()->as<cppLox::Types::ObjectFunction>();
+    std::vector<uint8_t> image = write(*script);
+    // The maximum stack depth is the first field of a body, five fields before the code
+    std::vector<uint8_t> tooShallow = image;
+    writeNumber(tooShallow, codeOffset(image, *function) - 20, function->maxStackDepth() - 1);
+
+    // Act & Assert
+    ASSERT_TRUE(loader.load(image).has_value());
+    ASSERT_FALSE(loader.load(tooShallow).has_value());
+}
+
+TEST_F(ImageIntegrationTest, SavedImageIsMappedFromFile) {
+    // Arrange
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                 std::format("cpplox-image-test-{}", std::random_device()()) / "script.loxc";
+    std::vector<uint8_t> image = write(*compile("print \"mapped\";"));
+
+    // Act
+    bool saved = cppLox::ByteCode::ImageWriter::save(image, path);
+    std::optional<cppLox::Types::ObjectFunction *> script = loader.loadFile(path);
+    std::optional<cppLox::Types::ObjectFunction *> missing = loader.loadFile(path.parent_path() / "missing.loxc");
+    std::filesystem::remove_all(path.parent_path());
+
+    // Assert
+    ASSERT_TRUE(saved);
+    ASSERT_TRUE(script.has_value());
+    ASSERT_FALSE(missing.has_value());
+    ASSERT_EQ("mapped\n", run(**script));
+}
@@ -3,9 +3,11 @@
 #include "../../src/bytecode/opcode.hpp"
 #include "../../src/error/runtime_exception.hpp"
 #include "../../src/frontend/compiler.hpp"
+#include "../../src/types/object_native_fuction.hpp"
 #include "../../src/types/value.hpp"
 
 #include <ranges>
+#include <span>
 #include <variant>
 
 #include <gtest/gtest.h>
@@ -21,6 +23,8 @@ class VMIntegrationTest : public ::testing::Test {
     VMIntegrationTest() : function(0, &functionName) {
         memoryMutator = std::make_shared<cppLox::MemoryMutator>();
         vm = std::make_unique<cppLox::Backend::VM>(memoryMutator);
+        // The bytecode of the tests is not emitted by the compiler, that determines the stack depth of a function
+        function.updateMaxStackDepth(UINT8_MAX);
     }
 
     auto SetUp() -> void override {
@@ -42,6 +46,10 @@ class VMIntegrationTest : public ::testing::Test {
         return vm->m_frames[0];
     }
 
+    auto getFrameCount() -> size_t {
+        return vm->m_frame_count;
+    }
+
     auto interpret() -> void {
         vm->interpret(function);
         // The value on top of the stack is popped when the function returns,
@@ -83,6 +91,154 @@ TEST_F(VMIntegrationTest, AddInstructionUsingStrings) {
     ASSERT_STREQ("Hello World!", result);
 }
 
+TEST_F(VMIntegrationTest, AddInstructionIsQuickenedForNumbers) {
+    // Arrange
+    cppLox::Types::Value value(42.0);
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT, function.chunk()->addConstant(value),
+                         cppLox::ByteCode::Opcode::CONSTANT, function.chunk()->addConstant(value),
+                         cppLox::ByteCode::Opcode::ADD, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act
+    interpret();
+
+    // Assert
+    EXPECT_EQ(cppLox::ByteCode::Opcode::ADD_NUM_NUM, function.chunk()->getByte(4));
+    EXPECT_EQ(cppLox::Types::Value(42.0 + 42.0), vm->pop(getTopFrame()));
+}
+
+TEST_F(VMIntegrationTest, QuickenedAddInstructionFallsBackForStrings) {
+    // Arrange
+    cppLox::Types::Value value(memoryMutator->create<cppLox::Types::ObjectString>("Hello "));
+    cppLox::Types::Value value2(memoryMutator->create<cppLox::Types::ObjectString>("World!"));
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT, function.chunk()->addConstant(value),
+                         cppLox::ByteCode::Opcode::CONSTANT, function.chunk()->addConstant(value2),
+                         cppLox::ByteCode::Opcode::ADD_NUM_NUM, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act
+    interpret();
+    char const * result =
+        vm->pop(getTopFrame()).as<cppLox::Types::Object *>()->as<cppLox::Types::ObjectString>()->string().c_str();
+
+    // Assert
+    EXPECT_EQ(cppLox::ByteCode::Opcode::ADD, function.chunk()->getByte(4));
+    ASSERT_STREQ("Hello World!", result);
+}
+
+TEST_F(VMIntegrationTest, QuickenedLessJumpIfFalseInstructionFallsBackForStrings) {
+    // Arrange
+    cppLox::Types::Value value(memoryMutator->create<cppLox::Types::ObjectString>("a"));
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::CONSTANT,
+                         function.chunk()->addConstant(value), cppLox::ByteCode::Opcode::CONSTANT,
+                         function.chunk()->addConstant(value), cppLox::ByteCode::Opcode::LESS_JUMP_IF_FALSE_NUM_NUM,
+                         size_t{0}, size_t{0}, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act & Assert
+    ASSERT_THROW(interpret(), cppLox::Error::RunTimeException);
+    EXPECT_EQ(cppLox::ByteCode::Opcode::LESS_JUMP_IF_FALSE, function.chunk()->getByte(5));
+}
+
+#ifdef JIT
+TEST_F(VMIntegrationTest, FunctionIsCompiledWhenItReachesTheJitThreshold) {
+    // Arrange
+    vm->setJitThreshold(2);
+    cppLox::Types::ObjectString calleeName("callee");
+    cppLox::Types::ObjectFunction callee(0, &calleeName);
+    callee.updateMaxStackDepth(2);
+    callee.chunk()->write(cppLox::ByteCode::Opcode::TRUE, 0);
+    callee.chunk()->write(cppLox::ByteCode::Opcode::RETURN, 0);
+    size_t constant = function.chunk()->addConstant(cppLox::Types::Value(&callee));
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT, constant, cppLox::ByteCode::Opcode::CALL, size_t{0},
+                         cppLox::ByteCode::Opcode::POP, cppLox::ByteCode::Opcode::CONSTANT, constant,
+                         cppLox::ByteCode::Opcode::CALL, size_t{0}, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act
+    interpret();
+
+    // Assert
+    ASSERT_NE(nullptr, callee.nativeCode());
+    EXPECT_EQ(cppLox::Types::Value(true), vm->pop(getTopFrame()));
+}
+
+TEST_F(VMIntegrationTest, FunctionIsNotCompiledBelowTheJitThreshold) {
+    // Arrange
+    vm->setJitThreshold(2);
+    cppLox::Types::ObjectString calleeName("callee");
+    cppLox::Types::ObjectFunction callee(0, &calleeName);
+    callee.updateMaxStackDepth(2);
+    callee.chunk()->write(cppLox::ByteCode::Opcode::TRUE, 0);
+    callee.chunk()->write(cppLox::ByteCode::Opcode::RETURN, 0);
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT,
+                         function.chunk()->addConstant(cppLox::Types::Value(&callee)), cppLox::ByteCode::Opcode::CALL,
+                         size_t{0}, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act
+    interpret();
+
+    // Assert
+    ASSERT_EQ(nullptr, callee.nativeCode());
+    EXPECT_EQ(cppLox::Types::Value(true), vm->pop(getTopFrame()));
+}
+#endif
+
+TEST_F(VMIntegrationTest, CallInstructionWithNativeFunction) {
+    // Arrange
+    cppLox::Types::ObjectNativeFunction native(
+        [](std::span<cppLox::Types::Value> args) -> cppLox::Types::NativeResult {
+            return {cppLox::Types::Value(args[0].as<double>() * 2)};
+        },
+        1);
+    size_t const callee = function.chunk()->addConstant(cppLox::Types::Value(&native));
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT, callee,
+                         cppLox::ByteCode::Opcode::CONSTANT, function.chunk()->addConstant(cppLox::Types::Value(21.0)),
+                         cppLox::ByteCode::Opcode::CALL, size_t{1}, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act
+    interpret();
+
+    // Assert
+    ASSERT_EQ(cppLox::Types::Value(42.0), vm->pop(getTopFrame()));
+}
+
+TEST_F(VMIntegrationTest, CallInstructionWithNativeFunctionRaisingError) {
+    // Arrange
+    cppLox::Types::ObjectNativeFunction native(
+        [](std::span<cppLox::Types::Value>) -> cppLox::Types::NativeResult {
+            return {cppLox::Types::Value(), "Native error"};
+        },
+        0);
+    size_t const callee = function.chunk()->addConstant(cppLox::Types::Value(&native));
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT, callee,
+                         cppLox::ByteCode::Opcode::CALL, size_t{0}, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act & Assert
+    try {
+        vm->interpret(function);
+        FAIL() << "Expected a runtime exception";
+    } catch (cppLox::Error::RunTimeException const & exception) {
+        ASSERT_TRUE(std::string(exception.what()).starts_with("Native error"));
+    }
+}
+
+TEST_F(VMIntegrationTest, CallInstructionWithNativeFunctionUsingErrorCallback) {
+    // Arrange
+    cppLox::Types::ObjectNativeFunction native(
+        [](int, cppLox::Types::Value * args, cppLox::Backend::CallFrame &,
+           std::function<void(cppLox::Backend::CallFrame &, std::string_view)>) -> cppLox::Types::Value {
+            return cppLox::Types::Value(args[0].as<double>() + 1);
+        },
+        1);
+    size_t const callee = function.chunk()->addConstant(cppLox::Types::Value(&native));
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT, callee,
+                         cppLox::ByteCode::Opcode::CONSTANT, function.chunk()->addConstant(cppLox::Types::Value(41.0)),
+                         cppLox::ByteCode::Opcode::CALL, size_t{1}, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act
+    interpret();
+
+    // Assert
+    ASSERT_EQ(cppLox::Types::Value(42.0), vm->pop(getTopFrame()));
+}
+
 TEST_F(VMIntegrationTest, ConstantInstruction) {
     // Arrange
     cppLox::Types::Value value(42.0);
@@ -148,31 +304,31 @@ TEST_F(VMIntegrationTest, FalseInstruction) {
 TEST_F(VMIntegrationTest, GlobalVariableDeclaration) {
     // Arrange
     auto variableNameObjectString = std::make_unique<cppLox::Types::ObjectString>("a");
-    writeMultipleToChunk(cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::DEFINE_GLOBAL,
-                         function.chunk()->addConstant(cppLox::Types::Value(variableNameObjectString.get())),
-                         cppLox::ByteCode::Opcode::RETURN);
+    size_t slot = memoryMutator->resolveGlobal(variableNameObjectString.get());
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::DEFINE_GLOBAL, slot >> 8,
+                         slot & 0xff, cppLox::ByteCode::Opcode::RETURN);
 
     // Act
     interpret();
 
     // Assert
-    ASSERT_TRUE(memoryMutator->setGlobal(variableNameObjectString.get(), cppLox::Types::Value()));
+    ASSERT_TRUE(memoryMutator->setGlobal(slot, cppLox::Types::Value()));
 }
 
 TEST_F(VMIntegrationTest, GlobalVariableDeclarationAndAssignment) {
     // Arrange
     cppLox::Types::Value value(42.0);
     auto variableNameObjectString = std::make_unique<cppLox::Types::ObjectString>("a");
+    size_t slot = memoryMutator->resolveGlobal(variableNameObjectString.get());
     writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT, function.chunk()->addConstant(value),
-                         cppLox::ByteCode::Opcode::DEFINE_GLOBAL,
-                         function.chunk()->addConstant(cppLox::Types::Value(variableNameObjectString.get())),
+                         cppLox::ByteCode::Opcode::DEFINE_GLOBAL, slot >> 8, slot & 0xff,
                          cppLox::ByteCode::Opcode::RETURN);
 
     // Act
     interpret();
 
     // Assert
-    ASSERT_EQ(cppLox::Types::Value(42.0), memoryMutator->getGlobal(variableNameObjectString.get()));
+    ASSERT_EQ(cppLox::Types::Value(42.0), memoryMutator->getGlobal(slot));
 }
 
 TEST_F(VMIntegrationTest, GreaterInstruction) {
@@ -423,16 +579,18 @@ TEST_F(VMIntegrationTest, ReturnInstruction) {
 
 TEST_F(VMIntegrationTest, StackOverflow) {
     // Arrange
-    cppLox::Types::Value value(42.0);
-    for (auto i : std::views::iota(0, STACK_MAX - 1)) {
-        vm->push(getTopFrame(), value);
-    }
-    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT, function.chunk()->addConstant(value));
+    // The function calls itself until the value stack is exhausted
+    vm->setFrameLimit(SIZE_MAX);
+    size_t constant = function.chunk()->addConstant(cppLox::Types::Value(&function));
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT, constant, cppLox::ByteCode::Opcode::CALL, size_t{0},
+                         cppLox::ByteCode::Opcode::RETURN);
 
     // Act & Assert
     ASSERT_THROW(vm->interpret(function), cppLox::Error::RunTimeException);
 }
 
+// The stack is only checked for underflows in debug builds, compiled code never pops more values than it pushed
+#ifndef NDEBUG
 TEST_F(VMIntegrationTest, StackUnderflow) {
     // Arrange
     writeMultipleToChunk(cppLox::ByteCode::Opcode::ADD);
@@ -440,6 +598,7 @@ TEST_F(VMIntegrationTest, StackUnderflow) {
     // Act & Assert
     ASSERT_THROW(vm->interpret(function), cppLox::Error::RunTimeException);
 }
+#endif
 
 TEST_F(VMIntegrationTest, SubtractInstruction) {
     // Arrange
@@ -455,6 +614,55 @@ TEST_F(VMIntegrationTest, SubtractInstruction) {
     ASSERT_EQ(value - value, vm->pop(getTopFrame()));
 }
 
+TEST_F(VMIntegrationTest, TryInterpretReturnsOk) {
+    // Arrange
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act
+    cppLox::Backend::InterpretResult const result = vm->tryInterpret(function);
+
+    // Assert
+    ASSERT_EQ(cppLox::Backend::InterpretResult::OK, result);
+    ASSERT_TRUE(vm->errorMessage().empty());
+}
+
+TEST_F(VMIntegrationTest, TryInterpretRecordsRuntimeErrorWithoutThrowing) {
+    // Arrange
+    cppLox::Types::Value value(memoryMutator->create<cppLox::Types::ObjectString>("a"));
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT, function.chunk()->addConstant(value),
+                         cppLox::ByteCode::Opcode::NEGATE, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act
+    cppLox::Backend::InterpretResult result = cppLox::Backend::InterpretResult::OK;
+    ASSERT_NO_THROW(result = vm->tryInterpret(function));
+
+    // Assert
+    ASSERT_EQ(cppLox::Backend::InterpretResult::RUNTIME_ERROR, result);
+    ASSERT_EQ("Runtime error: unary negation is only defined for numbers", vm->errorMessage());
+}
+
+TEST_F(VMIntegrationTest, TryInterpretUnwindsCallFramesOnRuntimeError) {
+    // Arrange
+    cppLox::Types::ObjectString calleeName("callee");
+    cppLox::Types::ObjectFunction callee(0, &calleeName);
+    callee.updateMaxStackDepth(UINT8_MAX);
+    callee.chunk()->write(cppLox::ByteCode::Opcode::TRUE, 0);
+    callee.chunk()->write(cppLox::ByteCode::Opcode::TRUE, 0);
+    callee.chunk()->write(cppLox::ByteCode::Opcode::SUBTRACT, 0);
+    callee.chunk()->write(cppLox::ByteCode::Opcode::RETURN, 0);
+    writeMultipleToChunk(cppLox::ByteCode::Opcode::CONSTANT,
+                         function.chunk()->addConstant(cppLox::Types::Value(&callee)), cppLox::ByteCode::Opcode::CALL,
+                         size_t{0}, cppLox::ByteCode::Opcode::RETURN);
+
+    // Act
+    cppLox::Backend::InterpretResult const result = vm->tryInterpret(function);
+
+    // Assert
+    ASSERT_EQ(cppLox::Backend::InterpretResult::RUNTIME_ERROR, result);
+    ASSERT_EQ("subtraction is only defined for numbers", vm->errorMessage());
+    ASSERT_EQ(0, getFrameCount());
+}
+
 TEST_F(VMIntegrationTest, TrueInstruction) {
     // Arrange
     writeMultipleToChunk(cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::RETURN);
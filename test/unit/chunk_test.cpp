@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 
 #include <utility>
+#include <vector>
 
 class ChunkTest : public ::testing::Test {
   protected:
@@ -50,6 +51,117 @@ TEST_F(ChunkTest, GetLine) {
     EXPECT_EQ(result, 123);
 }
 
+TEST_F(ChunkTest, BytesOfTheSameLineShareARun) {
+    // Arrange
+    chunk.write(cppLox::ByteCode::Opcode::CONSTANT, 1);
+    chunk.write(0, 1);
+    chunk.write(cppLox::ByteCode::Opcode::PRINT, 1);
+    chunk.write(cppLox::ByteCode::Opcode::NULL_, 4);
+    chunk.write(cppLox::ByteCode::Opcode::POP, 4);
+    chunk.write(cppLox::ByteCode::Opcode::RETURN, 1);
+
+    // Act
+    size_t const runs = chunk.getLineRunCount();
+
+    // Assert
+    EXPECT_EQ(runs, 3);
+    EXPECT_EQ(chunk.getLine(0), 1);
+    EXPECT_EQ(chunk.getLine(2), 1);
+    EXPECT_EQ(chunk.getLine(3), 4);
+    EXPECT_EQ(chunk.getLine(4), 4);
+    EXPECT_EQ(chunk.getLine(5), 1);
+}
+
+TEST_F(ChunkTest, TruncateRemovesLineRuns) {
+    // Arrange
+    chunk.write(cppLox::ByteCode::Opcode::NULL_, 1);
+    chunk.write(cppLox::ByteCode::Opcode::NULL_, 2);
+    chunk.write(cppLox::ByteCode::Opcode::NULL_, 3);
+
+    // Act
+    chunk.truncate(1);
+    chunk.write(cppLox::ByteCode::Opcode::RETURN, 1);
+
+    // Assert
+    EXPECT_EQ(chunk.getLineRunCount(), 1);
+    EXPECT_EQ(chunk.getLine(1), 1);
+}
+
+TEST_F(ChunkTest, BytesWrittenAtOnceShareARun) {
+    // Arrange
+    std::vector<uint8_t> bytes = {cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::POP};
+
+    // Act
+    chunk.write(bytes, 1);
+    chunk.write(bytes, 2);
+
+    // Assert
+    EXPECT_EQ(chunk.getSize(), 4);
+    EXPECT_EQ(chunk.getLineRunCount(), 2);
+    EXPECT_EQ(chunk.getLineRun(1).start, 2);
+    EXPECT_EQ(chunk.getLine(1), 1);
+    EXPECT_EQ(chunk.getLine(3), 2);
+}
+
+TEST_F(ChunkTest, TruncateAndPopConstant) {
+    // Arrange
+    chunk.write(cppLox::ByteCode::Opcode::CONSTANT, 1);
+    chunk.write(chunk.addConstant(1.2), 1);
+    chunk.write(cppLox::ByteCode::Opcode::CONSTANT, 2);
+    chunk.write(chunk.addConstant(3.4), 2);
+
+    // Act
+    chunk.truncate(2);
+    chunk.popConstant();
+    chunk.write(cppLox::ByteCode::Opcode::NEGATE, 3);
+
+    // Assert
+    EXPECT_EQ(chunk.getSize(), 3);
+    EXPECT_EQ(chunk.getConstantCount(), 1);
+    EXPECT_EQ(chunk.getByte(2), cppLox::ByteCode::Opcode::NEGATE);
+    EXPECT_EQ(chunk.getLine(2), 3);
+}
+
+TEST_F(ChunkTest, EqualConstantsAddedOnce) {
+    // Arrange
+    size_t const first = chunk.addConstant(cppLox::Types::Value(1.5));
+    size_t const second = chunk.addConstant(cppLox::Types::Value(true));
+
+    // Act
+    size_t const repeated = chunk.addConstant(cppLox::Types::Value(1.5));
+
+    // Assert
+    EXPECT_EQ(repeated, first);
+    EXPECT_NE(second, first);
+    EXPECT_EQ(chunk.getConstantCount(), 2);
+    EXPECT_EQ(chunk.findConstant(cppLox::Types::Value(true)), second);
+}
+
+TEST_F(ChunkTest, ZeroAndNegativeZeroAreDifferentConstants) {
+    // Arrange
+    size_t const zero = chunk.addConstant(cppLox::Types::Value(0.0));
+
+    // Act
+    size_t const negativeZero = chunk.addConstant(cppLox::Types::Value(-0.0));
+
+    // Assert
+    EXPECT_NE(negativeZero, zero);
+    EXPECT_EQ(chunk.getConstantCount(), 2);
+}
+
+TEST_F(ChunkTest, PoppedConstantIsNotFound) {
+    // Arrange
+    static_cast<void>(chunk.addConstant(cppLox::Types::Value(1.0)));
+    static_cast<void>(chunk.addConstant(cppLox::Types::Value(2.0)));
+
+    // Act
+    chunk.popConstant();
+
+    // Assert
+    EXPECT_FALSE(chunk.findConstant(cppLox::Types::Value(2.0)).has_value());
+    EXPECT_EQ(chunk.addConstant(cppLox::Types::Value(2.0)), 1);
+}
+
 // Test suite for dissassembling simple instructions using parameterized tests
 class ChunkParameterizedSimpleInstructionTestFixture
     : public ChunkTest,
@@ -58,6 +170,7 @@ class ChunkParameterizedSimpleInstructionTestFixture
 // The parameters for this test suite are a pair of Opcode and the expected string output for that opcode
 INSTANTIATE_TEST_SUITE_P(ChunkTest, ChunkParameterizedSimpleInstructionTestFixture,
                          ::testing::Values(std::make_pair(cppLox::ByteCode::Opcode::ADD, "ADD"),
+                                           std::make_pair(cppLox::ByteCode::Opcode::ADD_NUM_NUM, "ADD_NUM_NUM"),
                                            std::make_pair(cppLox::ByteCode::Opcode::DIVIDE, "DIVIDE"),
                                            std::make_pair(cppLox::ByteCode::Opcode::EQUAL, "EQUAL"),
                                            std::make_pair(cppLox::ByteCode::Opcode::FALSE, "FALSE"),
@@ -65,6 +178,7 @@ INSTANTIATE_TEST_SUITE_P(ChunkTest, ChunkParameterizedSimpleInstructionTestFixtu
                                            std::make_pair(cppLox::ByteCode::Opcode::GREATER_EQUAL, "GREATER_EQUAL"),
                                            std::make_pair(cppLox::ByteCode::Opcode::LESS, "LESS"),
                                            std::make_pair(cppLox::ByteCode::Opcode::LESS_EQUAL, "LESS_EQUAL"),
+                                           std::make_pair(cppLox::ByteCode::Opcode::LESS_NUM_NUM, "LESS_NUM_NUM"),
                                            std::make_pair(cppLox::ByteCode::Opcode::MULTIPLY, "MULTIPLY"),
                                            std::make_pair(cppLox::ByteCode::Opcode::NEGATE, "NEGATE"),
                                            std::make_pair(cppLox::ByteCode::Opcode::NOT, "NOT"),
@@ -95,10 +209,7 @@ class ChunkParameterizedConstantInstructionTestFixture
       public ::testing::WithParamInterface<std::pair<cppLox::ByteCode::Opcode, std::string>> {};
 
 INSTANTIATE_TEST_SUITE_P(ChunkTest, ChunkParameterizedConstantInstructionTestFixture,
-                         ::testing::Values(std::make_pair(cppLox::ByteCode::Opcode::CONSTANT, "CONSTANT"),
-                                           std::make_pair(cppLox::ByteCode::Opcode::DEFINE_GLOBAL, "DEFINE_GLOBAL"),
-                                           std::make_pair(cppLox::ByteCode::Opcode::GET_GLOBAL, "GET_GLOBAL"),
-                                           std::make_pair(cppLox::ByteCode::Opcode::SET_GLOBAL, "SET_GLOBAL")));
+                         ::testing::Values(std::make_pair(cppLox::ByteCode::Opcode::CONSTANT, "CONSTANT")));
 
 TEST_P(ChunkParameterizedConstantInstructionTestFixture, WriteOpCode) {
     // Arrange
@@ -116,6 +227,52 @@ TEST_P(ChunkParameterizedConstantInstructionTestFixture, WriteOpCode) {
     EXPECT_EQ(output, std::format("== test chunk ==\n0X0000  123 {:>16}{:>16} '{}'\n", expected, 0, value));
 }
 
+TEST_F(ChunkTest, DisassembleConstantLong) {
+    // Arrange
+    for (int index = 0; index < 300; index++) {
+        static_cast<void>(chunk.addConstant(cppLox::Types::Value(static_cast<double>(index))));
+    }
+    chunk.write(cppLox::ByteCode::Opcode::CONSTANT_LONG, 123);
+    chunk.write(1, 123);
+    chunk.write(2, 123);
+    testing::internal::CaptureStdout();
+
+    // Act
+    chunk.disassemble("test chunk");
+    std::string output = testing::internal::GetCapturedStdout();
+
+    // Assert
+    EXPECT_EQ(output, std::format("== test chunk ==\n0X0000  123 {:>16}{:>16} '{}'\n", "CONSTANT_LONG", 258,
+                                  cppLox::Types::Value(258.0)));
+}
+
+// Test suite for dissassembling instructions that access a global slot
+class ChunkParameterizedGlobalInstructionTestFixture
+    : public ChunkTest,
+      public ::testing::WithParamInterface<std::pair<cppLox::ByteCode::Opcode, std::string>> {};
+
+INSTANTIATE_TEST_SUITE_P(ChunkTest, ChunkParameterizedGlobalInstructionTestFixture,
+                         ::testing::Values(std::make_pair(cppLox::ByteCode::Opcode::DEFINE_GLOBAL, "DEFINE_GLOBAL"),
+                                           std::make_pair(cppLox::ByteCode::Opcode::GET_GLOBAL, "GET_GLOBAL"),
+                                           std::make_pair(cppLox::ByteCode::Opcode::SET_GLOBAL, "SET_GLOBAL")));
+
+TEST_P(ChunkParameterizedGlobalInstructionTestFixture, WriteOpCode) {
+    // Arrange
+    uint16_t slot = 258;
+    auto [opcode, expected] = GetParam();
+    chunk.write(opcode, 123);
+    chunk.write(static_cast<uint8_t>(slot >> 8), 123);
+    chunk.write(static_cast<uint8_t>(slot & 0xff), 123);
+    testing::internal::CaptureStdout();
+
+    // Act
+    chunk.disassemble("test chunk");
+    std::string output = testing::internal::GetCapturedStdout();
+
+    // Assert
+    EXPECT_EQ(output, std::format("== test chunk ==\n0X0000  123 {:>16}{:>16}\n", expected, slot));
+}
+
 class ChunkParameterizedByteInstructionTestFixture
     : public ChunkTest,
       public ::testing::WithParamInterface<std::pair<cppLox::ByteCode::Opcode, std::string>> {};
@@ -148,7 +305,9 @@ class ChunkParameterizedJumpInstructionTestFixture
 INSTANTIATE_TEST_SUITE_P(ChunkTest, ChunkParameterizedJumpInstructionTestFixture,
                          ::testing::Values(std::make_pair(cppLox::ByteCode::Opcode::LOOP, "LOOP"),
                                            std::make_pair(cppLox::ByteCode::Opcode::JUMP, "JUMP"),
-                                           std::make_pair(cppLox::ByteCode::Opcode::JUMP_IF_FALSE, "JUMP_IF_FALSE")));
+                                           std::make_pair(cppLox::ByteCode::Opcode::JUMP_IF_FALSE, "JUMP_IF_FALSE"),
+                                           std::make_pair(cppLox::ByteCode::Opcode::POP_JUMP_IF_TRUE,
+                                                          "POP_JUMP_IF_TRUE")));
 
 TEST_P(ChunkParameterizedJumpInstructionTestFixture, WriteOpCode) {
     // Arrange
@@ -0,0 +1,61 @@
+#include "../../src/backend/dispatch_profile.hpp"
+#include "../../src/bytecode/opcode.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(DispatchProfileTest, CountsOpcodesPairsAndTriples) {
+    // Arrange
+    cppLox::Backend::DispatchProfile profile;
+
+    // Act
+    for (int i = 0; i < 3; i++) {
+        profile.record(cppLox::ByteCode::Opcode::GET_LOCAL);
+        profile.record(cppLox::ByteCode::Opcode::CONSTANT);
+        profile.record(cppLox::ByteCode::Opcode::LESS);
+    }
+
+    // Assert
+    EXPECT_EQ(9u, profile.dispatches());
+    EXPECT_EQ(3u, profile.count(cppLox::ByteCode::Opcode::GET_LOCAL));
+    EXPECT_EQ(3u, profile.count(cppLox::ByteCode::Opcode::GET_LOCAL, cppLox::ByteCode::Opcode::CONSTANT));
+    EXPECT_EQ(2u, profile.count(cppLox::ByteCode::Opcode::LESS, cppLox::ByteCode::Opcode::GET_LOCAL));
+    EXPECT_EQ(3u, profile.count(cppLox::ByteCode::Opcode::GET_LOCAL, cppLox::ByteCode::Opcode::CONSTANT,
+                                cppLox::ByteCode::Opcode::LESS));
+    EXPECT_EQ(0u, profile.count(cppLox::ByteCode::Opcode::LESS, cppLox::ByteCode::Opcode::LESS,
+                                cppLox::ByteCode::Opcode::LESS));
+}
+
+TEST(DispatchProfileTest, DoesNotRecordSequencesAcrossBreaks) {
+    // Arrange
+    cppLox::Backend::DispatchProfile profile;
+
+    // Act
+    profile.record(cppLox::ByteCode::Opcode::ADD);
+    profile.breakSequence();
+    profile.record(cppLox::ByteCode::Opcode::POP);
+
+    // Assert
+    EXPECT_EQ(2u, profile.dispatches());
+    EXPECT_EQ(0u, profile.count(cppLox::ByteCode::Opcode::ADD, cppLox::ByteCode::Opcode::POP));
+}
+
+TEST(DispatchProfileTest, OrdersSequencesByFrequency) {
+    // Arrange
+    cppLox::Backend::DispatchProfile profile;
+    profile.record(cppLox::ByteCode::Opcode::SET_LOCAL);
+    profile.record(cppLox::ByteCode::Opcode::POP);
+    profile.record(cppLox::ByteCode::Opcode::SET_LOCAL);
+    profile.record(cppLox::ByteCode::Opcode::POP);
+    profile.record(cppLox::ByteCode::Opcode::LOOP);
+
+    // Act
+    auto pairs = profile.mostFrequentPairs(1);
+    auto triples = profile.mostFrequentTriples(10);
+
+    // Assert
+    ASSERT_EQ(1u, pairs.size());
+    EXPECT_EQ(cppLox::ByteCode::Opcode::SET_LOCAL, pairs[0].opcodes[0]);
+    EXPECT_EQ(cppLox::ByteCode::Opcode::POP, pairs[0].opcodes[1]);
+    EXPECT_EQ(2u, pairs[0].count);
+    EXPECT_EQ(3u, triples.size());
+}
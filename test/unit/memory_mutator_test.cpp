@@ -1,5 +1,9 @@
 #include "../../src/memory_mutator.hpp"
 #include "../../src/types/object.hpp"
+#include "../../src/types/object_function.hpp"
+
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -24,11 +28,316 @@ TEST_F(MemoryMutatorTest, CanGetGlobal) {
     // Arrange
     auto globalName = std::make_unique<cppLox::Types::ObjectString>("foo");
     auto globalValue = cppLox::Types::Value(1.0);
-    memoryMutator->setGlobal(globalName.get(), globalValue);
+    size_t slot = memoryMutator->resolveGlobal(globalName.get());
+    memoryMutator->defineGlobal(slot, globalValue);
 
     // Act
-    auto gottenValue = memoryMutator->getGlobal(globalName.get());
+    auto gottenValue = memoryMutator->getGlobal(slot);
 
     // Assert
     EXPECT_EQ(globalValue, gottenValue);
 }
+
+TEST_F(MemoryMutatorTest, ResolvesGlobalsWithTheSameNameToTheSameSlot) {
+    // Arrange
+    auto globalName = std::make_unique<cppLox::Types::ObjectString>("foo");
+    auto sameGlobalName = std::make_unique<cppLox::Types::ObjectString>("foo");
+    auto otherGlobalName = std::make_unique<cppLox::Types::ObjectString>("bar");
+
+    // Act
+    size_t slot = memoryMutator->resolveGlobal(globalName.get());
+    size_t sameSlot = memoryMutator->resolveGlobal(sameGlobalName.get());
+    size_t otherSlot = memoryMutator->resolveGlobal(otherGlobalName.get());
+
+    // Assert
+    EXPECT_EQ(slot, sameSlot);
+    EXPECT_NE(slot, otherSlot);
+}
+
+TEST_F(MemoryMutatorTest, CannotSetUndefinedGlobal) {
+    // Arrange
+    auto globalName = std::make_unique<cppLox::Types::ObjectString>("foo");
+    size_t slot = memoryMutator->resolveGlobal(globalName.get());
+
+    // Act
+    bool set = memoryMutator->setGlobal(slot, cppLox::Types::Value(1.0));
+
+    // Assert
+    EXPECT_FALSE(set);
+    EXPECT_EQ(cppLox::Types::Value(), memoryMutator->getGlobal(slot));
+}
+
+// Marks the objects it holds as roots of the garbage collector
+class TestRootSource : public cppLox::RootSource {
+  public:
+    auto markRoots(cppLox::MemoryMutator & memoryMutator) -> void override {
+        for (cppLox::Types::Object * object : objects) {
+            memoryMutator.markObject(object);
+        }
+        for (cppLox::Types::Value & value : values) {
+            memoryMutator.markValue(value);
+        }
+    }
+
+    std::vector<cppLox::Types::Object *> objects;
+    std::vector<cppLox::Types::Value> values;
+};
+
+TEST_F(MemoryMutatorTest, CollectsUnreachableObjects) {
+    // Arrange
+    memoryMutator->create<cppLox::Types::ObjectString>("unreachable");
+    memoryMutator->create<cppLox::Types::ObjectFunction>(0, nullptr);
+
+    // Act
+    memoryMutator->collectGarbage();
+
+    // Assert
+    EXPECT_EQ(0, memoryMutator->bytesAllocated());
+}
+
+TEST_F(MemoryMutatorTest, KeepsObjectsReferencedByGlobals) {
+    // Arrange
+    cppLox::Types::Object * name = memoryMutator->create<cppLox::Types::ObjectString>("foo");
+    cppLox::Types::Object * value = memoryMutator->create<cppLox::Types::ObjectString>("bar");
+    size_t slot = memoryMutator->resolveGlobal(name->as<cppLox::Types::ObjectString>());
+    memoryMutator->defineGlobal(slot, cppLox::Types::Value(value));
+    size_t const bytesAllocated = memoryMutator->bytesAllocated();
+
+    // Act
+    memoryMutator->collectGarbage();
+
+    // Assert
+    EXPECT_EQ(bytesAllocated, memoryMutator->bytesAllocated());
+    EXPECT_EQ("bar", memoryMutator->getGlobal(slot).as<cppLox::Types::Object *>()->as<cppLox::Types::ObjectString>()
+                         ->string());
+}
+
+TEST_F(MemoryMutatorTest, TracesTheReferencesOfRootFunctions) {
+    // Arrange
+    TestRootSource rootSource;
+    memoryMutator->addRootSource(&rootSource);
+    cppLox::Types::Object * name = memoryMutator->create<cppLox::Types::ObjectString>("function");
+    cppLox::Types::Object * function =
+        memoryMutator->create<cppLox::Types::ObjectFunction>(0, name->as<cppLox::Types::ObjectString>());
+    cppLox::Types::Object * constant = memoryMutator->create<cppLox::Types::ObjectString>("constant");
+    static_cast<void>(function->as<cppLox::Types::ObjectFunction>()->chunk()->addConstant(constant));
+    rootSource.objects.push_back(function);
+
+    // Act
+    memoryMutator->collectGarbage();
+    memoryMutator->removeRootSource(&rootSource);
+
+    // Assert
+    EXPECT_EQ(name->size() + function->size() + constant->size(), memoryMutator->bytesAllocated());
+}
+
+TEST_F(MemoryMutatorTest, RemovesCollectedStringsFromInternedStrings) {
+    // Arrange
+    memoryMutator->create<cppLox::Types::ObjectString>("test");
+    memoryMutator->collectGarbage();
+
+    // Act
+    cppLox::Types::Object * string = memoryMutator->create<cppLox::Types::ObjectString>("test");
+
+    // Assert
+    EXPECT_EQ("test", string->as<cppLox::Types::ObjectString>()->string());
+    EXPECT_EQ(string->size(), memoryMutator->bytesAllocated());
+}
+
+TEST_F(MemoryMutatorTest, CollectsGarbageWhenThresholdIsExceeded) {
+    // Arrange
+    cppLox::MemoryMutator smallHeap(1024);
+
+    // Act
+    for (int i = 0; i < 1000; i++) {
+        smallHeap.create<cppLox::Types::ObjectString>(std::to_string(i));
+    }
+
+    // Assert
+    EXPECT_LE(smallHeap.bytesAllocated(), 1024 + sizeof(cppLox::Types::ObjectString) + sizeof(std::string) + 16);
+}
+
+TEST_F(MemoryMutatorTest, AllocatesYoungStringsByBumpingAPointer) {
+    // Act
+    cppLox::Types::Object * first = memoryMutator->createYoung<cppLox::Types::ObjectString>("first");
+    cppLox::Types::Object * second = memoryMutator->createYoung<cppLox::Types::ObjectString>("second");
+
+    // Assert
+    EXPECT_TRUE(memoryMutator->isYoung(first));
+    EXPECT_TRUE(memoryMutator->isYoung(second));
+    EXPECT_EQ(reinterpret_cast<std::byte *>(first) + sizeof(cppLox::Types::ObjectString),
+              reinterpret_cast<std::byte *>(second));
+}
+
+TEST_F(MemoryMutatorTest, FreesUnreachableYoungObjects) {
+    // Arrange
+    memoryMutator->createYoung<cppLox::Types::ObjectString>("unreachable");
+
+    // Act
+    memoryMutator->collectYoungGeneration();
+
+    // Assert
+    EXPECT_EQ(0, memoryMutator->bytesAllocated());
+}
+
+TEST_F(MemoryMutatorTest, PromotesYoungObjectsReferencedByRoots) {
+    // Arrange
+    TestRootSource rootSource;
+    memoryMutator->addRootSource(&rootSource);
+    cppLox::Types::Object * young = memoryMutator->createYoung<cppLox::Types::ObjectString>("young");
+    rootSource.values.push_back(cppLox::Types::Value(young));
+    rootSource.values.push_back(cppLox::Types::Value(young));
+
+    // Act
+    memoryMutator->collectYoungGeneration();
+    memoryMutator->removeRootSource(&rootSource);
+
+    // Assert
+    cppLox::Types::Object * promoted = rootSource.values[0].as<cppLox::Types::Object *>();
+    EXPECT_FALSE(memoryMutator->isYoung(promoted));
+    EXPECT_EQ(promoted, rootSource.values[1].as<cppLox::Types::Object *>());
+    EXPECT_EQ("young", promoted->as<cppLox::Types::ObjectString>()->string());
+    EXPECT_EQ(promoted, memoryMutator->create<cppLox::Types::ObjectString>("young"));
+}
+
+TEST_F(MemoryMutatorTest, PromotesYoungObjectsStoredInGlobals) {
+    // Arrange
+    cppLox::Types::Object * name = memoryMutator->create<cppLox::Types::ObjectString>("foo");
+    size_t slot = memoryMutator->resolveGlobal(name->as<cppLox::Types::ObjectString>());
+    memoryMutator->defineGlobal(slot, cppLox::Types::Value(1.0));
+    cppLox::Types::Object * young = memoryMutator->createYoung<cppLox::Types::ObjectString>("bar");
+    memoryMutator->setGlobal(slot, cppLox::Types::Value(young));
+
+    // Act
+    memoryMutator->collectYoungGeneration();
+
+    // Assert
+    cppLox::Types::Object * value = memoryMutator->getGlobal(slot).as<cppLox::Types::Object *>();
+    EXPECT_FALSE(memoryMutator->isYoung(value));
+    EXPECT_EQ("bar", value->as<cppLox::Types::ObjectString>()->string());
+}
+
+TEST_F(MemoryMutatorTest, TenuresYoungStringsThatAreCreatedAgainInTheOldGeneration) {
+    // Arrange
+    cppLox::Types::Object * name = memoryMutator->create<cppLox::Types::ObjectString>("foo");
+    size_t slot = memoryMutator->resolveGlobal(name->as<cppLox::Types::ObjectString>());
+    cppLox::Types::Object * young = memoryMutator->createYoung<cppLox::Types::ObjectString>("bar");
+    memoryMutator->defineGlobal(slot, cppLox::Types::Value(young));
+
+    // Act
+    cppLox::Types::Object * constant = memoryMutator->create<cppLox::Types::ObjectString>("bar");
+
+    // Assert
+    EXPECT_FALSE(memoryMutator->isYoung(constant));
+    EXPECT_EQ(constant, memoryMutator->getGlobal(slot).as<cppLox::Types::Object *>());
+}
+
+TEST_F(MemoryMutatorTest, CollectsYoungGenerationWhenNurseryIsFull) {
+    // Arrange
+    size_t const nurserySize = 4 * sizeof(cppLox::Types::ObjectString);
+    cppLox::MemoryMutator smallNursery(GC_INITIAL_THRESHOLD, GC_HEAP_GROW_FACTOR, nurserySize);
+
+    // Act
+    for (int i = 0; i < 100; i++) {
+        smallNursery.createYoung<cppLox::Types::ObjectString>(std::to_string(i));
+    }
+
+    // Assert
+    EXPECT_LE(smallNursery.bytesAllocated(), 4 * (sizeof(cppLox::Types::ObjectString) + sizeof(std::string) + 16));
+}
+
+TEST_F(MemoryMutatorTest, KeepsGlobalValuesThatAreOverwrittenWhileMarking) {
+    // Arrange
+    TestRootSource rootSource;
+    memoryMutator->addRootSource(&rootSource);
+    memoryMutator->setCollectionMode(cppLox::CollectionMode::INCREMENTAL);
+    cppLox::Types::Object * name = memoryMutator->create<cppLox::Types::ObjectString>("foo");
+    cppLox::Types::Object * value = memoryMutator->create<cppLox::Types::ObjectString>("bar");
+    size_t slot = memoryMutator->resolveGlobal(name->as<cppLox::Types::ObjectString>());
+    memoryMutator->defineGlobal(slot, cppLox::Types::Value(value));
+    size_t const bytesAllocated = memoryMutator->bytesAllocated();
+    memoryMutator->collectIncrementally();
+
+    // Act
+    rootSource.values.push_back(cppLox::Types::Value(value));
+    memoryMutator->setGlobal(slot, cppLox::Types::Value(1.0));
+    while (memoryMutator->isCollecting()) {
+        memoryMutator->collectIncrementally();
+    }
+    memoryMutator->removeRootSource(&rootSource);
+
+    // Assert
+    EXPECT_EQ(bytesAllocated, memoryMutator->bytesAllocated());
+}
+
+TEST_F(MemoryMutatorTest, KeepsObjectsAllocatedWhileMarking) {
+    // Arrange
+    memoryMutator->setCollectionMode(cppLox::CollectionMode::INCREMENTAL);
+    memoryMutator->collectIncrementally();
+
+    // Act
+    cppLox::Types::Object * string = memoryMutator->create<cppLox::Types::ObjectString>("new");
+    while (memoryMutator->isCollecting()) {
+        memoryMutator->collectIncrementally();
+    }
+
+    // Assert
+    EXPECT_EQ(string->size(), memoryMutator->bytesAllocated());
+}
+
+TEST_F(MemoryMutatorTest, RecordsThePausesOfIncrementalCollections) {
+    // Arrange
+    memoryMutator->setCollectionMode(cppLox::CollectionMode::INCREMENTAL);
+
+    // Act
+    memoryMutator->collectIncrementally();
+    memoryMutator->collectIncrementally();
+    memoryMutator->collectIncrementally();
+
+    // Assert
+    EXPECT_FALSE(memoryMutator->isCollecting());
+    EXPECT_EQ(1, memoryMutator->pauseHistogram(cppLox::CollectionPause::ROOT_SCAN).count());
+    EXPECT_EQ(1, memoryMutator->pauseHistogram(cppLox::CollectionPause::MARKING_STEP).count());
+    EXPECT_EQ(1, memoryMutator->pauseHistogram(cppLox::CollectionPause::SWEEPING_STEP).count());
+    EXPECT_EQ(0, memoryMutator->pauseHistogram(cppLox::CollectionPause::FULL).count());
+}
+
+TEST_F(MemoryMutatorTest, StartsIncrementalCollectionWhenThresholdIsExceeded) {
+    // Arrange
+    cppLox::MemoryMutator smallHeap(1024);
+    smallHeap.setCollectionMode(cppLox::CollectionMode::INCREMENTAL);
+
+    // Act
+    for (int i = 0; i < 1000; i++) {
+        smallHeap.create<cppLox::Types::ObjectString>(std::to_string(i));
+    }
+
+    // Assert
+    EXPECT_LT(0, smallHeap.pauseHistogram(cppLox::CollectionPause::ROOT_SCAN).count());
+    EXPECT_EQ(0, smallHeap.pauseHistogram(cppLox::CollectionPause::FULL).count());
+    EXPECT_LE(smallHeap.bytesAllocated(), 2 * (1024 + sizeof(cppLox::Types::ObjectString) + sizeof(std::string) + 16));
+}
+
+TEST_F(MemoryMutatorTest, MarksTheOldGenerationWithSeveralThreads) {
+    // Arrange
+    TestRootSource rootSource;
+    memoryMutator->addRootSource(&rootSource);
+    memoryMutator->setMarkingThreads(4, 0);
+    cppLox::Types::Object * name = memoryMutator->create<cppLox::Types::ObjectString>("foo");
+    cppLox::Types::Object * value = memoryMutator->create<cppLox::Types::ObjectString>("bar");
+    size_t slot = memoryMutator->resolveGlobal(name->as<cppLox::Types::ObjectString>());
+    memoryMutator->defineGlobal(slot, cppLox::Types::Value(value));
+    cppLox::Types::Object * function = memoryMutator->create<cppLox::Types::ObjectFunction>(0, nullptr);
+    cppLox::Types::Object * constant = memoryMutator->create<cppLox::Types::ObjectString>("constant");
+    static_cast<void>(function->as<cppLox::Types::ObjectFunction>()->chunk()->addConstant(constant));
+    rootSource.objects.push_back(function);
+    memoryMutator->create<cppLox::Types::ObjectString>("unreachable");
+
+    // Act
+    memoryMutator->collectGarbage();
+    memoryMutator->removeRootSource(&rootSource);
+
+    // Assert
+    EXPECT_EQ(4, memoryMutator->markingThreads());
+    EXPECT_EQ(name->size() + value->size() + function->size() + constant->size(), memoryMutator->bytesAllocated());
+}
@@ -0,0 +1,113 @@
+#include "../../src/object_arena.hpp"
+#include "../../src/types/object_string.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(ObjectArenaTest, AllocatesObjectsOfTheSameSizeNextToEachOther) {
+    // Arrange
+    cppLox::ObjectArena arena;
+
+    // Act
+    void * first = arena.allocate(24);
+    void * second = arena.allocate(20);
+
+    // Assert
+    EXPECT_EQ(32, reinterpret_cast<uintptr_t>(second) - reinterpret_cast<uintptr_t>(first));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(first) % ARENA_SIZE_CLASS_GRANULARITY);
+    cppLox::ObjectArena::deallocate(first);
+    cppLox::ObjectArena::deallocate(second);
+}
+
+TEST(ObjectArenaTest, AllocatesDifferentSizeClassesInDifferentPages) {
+    // Arrange
+    cppLox::ObjectArena arena;
+
+    // Act
+    void * small = arena.allocate(16);
+    void * large = arena.allocate(64);
+
+    // Assert
+    EXPECT_EQ(2, arena.usedPages());
+    EXPECT_NE(reinterpret_cast<uintptr_t>(small) / ARENA_PAGE_SIZE,
+              reinterpret_cast<uintptr_t>(large) / ARENA_PAGE_SIZE);
+    cppLox::ObjectArena::deallocate(small);
+    cppLox::ObjectArena::deallocate(large);
+}
+
+TEST(ObjectArenaTest, ReusesFreedSlots) {
+    // Arrange
+    cppLox::ObjectArena arena;
+    void * freed = arena.allocate(48);
+    void * kept = arena.allocate(48);
+    cppLox::ObjectArena::deallocate(freed);
+
+    // Act
+    void * reused = arena.allocate(48);
+
+    // Assert
+    EXPECT_EQ(freed, reused);
+    cppLox::ObjectArena::deallocate(kept);
+    cppLox::ObjectArena::deallocate(reused);
+}
+
+TEST(ObjectArenaTest, ReturnsEmptyPagesToTheOperatingSystem) {
+    // Arrange
+    cppLox::ObjectArena arena;
+    std::vector<void *> slots;
+    for (size_t slot = 0; slot < 3 * ARENA_PAGE_SIZE / 64; slot++) {
+        slots.push_back(arena.allocate(64));
+    }
+    size_t const usedPages = arena.usedPages();
+
+    for (void * slot : slots) {
+        cppLox::ObjectArena::deallocate(slot);
+    }
+
+    // Act
+    arena.trim();
+    size_t const cachedPages = arena.cachedPages();
+    arena.trim();
+
+    // Assert
+    EXPECT_LE(4, usedPages);
+    EXPECT_EQ(1, arena.usedPages());
+    EXPECT_EQ(usedPages - 1, cachedPages);
+    EXPECT_EQ(0, arena.cachedPages());
+    EXPECT_EQ(ARENA_CHUNK_SIZE, arena.mappedBytes());
+}
+
+TEST(ObjectArenaTest, ReusesCachedPagesForOtherSizeClasses) {
+    // Arrange
+    cppLox::ObjectArena arena;
+    std::vector<void *> slots;
+    for (size_t slot = 0; slot < 2 * ARENA_PAGE_SIZE / 32; slot++) {
+        slots.push_back(arena.allocate(32));
+    }
+    for (void * slot : slots) {
+        cppLox::ObjectArena::deallocate(slot);
+    }
+    size_t const cachedPages = arena.cachedPages();
+
+    // Act
+    void * other = arena.allocate(128);
+
+    // Assert
+    EXPECT_EQ(cachedPages - 1, arena.cachedPages());
+    cppLox::ObjectArena::deallocate(other);
+}
+
+TEST(ObjectArenaTest, CreatesObjectsThatAreFreedByTheDeleter) {
+    // Arrange
+    cppLox::ObjectArena arena;
+
+    // Act
+    cppLox::ObjectArena::Pointer string(arena.create<cppLox::Types::ObjectString>("arena"));
+
+    // Assert
+    EXPECT_EQ("arena", string->as<cppLox::Types::ObjectString>()->string());
+    string.reset();
+    EXPECT_EQ(1, arena.usedPages());
+}
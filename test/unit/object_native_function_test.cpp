@@ -1,8 +1,10 @@
 #include "../../src/types/object_formatter.hpp"
 #include "../../src/types/object_native_fuction.hpp"
 
+#include <array>
 #include <functional>
 #include <memory>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -18,6 +20,13 @@ static auto testFunction(int argCount, cppLox::Types::Value * args, cppLox::Back
     return cppLox::Types::Value();
 }
 
+static auto directTestFunction(std::span<cppLox::Types::Value> args) -> cppLox::Types::NativeResult {
+    if (args.empty()) {
+        return {cppLox::Types::Value(), "Expected an argument"};
+    }
+    return {args[0]};
+}
+
 class ObjectNativeFunctionTest : public ::testing::Test {
   protected:
     std::unique_ptr<cppLox::Types::Object> object;
@@ -79,4 +88,36 @@ TEST_F(ObjectNativeFunctionTest, format) {
 
     // Assert
     ASSERT_EQ(result, "<native fn>");
-}
\ No newline at end of file
+}
+TEST_F(ObjectNativeFunctionTest, isDirect) {
+    // Arrange
+    cppLox::Types::ObjectNativeFunction directFunction(directTestFunction, 1);
+
+    // Act & Assert
+    ASSERT_FALSE(object->as<cppLox::Types::ObjectNativeFunction>()->isDirect());
+    ASSERT_TRUE(directFunction.isDirect());
+}
+
+TEST_F(ObjectNativeFunctionTest, callDirect) {
+    // Arrange
+    cppLox::Types::ObjectNativeFunction directFunction(directTestFunction, 1);
+    std::array<cppLox::Types::Value, 1> args = {cppLox::Types::Value(42.0)};
+
+    // Act
+    auto result = directFunction.call(args);
+
+    // Assert
+    ASSERT_EQ(result.value, cppLox::Types::Value(42.0));
+    ASSERT_EQ(result.error, nullptr);
+}
+
+TEST_F(ObjectNativeFunctionTest, callDirectWithError) {
+    // Arrange
+    cppLox::Types::ObjectNativeFunction directFunction(directTestFunction, -1);
+
+    // Act
+    auto result = directFunction.call({});
+
+    // Assert
+    ASSERT_STREQ(result.error, "Expected an argument");
+}
@@ -0,0 +1,72 @@
+#include "../../src/parallel_marker.hpp"
+#include "../../src/types/object_function.hpp"
+#include "../../src/types/object_string.hpp"
+
+#include <format>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+class ParallelMarkerTest : public ::testing::Test {
+  protected:
+    // Creates a function, that references the given objects as constants
+    auto createFunction(std::vector<cppLox::Types::Object *> const & constants) -> cppLox::Types::Object * {
+        functions.push_back(std::make_unique<cppLox::Types::ObjectFunction>(0, nullptr));
+        for (cppLox::Types::Object * constant : constants) {
+            static_cast<void>(functions.back()->chunk()->addConstant(cppLox::Types::Value(constant)));
+        }
+        return functions.back().get();
+    }
+
+    auto createString(std::string string) -> cppLox::Types::Object * {
+        strings.push_back(std::make_unique<cppLox::Types::ObjectString>(string));
+        return strings.back().get();
+    }
+
+    std::vector<std::unique_ptr<cppLox::Types::ObjectFunction>> functions;
+    std::vector<std::unique_ptr<cppLox::Types::ObjectString>> strings;
+};
+
+TEST_F(ParallelMarkerTest, MarksEveryReachableObject) {
+    // Arrange
+    cppLox::ParallelMarker marker(4);
+    std::vector<cppLox::Types::Object *> roots;
+    for (int root = 0; root < 16; root++) {
+        // Every root references a chain of functions, so the threads have to steal from each other
+        cppLox::Types::Object * function = createFunction({createString(std::to_string(root))});
+        for (int depth = 0; depth < 100; depth++) {
+            function = createFunction({function, createString(std::format("{}_{}", root, depth))});
+        }
+        roots.push_back(function);
+        roots.push_back(function);
+    }
+    cppLox::Types::Object * unreachable = createString("unreachable");
+
+    // Act
+    marker.mark(roots, 1);
+
+    // Assert
+    for (std::unique_ptr<cppLox::Types::ObjectFunction> const & function : functions) {
+        EXPECT_TRUE(function->isMarked(1));
+    }
+    for (std::unique_ptr<cppLox::Types::ObjectString> const & string : strings) {
+        EXPECT_EQ(string.get() != unreachable, string->isMarked(1));
+    }
+}
+
+TEST_F(ParallelMarkerTest, MarksAgainInTheNextCycle) {
+    // Arrange
+    cppLox::ParallelMarker marker(2);
+    cppLox::Types::Object * string = createString("string");
+    std::vector<cppLox::Types::Object *> roots = {createFunction({string})};
+    marker.mark(roots, 1);
+
+    // Act
+    marker.mark(roots, 2);
+
+    // Assert
+    EXPECT_TRUE(roots[0]->isMarked(2));
+    EXPECT_TRUE(string->isMarked(2));
+}
@@ -0,0 +1,52 @@
+#include "../../src/pause_histogram.hpp"
+
+#include <chrono>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+TEST(PauseHistogramTest, CountsPausesInPowerOfTwoBuckets) {
+    // Arrange
+    cppLox::PauseHistogram histogram;
+
+    // Act
+    histogram.record(std::chrono::nanoseconds(500));
+    histogram.record(std::chrono::microseconds(1));
+    histogram.record(std::chrono::microseconds(5));
+    histogram.record(std::chrono::microseconds(7));
+    histogram.record(std::chrono::seconds(100));
+
+    // Assert
+    EXPECT_EQ(1u, histogram.bucket(0));
+    EXPECT_EQ(1u, histogram.bucket(1));
+    EXPECT_EQ(2u, histogram.bucket(3));
+    EXPECT_EQ(1u, histogram.bucket(cppLox::PauseHistogram::BUCKETS - 1));
+    EXPECT_EQ(std::chrono::microseconds(4), cppLox::PauseHistogram::lowerBound(3));
+}
+
+TEST(PauseHistogramTest, SummarizesThePauses) {
+    // Arrange
+    cppLox::PauseHistogram histogram;
+
+    // Act
+    histogram.record(std::chrono::microseconds(3));
+    histogram.record(std::chrono::microseconds(10));
+
+    // Assert
+    EXPECT_EQ(2u, histogram.count());
+    EXPECT_EQ(std::chrono::microseconds(13), histogram.total());
+    EXPECT_EQ(std::chrono::microseconds(10), histogram.longest());
+}
+
+TEST(PauseHistogramTest, PrintsTheBucketsWithPauses) {
+    // Arrange
+    cppLox::PauseHistogram histogram;
+    histogram.record(std::chrono::microseconds(3));
+    std::stringstream stream;
+
+    // Act
+    stream << histogram;
+
+    // Assert
+    EXPECT_EQ(">=        2 us: 1\n", stream.str());
+}
@@ -0,0 +1,95 @@
+#include "../../src/middleend/peephole_optimizer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+class PeepholeOptimizerTest : public ::testing::Test {
+  protected:
+    auto SetUp() -> void override {
+        chunk = cppLox::ByteCode::Chunk();
+    }
+
+    auto emit(std::vector<uint8_t> const & bytes, int line) -> void {
+        for (uint8_t const byte : bytes) {
+            chunk.write(byte, line);
+        }
+    }
+
+    cppLox::ByteCode::Chunk chunk;
+    cppLox::MiddleEnd::PeepholeOptimizer optimizer;
+};
+
+TEST_F(PeepholeOptimizerTest, JumpChainCollapsedAndDeadCodeRemoved) {
+    // Arrange
+    emit({cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE, 0, 3}, 1);
+    emit({cppLox::ByteCode::Opcode::JUMP, 0, 1}, 2);
+    emit({cppLox::ByteCode::Opcode::NULL_}, 3);
+    emit({cppLox::ByteCode::Opcode::JUMP, 0, 1}, 4);
+    emit({cppLox::ByteCode::Opcode::TRUE}, 5);
+    emit({cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN}, 6);
+
+    // Act
+    optimizer.optimize(chunk);
+
+    // Assert
+    std::vector<uint8_t> const expectedCode = {
+        cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE, 0, 3,
+        cppLox::ByteCode::Opcode::JUMP, 0, 1, cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::NULL_,
+        cppLox::ByteCode::Opcode::RETURN};
+    std::vector<size_t> const expectedLines = {1, 1, 1, 1, 2, 2, 2, 3, 6, 6};
+    ASSERT_EQ(chunk.code(), expectedCode);
+    for (size_t offset = 0; offset < expectedLines.size(); offset++) {
+        EXPECT_EQ(chunk.getLine(offset), expectedLines[offset]);
+    }
+}
+
+TEST_F(PeepholeOptimizerTest, JumpToLoopReplacedByLoop) {
+    // Arrange
+    emit({cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE, 0, 7}, 1);
+    emit({cppLox::ByteCode::Opcode::JUMP, 0, 1}, 2);
+    emit({cppLox::ByteCode::Opcode::TRUE}, 3);
+    emit({cppLox::ByteCode::Opcode::LOOP, 0, 11}, 4);
+    emit({cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN}, 5);
+
+    // Act
+    optimizer.optimize(chunk);
+
+    // Assert
+    std::vector<uint8_t> const expectedCode = {
+        cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE, 0, 3,
+        cppLox::ByteCode::Opcode::LOOP, 0, 7, cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN};
+    ASSERT_EQ(chunk.code(), expectedCode);
+}
+
+TEST_F(PeepholeOptimizerTest, NegationFusedWithPopJumpIfFalse) {
+    // Arrange
+    emit({cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::NOT}, 1);
+    emit({cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE, 0, 1, cppLox::ByteCode::Opcode::TRUE}, 2);
+    emit({cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN}, 3);
+
+    // Act
+    optimizer.optimize(chunk);
+
+    // Assert
+    std::vector<uint8_t> const expectedCode = {
+        cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::POP_JUMP_IF_TRUE, 0, 1,
+        cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN};
+    ASSERT_EQ(chunk.code(), expectedCode);
+    EXPECT_EQ(chunk.getLine(1), 2);
+}
+
+TEST_F(PeepholeOptimizerTest, NegationNotFusedWithJumpTarget) {
+    // Arrange
+    emit({cppLox::ByteCode::Opcode::TRUE, cppLox::ByteCode::Opcode::JUMP_IF_FALSE, 0, 1}, 1);
+    emit({cppLox::ByteCode::Opcode::NOT, cppLox::ByteCode::Opcode::POP_JUMP_IF_FALSE, 0, 0}, 2);
+    emit({cppLox::ByteCode::Opcode::NULL_, cppLox::ByteCode::Opcode::RETURN}, 3);
+    std::vector<uint8_t> const expectedCode = chunk.code();
+
+    // Act
+    optimizer.optimize(chunk);
+
+    // Assert
+    ASSERT_EQ(chunk.code(), expectedCode);
+}
@@ -0,0 +1,30 @@
+#ifdef JIT
+
+#include "../../src/backend/perf_map.hpp"
+
+#include <format>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+TEST(PerfMapTest, AppendsSymbolToThePerfMapOfTheProcess) {
+    // Arrange
+    cppLox::Backend::PerfMap perfMap;
+    int code = 0;
+
+    // Act
+    perfMap.add(&code, 0x2a, "lox::perfMapTest");
+
+    // Assert
+    std::ifstream file(std::format("/tmp/perf-{}.map", getpid()));
+    std::string line;
+    std::string lastLine;
+    while (std::getline(file, line)) {
+        lastLine = line;
+    }
+    EXPECT_EQ(std::format("{:x} 2a lox::perfMapTest", reinterpret_cast<uintptr_t>(&code)), lastLine);
+}
+
+#endif
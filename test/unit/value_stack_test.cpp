@@ -0,0 +1,43 @@
+#include "../../src/backend/value_stack.hpp"
+#include "../../src/types/value.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(ValueStackTest, CommitsMemoryUpFront) {
+    // Arrange & Act
+    cppLox::Backend::ValueStack stack(1024);
+
+    // Assert
+    EXPECT_GT(stack.capacity(), 0u);
+    EXPECT_LE(stack.capacity(), stack.maxSize());
+}
+
+TEST(ValueStackTest, GrowsWithoutMovingValues) {
+    // Arrange
+    size_t const maxSize = 1 << 20;
+    cppLox::Backend::ValueStack stack(maxSize);
+    cppLox::Types::Value * bottom = stack.data();
+    stack[0] = cppLox::Types::Value(42.0);
+
+    // Act
+    bool result = stack.ensureCapacity(maxSize);
+    stack[maxSize - 1] = cppLox::Types::Value(true);
+
+    // Assert
+    EXPECT_TRUE(result);
+    EXPECT_EQ(stack.capacity(), maxSize);
+    EXPECT_EQ(bottom, stack.data());
+    EXPECT_EQ(cppLox::Types::Value(42.0), stack[0]);
+    EXPECT_EQ(cppLox::Types::Value(true), stack[maxSize - 1]);
+}
+
+TEST(ValueStackTest, CanNotGrowPastMaximumSize) {
+    // Arrange
+    cppLox::Backend::ValueStack stack(1024);
+
+    // Act
+    bool result = stack.ensureCapacity(1025);
+
+    // Assert
+    EXPECT_FALSE(result);
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <format>
+#include <limits>
 #include <utility>
 
 #include "../../src/error/runtime_exception.hpp"
@@ -50,6 +53,41 @@ TEST_F(ValueTest, as) {
     EXPECT_EQ(objectVal.as<cppLox::Types::Object *>(), nullptr);
 }
 
+TEST_F(ValueTest, SpecialNumbers) {
+    // Arrange
+    cppLox::Types::Value nanVal(std::numeric_limits<double>::quiet_NaN());
+    cppLox::Types::Value infinityVal(-std::numeric_limits<double>::infinity());
+
+    // Assert
+    EXPECT_TRUE(nanVal.is(cppLox::Types::Value::Type::NUMBER));
+    EXPECT_NE(nanVal, nanVal);
+    EXPECT_TRUE(infinityVal.is(cppLox::Types::Value::Type::NUMBER));
+    EXPECT_EQ(infinityVal.as<double>(), -std::numeric_limits<double>::infinity());
+}
+
+TEST_F(ValueTest, NegativeNaNKeepsItsSign) {
+    // Arrange
+    cppLox::Types::Value nanVal(-std::numeric_limits<double>::quiet_NaN());
+
+    // Assert
+    EXPECT_TRUE(nanVal.is(cppLox::Types::Value::Type::NUMBER));
+    EXPECT_TRUE(std::signbit(nanVal.as<double>()));
+    EXPECT_EQ(std::format("{}", nanVal), std::format("{}", -std::numeric_limits<double>::quiet_NaN()));
+}
+
+TEST_F(ValueTest, ObjectPointerRoundTrip) {
+    // Arrange
+    cppLox::Types::Object * object = reinterpret_cast<cppLox::Types::Object *>(&numVal);
+
+    // Act
+    cppLox::Types::Value value(object);
+
+    // Assert
+    EXPECT_TRUE(value.is(cppLox::Types::Value::Type::OBJECT));
+    EXPECT_EQ(value.as<cppLox::Types::Object *>(), object);
+    EXPECT_EQ(value, cppLox::Types::Value(object));
+}
+
 TEST_F(ValueTest, getType) {
     EXPECT_EQ(numVal.getType(), cppLox::Types::Value::Type::NUMBER);
     EXPECT_EQ(boolVal.getType(), cppLox::Types::Value::Type::BOOL);
@@ -0,0 +1,94 @@
+#include "../../src/work_stealing_deque.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(WorkStealingDequeTest, PopsTheWorkThatWasPushedLast) {
+    // Arrange
+    cppLox::WorkStealingDeque<int> deque;
+    deque.push(1);
+    deque.push(2);
+
+    // Act
+    std::optional<int> first = deque.pop();
+    std::optional<int> second = deque.pop();
+    std::optional<int> third = deque.pop();
+
+    // Assert
+    EXPECT_EQ(2, first);
+    EXPECT_EQ(1, second);
+    EXPECT_FALSE(third.has_value());
+    EXPECT_TRUE(deque.empty());
+}
+
+TEST(WorkStealingDequeTest, StealsTheWorkThatWasPushedFirst) {
+    // Arrange
+    cppLox::WorkStealingDeque<int> deque;
+    deque.push(1);
+    deque.push(2);
+
+    // Act
+    std::optional<int> stolen = deque.steal();
+
+    // Assert
+    EXPECT_EQ(1, stolen);
+    EXPECT_EQ(2, deque.pop());
+}
+
+TEST(WorkStealingDequeTest, GrowsWhenItIsFull) {
+    // Arrange
+    cppLox::WorkStealingDeque<int> deque(2);
+
+    // Act
+    for (int work = 0; work < 100; work++) {
+        deque.push(work);
+    }
+
+    // Assert
+    for (int work = 99; work >= 0; work--) {
+        EXPECT_EQ(work, deque.pop());
+    }
+}
+
+TEST(WorkStealingDequeTest, HandsOutEveryWorkOnceWhileBeingStolenFrom) {
+    // Arrange
+    constexpr int WORK = 100000;
+    cppLox::WorkStealingDeque<int> deque(16);
+    std::vector<std::atomic<int>> taken(WORK);
+    std::atomic<bool> pushing = true;
+    std::vector<std::thread> thieves;
+    for (int thief = 0; thief < 3; thief++) {
+        thieves.emplace_back([&] {
+            while (pushing.load() || !deque.empty()) {
+                if (std::optional<int> work = deque.steal()) {
+                    taken[*work]++;
+                }
+            }
+        });
+    }
+
+    // Act
+    for (int work = 0; work < WORK; work++) {
+        deque.push(work);
+        if (work % 3 == 0) {
+            if (std::optional<int> popped = deque.pop()) {
+                taken[*popped]++;
+            }
+        }
+    }
+    while (std::optional<int> popped = deque.pop()) {
+        taken[*popped]++;
+    }
+    pushing = false;
+    for (std::thread & thief : thieves) {
+        thief.join();
+    }
+
+    // Assert
+    for (int work = 0; work < WORK; work++) {
+        EXPECT_EQ(1, taken[work].load()) << "work " << work;
+    }
+}